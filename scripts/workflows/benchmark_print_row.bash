@@ -0,0 +1,7 @@
+#!/bin/bash
+csv=$1
+shift
+for key in "$@"
+do
+    awk -F, -v key="$key" '$1 "::" $2 == key {printf "|%d|%.3f|%.3f", $3, $5, $9; found=1} END {if (!found) printf "|-|-|-"}' "$csv"
+done
@@ -80,6 +80,14 @@ struct timing_stats {
     }
 };
 
+//! Event recorded during the benchmark (e.g. a change of the parameters)
+struct benchmark_event {
+    //! elapsed time since the benchmark manager was created
+    double time_ms = 0.0;
+    std::string module;
+    std::string description;
+};
+
 class benchmark_manager {
 public:
     static benchmark_manager& get_instance() {
@@ -96,6 +104,16 @@ public:
         stats_[key].add_sample(time_ms);
     }
 
+    void record_event(const std::string& module, const std::string& description) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back({start_timer_.elapsed_ms(), module, description});
+    }
+
+    std::vector<benchmark_event> get_events() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return events_;
+    }
+
     timing_stats get_stats(const std::string& module, const std::string& function) const {
         std::lock_guard<std::mutex> lock(mutex_);
         std::string key = module + "::" + function;
@@ -165,6 +183,15 @@ public:
                   << total_calls << " total calls, " 
                   << std::fixed << std::setprecision(2) << total_processing_time << " ms total time" << std::endl;
         std::cout << std::string(total_width, '=') << std::endl;
+
+        if (!events_.empty()) {
+            std::cout << "EVENTS:" << std::endl;
+            for (const auto& event : events_) {
+                std::cout << std::right << std::setw(12) << std::fixed << std::setprecision(2) << event.time_ms << " ms  "
+                          << event.module << ": " << event.description << std::endl;
+            }
+            std::cout << std::string(total_width, '=') << std::endl;
+        }
     }
 
     void save_to_csv(const std::string& filename) const {
@@ -197,9 +224,28 @@ public:
         std::cout << "Benchmark results saved to " << filename << std::endl;
     }
 
+    void save_events_to_csv(const std::string& filename) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << filename << " for writing" << std::endl;
+            return;
+        }
+
+        file << "Time_ms,Module,Description\n";
+        for (const auto& event : events_) {
+            file << std::fixed << std::setprecision(3) << event.time_ms << ","
+                 << event.module << ","
+                 << "\"" << event.description << "\"\n";
+        }
+
+        std::cout << "Benchmark events saved to " << filename << std::endl;
+    }
+
     void reset() {
         std::lock_guard<std::mutex> lock(mutex_);
         stats_.clear();
+        events_.clear();
     }
 
     void enable(bool enabled = true) {
@@ -215,6 +261,9 @@ public:
 private:
     mutable std::mutex mutex_;
     std::unordered_map<std::string, timing_stats> stats_;
+    std::vector<benchmark_event> events_;
+    //! timer started when the benchmark manager is created
+    timer start_timer_;
     bool enabled_ = true;
 
     benchmark_manager() = default;
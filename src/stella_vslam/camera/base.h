@@ -137,6 +137,9 @@ public:
     //! Undistort point according to camera model
     virtual cv::Point2f undistort_point(const cv::Point2f& dist_pt) const = 0;
 
+    //! Distort point according to camera model (the inverse of undistort_point)
+    virtual cv::Point2f distort_point(const cv::Point2f& undist_pt) const = 0;
+
     //! Convert undistorted point to bearing vector
     virtual Vec3_t convert_point_to_bearing(const cv::Point2f& undist_pt) const = 0;
 
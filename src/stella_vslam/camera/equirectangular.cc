@@ -39,6 +39,10 @@ cv::Point2f equirectangular::undistort_point(const cv::Point2f& dist_pt) const {
     return dist_pt;
 }
 
+cv::Point2f equirectangular::distort_point(const cv::Point2f& undist_pt) const {
+    return undist_pt;
+}
+
 Vec3_t equirectangular::convert_point_to_bearing(const cv::Point2f& undist_pt) const {
     // "From Google Street View to 3D City Models (ICCVW 2009)"
     // convert to unit polar coordinates
@@ -153,6 +153,24 @@ cv::Point2f fisheye::undistort_point(const cv::Point2f& dist_pt) const {
     return undist_pt;
 }
 
+cv::Point2f fisheye::distort_point(const cv::Point2f& undist_pt) const {
+    // normalized coordinates
+    const double x = (undist_pt.x - cx_) * fx_inv_;
+    const double y = (undist_pt.y - cy_) * fy_inv_;
+
+    // equidistant distortion of the incident angle (the model of cv::fisheye::undistortPoints)
+    const double r = std::sqrt(x * x + y * y);
+    if (r < 1e-8) {
+        return undist_pt;
+    }
+    const double theta = std::atan(r);
+    const double theta2 = theta * theta;
+    const double theta_d = theta * (1.0 + theta2 * (k1_ + theta2 * (k2_ + theta2 * (k3_ + theta2 * k4_))));
+    const double scale = theta_d / r;
+
+    return cv::Point2f(fx_ * x * scale + cx_, fy_ * y * scale + cy_);
+}
+
 Vec3_t fisheye::convert_point_to_bearing(const cv::Point2f& undist_pt) const {
     const auto x_normalized = (undist_pt.x - cx_) / fx_;
     const auto y_normalized = (undist_pt.y - cy_) / fy_;
@@ -28,6 +28,8 @@ public:
 
     cv::Point2f undistort_point(const cv::Point2f& dist_pt) const override final;
 
+    cv::Point2f distort_point(const cv::Point2f& undist_pt) const override final;
+
     Vec3_t convert_point_to_bearing(const cv::Point2f& undist_pt) const override final;
 
     cv::Point2f convert_bearing_to_point(const Vec3_t& bearing) const override final;
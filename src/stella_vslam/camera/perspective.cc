@@ -114,6 +114,20 @@ cv::Point2f perspective::undistort_point(const cv::Point2f& dist_pt) const {
     return undist_pt;
 }
 
+cv::Point2f perspective::distort_point(const cv::Point2f& undist_pt) const {
+    // normalized coordinates
+    const double x = (undist_pt.x - cx_) * fx_inv_;
+    const double y = (undist_pt.y - cy_) * fy_inv_;
+
+    // radial and tangential distortion (the model of cv::undistortPoints)
+    const double r2 = x * x + y * y;
+    const double radial = 1.0 + k1_ * r2 + k2_ * r2 * r2 + k3_ * r2 * r2 * r2;
+    const double dist_x = x * radial + 2.0 * p1_ * x * y + p2_ * (r2 + 2.0 * x * x);
+    const double dist_y = y * radial + p1_ * (r2 + 2.0 * y * y) + 2.0 * p2_ * x * y;
+
+    return cv::Point2f(fx_ * dist_x + cx_, fy_ * dist_y + cy_);
+}
+
 Vec3_t perspective::convert_point_to_bearing(const cv::Point2f& undist_pt) const {
     const auto x_normalized = (undist_pt.x - cx_) / fx_;
     const auto y_normalized = (undist_pt.y - cy_) / fy_;
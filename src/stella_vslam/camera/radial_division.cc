@@ -97,6 +97,27 @@ cv::Point2f radial_division::undistort_point(const cv::Point2f& dist_pt) const {
     return undist_pt;
 }
 
+cv::Point2f radial_division::distort_point(const cv::Point2f& undist_pt) const {
+    const double pixel_x = (undist_pt.x - cx_) / fx_;
+    const double pixel_y = (undist_pt.y - cy_) / fy_;
+    const double radius_undistorted = std::sqrt(pixel_x * pixel_x + pixel_y * pixel_y);
+    if (distortion_ == 0.0 || radius_undistorted < 1e-8) {
+        return undist_pt;
+    }
+
+    // solve r_u = r_d / (1 + distortion * r_d^2) for the distorted radius r_d closest to r_u
+    // (the radii beyond the extremum of the model are clamped to it)
+    const double discriminant = std::max(0.0, 1.0 - 4.0 * distortion_ * radius_undistorted * radius_undistorted);
+    const double radius_distorted = 2.0 * radius_undistorted / (1.0 + std::sqrt(discriminant));
+    const double scale = radius_distorted / radius_undistorted;
+
+    cv::Point2f dist_pt;
+    dist_pt.x = pixel_x * scale * fx_ + cx_;
+    dist_pt.y = pixel_y * scale * fy_ + cy_;
+
+    return dist_pt;
+}
+
 Vec3_t radial_division::convert_point_to_bearing(const cv::Point2f& undist_pt) const {
     const auto x_normalized = (undist_pt.x - cx_) / fx_;
     const auto y_normalized = (undist_pt.y - cy_) / fy_;
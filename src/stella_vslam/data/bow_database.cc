@@ -2,6 +2,7 @@
 #include "stella_vslam/data/keyframe.h"
 #include "stella_vslam/data/bow_database.h"
 #include "stella_vslam/data/bow_vocabulary.h"
+#include "stella_vslam/util/background_deleter.h"
 
 #include <spdlog/spdlog.h>
 
@@ -49,19 +50,23 @@ void bow_database::erase_keyframe(const std::shared_ptr<keyframe>& keyfrm) {
     }
 }
 
-void bow_database::clear() {
+void bow_database::clear(util::background_deleter* deleter) {
     std::lock_guard<std::mutex> lock(mtx_);
     spdlog::info("clear BoW database");
+    if (deleter) {
+        deleter->dispose(std::move(keyfrms_in_node_));
+    }
     keyfrms_in_node_.clear();
 }
 
 std::vector<std::shared_ptr<keyframe>> bow_database::acquire_keyframes(const bow_vector& bow_vec, const float min_score,
                                                                        const float num_common_words_thr_ratio,
-                                                                       const std::set<std::shared_ptr<keyframe>>& keyfrms_to_reject) {
+                                                                       const std::set<std::shared_ptr<keyframe>>& keyfrms_to_reject,
+                                                                       const keyframe_region* region) {
     // Step 1.
     // Count up the number of nodes, words which are shared with query_keyframe, for all the keyframes in DoW database
 
-    const auto num_common_words = compute_num_common_words(bow_vec, keyfrms_to_reject);
+    const auto num_common_words = compute_num_common_words(bow_vec, keyfrms_to_reject, region);
     if (num_common_words.empty()) {
         return std::vector<std::shared_ptr<keyframe>>();
     }
@@ -97,8 +102,11 @@ std::vector<std::shared_ptr<keyframe>> bow_database::acquire_keyframes(const bow
 
 std::unordered_map<std::shared_ptr<keyframe>, unsigned int>
 bow_database::compute_num_common_words(const bow_vector& bow_vec,
-                                       const std::set<std::shared_ptr<keyframe>>& keyfrms_to_reject) const {
+                                       const std::set<std::shared_ptr<keyframe>>& keyfrms_to_reject,
+                                       const keyframe_region* region) const {
     std::unordered_map<std::shared_ptr<keyframe>, unsigned int> num_common_words;
+    // Cache whether each keyframe is in the region, because a keyframe appears in many nodes
+    std::unordered_map<std::shared_ptr<keyframe>, bool> keyfrm_is_in_region;
 
     std::lock_guard<std::mutex> lock(mtx_);
 
@@ -114,6 +122,15 @@ bow_database::compute_num_common_words(const bow_vector& bow_vec,
         // For each keyframe, increase shared word number one by one
         for (const auto& keyfrm_in_node : keyfrms_in_node) {
             // If far enough from the query keyframe, store it as the initial loop candidates
+            if (region) {
+                auto itr = keyfrm_is_in_region.find(keyfrm_in_node);
+                if (itr == keyfrm_is_in_region.end()) {
+                    itr = keyfrm_is_in_region.emplace(keyfrm_in_node, region->contains(keyfrm_in_node)).first;
+                }
+                if (!itr->second) {
+                    continue;
+                }
+            }
             if (!static_cast<bool>(keyfrms_to_reject.count(keyfrm_in_node))) {
                 // Initialize if not in num_common_words
                 if (!static_cast<bool>(num_common_words.count(keyfrm_in_node))) {
@@ -12,10 +12,16 @@
 #include <memory>
 
 namespace stella_vslam {
+
+namespace util {
+class background_deleter;
+} // namespace util
+
 namespace data {
 
 class frame;
 class keyframe;
+class keyframe_region;
 
 class bow_database {
 public:
@@ -44,15 +50,18 @@ public:
 
     /**
      * Clear the database
+     * (if the deleter is given, the old contents are destroyed in its background thread)
      */
-    void clear();
+    void clear(util::background_deleter* deleter = nullptr);
 
     /**
      * Acquire keyframes over score
+     * (if the region is given, only the keyframes in the region are scored)
      */
     std::vector<std::shared_ptr<keyframe>> acquire_keyframes(const bow_vector& bow_vec, const float min_score = 0.0f,
                                                              const float num_common_words_thr_ratio = 0.8f,
-                                                             const std::set<std::shared_ptr<keyframe>>& keyfrms_to_reject = {});
+                                                             const std::set<std::shared_ptr<keyframe>>& keyfrms_to_reject = {},
+                                                             const keyframe_region* region = nullptr);
 
 protected:
     /**
@@ -64,11 +73,13 @@ protected:
      * Compute the number of shared words
      * @param bow_vec
      * @param keyfrms_to_reject
+     * @param region (the keyframes outside of it are rejected)
      * @return number of shared words between the query and the each of keyframes contained in the database (key: keyframes that share word with query keyframe, value: number of shared words)
      */
     std::unordered_map<std::shared_ptr<keyframe>, unsigned int>
     compute_num_common_words(const bow_vector& bow_vec,
-                             const std::set<std::shared_ptr<keyframe>>& keyfrms_to_reject = {}) const;
+                             const std::set<std::shared_ptr<keyframe>>& keyfrms_to_reject = {},
+                             const keyframe_region* region = nullptr) const;
 
     /**
      * Compute scores (scores_) between the query and the each of keyframes contained in the database
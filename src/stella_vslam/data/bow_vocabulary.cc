@@ -47,6 +47,22 @@ bow_vocabulary* load(std::string path) {
     return bow_vocab;
 }
 
+bool save(bow_vocabulary* bow_vocab, const std::string& path) {
+    try {
+#ifdef USE_DBOW2
+        bow_vocab->saveToBinaryFile(path);
+#else
+        bow_vocab->saveToFile(path);
+#endif
+    }
+    catch (const std::exception& e) {
+        spdlog::critical("cannot save the vocabulary to {}: {}", path, e.what());
+        return false;
+    }
+    spdlog::info("save the vocabulary to {}", path);
+    return true;
+}
+
 }; // namespace bow_vocabulary_util
 }; // namespace data
 }; // namespace stella_vslam
@@ -17,6 +17,7 @@ namespace bow_vocabulary_util {
 float score(bow_vocabulary* bow_vocab, const bow_vector& bow_vec1, const bow_vector& bow_vec2);
 void compute_bow(bow_vocabulary* bow_vocab, const cv::Mat& descriptors, bow_vector& bow_vec, bow_feature_vector& bow_feat_vec);
 bow_vocabulary* load(std::string path);
+bool save(bow_vocabulary* bow_vocab, const std::string& path);
 
 }; // namespace bow_vocabulary_util
 }; // namespace data
@@ -0,0 +1,184 @@
+#include "stella_vslam/data/bow_vocabulary_trainer.h"
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/camera_database.h"
+#include "stella_vslam/data/orb_params_database.h"
+#include "stella_vslam/data/map_database.h"
+#include "stella_vslam/io/map_database_io_factory.h"
+#include "stella_vslam/util/converter.h"
+
+#include <algorithm>
+#include <iterator>
+#include <chrono>
+#include <thread>
+
+#ifndef USE_DBOW2
+#include <fbow/vocabulary_creator.h>
+#endif // USE_DBOW2
+
+#include <spdlog/spdlog.h>
+
+namespace stella_vslam {
+namespace data {
+
+bow_vocabulary_trainer::bow_vocabulary_trainer(const unsigned int branching_factor, const unsigned int depth,
+                                               const unsigned int holdout_interval)
+    : branching_factor_(branching_factor), depth_(depth), holdout_interval_(holdout_interval) {}
+
+bool bow_vocabulary_trainer::add_map(const std::string& path, const std::string& map_format) {
+    // The vocabulary is not needed to read the keyframes and their descriptors
+    camera_database cam_db;
+    orb_params_database orb_params_db;
+    map_database map_db(15);
+    auto map_database_io = io::map_database_io_factory::create(map_format);
+    if (!map_database_io->load(path, &cam_db, &orb_params_db, &map_db, nullptr, nullptr)) {
+        return false;
+    }
+    add_keyframes(map_db.get_all_keyframes());
+    return true;
+}
+
+void bow_vocabulary_trainer::add_keyframes(const std::vector<std::shared_ptr<keyframe>>& keyfrms) {
+    auto sorted_keyfrms = keyfrms;
+    std::sort(sorted_keyfrms.begin(), sorted_keyfrms.end(),
+              [](const std::shared_ptr<keyframe>& keyfrm_1, const std::shared_ptr<keyframe>& keyfrm_2) {
+                  return keyfrm_1->id_ < keyfrm_2->id_;
+              });
+
+    const unsigned int map_idx = num_maps_++;
+    std::set<unsigned int> training_ids;
+    std::vector<sample> holdout_samples;
+    for (unsigned int i = 0; i < sorted_keyfrms.size(); ++i) {
+        const auto& keyfrm = sorted_keyfrms.at(i);
+        if (!keyfrm || keyfrm->will_be_erased() || keyfrm->frm_obs_->descriptors_.empty()) {
+            continue;
+        }
+
+        sample smpl;
+        smpl.map_idx_ = map_idx;
+        smpl.keyfrm_id_ = keyfrm->id_;
+        smpl.descriptors_ = keyfrm->frm_obs_->descriptors_.clone();
+        for (const auto& covisibility : keyfrm->graph_node_->get_covisibilities()) {
+            smpl.covisibility_ids_.insert(covisibility->id_);
+        }
+
+        if (0 < holdout_interval_ && i % holdout_interval_ == holdout_interval_ - 1) {
+            holdout_samples.push_back(std::move(smpl));
+        }
+        else {
+            training_ids.insert(smpl.keyfrm_id_);
+            training_samples_.push_back(std::move(smpl));
+        }
+    }
+
+    // Only the covisibilities which can be retrieved are regarded as the correct answers
+    for (auto& smpl : holdout_samples) {
+        std::set<unsigned int> retrievable_ids;
+        std::set_intersection(smpl.covisibility_ids_.begin(), smpl.covisibility_ids_.end(),
+                              training_ids.begin(), training_ids.end(),
+                              std::inserter(retrievable_ids, retrievable_ids.end()));
+        smpl.covisibility_ids_ = std::move(retrievable_ids);
+        holdout_samples_.push_back(std::move(smpl));
+    }
+
+    spdlog::info("add {} keyframes of map {} ({} held out)", keyfrms.size(), map_idx, holdout_samples.size());
+}
+
+unsigned int bow_vocabulary_trainer::get_num_training_keyframes() const {
+    return training_samples_.size();
+}
+
+unsigned int bow_vocabulary_trainer::get_num_holdout_keyframes() const {
+    return holdout_samples_.size();
+}
+
+std::unique_ptr<bow_vocabulary> bow_vocabulary_trainer::train() const {
+    if (training_samples_.empty()) {
+        spdlog::warn("no keyframes to train the vocabulary");
+        return nullptr;
+    }
+
+    spdlog::info("train the vocabulary (branching factor: {}, depth: {}) with {} keyframes",
+                 branching_factor_, depth_, training_samples_.size());
+#ifdef USE_DBOW2
+    auto bow_vocab = std::unique_ptr<bow_vocabulary>(new bow_vocabulary(branching_factor_, depth_, DBoW2::TF_IDF, DBoW2::L1_NORM));
+    std::vector<std::vector<cv::Mat>> features;
+    features.reserve(training_samples_.size());
+    for (const auto& smpl : training_samples_) {
+        features.push_back(util::converter::to_desc_vec(smpl.descriptors_));
+    }
+    bow_vocab->create(features);
+#else
+    auto bow_vocab = std::unique_ptr<bow_vocabulary>(new bow_vocabulary());
+    std::vector<cv::Mat> features;
+    features.reserve(training_samples_.size());
+    for (const auto& smpl : training_samples_) {
+        features.push_back(smpl.descriptors_);
+    }
+    const fbow::VocabularyCreator::Params params(branching_factor_, depth_, std::max(1u, std::thread::hardware_concurrency()));
+    fbow::VocabularyCreator creator;
+    creator.create(*bow_vocab, features, "orb", params);
+#endif // USE_DBOW2
+    return bow_vocab;
+}
+
+bow_vocabulary_trainer::evaluation bow_vocabulary_trainer::evaluate(bow_vocabulary* bow_vocab) const {
+    evaluation eval;
+    if (!bow_vocab) {
+        return eval;
+    }
+
+    double transform_time_ms = 0.0;
+    const auto transform = [bow_vocab, &transform_time_ms](const sample& smpl) {
+        bow_vector bow_vec;
+        bow_feature_vector bow_feat_vec;
+        const auto start = std::chrono::steady_clock::now();
+        bow_vocabulary_util::compute_bow(bow_vocab, smpl.descriptors_, bow_vec, bow_feat_vec);
+        transform_time_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return bow_vec;
+    };
+
+    std::vector<bow_vector> training_bow_vecs;
+    training_bow_vecs.reserve(training_samples_.size());
+    for (const auto& smpl : training_samples_) {
+        training_bow_vecs.push_back(transform(smpl));
+    }
+
+    unsigned int num_transforms = training_samples_.size();
+    for (const auto& query : holdout_samples_) {
+        const auto query_bow_vec = transform(query);
+        ++num_transforms;
+        // Skip the query which has no retrievable answer
+        if (query.covisibility_ids_.empty()) {
+            continue;
+        }
+
+        float best_score = -1.0;
+        const sample* best_match = nullptr;
+        for (unsigned int i = 0; i < training_samples_.size(); ++i) {
+            const auto score = bow_vocabulary_util::score(bow_vocab, query_bow_vec, training_bow_vecs.at(i));
+            if (best_score < score) {
+                best_score = score;
+                best_match = &training_samples_.at(i);
+            }
+        }
+
+        ++eval.num_queries_;
+        if (best_match && best_match->map_idx_ == query.map_idx_
+            && query.covisibility_ids_.count(best_match->keyfrm_id_)) {
+            ++eval.num_correct_;
+        }
+    }
+
+    if (0 < eval.num_queries_) {
+        eval.precision_ = static_cast<double>(eval.num_correct_) / eval.num_queries_;
+    }
+    if (0 < num_transforms) {
+        eval.mean_transform_time_ms_ = transform_time_ms / num_transforms;
+    }
+    spdlog::info("retrieval precision: {:.3f} ({}/{}), transform time: {:.3f} ms/keyframe",
+                 eval.precision_, eval.num_correct_, eval.num_queries_, eval.mean_transform_time_ms_);
+    return eval;
+}
+
+} // namespace data
+} // namespace stella_vslam
@@ -0,0 +1,103 @@
+#ifndef STELLA_VSLAM_DATA_BOW_VOCABULARY_TRAINER_H
+#define STELLA_VSLAM_DATA_BOW_VOCABULARY_TRAINER_H
+
+#include "stella_vslam/data/bow_vocabulary.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+namespace stella_vslam {
+namespace data {
+
+class keyframe;
+
+/**
+ * Train a BoW vocabulary from the keyframe descriptors of saved maps
+ */
+class bow_vocabulary_trainer {
+public:
+    /**
+     * Retrieval statistics on the held-out keyframes
+     */
+    struct evaluation {
+        //! number of held-out keyframes used as queries
+        unsigned int num_queries_ = 0;
+        //! number of queries whose best match is one of their covisibilities
+        unsigned int num_correct_ = 0;
+        //! num_correct_ / num_queries_
+        double precision_ = 0.0;
+        //! mean time to transform the descriptors of a keyframe into the BoW vector [ms]
+        double mean_transform_time_ms_ = 0.0;
+    };
+
+    /**
+     * Constructor
+     * @param branching_factor
+     * @param depth
+     * @param holdout_interval every holdout_interval-th keyframe is held out for evaluation (0: no holdout)
+     */
+    bow_vocabulary_trainer(const unsigned int branching_factor, const unsigned int depth,
+                           const unsigned int holdout_interval = 10);
+
+    /**
+     * Load the map saved by the map_database_io backend and add its keyframes
+     */
+    bool add_map(const std::string& path, const std::string& map_format);
+
+    /**
+     * Add the keyframes of a map (the keyframes of different calls are regarded as different maps)
+     */
+    void add_keyframes(const std::vector<std::shared_ptr<keyframe>>& keyfrms);
+
+    //! Get the number of keyframes used for training
+    unsigned int get_num_training_keyframes() const;
+
+    //! Get the number of held-out keyframes
+    unsigned int get_num_holdout_keyframes() const;
+
+    /**
+     * Train the vocabulary with the training keyframes
+     */
+    std::unique_ptr<bow_vocabulary> train() const;
+
+    /**
+     * Query each held-out keyframe against the training keyframes with the vocabulary
+     */
+    evaluation evaluate(bow_vocabulary* bow_vocab) const;
+
+    //! branching factor of the vocabulary tree
+    const unsigned int branching_factor_;
+    //! depth of the vocabulary tree
+    const unsigned int depth_;
+    //! interval of the held-out keyframes
+    const unsigned int holdout_interval_;
+
+private:
+    struct sample {
+        //! index of the map which the keyframe belongs to
+        unsigned int map_idx_;
+        //! keyframe ID in the map
+        unsigned int keyfrm_id_;
+        //! ORB descriptors
+        cv::Mat descriptors_;
+        //! IDs of the covisibilities in the same map
+        std::set<unsigned int> covisibility_ids_;
+    };
+
+    //! keyframes used for training
+    std::vector<sample> training_samples_;
+    //! keyframes used for evaluation
+    std::vector<sample> holdout_samples_;
+
+    //! number of the added maps
+    unsigned int num_maps_ = 0;
+};
+
+} // namespace data
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_DATA_BOW_VOCABULARY_TRAINER_H
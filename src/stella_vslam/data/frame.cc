@@ -13,11 +13,12 @@ namespace stella_vslam {
 namespace data {
 
 frame::frame(unsigned int frame_id, const double timestamp, camera::base* camera, feature::orb_params* orb_params,
-             const frame_observation frm_obs, const std::unordered_map<unsigned int, marker2d>& markers_2d)
-    : id_(frame_id), timestamp_(timestamp), camera_(camera), orb_params_(orb_params), frm_obs_(frm_obs),
+             frame_observation frm_obs, const std::unordered_map<unsigned int, marker2d>& markers_2d)
+    : id_(frame_id), timestamp_(timestamp), camera_(camera), orb_params_(orb_params),
+      frm_obs_(std::make_shared<const frame_observation>(std::move(frm_obs))),
       markers_2d_(markers_2d),
       // Initialize association with 3D points
-      landmarks_(std::vector<std::shared_ptr<landmark>>(frm_obs_.undist_keypts_.size(), nullptr)) {}
+      landmarks_(std::vector<std::shared_ptr<landmark>>(frm_obs_->undist_keypts_.size(), nullptr)) {}
 
 void frame::set_pose_cw(const Mat44_t& pose_cw) {
     pose_is_valid_ = true;
@@ -53,7 +54,7 @@ bool frame::bow_is_available() const {
 }
 
 void frame::compute_bow(bow_vocabulary* bow_vocab) {
-    bow_vocabulary_util::compute_bow(bow_vocab, frm_obs_.descriptors_, bow_vec_, bow_feat_vec_);
+    bow_vocabulary_util::compute_bow(bow_vocab, frm_obs_->descriptors_, bow_vec_, bow_feat_vec_);
 }
 
 bool frame::can_observe(const std::shared_ptr<landmark>& lm, const float ray_cos_thr,
@@ -131,11 +132,16 @@ void frame::set_landmarks(const std::vector<std::shared_ptr<landmark>>& landmark
 }
 
 std::vector<unsigned int> frame::get_keypoints_in_cell(const float ref_x, const float ref_y, const float margin, const int min_level, const int max_level) const {
-    return data::get_keypoints_in_cell(camera_, frm_obs_, ref_x, ref_y, margin, min_level, max_level);
+    return data::get_keypoints_in_cell(camera_, *frm_obs_, ref_x, ref_y, margin, min_level, max_level);
 }
 
 Vec3_t frame::triangulate_stereo(const unsigned int idx) const {
-    return data::triangulate_stereo(camera_, rot_wc_, trans_wc_, frm_obs_, idx);
+    return data::triangulate_stereo(camera_, rot_wc_, trans_wc_, *frm_obs_, idx);
+}
+
+void frame::set_image_pyramid(const std::vector<cv::Mat>& image_pyramid, const std::shared_ptr<const std::vector<cv::KeyPoint>>& keypts) {
+    image_pyramid_ = image_pyramid;
+    keypts_ = keypts;
 }
 
 } // namespace data
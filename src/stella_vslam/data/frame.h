@@ -52,7 +52,7 @@ public:
      * @param markers_2d
      */
     frame(const unsigned int frame_id, const double timestamp, camera::base* camera, feature::orb_params* orb_params,
-          const frame_observation frm_obs, const std::unordered_map<unsigned int, marker2d>& markers_2d);
+          frame_observation frm_obs, const std::unordered_map<unsigned int, marker2d>& markers_2d);
 
     /**
      * Set camera pose and refresh rotation and translation
@@ -160,6 +160,27 @@ public:
      */
     Vec3_t triangulate_stereo(const unsigned int idx) const;
 
+    /**
+     * Set the image pyramid and the distorted keypoints for the sparse image alignment
+     * @param image_pyramid (the cv::Mat headers share the buffers of the extractor)
+     * @param keypts
+     */
+    void set_image_pyramid(const std::vector<cv::Mat>& image_pyramid, const std::shared_ptr<const std::vector<cv::KeyPoint>>& keypts);
+
+    /**
+     * Get the image pyramid (empty unless the sparse image alignment is enabled)
+     */
+    const std::vector<cv::Mat>& get_image_pyramid() const {
+        return image_pyramid_;
+    }
+
+    /**
+     * Get the distorted keypoints (empty unless the sparse image alignment is enabled)
+     */
+    const std::vector<cv::KeyPoint>& get_keypoints() const {
+        return *keypts_;
+    }
+
     //! current frame ID
     unsigned int id_;
 
@@ -172,8 +193,8 @@ public:
     //! ORB scale pyramid information
     const feature::orb_params* orb_params_ = nullptr;
 
-    //! constant observations
-    frame_observation frm_obs_;
+    //! constant observations (shared with the keyframe created from this frame)
+    std::shared_ptr<const frame_observation> frm_obs_ = std::make_shared<const frame_observation>();
 
     //! markers 2D (ID to marker2d map)
     std::unordered_map<unsigned int, marker2d> markers_2d_;
@@ -186,6 +207,11 @@ public:
     std::shared_ptr<keyframe> ref_keyfrm_ = nullptr;
 
 private:
+    //! image pyramid and distorted keypoints for the sparse image alignment
+    //! (shared with the copies of this frame)
+    std::vector<cv::Mat> image_pyramid_;
+    std::shared_ptr<const std::vector<cv::KeyPoint>> keypts_ = std::make_shared<const std::vector<cv::KeyPoint>>();
+
     //! landmarks, whose nullptr indicates no-association
     std::vector<std::shared_ptr<landmark>> landmarks_;
     std::unordered_map<std::shared_ptr<landmark>, unsigned int> landmarks_idx_map_;
@@ -9,6 +9,11 @@
 namespace stella_vslam {
 namespace data {
 
+/**
+ * Observations in a frame.
+ * They are not modified once the frame is created, and are shared by the copies of the frame
+ * and the keyframe created from it.
+ */
 struct frame_observation {
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -2,6 +2,10 @@
 #include "stella_vslam/data/graph_node.h"
 #include "stella_vslam/data/landmark.h"
 
+#include <limits>
+#include <queue>
+#include <tuple>
+
 namespace stella_vslam {
 namespace data {
 
@@ -54,7 +58,7 @@ void graph_node::erase_all_connections() {
     ordered_num_shared_lms_.clear();
 }
 
-void graph_node::update_connections(unsigned int min_num_shared_lms) {
+void graph_node::update_connections(unsigned int min_num_shared_lms, unsigned int max_num_covisibilities) {
     const auto owner_keyfrm = owner_keyfrm_.lock();
     const auto landmarks = owner_keyfrm->get_landmarks();
 
@@ -68,7 +72,7 @@ void graph_node::update_connections(unsigned int min_num_shared_lms) {
             continue;
         }
 
-        const auto observations = lm->get_observations();
+        const auto observations = lm->get_all_observations();
 
         for (const auto& obs : observations) {
             auto keyfrm = obs.first;
@@ -125,6 +129,8 @@ void graph_node::update_connections(unsigned int min_num_shared_lms) {
     // to match selection of nearest_covisibility.
     std::sort(num_shared_lms_and_covisibility_pairs.rbegin(), num_shared_lms_and_covisibility_pairs.rend(),
               less_number_and_id_object_pairs<unsigned int, data::keyframe>());
+    // (the nearest covisibility is always kept as the strongest one)
+    bound_covisibilities(num_shared_lms_and_covisibility_pairs, get_spanning_parent(), max_num_covisibilities);
 
     decltype(ordered_covisibilities_) ordered_covisibilities;
     ordered_covisibilities.reserve(num_shared_lms_and_covisibility_pairs.size());
@@ -142,6 +148,7 @@ void graph_node::update_connections(unsigned int min_num_shared_lms) {
 
         ordered_covisibilities_ = ordered_covisibilities;
         ordered_num_shared_lms_ = ordered_num_shared_lms;
+        max_num_covisibilities_ = max_num_covisibilities;
 
         if (spanning_parent_.expired() && !is_spanning_root_impl()) {
             // set the parent of spanning tree
@@ -169,6 +176,7 @@ void graph_node::update_covisibility_orders_impl() {
     // sort with number of shared landmarks and keyframe IDs for consistency
     std::sort(num_shared_lms_and_keyfrm_pairs.rbegin(), num_shared_lms_and_keyfrm_pairs.rend(),
               less_number_and_id_object_pairs<unsigned int, data::keyframe>());
+    bound_covisibilities(num_shared_lms_and_keyfrm_pairs, spanning_parent_.lock(), max_num_covisibilities_);
 
     ordered_covisibilities_.clear();
     ordered_covisibilities_.reserve(num_shared_lms_and_keyfrm_pairs.size());
@@ -180,6 +188,93 @@ void graph_node::update_covisibility_orders_impl() {
     }
 }
 
+void graph_node::bound_covisibilities(std::vector<std::pair<unsigned int, std::shared_ptr<keyframe>>>& num_shared_lms_and_covisibility_pairs,
+                                      const std::shared_ptr<keyframe>& spanning_parent,
+                                      const unsigned int max_num_covisibilities) const {
+    if (max_num_covisibilities == 0 || num_shared_lms_and_covisibility_pairs.size() <= max_num_covisibilities) {
+        return;
+    }
+
+    // 1. Keep the strongest covisibilities (a quarter of the slots are left for the spatially spread ones)
+    const unsigned int num_strong = max_num_covisibilities - max_num_covisibilities / 4;
+    std::vector<bool> is_selected(num_shared_lms_and_covisibility_pairs.size(), false);
+    unsigned int num_selected = 0;
+    for (unsigned int idx = 0; idx < num_strong; ++idx) {
+        is_selected.at(idx) = true;
+        ++num_selected;
+    }
+
+    // 2. Keep the spanning parent to keep the covisibility graph connected
+    for (unsigned int idx = num_strong; idx < num_shared_lms_and_covisibility_pairs.size(); ++idx) {
+        const auto& covisibility = num_shared_lms_and_covisibility_pairs.at(idx).second;
+        if (max_num_covisibilities <= num_selected) {
+            break;
+        }
+        if (spanning_parent && covisibility && *covisibility == *spanning_parent) {
+            is_selected.at(idx) = true;
+            ++num_selected;
+            break;
+        }
+    }
+
+    // 3. Fill the remaining slots with the covisibilities farthest from the selected ones (and myself)
+    const auto num_candidates = num_shared_lms_and_covisibility_pairs.size();
+    eigen_alloc_vector<Vec3_t> centers(num_candidates);
+    std::vector<double> min_dists_sq(num_candidates, std::numeric_limits<double>::max());
+    for (unsigned int idx = 0; idx < num_candidates; ++idx) {
+        const auto& covisibility = num_shared_lms_and_covisibility_pairs.at(idx).second;
+        if (!covisibility) {
+            // expired keyframes are never selected
+            min_dists_sq.at(idx) = -1.0;
+            continue;
+        }
+        centers.at(idx) = covisibility->get_trans_wc();
+    }
+    const auto update_min_dists_sq = [&](const Vec3_t& selected_center) {
+        for (unsigned int idx = 0; idx < num_candidates; ++idx) {
+            if (is_selected.at(idx) || min_dists_sq.at(idx) < 0.0) {
+                continue;
+            }
+            min_dists_sq.at(idx) = std::min(min_dists_sq.at(idx), (centers.at(idx) - selected_center).squaredNorm());
+        }
+    };
+    update_min_dists_sq(owner_keyfrm_.lock()->get_trans_wc());
+    for (unsigned int idx = 0; idx < num_candidates; ++idx) {
+        if (is_selected.at(idx) && num_shared_lms_and_covisibility_pairs.at(idx).second) {
+            update_min_dists_sq(centers.at(idx));
+        }
+    }
+    while (num_selected < max_num_covisibilities) {
+        int farthest_idx = -1;
+        double max_min_dist_sq = -1.0;
+        for (unsigned int idx = 0; idx < num_candidates; ++idx) {
+            if (is_selected.at(idx) || min_dists_sq.at(idx) < 0.0) {
+                continue;
+            }
+            if (max_min_dist_sq < min_dists_sq.at(idx)) {
+                max_min_dist_sq = min_dists_sq.at(idx);
+                farthest_idx = idx;
+            }
+        }
+        if (farthest_idx < 0) {
+            break;
+        }
+        is_selected.at(farthest_idx) = true;
+        ++num_selected;
+        update_min_dists_sq(centers.at(farthest_idx));
+    }
+
+    // Remove the others with keeping the descending order
+    std::vector<std::pair<unsigned int, std::shared_ptr<keyframe>>> selected_pairs;
+    selected_pairs.reserve(num_selected);
+    for (unsigned int idx = 0; idx < num_shared_lms_and_covisibility_pairs.size(); ++idx) {
+        if (is_selected.at(idx)) {
+            selected_pairs.push_back(num_shared_lms_and_covisibility_pairs.at(idx));
+        }
+    }
+    num_shared_lms_and_covisibility_pairs = std::move(selected_pairs);
+}
+
 std::set<std::shared_ptr<keyframe>> graph_node::get_connected_keyframes() const {
     std::lock_guard<std::mutex> lock(mtx_);
     std::set<std::shared_ptr<keyframe>> keyfrms;
@@ -204,6 +299,21 @@ std::vector<std::shared_ptr<keyframe>> graph_node::get_covisibilities() const {
     return covisibilities;
 }
 
+std::vector<std::pair<std::shared_ptr<keyframe>, unsigned int>> graph_node::get_covisibilities_and_num_shared_lms() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<std::pair<std::shared_ptr<keyframe>, unsigned int>> covisibilities_and_num_shared_lms;
+    covisibilities_and_num_shared_lms.reserve(ordered_covisibilities_.size());
+
+    for (unsigned int idx = 0; idx < ordered_covisibilities_.size(); ++idx) {
+        const auto& covisibility = ordered_covisibilities_.at(idx);
+        if (covisibility.expired()) {
+            continue;
+        }
+        covisibilities_and_num_shared_lms.emplace_back(covisibility.lock(), ordered_num_shared_lms_.at(idx));
+    }
+    return covisibilities_and_num_shared_lms;
+}
+
 std::vector<std::shared_ptr<keyframe>> graph_node::get_top_n_covisibilities(const unsigned int num_covisibilities) const {
     std::lock_guard<std::mutex> lock(mtx_);
     std::vector<std::shared_ptr<keyframe>> covisibilities;
@@ -300,54 +410,79 @@ void graph_node::recover_spanning_connections() {
 
     // 1. find new parents for my children
 
-    std::set<std::shared_ptr<keyframe>> new_parent_candidates;
-    new_parent_candidates.insert(spanning_parent_.lock());
+    // Prim's algorithm: the tree is grown from my parent, and the child connected to the tree with the maximum number of shared landmarks is attached first.
+    // The candidate edges (num_shared_lms, child, new parent) are kept in a max-heap.
+    using spanning_edge_t = std::tuple<unsigned int, std::shared_ptr<keyframe>, std::shared_ptr<keyframe>>;
+    const auto edge_less = [](const spanning_edge_t& a, const spanning_edge_t& b) {
+        // greater number of shared landmarks, then smaller child ID, then smaller parent ID is popped first
+        if (std::get<0>(a) != std::get<0>(b)) {
+            return std::get<0>(a) < std::get<0>(b);
+        }
+        if (std::get<1>(a)->id_ != std::get<1>(b)->id_) {
+            return std::get<1>(a)->id_ > std::get<1>(b)->id_;
+        }
+        return std::get<2>(a)->id_ > std::get<2>(b)->id_;
+    };
+    std::priority_queue<spanning_edge_t, std::vector<spanning_edge_t>, decltype(edge_less)> edges(edge_less);
 
-    while (!spanning_children_.empty()) {
-        bool max_is_found = false;
+    const auto parent = spanning_parent_.lock();
 
-        unsigned int max_num_shared_lms = 0;
-        std::shared_ptr<keyframe> max_num_shared_lms_parent = nullptr;
-        std::shared_ptr<keyframe> max_num_shared_lms_child = nullptr;
+    // edges from the children to the other children, which become candidates once the other child is attached
+    id_ordered_map<std::shared_ptr<keyframe>, std::vector<std::pair<unsigned int, std::shared_ptr<keyframe>>>> edges_to_children;
+    for (const auto& spanning_child : spanning_children_) {
+        auto locked_spanning_child = spanning_child.lock();
+        if (locked_spanning_child->will_be_erased()) {
+            continue;
+        }
+        edges_to_children[locked_spanning_child];
+    }
 
-        for (const auto& spanning_child : spanning_children_) {
-            auto locked_spanning_child = spanning_child.lock();
-            if (locked_spanning_child->will_be_erased()) {
+    for (const auto& child_and_edges : edges_to_children) {
+        const auto& child = child_and_edges.first;
+        // use the cached number of shared landmarks between the child and its covisibilities
+        for (const auto& covisibility_and_num_shared_lms : child->graph_node_->get_covisibilities_and_num_shared_lms()) {
+            const auto& covisibility = covisibility_and_num_shared_lms.first;
+            const auto num_shared_lms = covisibility_and_num_shared_lms.second;
+            if (num_shared_lms == 0) {
                 continue;
             }
-
-            // get intersection between the parent candidates and the spanning-child's covisibilities
-            const auto child_covisibilities = locked_spanning_child->graph_node_->get_covisibilities();
-            const auto intersection = extract_intersection(new_parent_candidates, child_covisibilities);
-
-            // find the new parent (which has the maximum number of shared landmarks with the spanning child) from the intersection
-            for (const auto& parent_candidate : intersection) {
-                const auto num_shared_lms = locked_spanning_child->graph_node_->get_num_shared_landmarks(parent_candidate);
-                if (max_num_shared_lms < num_shared_lms) {
-                    max_num_shared_lms = num_shared_lms;
-                    max_num_shared_lms_parent = parent_candidate;
-                    max_num_shared_lms_child = locked_spanning_child;
-                    max_is_found = true;
-                }
+            if (*covisibility == *parent) {
+                edges.emplace(num_shared_lms, child, covisibility);
+                continue;
+            }
+            auto itr = edges_to_children.find(covisibility);
+            if (itr != edges_to_children.end()) {
+                itr->second.emplace_back(num_shared_lms, child);
             }
         }
+    }
 
-        if (max_is_found) {
-            // update spanning tree
-            max_num_shared_lms_child->graph_node_->change_spanning_parent(max_num_shared_lms_parent);
-            spanning_children_.erase(max_num_shared_lms_child);
-            new_parent_candidates.insert(max_num_shared_lms_child);
+    while (!edges.empty()) {
+        const auto edge = edges.top();
+        edges.pop();
+        const auto& child = std::get<1>(edge);
+        const auto& new_parent = std::get<2>(edge);
+        if (!spanning_children_.count(child)) {
+            // already attached via a stronger edge
+            continue;
         }
-        else {
-            // cannot update anymore
-            break;
+
+        // update spanning tree
+        child->graph_node_->change_spanning_parent(new_parent);
+        spanning_children_.erase(child);
+
+        // the attached child becomes a parent candidate of the remaining children
+        for (const auto& num_shared_lms_and_child : edges_to_children.at(child)) {
+            if (!spanning_children_.count(num_shared_lms_and_child.second)) {
+                continue;
+            }
+            edges.emplace(num_shared_lms_and_child.first, num_shared_lms_and_child.second, child);
         }
     }
 
     // set my parent as the new parent
     for (const auto& spanning_child : spanning_children_) {
         const auto child = spanning_child.lock();
-        const auto parent = spanning_parent_.lock();
         child->graph_node_->change_spanning_parent(parent);
     }
 
@@ -355,7 +490,7 @@ void graph_node::recover_spanning_connections() {
 
     // 2. remove myself from my parent's children list
 
-    spanning_parent_.lock()->graph_node_->erase_spanning_child(owner_keyfrm_.lock());
+    parent->graph_node_->erase_spanning_child(owner_keyfrm_.lock());
 }
 
 id_ordered_set<std::shared_ptr<keyframe>> graph_node::get_spanning_children() const {
@@ -448,19 +583,5 @@ std::vector<std::shared_ptr<keyframe>> graph_node::get_keyframes_from_root() {
     return keyfrms;
 }
 
-template<typename T, typename U>
-std::vector<std::shared_ptr<keyframe>> graph_node::extract_intersection(const T& keyfrms_1, const U& keyfrms_2) {
-    std::vector<std::shared_ptr<keyframe>> intersection;
-    intersection.reserve(std::min(keyfrms_1.size(), keyfrms_2.size()));
-    for (const auto& keyfrm_1 : keyfrms_1) {
-        for (const auto& keyfrm_2 : keyfrms_2) {
-            if (*keyfrm_1 == *keyfrm_2) {
-                intersection.push_back(keyfrm_1);
-            }
-        }
-    }
-    return intersection;
-}
-
 } // namespace data
 } // namespace stella_vslam
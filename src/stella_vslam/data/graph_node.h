@@ -1,6 +1,8 @@
 #ifndef STELLA_VSLAM_DATA_GRAPH_NODE_H
 #define STELLA_VSLAM_DATA_GRAPH_NODE_H
 
+#include "stella_vslam/type.h"
+
 #include <atomic>
 #include <mutex>
 #include <vector>
@@ -45,8 +47,10 @@ public:
 
     /**
      * Update the connections and the covisibilities by referring landmark observations
+     * @param min_num_shared_lms
+     * @param max_num_covisibilities max number of the ordered covisibilities (0: unlimited)
      */
-    void update_connections(unsigned int min_num_shared_lms);
+    void update_connections(unsigned int min_num_shared_lms, unsigned int max_num_covisibilities = 0);
 
     /**
      * Update the order of the covisibilities
@@ -64,6 +68,11 @@ public:
      */
     std::vector<std::shared_ptr<keyframe>> get_covisibilities() const;
 
+    /**
+     * Get the covisibility keyframes and the number of shared landmarks (in descending order)
+     */
+    std::vector<std::pair<std::shared_ptr<keyframe>, unsigned int>> get_covisibilities_and_num_shared_lms() const;
+
     /**
      * Get the top-n covisibility keyframes
      */
@@ -160,10 +169,16 @@ private:
     void update_covisibility_orders_impl();
 
     /**
-     * Extract intersection from the two lists of keyframes
+     * Bound the number of the covisibilities by max_num_covisibilities
+     * The strongest ones and the spanning parent are kept,
+     * then the remaining slots are filled with the weaker ones which are spatially spread.
+     * @param num_shared_lms_and_covisibility_pairs covisibilities in descending order (bounded in-place)
+     * @param spanning_parent
+     * @param max_num_covisibilities
      */
-    template<typename T, typename U>
-    static std::vector<std::shared_ptr<keyframe>> extract_intersection(const T& keyfrms_1, const U& keyfrms_2);
+    void bound_covisibilities(std::vector<std::pair<unsigned int, std::shared_ptr<keyframe>>>& num_shared_lms_and_covisibility_pairs,
+                              const std::shared_ptr<keyframe>& spanning_parent,
+                              const unsigned int max_num_covisibilities) const;
 
     //-----------------------------------------
     // implementation
@@ -182,6 +197,9 @@ private:
     std::vector<std::weak_ptr<keyframe>> ordered_covisibilities_;
     //! number of shared landmarks in descending order
     std::vector<unsigned int> ordered_num_shared_lms_;
+    //! max number of the ordered covisibilities (0: unlimited), given at the last update_connections()
+    //! The connections beyond it are kept only for counting the shared landmarks.
+    unsigned int max_num_covisibilities_ = 0;
 
     //! parent of spanning tree
     std::weak_ptr<keyframe> spanning_parent_;
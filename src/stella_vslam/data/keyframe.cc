@@ -10,6 +10,7 @@
 #include "stella_vslam/data/orb_params_database.h"
 #include "stella_vslam/data/bow_vocabulary.h"
 #include "stella_vslam/feature/orb_params.h"
+#include "stella_vslam/imu/preintegrator.h"
 #include "stella_vslam/util/converter.h"
 
 #include <nlohmann/json.hpp>
@@ -114,15 +115,15 @@ keyframe::keyframe(unsigned int id, const frame& frm)
 
 keyframe::keyframe(const unsigned int id, const double timestamp,
                    const Mat44_t& pose_cw, camera::base* camera,
-                   const feature::orb_params* orb_params, const frame_observation& frm_obs,
+                   const feature::orb_params* orb_params, frame_observation frm_obs,
                    const bow_vector& bow_vec, const bow_feature_vector& bow_feat_vec,
                    std::unordered_map<unsigned int, marker2d> markers_2d)
     : id_(id),
       timestamp_(timestamp), camera_(camera),
-      orb_params_(orb_params), frm_obs_(frm_obs),
+      orb_params_(orb_params), frm_obs_(std::make_shared<const frame_observation>(std::move(frm_obs))),
       bow_vec_(bow_vec), bow_feat_vec_(bow_feat_vec),
       markers_2d_(markers_2d),
-      landmarks_(std::vector<std::shared_ptr<landmark>>(frm_obs_.undist_keypts_.size(), nullptr)) {
+      landmarks_(std::vector<std::shared_ptr<landmark>>(frm_obs_->undist_keypts_.size(), nullptr)) {
     // set pose parameters (pose_wc_, trans_wc_) using pose_cw_
     set_pose_cw(pose_cw);
 
@@ -148,14 +149,14 @@ std::shared_ptr<keyframe> keyframe::make_keyframe(unsigned int id, const frame&
 std::shared_ptr<keyframe> keyframe::make_keyframe(
     const unsigned int id, const double timestamp,
     const Mat44_t& pose_cw, camera::base* camera,
-    const feature::orb_params* orb_params, const frame_observation& frm_obs,
+    const feature::orb_params* orb_params, frame_observation frm_obs,
     const bow_vector& bow_vec, const bow_feature_vector& bow_feat_vec,
     std::unordered_map<unsigned int, marker2d> markers_2d) {
     auto ptr = std::allocate_shared<keyframe>(
         Eigen::aligned_allocator<keyframe>(),
         id, timestamp,
         pose_cw, camera, orb_params,
-        frm_obs, bow_vec, bow_feat_vec, markers_2d);
+        std::move(frm_obs), bow_vec, bow_feat_vec, markers_2d);
     // covisibility graph node (connections is not assigned yet)
     ptr->graph_node_ = stella_vslam::make_unique<graph_node>(ptr);
     return ptr;
@@ -165,7 +166,9 @@ std::shared_ptr<keyframe> keyframe::from_stmt(sqlite3_stmt* stmt,
                                               camera_database* cam_db,
                                               orb_params_database* orb_params_db,
                                               bow_vocabulary* bow_vocab,
-                                              unsigned int next_keyframe_id) {
+                                              unsigned int next_keyframe_id,
+                                              unsigned int num_grid_cols,
+                                              unsigned int num_grid_rows) {
     const char* p;
     int column_id = 0;
     auto id = sqlite3_column_int64(stmt, column_id);
@@ -239,6 +242,11 @@ std::shared_ptr<keyframe> keyframe::from_stmt(sqlite3_stmt* stmt,
     data::bow_feature_vector bow_feat_vec;
     // Construct frame_observation
     frame_observation frm_obs{descriptors, undist_keypts, bearings, stereo_x_right, depths};
+    // Assign all the keypoints into grid
+    frm_obs.num_grid_cols_ = num_grid_cols;
+    frm_obs.num_grid_rows_ = num_grid_rows;
+    data::assign_keypoints_to_grid(camera, frm_obs.undist_keypts_, frm_obs.keypt_indices_in_cells_,
+                                   frm_obs.num_grid_cols_, frm_obs.num_grid_rows_);
     // Compute BoW
     if (bow_vocab) {
         data::bow_vocabulary_util::compute_bow(bow_vocab, descriptors, bow_vec, bow_feat_vec);
@@ -246,7 +254,7 @@ std::shared_ptr<keyframe> keyframe::from_stmt(sqlite3_stmt* stmt,
     // NOTE: 3D marker info will be filled in later based on loaded markers
     auto keyfrm = data::keyframe::make_keyframe(
         id + next_keyframe_id, timestamp, pose_cw, camera, orb_params,
-        frm_obs, bow_vec, bow_feat_vec, markers_2d);
+        std::move(frm_obs), bow_vec, bow_feat_vec, markers_2d);
 
     return keyfrm;
 }
@@ -287,11 +295,11 @@ nlohmann::json keyframe::to_json() const {
             {"rot_cw", convert_rotation_to_json(pose_cw_.block<3, 3>(0, 0))},
             {"trans_cw", convert_translation_to_json(pose_cw_.block<3, 1>(0, 3))},
             // features and observations
-            {"n_keypts", frm_obs_.undist_keypts_.size()},
-            {"undist_keypts", convert_keypoints_to_json(frm_obs_.undist_keypts_)},
-            {"x_rights", frm_obs_.stereo_x_right_},
-            {"depths", frm_obs_.depths_},
-            {"descs", convert_descriptors_to_json(frm_obs_.descriptors_)},
+            {"n_keypts", frm_obs_->undist_keypts_.size()},
+            {"undist_keypts", convert_keypoints_to_json(frm_obs_->undist_keypts_)},
+            {"x_rights", frm_obs_->stereo_x_right_},
+            {"depths", frm_obs_->depths_},
+            {"descs", convert_descriptors_to_json(frm_obs_->descriptors_)},
             {"lm_ids", landmark_ids},
             // graph information
             {"span_parent", spanning_parent ? spanning_parent->id_ : -1},
@@ -320,24 +328,24 @@ bool keyframe::bind_to_stmt(sqlite3* db, sqlite3_stmt* stmt) const {
     }
     size_t num_keypts = 0;
     if (ret == SQLITE_OK) {
-        num_keypts = frm_obs_.undist_keypts_.size();
+        num_keypts = frm_obs_->undist_keypts_.size();
         ret = sqlite3_bind_int64(stmt, column_id++, num_keypts);
     }
     if (ret == SQLITE_OK) {
-        const auto& undist_keypts = frm_obs_.undist_keypts_;
+        const auto& undist_keypts = frm_obs_->undist_keypts_;
         assert(undist_keypts.size() == num_keypts);
         ret = sqlite3_bind_blob(stmt, column_id++, undist_keypts.data(), undist_keypts.size() * sizeof(std::remove_reference<decltype(undist_keypts)>::type::value_type), SQLITE_TRANSIENT);
     }
     if (ret == SQLITE_OK) {
-        const auto& stereo_x_right = frm_obs_.stereo_x_right_;
+        const auto& stereo_x_right = frm_obs_->stereo_x_right_;
         ret = sqlite3_bind_blob(stmt, column_id++, stereo_x_right.data(), stereo_x_right.size() * sizeof(std::remove_reference<decltype(stereo_x_right)>::type::value_type), SQLITE_TRANSIENT);
     }
     if (ret == SQLITE_OK) {
-        const auto& depths = frm_obs_.depths_;
+        const auto& depths = frm_obs_->depths_;
         ret = sqlite3_bind_blob(stmt, column_id++, depths.data(), depths.size() * sizeof(std::remove_reference<decltype(depths)>::type::value_type), SQLITE_TRANSIENT);
     }
     if (ret == SQLITE_OK) {
-        const auto& descriptors = frm_obs_.descriptors_;
+        const auto& descriptors = frm_obs_->descriptors_;
         assert(descriptors.dims == 2);
         assert(descriptors.channels() == 1);
         assert(descriptors.cols == 32);
@@ -401,12 +409,46 @@ Vec3_t keyframe::get_trans_cw() const {
     return pose_cw_.block<3, 1>(0, 3);
 }
 
+void keyframe::set_imu_preintegration(const std::shared_ptr<keyframe>& prev_keyfrm,
+                                      const std::shared_ptr<const imu::preintegrator>& imu_preint) {
+    std::lock_guard<std::mutex> lock(mtx_imu_);
+    imu_prev_keyfrm_ = prev_keyfrm;
+    imu_preint_ = imu_preint;
+}
+
+std::shared_ptr<keyframe> keyframe::get_imu_prev_keyframe() const {
+    std::shared_ptr<keyframe> prev_keyfrm;
+    {
+        std::lock_guard<std::mutex> lock(mtx_imu_);
+        prev_keyfrm = imu_prev_keyfrm_.lock();
+    }
+    if (!prev_keyfrm || prev_keyfrm->will_be_erased()) {
+        return nullptr;
+    }
+    return prev_keyfrm;
+}
+
+std::shared_ptr<const imu::preintegrator> keyframe::get_imu_preintegration() const {
+    std::lock_guard<std::mutex> lock(mtx_imu_);
+    return imu_preint_;
+}
+
+void keyframe::set_imu_state(const imu::state& imu_state) {
+    std::lock_guard<std::mutex> lock(mtx_imu_);
+    imu_state_ = imu_state;
+}
+
+imu::state keyframe::get_imu_state() const {
+    std::lock_guard<std::mutex> lock(mtx_imu_);
+    return imu_state_;
+}
+
 bool keyframe::bow_is_available() const {
     return !bow_vec_.empty() && !bow_feat_vec_.empty();
 }
 
 void keyframe::compute_bow(bow_vocabulary* bow_vocab) {
-    bow_vocabulary_util::compute_bow(bow_vocab, frm_obs_.descriptors_, bow_vec_, bow_feat_vec_);
+    bow_vocabulary_util::compute_bow(bow_vocab, frm_obs_->descriptors_, bow_vec_, bow_feat_vec_);
 }
 
 void keyframe::add_landmark(std::shared_ptr<landmark> lm, const unsigned int idx) {
@@ -510,7 +552,7 @@ std::shared_ptr<landmark>& keyframe::get_landmark(const unsigned int idx) {
 
 std::vector<unsigned int> keyframe::get_keypoints_in_cell(const float ref_x, const float ref_y, const float margin,
                                                           const int min_level, const int max_level) const {
-    return data::get_keypoints_in_cell(camera_, frm_obs_, ref_x, ref_y, margin, min_level, max_level);
+    return data::get_keypoints_in_cell(camera_, *frm_obs_, ref_x, ref_y, margin, min_level, max_level);
 }
 
 Vec3_t keyframe::triangulate_stereo(const unsigned int idx) const {
@@ -519,7 +561,7 @@ Vec3_t keyframe::triangulate_stereo(const unsigned int idx) const {
         std::lock_guard<std::mutex> lock(mtx_pose_);
         pose_wc = pose_wc_;
     }
-    return data::triangulate_stereo(camera_, pose_wc.block<3, 3>(0, 0), pose_wc.block<3, 1>(0, 3), frm_obs_, idx);
+    return data::triangulate_stereo(camera_, pose_wc.block<3, 3>(0, 0), pose_wc.block<3, 1>(0, 3), *frm_obs_, idx);
 }
 
 float keyframe::compute_median_depth(const bool abs) const {
@@ -533,7 +575,7 @@ float keyframe::compute_median_depth(const bool abs) const {
     }
 
     std::vector<float> depths;
-    depths.reserve(frm_obs_.undist_keypts_.size());
+    depths.reserve(frm_obs_->undist_keypts_.size());
     const Vec3_t rot_cw_z_row = pose_cw.block<1, 3>(2, 0);
     const float trans_cw_z = pose_cw(2, 3);
 
@@ -562,7 +604,7 @@ float keyframe::compute_median_distance() const {
     }
 
     std::vector<float> distances;
-    distances.reserve(frm_obs_.undist_keypts_.size());
+    distances.reserve(frm_obs_->undist_keypts_.size());
     const Mat33_t rot_cw = pose_cw.block<3, 3>(0, 0);
     const Vec3_t trans_cw = pose_cw.block<3, 1>(0, 3);
 
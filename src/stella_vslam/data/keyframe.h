@@ -9,6 +9,7 @@
 #include "stella_vslam/data/frame_observation.h"
 #include "stella_vslam/data/marker2d.h"
 #include "stella_vslam/data/bow_vocabulary_fwd.h"
+#include "stella_vslam/imu/state.h"
 
 #include <set>
 #include <mutex>
@@ -24,6 +25,10 @@ namespace camera {
 class base;
 } // namespace camera
 
+namespace imu {
+class preintegrator;
+} // namespace imu
+
 namespace data {
 
 class frame;
@@ -50,7 +55,7 @@ public:
      */
     keyframe(const unsigned int id,
              const double timestamp, const Mat44_t& pose_cw, camera::base* camera,
-             const feature::orb_params* orb_params, const frame_observation& frm_obs,
+             const feature::orb_params* orb_params, frame_observation frm_obs,
              const bow_vector& bow_vec, const bow_feature_vector& bow_feat_vec,
              std::unordered_map<unsigned int, marker2d> markers_2d = {});
     virtual ~keyframe();
@@ -60,14 +65,16 @@ public:
     static std::shared_ptr<keyframe> make_keyframe(
         const unsigned int id,
         const double timestamp, const Mat44_t& pose_cw, camera::base* camera,
-        const feature::orb_params* orb_params, const frame_observation& frm_obs,
+        const feature::orb_params* orb_params, frame_observation frm_obs,
         const bow_vector& bow_vec, const bow_feature_vector& bow_feat_vec,
         std::unordered_map<unsigned int, marker2d> markers_2d = {});
     static std::shared_ptr<keyframe> from_stmt(sqlite3_stmt* stmt,
                                                camera_database* cam_db,
                                                orb_params_database* orb_params_db,
                                                bow_vocabulary* bow_vocab,
-                                               unsigned int next_keyframe_id);
+                                               unsigned int next_keyframe_id,
+                                               unsigned int num_grid_cols,
+                                               unsigned int num_grid_rows);
 
     // operator overrides
     bool operator==(const keyframe& keyfrm) const { return id_ == keyfrm.id_; }
@@ -135,6 +142,37 @@ public:
      */
     Vec3_t get_trans_cw() const;
 
+    //-----------------------------------------
+    // inertial state
+
+    /**
+     * Connect the previous keyframe (in time) with the IMU preintegration between them
+     */
+    void set_imu_preintegration(const std::shared_ptr<keyframe>& prev_keyfrm,
+                                const std::shared_ptr<const imu::preintegrator>& imu_preint);
+
+    /**
+     * Get the previous keyframe connected with the IMU preintegration
+     * (nullptr if unavailable or erased)
+     */
+    std::shared_ptr<keyframe> get_imu_prev_keyframe() const;
+
+    /**
+     * Get the IMU preintegration from the previous keyframe
+     * (nullptr if unavailable)
+     */
+    std::shared_ptr<const imu::preintegrator> get_imu_preintegration() const;
+
+    /**
+     * Set the velocity and the IMU bias
+     */
+    void set_imu_state(const imu::state& imu_state);
+
+    /**
+     * Get the velocity and the IMU bias
+     */
+    imu::state get_imu_state() const;
+
     //-----------------------------------------
     // features and observations
 
@@ -273,7 +311,8 @@ public:
     //-----------------------------------------
     // constant observations
 
-    frame_observation frm_obs_;
+    //! (shared with the frame from which this keyframe is created)
+    const std::shared_ptr<const frame_observation> frm_obs_;
 
     //! BoW features (DBoW2 or FBoW)
     bow_vector bow_vec_;
@@ -301,6 +340,18 @@ private:
     //! camera center
     Vec3_t trans_wc_;
 
+    //-----------------------------------------
+    // inertial state
+
+    //! need mutex for access to the inertial state
+    mutable std::mutex mtx_imu_;
+    //! previous keyframe connected with the IMU preintegration
+    std::weak_ptr<keyframe> imu_prev_keyfrm_;
+    //! IMU preintegration from the previous keyframe
+    std::shared_ptr<const imu::preintegrator> imu_preint_ = nullptr;
+    //! velocity and IMU bias
+    imu::state imu_state_;
+
     //-----------------------------------------
     // observations
 
@@ -0,0 +1,55 @@
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/keyframe_region.h"
+
+namespace stella_vslam {
+namespace data {
+
+keyframe_region::keyframe_region(const keyframe_region_t type,
+                                 const Vec3_t& min_pos_w, const Vec3_t& max_pos_w,
+                                 const Vec3_t& center_w, const double radius,
+                                 const std::unordered_set<unsigned int>& keyfrm_ids)
+    : type_(type), min_pos_w_(min_pos_w), max_pos_w_(max_pos_w),
+      center_w_(center_w), radius_(radius), keyfrm_ids_(keyfrm_ids) {}
+
+keyframe_region keyframe_region::bounding_box(const Vec3_t& min_pos_w, const Vec3_t& max_pos_w) {
+    return keyframe_region(keyframe_region_t::BoundingBox, min_pos_w.cwiseMin(max_pos_w), min_pos_w.cwiseMax(max_pos_w),
+                           Vec3_t::Zero(), 0.0, {});
+}
+
+keyframe_region keyframe_region::sphere(const Vec3_t& center_w, const double radius) {
+    return keyframe_region(keyframe_region_t::Sphere, Vec3_t::Zero(), Vec3_t::Zero(),
+                           center_w, radius, {});
+}
+
+keyframe_region keyframe_region::keyframe_ids(const std::unordered_set<unsigned int>& keyfrm_ids) {
+    return keyframe_region(keyframe_region_t::KeyframeIDs, Vec3_t::Zero(), Vec3_t::Zero(),
+                           Vec3_t::Zero(), 0.0, keyfrm_ids);
+}
+
+bool keyframe_region::contains(const std::shared_ptr<keyframe>& keyfrm) const {
+    if (!keyfrm) {
+        return false;
+    }
+    if (type_ == keyframe_region_t::KeyframeIDs) {
+        return static_cast<bool>(keyfrm_ids_.count(keyfrm->id_));
+    }
+    return contains(keyfrm->get_trans_wc());
+}
+
+bool keyframe_region::contains(const Vec3_t& pos_w) const {
+    switch (type_) {
+        case keyframe_region_t::BoundingBox: {
+            return (min_pos_w_.array() <= pos_w.array()).all() && (pos_w.array() <= max_pos_w_.array()).all();
+        }
+        case keyframe_region_t::Sphere: {
+            return (pos_w - center_w_).squaredNorm() <= radius_ * radius_;
+        }
+        case keyframe_region_t::KeyframeIDs: {
+            return true;
+        }
+    }
+    return true;
+}
+
+} // namespace data
+} // namespace stella_vslam
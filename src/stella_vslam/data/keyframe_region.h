@@ -0,0 +1,69 @@
+#ifndef STELLA_VSLAM_DATA_KEYFRAME_REGION_H
+#define STELLA_VSLAM_DATA_KEYFRAME_REGION_H
+
+#include "stella_vslam/type.h"
+
+#include <memory>
+#include <unordered_set>
+
+namespace stella_vslam {
+namespace data {
+
+class keyframe;
+
+enum class keyframe_region_t {
+    BoundingBox,
+    Sphere,
+    KeyframeIDs
+};
+
+/**
+ * Coarse region of the map used to restrict the relocalization queries
+ * (an axis-aligned bounding box or a sphere in the world coordinates, or a set of keyframe IDs)
+ */
+class keyframe_region {
+public:
+    //! Create the region of the axis-aligned bounding box
+    static keyframe_region bounding_box(const Vec3_t& min_pos_w, const Vec3_t& max_pos_w);
+
+    //! Create the region of the sphere
+    static keyframe_region sphere(const Vec3_t& center_w, const double radius);
+
+    //! Create the region of the keyframes
+    static keyframe_region keyframe_ids(const std::unordered_set<unsigned int>& keyfrm_ids);
+
+    //! Check the keyframe is in the region (by the camera center if the region is spatial)
+    bool contains(const std::shared_ptr<keyframe>& keyfrm) const;
+
+    //! Check the position is in the region (always true if the region is a set of keyframe IDs)
+    bool contains(const Vec3_t& pos_w) const;
+
+    //! type of the region
+    const keyframe_region_t type_;
+
+    //! minimum and maximum corners of the bounding box
+    const Vec3_t min_pos_w_;
+    const Vec3_t max_pos_w_;
+
+    //! center and radius of the sphere
+    const Vec3_t center_w_;
+    const double radius_;
+
+    //! IDs of the keyframes in the region
+    const std::unordered_set<unsigned int> keyfrm_ids_;
+
+private:
+    //! Constructor
+    keyframe_region(const keyframe_region_t type,
+                    const Vec3_t& min_pos_w, const Vec3_t& max_pos_w,
+                    const Vec3_t& center_w, const double radius,
+                    const std::unordered_set<unsigned int>& keyfrm_ids);
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // namespace data
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_DATA_KEYFRAME_REGION_H
@@ -4,6 +4,11 @@
 #include "stella_vslam/data/map_database.h"
 #include "stella_vslam/match/base.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Eigenvalues>
 #include <nlohmann/json.hpp>
 
 #include <spdlog/spdlog.h>
@@ -85,6 +90,8 @@ void landmark::set_pos_in_world(const Vec3_t& pos_w) {
     SPDLOG_TRACE("landmark::set_pos_in_world {}", id_);
     pos_w_ = pos_w;
     has_valid_prediction_parameters_ = false;
+    // Moved by the other than the local BA (e.g. the loop correction), so it has to converge again
+    relative_BA_update_ = 1.0;
 }
 
 Vec3_t landmark::get_pos_in_world() const {
@@ -92,6 +99,33 @@ Vec3_t landmark::get_pos_in_world() const {
     return pos_w_;
 }
 
+void landmark::set_pos_in_world_by_BA(const Vec3_t& pos_w) {
+    const auto ref_keyfrm = get_ref_keyframe();
+    std::lock_guard<std::mutex> lock(mtx_position_);
+    SPDLOG_TRACE("landmark::set_pos_in_world_by_BA {}", id_);
+    const double dist = ref_keyfrm ? (pos_w - ref_keyfrm->get_trans_wc()).norm() : 0.0;
+    const double relative_update = (0.0 < dist) ? (pos_w - pos_w_).norm() / dist : 1.0;
+    // The landmark is regarded as converged if it kept still in the last several updates
+    relative_BA_update_ = 0.5 * relative_BA_update_ + 0.5 * relative_update;
+    pos_w_ = pos_w;
+    has_valid_prediction_parameters_ = false;
+}
+
+void landmark::reset_convergence() {
+    std::lock_guard<std::mutex> lock(mtx_position_);
+    relative_BA_update_ = 1.0;
+}
+
+float landmark::get_relative_BA_update() const {
+    std::lock_guard<std::mutex> lock(mtx_position_);
+    return relative_BA_update_;
+}
+
+float landmark::get_relative_pos_uncertainty() const {
+    std::lock_guard<std::mutex> lock(mtx_position_);
+    return relative_pos_uncertainty_;
+}
+
 Vec3_t landmark::get_obs_mean_normal() const {
     std::lock_guard<std::mutex> lock(mtx_position_);
     assert(has_valid_prediction_parameters_);
@@ -104,20 +138,127 @@ std::shared_ptr<keyframe> landmark::get_ref_keyframe() const {
 }
 
 void landmark::add_observation(const std::shared_ptr<keyframe>& keyfrm, unsigned int idx) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_observations_);
+        SPDLOG_TRACE("landmark::add_observation {} {} {}", id_, keyfrm->id_, idx);
+        assert(!static_cast<bool>(observations_.count(keyfrm)));
+        assert(!static_cast<bool>(inactive_observations_.count(keyfrm)));
+        observations_[keyfrm] = idx;
+        assert(static_cast<bool>(observations_.count(keyfrm)));
+
+        has_valid_prediction_parameters_ = false;
+        has_representative_descriptor_ = false;
+
+        if (!keyfrm->frm_obs_->stereo_x_right_.empty() && 0 <= keyfrm->frm_obs_->stereo_x_right_.at(idx)) {
+            num_observations_ += 2;
+        }
+        else {
+            num_observations_ += 1;
+        }
+    }
+    // The new observation can move the landmark
+    reset_convergence();
+}
+
+bool landmark::update_active_observations(const unsigned int max_num_active_obs) {
+    if (max_num_active_obs == 0) {
+        return false;
+    }
+    const Vec3_t pos_w = get_pos_in_world();
+
     std::lock_guard<std::mutex> lock(mtx_observations_);
-    SPDLOG_TRACE("landmark::add_observation {} {} {}", id_, keyfrm->id_, idx);
-    assert(!static_cast<bool>(observations_.count(keyfrm)));
-    observations_[keyfrm] = idx;
-    assert(static_cast<bool>(observations_.count(keyfrm)));
+    if (observations_.empty()) {
+        return false;
+    }
+    const auto ref_keyfrm = ref_keyfrm_.lock();
+    const auto latest_keyfrm = std::prev(observations_.end())->first.lock();
+
+    bool is_updated = false;
+    while (true) {
+        // Score the observations which are new or whose nearest one has gone
+        for (const auto& observation : observations_) {
+            if (!redundancies_.count(observation.first)) {
+                score_redundancy(observation.first.lock(), observation.second, pos_w);
+            }
+        }
+        if (observations_.size() <= max_num_active_obs) {
+            break;
+        }
 
-    has_valid_prediction_parameters_ = false;
-    has_representative_descriptor_ = false;
+        // Deactivate the observation which is the closest to the others,
+        // except for the reference keyframe and the latest one.
+        // The older one is deactivated in a tie because the keyframes are sorted by ID.
+        auto redundant_itr = redundancies_.end();
+        for (auto itr = redundancies_.begin(); itr != redundancies_.end(); ++itr) {
+            const auto keyfrm = itr->first.lock();
+            if (keyfrm == ref_keyfrm || keyfrm == latest_keyfrm) {
+                continue;
+            }
+            if (redundant_itr == redundancies_.end() || itr->second.nearest_dist_ < redundant_itr->second.nearest_dist_) {
+                redundant_itr = itr;
+            }
+        }
+        if (redundant_itr == redundancies_.end()) {
+            break;
+        }
 
-    if (!keyfrm->frm_obs_.stereo_x_right_.empty() && 0 <= keyfrm->frm_obs_.stereo_x_right_.at(idx)) {
-        num_observations_ += 2;
+        const auto redundant_keyfrm = redundant_itr->first.lock();
+        SPDLOG_TRACE("landmark::update_active_observations {} {}", id_, redundant_keyfrm->id_);
+        const auto obs_itr = observations_.find(redundant_keyfrm);
+        inactive_observations_.insert(*obs_itr);
+        observations_.erase(obs_itr);
+        invalidate_redundancy(redundant_keyfrm);
+        is_updated = true;
     }
-    else {
-        num_observations_ += 1;
+
+    if (is_updated) {
+        has_valid_prediction_parameters_ = false;
+        has_representative_descriptor_ = false;
+    }
+    return is_updated;
+}
+
+void landmark::score_redundancy(const std::shared_ptr<keyframe>& keyfrm, const unsigned int idx, const Vec3_t& pos_w) {
+    // The distance between two observations is the angle between the viewing directions plus the difference of the scale levels
+    // (one scale level is regarded as equivalent to the viewing angle of 0.1 rad)
+    constexpr double scale_level_weight = 0.1;
+    const Vec3_t direction = (pos_w - keyfrm->get_trans_wc()).normalized();
+    const int scale_level = keyfrm->frm_obs_->undist_keypts_.at(idx).octave;
+
+    redundancy redundancy_of_keyfrm;
+    for (const auto& observation : observations_) {
+        const auto ngh_keyfrm = observation.first.lock();
+        if (ngh_keyfrm == keyfrm) {
+            continue;
+        }
+        const Vec3_t ngh_direction = (pos_w - ngh_keyfrm->get_trans_wc()).normalized();
+        const int ngh_scale_level = ngh_keyfrm->frm_obs_->undist_keypts_.at(observation.second).octave;
+        const double cos_angle = std::min(1.0, std::max(-1.0, direction.dot(ngh_direction)));
+        const double dist = std::acos(cos_angle) + scale_level_weight * std::abs(scale_level - ngh_scale_level);
+
+        if (dist < redundancy_of_keyfrm.nearest_dist_) {
+            redundancy_of_keyfrm.nearest_dist_ = dist;
+            redundancy_of_keyfrm.nearest_keyfrm_ = ngh_keyfrm;
+        }
+        // The scored neighbor is updated only if `keyfrm` is nearer than its nearest one
+        const auto ngh_itr = redundancies_.find(ngh_keyfrm);
+        if (ngh_itr != redundancies_.end() && dist < ngh_itr->second.nearest_dist_) {
+            ngh_itr->second.nearest_dist_ = dist;
+            ngh_itr->second.nearest_keyfrm_ = keyfrm;
+        }
+    }
+    redundancies_[keyfrm] = redundancy_of_keyfrm;
+}
+
+void landmark::invalidate_redundancy(const std::shared_ptr<keyframe>& keyfrm) {
+    redundancies_.erase(keyfrm);
+    for (auto itr = redundancies_.begin(); itr != redundancies_.end();) {
+        if (itr->second.nearest_keyfrm_.lock() == keyfrm) {
+            itr = redundancies_.erase(itr);
+        }
+        else {
+            ++itr;
+        }
     }
 }
 
@@ -127,19 +268,33 @@ void landmark::erase_observation(map_database* map_db, const std::shared_ptr<key
         std::lock_guard<std::mutex> lock(mtx_observations_);
         SPDLOG_TRACE("landmark::erase_observation {} {}", id_, keyfrm->id_);
 
-        assert(observations_.count(keyfrm));
-        int idx = observations_.at(keyfrm);
-        if (!keyfrm->frm_obs_.stereo_x_right_.empty() && 0 <= keyfrm->frm_obs_.stereo_x_right_.at(idx)) {
+        const bool is_active = static_cast<bool>(observations_.count(keyfrm));
+        assert(is_active || inactive_observations_.count(keyfrm));
+        int idx = is_active ? observations_.at(keyfrm) : inactive_observations_.at(keyfrm);
+        if (!keyfrm->frm_obs_->stereo_x_right_.empty() && 0 <= keyfrm->frm_obs_->stereo_x_right_.at(idx)) {
             num_observations_ -= 2;
         }
         else {
             num_observations_ -= 1;
         }
 
-        observations_.erase(keyfrm);
+        if (is_active) {
+            observations_.erase(keyfrm);
+            invalidate_redundancy(keyfrm);
 
-        has_valid_prediction_parameters_ = false;
-        has_representative_descriptor_ = false;
+            has_valid_prediction_parameters_ = false;
+            has_representative_descriptor_ = false;
+
+            // Reactivate the latest inactive observation to fill the vacancy
+            if (!inactive_observations_.empty()) {
+                const auto latest_itr = std::prev(inactive_observations_.end());
+                observations_.insert(*latest_itr);
+                inactive_observations_.erase(latest_itr);
+            }
+        }
+        else {
+            inactive_observations_.erase(keyfrm);
+        }
 
         if (observations_.empty()) {
             discard = true;
@@ -153,6 +308,10 @@ void landmark::erase_observation(map_database* map_db, const std::shared_ptr<key
     if (discard) {
         prepare_for_erasing(map_db);
     }
+    else {
+        // The landmark loses a constraint
+        reset_convergence();
+    }
 }
 
 landmark::observations_t landmark::get_observations() const {
@@ -160,6 +319,18 @@ landmark::observations_t landmark::get_observations() const {
     return observations_;
 }
 
+landmark::observations_t landmark::get_inactive_observations() const {
+    std::lock_guard<std::mutex> lock(mtx_observations_);
+    return inactive_observations_;
+}
+
+landmark::observations_t landmark::get_all_observations() const {
+    std::lock_guard<std::mutex> lock(mtx_observations_);
+    auto observations = observations_;
+    observations.insert(inactive_observations_.begin(), inactive_observations_.end());
+    return observations;
+}
+
 unsigned int landmark::num_observations() const {
     std::lock_guard<std::mutex> lock(mtx_observations_);
     return num_observations_;
@@ -175,6 +346,9 @@ int landmark::get_index_in_keyframe(const std::shared_ptr<keyframe>& keyfrm) con
     if (observations_.count(keyfrm)) {
         return observations_.at(keyfrm);
     }
+    else if (inactive_observations_.count(keyfrm)) {
+        return inactive_observations_.at(keyfrm);
+    }
     else {
         return -1;
     }
@@ -182,7 +356,7 @@ int landmark::get_index_in_keyframe(const std::shared_ptr<keyframe>& keyfrm) con
 
 bool landmark::is_observed_in_keyframe(const std::shared_ptr<keyframe>& keyfrm) const {
     std::lock_guard<std::mutex> lock(mtx_observations_);
-    return static_cast<bool>(observations_.count(keyfrm));
+    return observations_.count(keyfrm) || inactive_observations_.count(keyfrm);
 }
 
 bool landmark::has_representative_descriptor() const {
@@ -215,7 +389,7 @@ void landmark::compute_descriptor() {
         const auto idx = observation.second;
 
         if (!keyfrm->will_be_erased()) {
-            descriptors.push_back(keyfrm->frm_obs_.descriptors_.row(idx));
+            descriptors.push_back(keyfrm->frm_obs_->descriptors_.row(idx));
         }
     }
 
@@ -274,7 +448,7 @@ void landmark::compute_orb_scale_variance(const observations_t& observations,
     const auto dist_ref_keyfrm_to_lm = vec_ref_keyfrm_to_lm.norm();
     assert(!observations.empty());
     const auto idx = observations.at(ref_keyfrm);
-    const auto scale_level = ref_keyfrm->frm_obs_.undist_keypts_.at(idx).octave;
+    const auto scale_level = ref_keyfrm->frm_obs_->undist_keypts_.at(idx).octave;
     const auto scale_factor = ref_keyfrm->orb_params_->scale_factors_.at(scale_level);
     const auto num_scale_levels = ref_keyfrm->orb_params_->num_levels_;
 
@@ -282,6 +456,46 @@ void landmark::compute_orb_scale_variance(const observations_t& observations,
     min_valid_dist = max_valid_dist * ref_keyfrm->orb_params_->inv_scale_factors_.at(num_scale_levels - 1);
 }
 
+float landmark::compute_relative_pos_uncertainty(const observations_t& observations,
+                                                 const std::shared_ptr<keyframe>& ref_keyfrm,
+                                                 const Vec3_t& pos_w) const {
+    // Accumulate the information matrix of the position:
+    // each bearing constrains the position orthogonally to the ray (with the stddev of dist * scale_factor),
+    // and each depth constrains it along the ray (with the stddev of dist^2 / baseline * scale_factor)
+    Mat33_t information = Mat33_t::Zero();
+    for (const auto& observation : observations) {
+        auto keyfrm = observation.first.lock();
+        if (!keyfrm) {
+            continue;
+        }
+        const Vec3_t ray = pos_w - keyfrm->get_trans_wc();
+        const double dist_sq = ray.squaredNorm();
+        if (dist_sq <= 0.0) {
+            continue;
+        }
+        const Vec3_t normal = ray / std::sqrt(dist_sq);
+        const auto idx = observation.second;
+        const auto scale_factor = keyfrm->orb_params_->scale_factors_.at(keyfrm->frm_obs_->undist_keypts_.at(idx).octave);
+        const double inv_sigma_sq = 1.0 / (dist_sq * scale_factor * scale_factor);
+        const Mat33_t normal_outer = normal * normal.transpose();
+        information += inv_sigma_sq * (Mat33_t::Identity() - normal_outer);
+        if (!keyfrm->frm_obs_->depths_.empty() && 0 < keyfrm->frm_obs_->depths_.at(idx)) {
+            const double baseline = keyfrm->camera_->true_baseline_;
+            information += inv_sigma_sq * (baseline * baseline / dist_sq) * normal_outer;
+        }
+    }
+
+    // The largest stddev corresponds to the smallest eigenvalue
+    Eigen::SelfAdjointEigenSolver<Mat33_t> solver;
+    solver.computeDirect(information, Eigen::EigenvaluesOnly);
+    const double min_eigenvalue = solver.eigenvalues()(0);
+    const double dist_ref_keyfrm_to_lm = (pos_w - ref_keyfrm->get_trans_wc()).norm();
+    if (min_eigenvalue <= 0.0 || dist_ref_keyfrm_to_lm <= 0.0) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return 1.0 / (dist_ref_keyfrm_to_lm * std::sqrt(min_eigenvalue));
+}
+
 void landmark::update_mean_normal_and_obs_scale_variance() {
     SPDLOG_TRACE("landmark::update_mean_normal_and_obs_scale_variance {}", id_);
     observations_t observations;
@@ -307,11 +521,14 @@ void landmark::update_mean_normal_and_obs_scale_variance() {
     float min_valid_dist;
     compute_orb_scale_variance(observations, ref_keyfrm, pos_w, max_valid_dist, min_valid_dist);
 
+    const auto relative_pos_uncertainty = compute_relative_pos_uncertainty(observations, ref_keyfrm, pos_w);
+
     {
         std::lock_guard<std::mutex> lock3(mtx_position_);
         max_valid_dist_ = max_valid_dist;
         min_valid_dist_ = min_valid_dist;
         mean_normal_ = mean_normal;
+        relative_pos_uncertainty_ = relative_pos_uncertainty;
         has_valid_prediction_parameters_ = true;
     }
 }
@@ -358,7 +575,10 @@ void landmark::prepare_for_erasing(map_database* map_db) {
     {
         std::lock_guard<std::mutex> lock1(mtx_observations_);
         observations = observations_;
+        observations.insert(inactive_observations_.begin(), inactive_observations_.end());
         observations_.clear();
+        inactive_observations_.clear();
+        redundancies_.clear();
         will_be_erased_ = true;
     }
 
@@ -374,7 +594,7 @@ bool landmark::will_be_erased() {
 }
 
 void landmark::connect_to_keyframe(const std::shared_ptr<keyframe>& keyfrm, unsigned int idx) {
-    assert(!observations_.count(keyfrm));
+    assert(!is_observed_in_keyframe(keyfrm));
     keyfrm->add_landmark(shared_from_this(), idx);
     add_observation(keyfrm, idx);
 }
@@ -386,11 +606,7 @@ void landmark::replace(std::shared_ptr<landmark> lm, data::map_database* map_db)
     }
 
     // 1. Erase this
-    observations_t observations;
-    {
-        std::lock_guard<std::mutex> lock1(mtx_observations_);
-        observations = observations_;
-    }
+    const auto observations = get_all_observations();
 
     prepare_for_erasing(map_db);
 
@@ -411,6 +627,9 @@ void landmark::replace(std::shared_ptr<landmark> lm, data::map_database* map_db)
 
     lm->increase_num_observed(num_observed);
     lm->increase_num_observable(num_observable);
+
+    // the erasure of this is recorded by the database itself
+    map_db->record_changed_landmarks({lm->id_});
 }
 
 void landmark::increase_num_observable(unsigned int num_observable) {
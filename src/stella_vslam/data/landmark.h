@@ -4,6 +4,7 @@
 #include "stella_vslam/type.h"
 
 #include <map>
+#include <limits>
 #include <mutex>
 #include <atomic>
 #include <memory>
@@ -57,10 +58,17 @@ public:
     };
     bool bind_to_stmt(sqlite3* db, sqlite3_stmt* stmt) const;
 
-    //! set world coordinates of this landmark
+    //! set world coordinates of this landmark (it has to converge again in the local BA)
     void set_pos_in_world(const Vec3_t& pos_w);
     //! get world coordinates of this landmark
     Vec3_t get_pos_in_world() const;
+    //! set world coordinates optimized by the bundle adjustment, and track the size of the update
+    void set_pos_in_world_by_BA(const Vec3_t& pos_w);
+    //! get moving average of the position updates by the bundle adjustment (relative to the distance from the reference keyframe)
+    float get_relative_BA_update() const;
+    //! get approximate standard deviation of the position from the observation geometry
+    //! (relative to the distance from the reference keyframe, per unit angular noise of the keypoints)
+    float get_relative_pos_uncertainty() const;
 
     //! get mean normalized vector of keyframe->lm vectors, for keyframes such that observe the 3D point.
     Vec3_t get_obs_mean_normal() const;
@@ -72,13 +80,25 @@ public:
     //! erase observation
     void erase_observation(map_database* map_db, const std::shared_ptr<keyframe>& keyfrm);
 
-    //! get observations (keyframe and keypoint idx)
+    //! get active observations (keyframe and keypoint idx)
     observations_t get_observations() const;
-    //! get number of observations
+    //! get inactive observations, which are kept only for the associations from the keyframes
+    observations_t get_inactive_observations() const;
+    //! get both the active and inactive observations
+    observations_t get_all_observations() const;
+    //! get number of observations (including the inactive ones)
     unsigned int num_observations() const;
     //! whether this landmark is observed from more than zero keyframes
     bool has_observation() const;
 
+    /**
+     * Deactivate the most redundant observations until the active ones are within the limit
+     * (The reference keyframe and the latest one are kept active)
+     * @param max_num_active_obs
+     * @return true if any of the observations is deactivated
+     */
+    bool update_active_observations(const unsigned int max_num_active_obs);
+
     //! get index of associated keypoint in the specified keyframe
     int get_index_in_keyframe(const std::shared_ptr<keyframe>& keyfrm) const;
     //! whether this landmark is observed in the specified keyframe
@@ -147,13 +167,35 @@ protected:
                                     const Vec3_t& pos_w,
                                     float& max_valid_dist,
                                     float& min_valid_dist) const;
+    float compute_relative_pos_uncertainty(const observations_t& observations,
+                                           const std::shared_ptr<keyframe>& ref_keyfrm,
+                                           const Vec3_t& pos_w) const;
+
+    //! Compute the redundancy of the active observation by `keyfrm`, and update those of the others
+    void score_redundancy(const std::shared_ptr<keyframe>& keyfrm, const unsigned int idx, const Vec3_t& pos_w);
+    //! Discard the redundancies which refer to the observation by `keyfrm`
+    void invalidate_redundancy(const std::shared_ptr<keyframe>& keyfrm);
+
+    //! Regard the landmark as unconverged until the local BA keeps it still again
+    void reset_convergence();
 
 private:
     //! world coordinates of this landmark
     Vec3_t pos_w_;
 
-    //! observations (keyframe and keypoint index)
+    //! active observations (keyframe and keypoint index)
     observations_t observations_;
+    //! inactive observations (keyframe and keypoint index)
+    observations_t inactive_observations_;
+
+    //! redundancy of an active observation (the nearest one of the others in the viewing direction and the scale)
+    struct redundancy {
+        double nearest_dist_ = std::numeric_limits<double>::max();
+        std::weak_ptr<keyframe> nearest_keyfrm_;
+    };
+    //! redundancies of the scored active observations, which are updated incrementally
+    //! (They are not rescored after the optimization because the viewing directions change little.)
+    std::map<std::weak_ptr<keyframe>, redundancy, id_less<std::weak_ptr<keyframe>>> redundancies_;
 
     //! true if the landmark has representative descriptor
     std::atomic<bool> has_representative_descriptor_{false};
@@ -180,6 +222,12 @@ private:
     //! min valid distance between landmark and camera
     float max_valid_dist_ = 0;
 
+    // parameters for convergence
+    //! moving average of the relative position updates by the bundle adjustment
+    float relative_BA_update_ = 1.0;
+    //! approximate relative standard deviation of the position
+    float relative_pos_uncertainty_ = std::numeric_limits<float>::infinity();
+
     mutable std::mutex mtx_position_;
     mutable std::mutex mtx_observations_;
 };
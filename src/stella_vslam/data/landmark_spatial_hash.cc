@@ -0,0 +1,121 @@
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/data/landmark_spatial_hash.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace stella_vslam {
+namespace data {
+
+landmark_spatial_hash::landmark_spatial_hash(const double cell_size)
+    : cell_size_(cell_size) {
+    assert(0.0 < cell_size_);
+}
+
+void landmark_spatial_hash::insert(const std::shared_ptr<landmark>& lm) {
+    if (!lm) {
+        return;
+    }
+
+    const auto key = get_cell_key(lm->get_pos_in_world());
+    const auto itr = lm_id_to_cell_key_.find(lm->id_);
+    if (itr != lm_id_to_cell_key_.end()) {
+        if (itr->second == key) {
+            return;
+        }
+        erase_from_cell(itr->second, lm->id_);
+        itr->second = key;
+    }
+    else {
+        lm_id_to_cell_key_.emplace(lm->id_, key);
+    }
+    cells_[key].emplace_back(lm->id_, lm);
+}
+
+std::vector<std::shared_ptr<landmark>> landmark_spatial_hash::get_landmarks_in_sphere(const Vec3_t& pos_w, const double radius) {
+    std::vector<std::shared_ptr<landmark>> lms;
+    const double clamped_radius = std::min(radius, 2.0 * cell_size_);
+    if (clamped_radius <= 0.0) {
+        return lms;
+    }
+
+    const int min_x = static_cast<int>(std::floor((pos_w(0) - clamped_radius) / cell_size_));
+    const int max_x = static_cast<int>(std::floor((pos_w(0) + clamped_radius) / cell_size_));
+    const int min_y = static_cast<int>(std::floor((pos_w(1) - clamped_radius) / cell_size_));
+    const int max_y = static_cast<int>(std::floor((pos_w(1) + clamped_radius) / cell_size_));
+    const int min_z = static_cast<int>(std::floor((pos_w(2) - clamped_radius) / cell_size_));
+    const int max_z = static_cast<int>(std::floor((pos_w(2) + clamped_radius) / cell_size_));
+
+    for (int x = min_x; x <= max_x; ++x) {
+        for (int y = min_y; y <= max_y; ++y) {
+            for (int z = min_z; z <= max_z; ++z) {
+                const auto cell_itr = cells_.find(get_cell_key(x, y, z));
+                if (cell_itr == cells_.end()) {
+                    continue;
+                }
+
+                auto& cell = cell_itr->second;
+                for (auto itr = cell.begin(); itr != cell.end();) {
+                    auto lm = itr->second.lock();
+                    if (!lm || lm->will_be_erased()) {
+                        // Remove the erased landmark lazily
+                        lm_id_to_cell_key_.erase(itr->first);
+                        itr = cell.erase(itr);
+                        continue;
+                    }
+                    if ((lm->get_pos_in_world() - pos_w).norm() <= clamped_radius) {
+                        lms.push_back(lm);
+                    }
+                    ++itr;
+                }
+                if (cell.empty()) {
+                    cells_.erase(cell_itr);
+                }
+            }
+        }
+    }
+    return lms;
+}
+
+size_t landmark_spatial_hash::size() const {
+    return lm_id_to_cell_key_.size();
+}
+
+void landmark_spatial_hash::clear() {
+    cells_.clear();
+    lm_id_to_cell_key_.clear();
+}
+
+landmark_spatial_hash::cell_key_t landmark_spatial_hash::get_cell_key(const Vec3_t& pos_w) const {
+    return get_cell_key(static_cast<int>(std::floor(pos_w(0) / cell_size_)),
+                        static_cast<int>(std::floor(pos_w(1) / cell_size_)),
+                        static_cast<int>(std::floor(pos_w(2) / cell_size_)));
+}
+
+landmark_spatial_hash::cell_key_t landmark_spatial_hash::get_cell_key(const int x, const int y, const int z) {
+    // Pack the lower 21 bits of each coordinate
+    constexpr cell_key_t mask = (static_cast<cell_key_t>(1) << 21) - 1;
+    return ((static_cast<cell_key_t>(x) & mask) << 42)
+           | ((static_cast<cell_key_t>(y) & mask) << 21)
+           | (static_cast<cell_key_t>(z) & mask);
+}
+
+void landmark_spatial_hash::erase_from_cell(const cell_key_t key, const unsigned int lm_id) {
+    const auto cell_itr = cells_.find(key);
+    if (cell_itr == cells_.end()) {
+        return;
+    }
+    auto& cell = cell_itr->second;
+    cell.erase(std::remove_if(cell.begin(), cell.end(),
+                              [lm_id](const std::pair<unsigned int, std::weak_ptr<landmark>>& entry) {
+                                  return entry.first == lm_id;
+                              }),
+               cell.end());
+    if (cell.empty()) {
+        cells_.erase(cell_itr);
+    }
+}
+
+} // namespace data
+} // namespace stella_vslam
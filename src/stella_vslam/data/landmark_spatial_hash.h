@@ -0,0 +1,65 @@
+#ifndef STELLA_VSLAM_DATA_LANDMARK_SPATIAL_HASH_H
+#define STELLA_VSLAM_DATA_LANDMARK_SPATIAL_HASH_H
+
+#include "stella_vslam/type.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stella_vslam {
+namespace data {
+
+class landmark;
+
+/**
+ * Voxel hash over the landmark positions to find the existing landmarks near a 3D point.
+ * The landmarks are re-hashed when they are inserted again after being moved,
+ * and the erased ones are removed lazily when they are found in a query.
+ * This class is not thread-safe.
+ */
+class landmark_spatial_hash {
+public:
+    //! Constructor
+    explicit landmark_spatial_hash(const double cell_size);
+
+    //! Insert the landmark, or move it to the cell of its current position
+    void insert(const std::shared_ptr<landmark>& lm);
+
+    //! Get the valid landmarks within the radius of the position
+    //! (the radius is truncated to twice the cell size)
+    std::vector<std::shared_ptr<landmark>> get_landmarks_in_sphere(const Vec3_t& pos_w, const double radius);
+
+    //! Get the number of the hashed landmarks (including the ones not removed yet)
+    size_t size() const;
+
+    //! Remove all the landmarks
+    void clear();
+
+    //! cell size
+    const double cell_size_;
+
+private:
+    using cell_key_t = uint64_t;
+
+    //! Get the key of the cell containing the position
+    cell_key_t get_cell_key(const Vec3_t& pos_w) const;
+
+    //! Get the key from the cell coordinates
+    static cell_key_t get_cell_key(const int x, const int y, const int z);
+
+    //! Remove the landmark from the cell
+    void erase_from_cell(const cell_key_t key, const unsigned int lm_id);
+
+    //! landmarks in each cell (landmark ID and pointer)
+    std::unordered_map<cell_key_t, std::vector<std::pair<unsigned int, std::weak_ptr<landmark>>>> cells_;
+    //! cell key of each landmark
+    std::unordered_map<unsigned int, cell_key_t> lm_id_to_cell_key_;
+};
+
+} // namespace data
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_DATA_LANDMARK_SPATIAL_HASH_H
@@ -9,19 +9,23 @@
 #include "stella_vslam/data/map_database.h"
 #include "stella_vslam/data/bow_vocabulary.h"
 #include "stella_vslam/util/converter.h"
+#include "stella_vslam/util/background_deleter.h"
 #include "stella_vslam/util/sqlite3.h"
 
 #include <spdlog/spdlog.h>
 #include <nlohmann/json.hpp>
 #include <sqlite3.h>
 
+#include <tuple>
+
 namespace stella_vslam {
 namespace data {
 
 std::mutex map_database::mtx_database_;
 
-map_database::map_database(unsigned int min_num_shared_lms)
-    : fixed_keyframe_id_threshold_(0), min_num_shared_lms_(min_num_shared_lms) {
+map_database::map_database(unsigned int min_num_shared_lms, unsigned int max_num_active_obs, unsigned int max_num_covisibilities)
+    : fixed_keyframe_id_threshold_(0), min_num_shared_lms_(min_num_shared_lms), max_num_active_obs_(max_num_active_obs),
+      max_num_covisibilities_(max_num_covisibilities) {
     spdlog::debug("CONSTRUCT: data::map_database");
 }
 
@@ -40,15 +44,29 @@ unsigned int map_database::get_fixed_keyframe_id_threshold() {
     return fixed_keyframe_id_threshold_;
 }
 
+void map_database::set_gravity(const Vec3_t& gravity_w) {
+    std::lock_guard<std::mutex> lock(mtx_map_access_);
+    gravity_is_initialized_ = true;
+    gravity_w_ = gravity_w;
+}
+
+bool map_database::get_gravity(Vec3_t& gravity_w) const {
+    std::lock_guard<std::mutex> lock(mtx_map_access_);
+    gravity_w = gravity_w_;
+    return gravity_is_initialized_;
+}
+
 void map_database::add_keyframe(const std::shared_ptr<keyframe>& keyfrm) {
     std::lock_guard<std::mutex> lock(mtx_map_access_);
     keyframes_[keyfrm->id_] = keyfrm;
     last_inserted_keyfrm_ = keyfrm;
+    record_changed_keyframes({keyfrm->id_});
 }
 
 void map_database::erase_keyframe(const std::shared_ptr<keyframe>& keyfrm) {
     std::lock_guard<std::mutex> lock(mtx_map_access_);
     keyframes_.erase(keyfrm->id_);
+    record_changed_keyframes({keyfrm->id_});
 }
 
 std::shared_ptr<keyframe> map_database::get_keyframe(unsigned int id) const {
@@ -62,11 +80,13 @@ std::shared_ptr<keyframe> map_database::get_keyframe(unsigned int id) const {
 void map_database::add_landmark(std::shared_ptr<landmark>& lm) {
     std::lock_guard<std::mutex> lock(mtx_map_access_);
     landmarks_[lm->id_] = lm;
+    record_changed_landmarks({lm->id_});
 }
 
 void map_database::erase_landmark(unsigned int id) {
     std::lock_guard<std::mutex> lock(mtx_map_access_);
     landmarks_.erase(id);
+    record_changed_landmarks({id});
 }
 
 std::shared_ptr<landmark> map_database::get_landmark(unsigned int id) const {
@@ -234,9 +254,29 @@ unsigned int map_database::get_min_num_shared_lms() const {
     return min_num_shared_lms_;
 }
 
-void map_database::clear() {
+unsigned int map_database::get_max_num_active_observations() const {
+    return max_num_active_obs_;
+}
+
+unsigned int map_database::get_max_num_covisibilities() const {
+    return max_num_covisibilities_;
+}
+
+void map_database::set_grid_size(const unsigned int num_grid_cols, const unsigned int num_grid_rows) {
+    num_grid_cols_ = num_grid_cols;
+    num_grid_rows_ = num_grid_rows;
+}
+
+void map_database::clear(util::background_deleter* deleter) {
     std::lock_guard<std::mutex> lock(mtx_map_access_);
 
+    if (deleter) {
+        // Swap in the empty containers and leave the destruction of the old object graph to the deleter
+        deleter->dispose(std::make_tuple(std::move(landmarks_), std::move(keyframes_), std::move(markers_),
+                                         std::move(last_inserted_keyfrm_), std::move(local_landmarks_),
+                                         std::move(spanning_roots_)));
+    }
+
     landmarks_.clear();
     keyframes_.clear();
     markers_.clear();
@@ -249,10 +289,58 @@ void map_database::clear() {
     next_keyframe_id_ = 0;
     next_landmark_id_ = 0;
     fixed_keyframe_id_threshold_ = 0;
+    gravity_is_initialized_ = false;
+    gravity_w_ = Vec3_t::Zero();
+
+    {
+        std::lock_guard<std::mutex> lock_changes(mtx_changes_);
+        if (change_recording_is_enabled_) {
+            changes_ = map_changes();
+            changes_.is_cleared_ = true;
+        }
+    }
 
     spdlog::info("clear map database");
 }
 
+void map_database::enable_change_recording() {
+    std::lock_guard<std::mutex> lock(mtx_changes_);
+    change_recording_is_enabled_ = true;
+}
+
+void map_database::record_changed_keyframes(const std::vector<unsigned int>& keyfrm_ids) {
+    std::lock_guard<std::mutex> lock(mtx_changes_);
+    if (!change_recording_is_enabled_ || changes_.all_changed_) {
+        return;
+    }
+    changes_.keyfrm_ids_.insert(keyfrm_ids.begin(), keyfrm_ids.end());
+}
+
+void map_database::record_changed_landmarks(const std::vector<unsigned int>& lm_ids) {
+    std::lock_guard<std::mutex> lock(mtx_changes_);
+    if (!change_recording_is_enabled_ || changes_.all_changed_) {
+        return;
+    }
+    changes_.lm_ids_.insert(lm_ids.begin(), lm_ids.end());
+}
+
+void map_database::record_map_change() {
+    std::lock_guard<std::mutex> lock(mtx_changes_);
+    if (!change_recording_is_enabled_) {
+        return;
+    }
+    changes_.all_changed_ = true;
+    changes_.keyfrm_ids_.clear();
+    changes_.lm_ids_.clear();
+}
+
+map_database::map_changes map_database::take_changes() {
+    std::lock_guard<std::mutex> lock(mtx_changes_);
+    map_changes changes;
+    std::swap(changes, changes_);
+    return changes;
+}
+
 void map_database::from_json(camera_database* cam_db, orb_params_database* orb_params_db, bow_vocabulary* bow_vocab,
                              const nlohmann::json& json_keyfrms, const nlohmann::json& json_landmarks) {
     std::lock_guard<std::mutex> lock(mtx_map_access_);
@@ -331,7 +419,7 @@ void map_database::from_json(camera_database* cam_db, orb_params_database* orb_p
         assert(keyframes_.count(keyfrm_id));
         auto keyfrm = keyframes_.at(keyfrm_id);
 
-        keyfrm->graph_node_->update_connections(min_num_shared_lms_);
+        keyfrm->graph_node_->update_connections(min_num_shared_lms_, max_num_covisibilities_);
         keyfrm->graph_node_->update_covisibility_orders();
     }
 
@@ -345,6 +433,7 @@ void map_database::from_json(camera_database* cam_db, orb_params_database* orb_p
         assert(landmarks_.count(landmark_id));
         const auto& lm = landmarks_.at(landmark_id);
 
+        lm->update_active_observations(max_num_active_obs_);
         if (!lm->has_valid_prediction_parameters()) {
             lm->update_mean_normal_and_obs_scale_variance();
         }
@@ -394,13 +483,18 @@ void map_database::register_keyframe(camera_database* cam_db, orb_params_databas
     data::bow_feature_vector bow_feat_vec;
     // Construct frame_observation
     frame_observation frm_obs{descriptors, undist_keypts, bearings, stereo_x_right, depths};
+    // Assign all the keypoints into grid
+    frm_obs.num_grid_cols_ = num_grid_cols_;
+    frm_obs.num_grid_rows_ = num_grid_rows_;
+    assign_keypoints_to_grid(camera, frm_obs.undist_keypts_, frm_obs.keypt_indices_in_cells_,
+                             frm_obs.num_grid_cols_, frm_obs.num_grid_rows_);
     // Compute BoW
     if (bow_vocab) {
         data::bow_vocabulary_util::compute_bow(bow_vocab, descriptors, bow_vec, bow_feat_vec);
     }
     auto keyfrm = data::keyframe::make_keyframe(
         id, timestamp, pose_cw, camera, orb_params,
-        frm_obs, bow_vec, bow_feat_vec);
+        std::move(frm_obs), bow_vec, bow_feat_vec);
 
     // Append to map database
     assert(!keyframes_.count(id));
@@ -476,7 +570,7 @@ void map_database::to_json(nlohmann::json& json_keyfrms, nlohmann::json& json_la
         assert(keyfrm);
         assert(id == keyfrm->id_);
         assert(!keyfrm->will_be_erased());
-        keyfrm->graph_node_->update_connections(min_num_shared_lms_);
+        keyfrm->graph_node_->update_connections(min_num_shared_lms_, max_num_covisibilities_);
         assert(!keyfrms.count(std::to_string(id)));
         keyfrms[std::to_string(id)] = keyfrm->to_json();
     }
@@ -545,7 +639,7 @@ bool map_database::from_db(sqlite3* db,
     for (const auto& id_keyfrm : keyframes_) {
         const auto keyfrm = id_keyfrm.second;
 
-        keyfrm->graph_node_->update_connections(min_num_shared_lms_);
+        keyfrm->graph_node_->update_connections(min_num_shared_lms_, max_num_covisibilities_);
         keyfrm->graph_node_->update_covisibility_orders();
     }
 
@@ -553,6 +647,7 @@ bool map_database::from_db(sqlite3* db,
     for (const auto& id_landmark : landmarks_) {
         const auto lm = id_landmark.second;
 
+        lm->update_active_observations(max_num_active_obs_);
         if (!lm->has_valid_prediction_parameters()) {
             lm->update_mean_normal_and_obs_scale_variance();
         }
@@ -575,7 +670,8 @@ bool map_database::load_keyframes_from_db(sqlite3* db,
 
     int ret = SQLITE_ERROR;
     while ((ret = sqlite3_step(stmt)) == SQLITE_ROW) {
-        auto keyfrm = data::keyframe::from_stmt(stmt, cam_db, orb_params_db, bow_vocab, next_keyframe_id_);
+        auto keyfrm = data::keyframe::from_stmt(stmt, cam_db, orb_params_db, bow_vocab, next_keyframe_id_,
+                                                num_grid_cols_, num_grid_rows_);
         // Append to map database
         assert(!keyframes_.count(keyfrm->id_));
         keyframes_[keyfrm->id_] = keyfrm;
@@ -607,7 +703,7 @@ void map_database::load_association_from_stmt(sqlite3_stmt* stmt) {
     auto keyfrm_id = sqlite3_column_int64(stmt, column_id);
     assert(keyframes_.count(keyfrm_id));
     column_id++;
-    std::vector<int> lm_ids(keyframes_.at(keyfrm_id)->frm_obs_.undist_keypts_.size(), -1);
+    std::vector<int> lm_ids(keyframes_.at(keyfrm_id)->frm_obs_->undist_keypts_.size(), -1);
     p = reinterpret_cast<const char*>(sqlite3_column_blob(stmt, column_id));
     std::memcpy(lm_ids.data(), p, sqlite3_column_bytes(stmt, column_id));
     column_id++;
@@ -674,7 +770,7 @@ bool map_database::to_db(sqlite3* db) const {
         const auto keyfrm = id_keyfrm.second;
         assert(keyfrm);
         assert(!keyfrm->will_be_erased());
-        keyfrm->graph_node_->update_connections(min_num_shared_lms_);
+        keyfrm->graph_node_->update_connections(min_num_shared_lms_, max_num_covisibilities_);
     }
 
     bool ok = util::sqlite3_util::drop_table(db, "keyframes");
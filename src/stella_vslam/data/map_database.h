@@ -7,6 +7,7 @@
 #include <mutex>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 
 #include <nlohmann/json_fwd.hpp>
@@ -15,6 +16,10 @@ typedef struct sqlite3 sqlite3;
 
 namespace stella_vslam {
 
+namespace util {
+class background_deleter;
+} // namespace util
+
 namespace camera {
 class base;
 } // namespace camera
@@ -34,7 +39,7 @@ public:
     /**
      * Constructor
      */
-    map_database(unsigned int min_num_shared_lms);
+    map_database(unsigned int min_num_shared_lms, unsigned int max_num_active_obs = 0, unsigned int max_num_covisibilities = 0);
 
     /**
      * Destructor
@@ -51,6 +56,20 @@ public:
      */
     unsigned int get_fixed_keyframe_id_threshold();
 
+    /**
+     * Set the gravity in the world frame estimated by the inertial initialization
+     * @param gravity_w
+     */
+    void set_gravity(const Vec3_t& gravity_w);
+
+    /**
+     * Get the gravity in the world frame
+     * (NOTE: the gravity is not saved with the map, and is estimated again after loading)
+     * @param gravity_w
+     * @return false if the gravity has not been estimated
+     */
+    bool get_gravity(Vec3_t& gravity_w) const;
+
     /**
      * Add keyframe to the database
      * @param keyfrm
@@ -200,6 +219,25 @@ public:
      */
     unsigned int get_min_num_shared_lms() const;
 
+    /**
+     * Get maximum number of the active observations of each landmark
+     * @return maximum number of the active observations of each landmark (0: unlimited)
+     */
+    unsigned int get_max_num_active_observations() const;
+
+    /**
+     * Get maximum number of the ordered covisibilities of each keyframe
+     * @return maximum number of the ordered covisibilities of each keyframe (0: unlimited)
+     */
+    unsigned int get_max_num_covisibilities() const;
+
+    /**
+     * Set the grid size to assign the keypoints of the loaded keyframes
+     * @param num_grid_cols
+     * @param num_grid_rows
+     */
+    void set_grid_size(const unsigned int num_grid_cols, const unsigned int num_grid_rows);
+
     /**
      * Update frame statistics
      * @param frm
@@ -231,8 +269,55 @@ public:
 
     /**
      * Clear the database
+     * (if the deleter is given, the old contents are destroyed in its background thread)
+     */
+    void clear(util::background_deleter* deleter = nullptr);
+
+    //-----------------------------------------
+    // change notifications (for the map exporters)
+
+    //! Changes of the map recorded after the last take_changes()
+    struct map_changes {
+        //! the map was cleared before the other changes
+        bool is_cleared_ = false;
+        //! all the keyframes and landmarks could be changed (e.g. by the loop correction)
+        bool all_changed_ = false;
+        //! IDs of the keyframes which are added, moved or erased
+        std::unordered_set<unsigned int> keyfrm_ids_;
+        //! IDs of the landmarks which are added, moved or erased
+        std::unordered_set<unsigned int> lm_ids_;
+    };
+
+    /**
+     * Start recording the changes
+     * (nothing is recorded before it is called, so that the changes are not accumulated without a consumer)
      */
-    void clear();
+    void enable_change_recording();
+
+    /**
+     * Record that the keyframes are moved
+     * (the addition and the erasure are recorded by the database itself)
+     * @param keyfrm_ids
+     */
+    void record_changed_keyframes(const std::vector<unsigned int>& keyfrm_ids);
+
+    /**
+     * Record that the landmarks are moved or merged with the others
+     * (the addition and the erasure are recorded by the database itself)
+     * @param lm_ids
+     */
+    void record_changed_landmarks(const std::vector<unsigned int>& lm_ids);
+
+    /**
+     * Record that all the keyframes and landmarks could be changed
+     */
+    void record_map_change();
+
+    /**
+     * Take the changes recorded after the last call
+     * @return
+     */
+    map_changes take_changes();
 
     /**
      * Load keyframes and landmarks from JSON
@@ -361,17 +446,46 @@ private:
     //! keyframes with id less than or equal to fixed_keyframe_id_threshold are not optimized
     unsigned int fixed_keyframe_id_threshold_ = 0;
 
+    //! gravity in the world frame is estimated or not
+    bool gravity_is_initialized_ = false;
+    //! gravity in the world frame
+    Vec3_t gravity_w_ = Vec3_t::Zero();
+
     //-----------------------------------------
     // parameters for global/local mapping (optimization)
 
     //! minimum threshold for covisibility graph connection
     const unsigned int min_num_shared_lms_ = 15;
 
+    //! maximum number of the active observations of each landmark (0: unlimited)
+    const unsigned int max_num_active_obs_ = 0;
+
+    //! maximum number of the ordered covisibilities of each keyframe (0: unlimited)
+    const unsigned int max_num_covisibilities_ = 0;
+
+    //-----------------------------------------
+    // parameters for map loading
+
+    //! number of columns of grid to assign the keypoints of the loaded keyframes
+    unsigned int num_grid_cols_ = 64;
+    //! number of rows of grid to assign the keypoints of the loaded keyframes
+    unsigned int num_grid_rows_ = 48;
+
     //-----------------------------------------
     // frame statistics for odometry evaluation
 
     //! frame statistics
     frame_statistics frm_stats_;
+
+    //-----------------------------------------
+    // change notifications
+
+    //! mutex for the recorded changes
+    mutable std::mutex mtx_changes_;
+    //! the changes are recorded or not
+    bool change_recording_is_enabled_ = false;
+    //! changes recorded after the last take_changes()
+    map_changes changes_;
 };
 
 } // namespace data
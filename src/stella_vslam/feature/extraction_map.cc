@@ -0,0 +1,40 @@
+#include "stella_vslam/feature/extraction_map.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace stella_vslam {
+namespace feature {
+
+extraction_map::extraction_map(const unsigned int cols, const unsigned int rows, const unsigned int cell_size,
+                               const unsigned int num_saturating_lms)
+    : cell_size_(std::max(1u, cell_size)),
+      num_cols_((cols + cell_size_ - 1) / cell_size_),
+      num_rows_((rows + cell_size_ - 1) / cell_size_),
+      num_saturating_lms_(std::max(1u, num_saturating_lms)),
+      num_lms_in_cells_(num_cols_ * num_rows_, 0) {}
+
+void extraction_map::add_landmark(const float x, const float y) {
+    if (x < 0.0 || y < 0.0 || num_cols_ * cell_size_ <= x || num_rows_ * cell_size_ <= y) {
+        return;
+    }
+    ++num_lms_in_cells_.at(get_cell_index(x, y));
+    ++num_lms_;
+}
+
+float extraction_map::get_coverage(const float x, const float y) const {
+    return get_coverage(get_cell_index(x, y));
+}
+
+unsigned int extraction_map::get_cell_index(const float x, const float y) const {
+    const int col = std::min(std::max(static_cast<int>(std::floor(x / cell_size_)), 0), static_cast<int>(num_cols_) - 1);
+    const int row = std::min(std::max(static_cast<int>(std::floor(y / cell_size_)), 0), static_cast<int>(num_rows_) - 1);
+    return col + row * num_cols_;
+}
+
+float extraction_map::get_coverage(const unsigned int cell_idx) const {
+    return std::min(1.0f, static_cast<float>(num_lms_in_cells_.at(cell_idx)) / num_saturating_lms_);
+}
+
+} // namespace feature
+} // namespace stella_vslam
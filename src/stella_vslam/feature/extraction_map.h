@@ -0,0 +1,57 @@
+#ifndef STELLA_VSLAM_FEATURE_EXTRACTION_MAP_H
+#define STELLA_VSLAM_FEATURE_EXTRACTION_MAP_H
+
+#include <vector>
+
+namespace stella_vslam {
+namespace feature {
+
+/**
+ * Coverage of the image by the landmarks which are expected to be observed in the next frame.
+ * orb_extractor reduces the effort on the cells which are already covered and spends it on the others.
+ */
+class extraction_map {
+public:
+    extraction_map() = delete;
+
+    //! Constructor
+    extraction_map(const unsigned int cols, const unsigned int rows, const unsigned int cell_size,
+                   const unsigned int num_saturating_lms);
+
+    //! Add a predicted landmark projection (in pixel coordinates of the level 0)
+    void add_landmark(const float x, const float y);
+
+    //! Get the coverage of the cell which contains the given point, in [0, 1] (1 means saturated)
+    float get_coverage(const float x, const float y) const;
+
+    //! Get the index of the cell which contains the given point (clamped to the image)
+    unsigned int get_cell_index(const float x, const float y) const;
+
+    //! Get the coverage of the cell, in [0, 1] (1 means saturated)
+    float get_coverage(const unsigned int cell_idx) const;
+
+    //! Get the number of cells
+    unsigned int get_num_cells() const { return num_cols_ * num_rows_; }
+
+    //! Get the number of added landmarks
+    unsigned int get_num_landmarks() const { return num_lms_; }
+
+private:
+    //! cell size in pixels
+    const unsigned int cell_size_;
+    //! number of columns/rows of the cells
+    const unsigned int num_cols_;
+    const unsigned int num_rows_;
+    //! number of landmarks in a cell with which the cell is regarded as saturated
+    const unsigned int num_saturating_lms_;
+
+    //! number of landmarks in each cell
+    std::vector<unsigned int> num_lms_in_cells_;
+    //! total number of landmarks
+    unsigned int num_lms_ = 0;
+};
+
+} // namespace feature
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_FEATURE_EXTRACTION_MAP_H
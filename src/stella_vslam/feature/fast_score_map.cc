@@ -0,0 +1,135 @@
+#include "stella_vslam/feature/fast_score_map.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+namespace stella_vslam {
+namespace feature {
+
+namespace {
+
+//! Number of the pixels on the Bresenham circle
+constexpr int num_circle_pixels = 16;
+//! Number of the contiguous pixels of a corner
+constexpr int arc_length = 9;
+//! Radius of the Bresenham circle
+constexpr int circle_radius = 3;
+
+//! Offsets (x, y) of the Bresenham circle
+constexpr int circle_offsets[num_circle_pixels][2] = {
+    {0, -3}, {1, -3}, {2, -2}, {3, -1}, {3, 0}, {3, 1}, {2, 2}, {1, 3}, {0, 3}, {-1, 3}, {-2, 2}, {-3, 1}, {-3, 0}, {-3, -1}, {-2, -2}, {-1, -3}};
+
+} // namespace
+
+void fast_score_map::compute(const cv::Mat& image, const cv::Rect& roi, const unsigned int min_thr) {
+    assert(image.type() == CV_8UC1);
+    scores_.create(image.rows, image.cols, CV_16SC1);
+    scores_.setTo(cv::Scalar(-1));
+    min_thr_ = min_thr;
+
+    const int x_begin = std::max(roi.x, circle_radius);
+    const int x_end = std::min(roi.x + roi.width, image.cols - circle_radius);
+    const int y_begin = std::max(roi.y, circle_radius);
+    const int y_end = std::min(roi.y + roi.height, image.rows - circle_radius);
+    if (x_end <= x_begin || y_end <= y_begin) {
+        return;
+    }
+
+    std::vector<uchar> is_candidate(image.cols);
+    for (int y = y_begin; y < y_end; ++y) {
+        compute_row(image.ptr<uchar>(y), static_cast<int>(image.step1()), x_begin, x_end,
+                    static_cast<int>(min_thr), is_candidate.data(), scores_.ptr<short>(y));
+    }
+}
+
+void fast_score_map::compute_row(const uchar* center, const int step, const int x_begin, const int x_end,
+                                 const int min_thr, uchar* is_candidate, short* scores) {
+    // 1. Reject the pixels quickly by the four compass points of the circle.
+    //    Any arc of 9 pixels contains the top or bottom point and the left or right one.
+    //    The loop has no branch so that it is vectorized by the compiler.
+    const uchar* top = center - circle_radius * step;
+    const uchar* bottom = center + circle_radius * step;
+    for (int x = x_begin; x < x_end; ++x) {
+        const int c = center[x];
+        const int diff_vertical = std::max(std::abs(top[x] - c), std::abs(bottom[x] - c));
+        const int diff_horizontal = std::max(std::abs(center[x + circle_radius] - c), std::abs(center[x - circle_radius] - c));
+        is_candidate[x] = (min_thr < diff_vertical) & (min_thr < diff_horizontal);
+    }
+
+    // 2. Compute the scores of the candidates
+    int offsets[num_circle_pixels];
+    for (int i = 0; i < num_circle_pixels; ++i) {
+        offsets[i] = circle_offsets[i][1] * step + circle_offsets[i][0];
+    }
+
+    for (int x = x_begin; x < x_end; ++x) {
+        if (!is_candidate[x]) {
+            continue;
+        }
+
+        const uchar* ptr = center + x;
+        const int c = *ptr;
+        int diffs[num_circle_pixels + arc_length - 1];
+        for (int i = 0; i < num_circle_pixels; ++i) {
+            diffs[i] = ptr[offsets[i]] - c;
+        }
+        for (int i = num_circle_pixels; i < num_circle_pixels + arc_length - 1; ++i) {
+            diffs[i] = diffs[i - num_circle_pixels];
+        }
+
+        // The brighter (or darker) arc with the largest minimum difference gives the score
+        int max_min_bright_diff = 0;
+        int max_min_dark_diff = 0;
+        for (int k = 0; k < num_circle_pixels; ++k) {
+            int min_bright_diff = diffs[k];
+            int min_dark_diff = -diffs[k];
+            for (int i = k + 1; i < k + arc_length; ++i) {
+                min_bright_diff = std::min(min_bright_diff, diffs[i]);
+                min_dark_diff = std::min(min_dark_diff, -diffs[i]);
+            }
+            max_min_bright_diff = std::max(max_min_bright_diff, min_bright_diff);
+            max_min_dark_diff = std::max(max_min_dark_diff, min_dark_diff);
+        }
+
+        // The pixel is a corner with the threshold t if the differences are greater than t
+        const int score = std::max(max_min_bright_diff, max_min_dark_diff) - 1;
+        if (min_thr <= score) {
+            scores[x] = static_cast<short>(score);
+        }
+    }
+}
+
+void fast_score_map::detect(const cv::Rect& roi, const unsigned int thr, std::vector<cv::KeyPoint>& keypts) const {
+    assert(min_thr_ <= thr);
+    keypts.clear();
+
+    // The scores on the border of the map are always -1
+    const int x_begin = std::max(roi.x, 1);
+    const int x_end = std::min(roi.x + roi.width, scores_.cols - 1);
+    const int y_begin = std::max(roi.y, 1);
+    const int y_end = std::min(roi.y + roi.height, scores_.rows - 1);
+
+    const int thr_int = static_cast<int>(thr);
+    for (int y = y_begin; y < y_end; ++y) {
+        const short* prev = scores_.ptr<short>(y - 1);
+        const short* curr = scores_.ptr<short>(y);
+        const short* next = scores_.ptr<short>(y + 1);
+        for (int x = x_begin; x < x_end; ++x) {
+            const short score = curr[x];
+            if (score < thr_int) {
+                continue;
+            }
+            // Non-maximum suppression over the 8 neighbors
+            // (the neighbors below the threshold have lower scores, so they do not suppress the pixel)
+            if (score > prev[x - 1] && score > prev[x] && score > prev[x + 1]
+                && score > curr[x - 1] && score > curr[x + 1]
+                && score > next[x - 1] && score > next[x] && score > next[x + 1]) {
+                keypts.emplace_back(cv::Point2f(x, y), 7.0f, -1.0f, score);
+            }
+        }
+    }
+}
+
+} // namespace feature
+} // namespace stella_vslam
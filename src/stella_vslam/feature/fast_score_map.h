@@ -0,0 +1,58 @@
+#ifndef STELLA_VSLAM_FEATURE_FAST_SCORE_MAP_H
+#define STELLA_VSLAM_FEATURE_FAST_SCORE_MAP_H
+
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+
+namespace stella_vslam {
+namespace feature {
+
+/**
+ * FAST-9 corner scores of an image computed in a single pass.
+ * The keypoints of each cell are detected from the scores with any threshold above the minimum one,
+ * so the pixels are never scanned again when the threshold is reduced.
+ * The score is the largest threshold with which the pixel is detected as a corner (same as cv::FAST).
+ */
+class fast_score_map {
+public:
+    //! Constructor
+    fast_score_map() = default;
+
+    /**
+     * Compute the scores in the region of the image
+     * @param image 8-bit grayscale image
+     * @param roi region whose pixels are scored (the pixels within 3 px from the image border are not scored)
+     * @param min_thr the pixels which are not corners with this threshold are not scored
+     */
+    void compute(const cv::Mat& image, const cv::Rect& roi, const unsigned int min_thr);
+
+    /**
+     * Detect the non-maximum suppressed keypoints in the region (the keypoints are in the image coordinates)
+     * @param roi
+     * @param thr FAST threshold (must not be less than the minimum threshold)
+     * @param keypts
+     */
+    void detect(const cv::Rect& roi, const unsigned int thr, std::vector<cv::KeyPoint>& keypts) const;
+
+    //! Get the score of the pixel (-1 if it is not a corner with the minimum threshold)
+    short get_score(const int x, const int y) const {
+        return scores_.at<short>(y, x);
+    }
+
+private:
+    //! Score the candidate pixels in [x_begin, x_end) of a row
+    static void compute_row(const uchar* center, const int step, const int x_begin, const int x_end,
+                            const int min_thr, uchar* is_candidate, short* scores);
+
+    //! scores of the pixels (CV_16SC1, -1 for the non-corners)
+    cv::Mat scores_;
+    //! minimum threshold used to compute the scores
+    unsigned int min_thr_ = 0;
+};
+
+} // namespace feature
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_FEATURE_FAST_SCORE_MAP_H
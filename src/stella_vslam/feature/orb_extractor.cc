@@ -1,4 +1,5 @@
 #include "stella_vslam/feature/orb_extractor.h"
+#include "stella_vslam/feature/fast_score_map.h"
 #include "stella_vslam/type.h"
 #include "stella_vslam/benchmark/timer.h"
 
@@ -7,6 +8,7 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/features2d.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 #include <spdlog/spdlog.h>
@@ -17,8 +19,11 @@ namespace feature {
 orb_extractor::orb_extractor(const orb_params* orb_params,
                              const unsigned int min_area,
                              const descriptor_type desc_type,
-                             const std::vector<std::vector<float>>& mask_rects)
-    : orb_params_(orb_params), mask_rects_(mask_rects), min_area_sqrt_(std::sqrt(min_area)), desc_type_(desc_type) {
+                             const std::vector<std::vector<float>>& mask_rects,
+                             const float min_keypts_ratio_in_saturated_cells)
+    : orb_params_(orb_params), mask_rects_(mask_rects), min_area_(min_area), min_area_sqrt_(std::sqrt(min_area)),
+      ini_fast_thr_(orb_params->ini_fast_thr_), min_fast_thr_(orb_params->min_fast_thr_),
+      min_keypts_ratio_in_saturated_cells_(min_keypts_ratio_in_saturated_cells), desc_type_(desc_type) {
     // resize buffers according to the number of levels
     image_pyramid_.resize(orb_params_->num_levels_);
 #ifdef USE_CUDA_EFFICIENT_DESCRIPTORS
@@ -138,6 +143,20 @@ void orb_extractor::extract(const cv::_InputArray& in_image, const cv::_InputArr
     }
 }
 
+void orb_extractor::set_min_area(const unsigned int min_area) {
+    min_area_ = min_area;
+    min_area_sqrt_ = std::sqrt(min_area);
+}
+
+void orb_extractor::set_fast_thresholds(const unsigned int ini_fast_thr, const unsigned int min_fast_thr) {
+    ini_fast_thr_ = ini_fast_thr;
+    min_fast_thr_ = min_fast_thr;
+}
+
+void orb_extractor::set_extraction_map(const std::shared_ptr<const extraction_map>& extraction_map) {
+    extraction_map_ = extraction_map;
+}
+
 void orb_extractor::create_rectangle_mask(const unsigned int cols, const unsigned int rows) {
     if (rect_mask_.empty()) {
         rect_mask_ = cv::Mat(rows, cols, CV_8UC1, cv::Scalar(255));
@@ -159,8 +178,10 @@ void orb_extractor::compute_image_pyramid(const cv::Mat& image) {
         // determine the size of an image
         const double scale = orb_params_->scale_factors_.at(level);
         const cv::Size size(std::round(image.cols * 1.0 / scale), std::round(image.rows * 1.0 / scale));
-        // resize
-        cv::resize(image_pyramid_.at(level - 1), image_pyramid_.at(level), size, 0, 0, cv::INTER_LINEAR);
+        // resize into a new buffer, as the frames may still share the one of the previous image
+        cv::Mat resized_image;
+        cv::resize(image_pyramid_.at(level - 1), resized_image, size, 0, 0, cv::INTER_LINEAR);
+        image_pyramid_.at(level) = resized_image;
     }
 }
 
@@ -195,6 +216,12 @@ void orb_extractor::compute_fast_keypoints(std::vector<std::vector<cv::KeyPoint>
         std::vector<cv::KeyPoint> keypts_to_distribute;
         keypts_to_distribute.reserve(500);
 
+        // Score the whole level once with the lowest threshold,
+        // then detect the keypoints of each cell from the scores with the threshold selected for the cell
+        fast_score_map score_map;
+        score_map.compute(image_pyramid_.at(level), cv::Rect(min_border_x, min_border_y, width, height),
+                          std::min(ini_fast_thr_, min_fast_thr_));
+
         // To enable parallelization, set the environment variable OMP_MAX_ACTIVE_LEVELS to 2.
 #ifdef USE_OPENMP
 #pragma omp parallel for schedule(static)
@@ -227,14 +254,28 @@ void orb_extractor::compute_fast_keypoints(std::vector<std::vector<cv::KeyPoint>
                     }
                 }
 
+                // Select the FAST threshold according to the coverage of the cell by the tracked landmarks:
+                // the reduced threshold is used directly for uncovered cells and never for saturated cells
+                unsigned int fast_thr = ini_fast_thr_;
+                bool use_reduced_fast_thr = true;
+                if (extraction_map_) {
+                    const float coverage = extraction_map_->get_coverage(0.5f * (min_x + max_x) * scale_factor, 0.5f * (min_y + max_y) * scale_factor);
+                    if (coverage == 0.0) {
+                        fast_thr = min_fast_thr_;
+                    }
+                    use_reduced_fast_thr = coverage < 1.0;
+                }
+
+                // Detect in the cell except the FAST circle radius from its border, same as cv::FAST on the cell
+                constexpr unsigned int fast_radius = 3;
+                const cv::Rect cell_roi(min_x + fast_radius, min_y + fast_radius,
+                                        max_x - min_x - 2 * fast_radius, max_y - min_y - 2 * fast_radius);
                 std::vector<cv::KeyPoint> keypts_in_cell;
-                cv::FAST(image_pyramid_.at(level).rowRange(min_y, max_y).colRange(min_x, max_x),
-                         keypts_in_cell, orb_params_->ini_fast_thr_, true);
+                score_map.detect(cell_roi, fast_thr, keypts_in_cell);
 
-                // Re-compute FAST keypoint with reduced threshold if enough keypoint was not got
-                if (keypts_in_cell.empty()) {
-                    cv::FAST(image_pyramid_.at(level).rowRange(min_y, max_y).colRange(min_x, max_x),
-                             keypts_in_cell, orb_params_->min_fast_thr_, true);
+                // Re-detect FAST keypoint with reduced threshold if enough keypoint was not got
+                if (keypts_in_cell.empty() && use_reduced_fast_thr && fast_thr != min_fast_thr_) {
+                    score_map.detect(cell_roi, min_fast_thr_, keypts_in_cell);
                 }
 
                 if (keypts_in_cell.empty()) {
@@ -242,8 +283,8 @@ void orb_extractor::compute_fast_keypoints(std::vector<std::vector<cv::KeyPoint>
                 }
 
                 for (auto& keypt : keypts_in_cell) {
-                    keypt.pt.x += j * cell_size;
-                    keypt.pt.y += i * cell_size;
+                    keypt.pt.x -= min_border_x;
+                    keypt.pt.y -= min_border_y;
                 }
 
                 if (!mask.empty()) {
@@ -273,6 +314,10 @@ void orb_extractor::compute_fast_keypoints(std::vector<std::vector<cv::KeyPoint>
         keypts_at_level = distribute_keypoints(keypts_to_distribute, min_border_x, max_border_x, min_border_y, max_border_y, scale_factor);
         SPDLOG_TRACE("keypts_at_level {} filtered={} raw={}", level, keypts_at_level.size(), keypts_to_distribute.size());
 
+        if (extraction_map_) {
+            keypts_at_level = limit_keypoints_by_coverage(keypts_at_level, keypts_to_distribute, min_border_x, min_border_y, scale_factor);
+        }
+
         // Keypoint size is patch size modified by the scale factor
         const unsigned int scaled_patch_size = orb_impl_.fast_patch_size_ * scale_factor;
 
@@ -331,6 +376,104 @@ std::vector<cv::KeyPoint> orb_extractor::distribute_keypoints(const std::vector<
     return result_keypts;
 }
 
+std::vector<cv::KeyPoint> orb_extractor::limit_keypoints_by_coverage(const std::vector<cv::KeyPoint>& keypts,
+                                                                     const std::vector<cv::KeyPoint>& candidate_keypts,
+                                                                     const int min_x, const int min_y, const float scale_factor) const {
+    const auto get_cell_index = [&](const cv::KeyPoint& keypt) {
+        return extraction_map_->get_cell_index((keypt.pt.x + min_x) * scale_factor, (keypt.pt.y + min_y) * scale_factor);
+    };
+    const auto is_stronger = [](const cv::KeyPoint& a, const cv::KeyPoint& b) {
+        if (a.response != b.response) {
+            return a.response > b.response;
+        }
+        if (a.pt.y != b.pt.y) {
+            return a.pt.y < b.pt.y;
+        }
+        return a.pt.x < b.pt.x;
+    };
+
+    const auto num_cells = extraction_map_->get_num_cells();
+    std::vector<std::vector<cv::KeyPoint>> keypts_in_cells(num_cells);
+    for (const auto& keypt : keypts) {
+        keypts_in_cells.at(get_cell_index(keypt)).push_back(keypt);
+    }
+
+    // the budget decreases linearly with the coverage of the cell, and the strongest keypoints are kept
+    // (the dropped ones stay at the end of each cell until the candidates are checked against them)
+    std::vector<unsigned int> num_keypts_to_keep(num_cells, 0);
+    unsigned int num_freed_keypts = 0;
+    for (unsigned int idx = 0; idx < num_cells; ++idx) {
+        auto& keypts_in_cell = keypts_in_cells.at(idx);
+        if (keypts_in_cell.empty()) {
+            continue;
+        }
+        const float coverage = extraction_map_->get_coverage(idx);
+        const float ratio = 1.0 - (1.0 - min_keypts_ratio_in_saturated_cells_) * coverage;
+        num_keypts_to_keep.at(idx) = std::min(static_cast<unsigned int>(keypts_in_cell.size()),
+                                              std::max(1u, static_cast<unsigned int>(std::ceil(keypts_in_cell.size() * ratio))));
+        if (num_keypts_to_keep.at(idx) < keypts_in_cell.size()) {
+            std::sort(keypts_in_cell.begin(), keypts_in_cell.end(), is_stronger);
+            num_freed_keypts += keypts_in_cell.size() - num_keypts_to_keep.at(idx);
+        }
+    }
+
+    // The freed budget is given to the under-covered cells in proportion to their lack of coverage.
+    // They receive the strongest candidates which were not selected by the distribution,
+    // away from the selected keypoints by at least half the spacing of the distribution.
+    float total_lack_of_coverage = 0.0;
+    for (unsigned int idx = 0; idx < num_cells; ++idx) {
+        total_lack_of_coverage += 1.0 - extraction_map_->get_coverage(idx);
+    }
+    std::vector<std::vector<cv::KeyPoint>> added_keypts_in_cells(num_cells);
+    if (0 < num_freed_keypts && 0.0 < total_lack_of_coverage) {
+        std::vector<std::vector<cv::KeyPoint>> candidate_keypts_in_cells(num_cells);
+        for (const auto& keypt : candidate_keypts) {
+            const auto idx = get_cell_index(keypt);
+            if (extraction_map_->get_coverage(idx) < 1.0) {
+                candidate_keypts_in_cells.at(idx).push_back(keypt);
+            }
+        }
+
+        const float min_dist = 0.5 * min_area_sqrt_ / scale_factor;
+        const float min_sq_dist = min_dist * min_dist;
+        for (unsigned int idx = 0; idx < num_cells; ++idx) {
+            auto& candidate_keypts_in_cell = candidate_keypts_in_cells.at(idx);
+            const auto num_keypts_to_add = static_cast<unsigned int>(
+                num_freed_keypts * (1.0 - extraction_map_->get_coverage(idx)) / total_lack_of_coverage);
+            if (candidate_keypts_in_cell.empty() || num_keypts_to_add == 0) {
+                continue;
+            }
+            std::sort(candidate_keypts_in_cell.begin(), candidate_keypts_in_cell.end(), is_stronger);
+
+            const auto& keypts_in_cell = keypts_in_cells.at(idx);
+            auto& added_keypts_in_cell = added_keypts_in_cells.at(idx);
+            for (const auto& candidate_keypt : candidate_keypts_in_cell) {
+                if (num_keypts_to_add <= added_keypts_in_cell.size()) {
+                    break;
+                }
+                const auto is_near_candidate = [&](const cv::KeyPoint& keypt) {
+                    const cv::Point2f diff = keypt.pt - candidate_keypt.pt;
+                    return diff.dot(diff) < min_sq_dist;
+                };
+                if (std::none_of(keypts_in_cell.begin(), keypts_in_cell.end(), is_near_candidate)
+                    && std::none_of(added_keypts_in_cell.begin(), added_keypts_in_cell.end(), is_near_candidate)) {
+                    added_keypts_in_cell.push_back(candidate_keypt);
+                }
+            }
+        }
+    }
+
+    std::vector<cv::KeyPoint> result_keypts;
+    result_keypts.reserve(keypts.size());
+    for (unsigned int idx = 0; idx < num_cells; ++idx) {
+        const auto& keypts_in_cell = keypts_in_cells.at(idx);
+        const auto& added_keypts_in_cell = added_keypts_in_cells.at(idx);
+        result_keypts.insert(result_keypts.end(), keypts_in_cell.begin(), keypts_in_cell.begin() + num_keypts_to_keep.at(idx));
+        result_keypts.insert(result_keypts.end(), added_keypts_in_cell.begin(), added_keypts_in_cell.end());
+    }
+    return result_keypts;
+}
+
 void orb_extractor::compute_orientation(const cv::Mat& image, std::vector<cv::KeyPoint>& keypts) const {
     for (auto& keypt : keypts) {
         keypt.angle = ic_angle(image, keypt.pt);
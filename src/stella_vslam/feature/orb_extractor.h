@@ -3,6 +3,9 @@
 
 #include "stella_vslam/feature/orb_params.h"
 #include "stella_vslam/feature/orb_impl.h"
+#include "stella_vslam/feature/extraction_map.h"
+
+#include <memory>
 
 #include <opencv2/core/mat.hpp>
 #include <opencv2/core/types.hpp>
@@ -51,7 +54,8 @@ public:
     orb_extractor(const orb_params* orb_params,
                   const unsigned int min_area,
                   const descriptor_type desc_type = descriptor_type::ORB,
-                  const std::vector<std::vector<float>>& mask_rects = {});
+                  const std::vector<std::vector<float>>& mask_rects = {},
+                  const float min_keypts_ratio_in_saturated_cells = 0.25);
 
     //! Destructor
     virtual ~orb_extractor() = default;
@@ -60,6 +64,29 @@ public:
     void extract(const cv::_InputArray& in_image, const cv::_InputArray& in_image_mask,
                  std::vector<cv::KeyPoint>& keypts, const cv::_OutputArray& out_descriptors);
 
+    //! Compute image pyramid (without extracting the keypoints)
+    void compute_image_pyramid(const cv::Mat& image);
+
+    //! Set the area occupied by one keypoint (a smaller area gives more keypoints)
+    //! (NOTE: call it between the extractions)
+    void set_min_area(const unsigned int min_area);
+
+    //! Get the area occupied by one keypoint
+    unsigned int get_min_area() const { return min_area_; }
+
+    //! Set the FAST thresholds which override the ones of the ORB parameters
+    //! (NOTE: call it between the extractions)
+    void set_fast_thresholds(const unsigned int ini_fast_thr, const unsigned int min_fast_thr);
+
+    //! Get the initial FAST threshold
+    unsigned int get_ini_fast_threshold() const { return ini_fast_thr_; }
+
+    //! Get the reduced FAST threshold
+    unsigned int get_min_fast_threshold() const { return min_fast_thr_; }
+
+    //! Set the coverage of the image used by the next extraction (nullptr to extract uniformly)
+    void set_extraction_map(const std::shared_ptr<const extraction_map>& extraction_map);
+
     //! parameters for ORB extraction
     const orb_params* orb_params_;
 
@@ -77,9 +104,6 @@ private:
     //! Create a mask matrix that constructed by rectangles
     void create_rectangle_mask(const unsigned int cols, const unsigned int rows);
 
-    //! Compute image pyramid
-    void compute_image_pyramid(const cv::Mat& image);
-
     //! Compute fast keypoints for cells in each image pyramid
     void compute_fast_keypoints(std::vector<std::vector<cv::KeyPoint>>& all_keypts, const cv::Mat& mask) const;
 
@@ -88,6 +112,12 @@ private:
                                                    const int min_x, const int max_x, const int min_y, const int max_y,
                                                    const float scale_factor) const;
 
+    //! Drop the weak keypoints in the cells which are covered by the extraction map,
+    //! and add the candidates in the under-covered cells instead
+    std::vector<cv::KeyPoint> limit_keypoints_by_coverage(const std::vector<cv::KeyPoint>& keypts,
+                                                          const std::vector<cv::KeyPoint>& candidate_keypts,
+                                                          const int min_x, const int min_y, const float scale_factor) const;
+
     //! Compute orientation for each keypoint
     void compute_orientation(const cv::Mat& image, std::vector<cv::KeyPoint>& keypts) const;
 
@@ -101,8 +131,16 @@ private:
     void compute_orb_descriptor(const cv::KeyPoint& keypt, const cv::Mat& image, uchar* desc) const;
 
     //! Area of node occupied by one feature point
+    unsigned int min_area_;
     unsigned int min_area_sqrt_;
 
+    //! FAST thresholds (initialized with the ORB parameters)
+    unsigned int ini_fast_thr_;
+    unsigned int min_fast_thr_;
+
+    //! ratio of the keypoints kept in the cells saturated by the extraction map
+    const float min_keypts_ratio_in_saturated_cells_;
+
     //! size of maximum ORB patch radius
     static constexpr unsigned int orb_patch_radius_ = 19;
 
@@ -112,6 +150,9 @@ private:
 
     descriptor_type desc_type_;
 
+    //! coverage of the image used by the next extraction
+    std::shared_ptr<const extraction_map> extraction_map_ = nullptr;
+
     //! feature descriptor implementations
     orb_impl orb_impl_;
 #ifdef USE_CUDA_EFFICIENT_DESCRIPTORS
@@ -21,10 +21,15 @@ global_optimization_module::global_optimization_module(data::map_database* map_d
           map_db,
           util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["num_iter"].as<unsigned int>(10),
           util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["use_huber_kernel"].as<bool>(false),
-          util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["verbose"].as<bool>(false))),
+          util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["verbose"].as<bool>(false),
+          util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["use_hierarchical_BA"].as<bool>(false),
+          util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["max_num_keyframes_in_submap"].as<unsigned int>(100),
+          util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["min_num_shared_lms_in_refinement"].as<unsigned int>(15))),
       map_db_(map_db),
       graph_optimizer_(new optimize::graph_optimizer(util::yaml_optional_ref(yaml_node, "GraphOptimizer"), fix_scale)),
-      thr_neighbor_keyframes_(util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["thr_neighbor_keyframes"].as<unsigned int>(15)) {
+      thr_neighbor_keyframes_(util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["thr_neighbor_keyframes"].as<unsigned int>(15)),
+      use_pose_only_refinement_(util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["use_pose_only_refinement"].as<bool>(false)),
+      max_deferral_time_of_loop_BA_(util::yaml_optional_ref(yaml_node, "GlobalOptimizer")["max_deferral_time_of_loop_BA"].as<double>(10.0)) {
     spdlog::debug("CONSTRUCT: global_optimization_module");
 }
 
@@ -157,6 +162,20 @@ void global_optimization_module::run() {
             continue;
         }
 
+        // apply the requested changes of the parameters between the loop detections
+        for (const auto& yaml_node : params_queue_.pop_all()) {
+            loop_detector_->update_parameters(yaml_node);
+        }
+
+        // run the deferred loop BA while both the modules are idle,
+        // or regardless of the queued keyframes once it has been deferred for too long
+        if (keyfrm_for_deferred_loop_BA_ && !loop_bundle_adjuster_->is_running()) {
+            const bool modules_are_idle = !keyframe_is_queued() && !mapper_->keyframe_is_queued();
+            if (modules_are_idle || deadline_of_deferred_loop_BA_ <= std::chrono::steady_clock::now()) {
+                launch_deferred_loop_BA();
+            }
+        }
+
         // if the queue is empty, the following process is not needed
         if (!keyframe_is_queued()) {
             continue;
@@ -205,6 +224,10 @@ void global_optimization_module::queue_keyframe(const std::shared_ptr<data::keyf
     keyfrms_queue_.push_back(keyfrm);
 }
 
+void global_optimization_module::request_update_parameters(const YAML::Node& yaml_node) {
+    params_queue_.push(yaml_node);
+}
+
 bool global_optimization_module::keyframe_is_queued() const {
     std::lock_guard<std::mutex> lock(mtx_keyfrm_queue_);
     return !keyfrms_queue_.empty();
@@ -301,12 +324,28 @@ void global_optimization_module::correct_loop() {
         thread_for_loop_BA_->join();
         thread_for_loop_BA_.reset(nullptr);
     }
-    SPDLOG_TRACE("global_optimization_module: launch loop BA");
-    thread_for_loop_BA_ = std::unique_ptr<std::thread>(new std::thread(&module::loop_bundle_adjuster::optimize, loop_bundle_adjuster_.get(), cur_keyfrm_));
+    if (use_pose_only_refinement_) {
+        // the full loop BA is deferred until the modules are idle
+        SPDLOG_TRACE("global_optimization_module: launch pose-only loop refinement");
+        thread_for_loop_BA_ = std::unique_ptr<std::thread>(new std::thread(&module::loop_bundle_adjuster::refine_poses, loop_bundle_adjuster_.get(), cur_keyfrm_));
+        // a new loop correction supersedes the deferred loop BA, but does not postpone its deadline
+        if (!keyfrm_for_deferred_loop_BA_) {
+            deadline_of_deferred_loop_BA_ = std::chrono::steady_clock::now()
+                                            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(max_deferral_time_of_loop_BA_));
+        }
+        keyfrm_for_deferred_loop_BA_ = cur_keyfrm_;
+    }
+    else {
+        SPDLOG_TRACE("global_optimization_module: launch loop BA");
+        thread_for_loop_BA_ = std::unique_ptr<std::thread>(new std::thread(&module::loop_bundle_adjuster::optimize, loop_bundle_adjuster_.get(), cur_keyfrm_));
+    }
 
     // 6. post-processing
 
     SPDLOG_TRACE("global_optimization_module: resume the mapping module");
+    // the keyframes and landmarks were moved by the loop correction
+    map_db_->record_map_change();
+    mapper_->invalidate_landmark_spatial_hash();
     // resume the mapping module
     mapper_->resume();
 
@@ -314,6 +353,16 @@ void global_optimization_module::correct_loop() {
     loop_detector_->set_loop_correct_keyframe_id(cur_keyfrm_->id_);
 }
 
+void global_optimization_module::launch_deferred_loop_BA() {
+    if (thread_for_loop_BA_) {
+        thread_for_loop_BA_->join();
+        thread_for_loop_BA_.reset(nullptr);
+    }
+    spdlog::info("launch deferred loop BA");
+    thread_for_loop_BA_ = std::unique_ptr<std::thread>(new std::thread(&module::loop_bundle_adjuster::optimize, loop_bundle_adjuster_.get(), keyfrm_for_deferred_loop_BA_));
+    keyfrm_for_deferred_loop_BA_ = nullptr;
+}
+
 module::keyframe_Sim3_pairs_t global_optimization_module::get_Sim3s_before_loop_correction(const std::vector<std::shared_ptr<data::keyframe>>& neighbors) const {
     module::keyframe_Sim3_pairs_t Sim3s_nw_before_loop_correction;
 
@@ -407,7 +456,7 @@ void global_optimization_module::replace_duplicated_landmarks(const std::vector<
     {
         std::lock_guard<std::mutex> lock(data::map_database::mtx_database_);
 
-        for (unsigned int idx = 0; idx < cur_keyfrm_->frm_obs_.undist_keypts_.size(); ++idx) {
+        for (unsigned int idx = 0; idx < cur_keyfrm_->frm_obs_->undist_keypts_.size(); ++idx) {
             auto curr_match_lm_in_cand = curr_match_lms_observed_in_cand.at(idx);
             if (!curr_match_lm_in_cand) {
                 continue;
@@ -428,6 +477,7 @@ void global_optimization_module::replace_duplicated_landmarks(const std::vector<
                 if (lm_in_curr->id_ != curr_match_lm_in_cand->id_) {
                     replaced_lms[lm_in_curr] = curr_match_lm_in_cand;
                     lm_in_curr->replace(curr_match_lm_in_cand, map_db_);
+                    curr_match_lm_in_cand->update_active_observations(map_db_->get_max_num_active_observations());
                     if (!curr_match_lm_in_cand->has_representative_descriptor()) {
                         curr_match_lm_in_cand->compute_descriptor();
                     }
@@ -440,6 +490,7 @@ void global_optimization_module::replace_duplicated_landmarks(const std::vector<
                 // if landmark corresponding `idx` does not exists,
                 // add association between the current keyframe and `curr_match_lm_in_cand`
                 curr_match_lm_in_cand->connect_to_keyframe(cur_keyfrm_, idx);
+                curr_match_lm_in_cand->update_active_observations(map_db_->get_max_num_active_observations());
                 curr_match_lm_in_cand->update_mean_normal_and_obs_scale_variance();
                 curr_match_lm_in_cand->compute_descriptor();
             }
@@ -470,6 +521,7 @@ void global_optimization_module::replace_duplicated_landmarks(const std::vector<
             const auto& best_idx = best_idx_lm.first;
             const auto& lm = best_idx_lm.second;
             lm->connect_to_keyframe(neighbor, best_idx);
+            lm->update_active_observations(map_db_->get_max_num_active_observations());
             lm->update_mean_normal_and_obs_scale_variance();
             lm->compute_descriptor();
         }
@@ -481,6 +533,7 @@ void global_optimization_module::replace_duplicated_landmarks(const std::vector<
             if (lm_to_replace->id_ != lm_in_neighbor->id_) {
                 replaced_lms[lm_to_replace] = lm_in_neighbor;
                 lm_to_replace->replace(lm_in_neighbor, map_db_);
+                lm_in_neighbor->update_active_observations(map_db_->get_max_num_active_observations());
                 if (!lm_in_neighbor->has_representative_descriptor()) {
                     lm_in_neighbor->compute_descriptor();
                 }
@@ -502,7 +555,7 @@ auto global_optimization_module::extract_new_connections(const std::vector<std::
         const auto neighbors_before_update = covisibility->graph_node_->get_covisibilities();
 
         // call update_connections()
-        covisibility->graph_node_->update_connections(map_db_->get_min_num_shared_lms());
+        covisibility->graph_node_->update_connections(map_db_->get_min_num_shared_lms(), map_db_->get_max_num_covisibilities());
         // acquire neighbors AFTER loop fusion
         new_connections[covisibility] = covisibility->graph_node_->get_connected_keyframes();
 
@@ -537,6 +590,7 @@ void global_optimization_module::reset() {
     std::lock_guard<std::mutex> lock(mtx_reset_);
     spdlog::info("reset global optimization module");
     keyfrms_queue_.clear();
+    keyfrm_for_deferred_loop_BA_ = nullptr;
     loop_detector_->set_loop_correct_keyframe_id(0);
     reset_is_requested_ = false;
     promise_reset_.set_value();
@@ -7,7 +7,9 @@
 #include "stella_vslam/module/loop_detector.h"
 #include "stella_vslam/module/loop_bundle_adjuster.h"
 #include "stella_vslam/optimize/graph_optimizer.h"
+#include "stella_vslam/util/runtime_params.h"
 
+#include <chrono>
 #include <list>
 #include <mutex>
 #include <thread>
@@ -65,6 +67,9 @@ public:
     //! Queue a keyframe to the BoW database
     void queue_keyframe(const std::shared_ptr<data::keyframe>& keyfrm);
 
+    //! Request to change the parameters of the loop detector (applied before the next loop detection)
+    void request_update_parameters(const YAML::Node& yaml_node);
+
     //-----------------------------------------
     // management for reset process
 
@@ -117,6 +122,9 @@ private:
     //! Perform loop closing
     void correct_loop();
 
+    //! Launch the loop BA deferred by the pose-only loop refinement
+    void launch_deferred_loop_BA();
+
     //! Compute Sim3s (world to covisibility) which are prior to loop correction
     module::keyframe_Sim3_pairs_t get_Sim3s_before_loop_correction(const std::vector<std::shared_ptr<data::keyframe>>& neighbors) const;
 
@@ -234,6 +242,9 @@ private:
     //! loop bundle adjuster
     std::unique_ptr<module::loop_bundle_adjuster> loop_bundle_adjuster_ = nullptr;
 
+    //! requested changes of the parameters of the loop detector
+    util::runtime_params_queue params_queue_;
+
     //! map database
     data::map_database* map_db_ = nullptr;
 
@@ -264,6 +275,17 @@ private:
     std::unique_ptr<std::thread> thread_for_loop_BA_ = nullptr;
 
     unsigned int thr_neighbor_keyframes_ = 15;
+
+    //! If true, refine only the keyframe poses after loop correction, and defer the loop BA until the modules are idle
+    const bool use_pose_only_refinement_ = false;
+
+    //! maximum time [s] to defer the loop BA while the modules are busy
+    const double max_deferral_time_of_loop_BA_ = 10.0;
+
+    //! current keyframe of the deferred loop BA (nullptr if not deferred)
+    std::shared_ptr<data::keyframe> keyfrm_for_deferred_loop_BA_ = nullptr;
+    //! time when the deferred loop BA is launched even if the modules are busy
+    std::chrono::steady_clock::time_point deadline_of_deferred_loop_BA_;
 };
 
 } // namespace stella_vslam
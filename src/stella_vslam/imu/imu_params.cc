@@ -0,0 +1,62 @@
+#include "stella_vslam/imu/imu_params.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace stella_vslam {
+namespace imu {
+
+namespace {
+
+Mat44_t load_rel_pose_bc(const YAML::Node& yaml_node) {
+    if (!yaml_node["rel_pose_bc"]) {
+        return Mat44_t::Identity();
+    }
+    const auto values = yaml_node["rel_pose_bc"].as<std::vector<double>>();
+    if (values.size() != 16) {
+        throw std::runtime_error("IMU.rel_pose_bc must be a row-major 4x4 matrix");
+    }
+    return Eigen::Map<const Eigen::Matrix<double, 4, 4, Eigen::RowMajor>>(values.data());
+}
+
+} // namespace
+
+imu_params::imu_params(const double rate_hz, const double gyr_noise_density, const double acc_noise_density,
+                       const double gyr_random_walk, const double acc_random_walk, const Mat44_t& rel_pose_bc)
+    : rate_hz_(rate_hz), gyr_noise_density_(gyr_noise_density), acc_noise_density_(acc_noise_density),
+      gyr_random_walk_(gyr_random_walk), acc_random_walk_(acc_random_walk), rel_pose_bc_(rel_pose_bc) {}
+
+imu_params::imu_params(const YAML::Node& yaml_node)
+    : imu_params(yaml_node["rate_hz"].as<double>(200.0),
+                 yaml_node["gyr_noise_density"].as<double>(1.7e-4),
+                 yaml_node["acc_noise_density"].as<double>(2.0e-3),
+                 yaml_node["gyr_random_walk"].as<double>(1.9e-5),
+                 yaml_node["acc_random_walk"].as<double>(3.0e-3),
+                 load_rel_pose_bc(yaml_node)) {}
+
+Mat66_t imu_params::get_measurement_covariance() const {
+    // continuous-time noise densities to the discrete-time variances
+    Mat66_t cov = Mat66_t::Zero();
+    cov.block<3, 3>(0, 0) = gyr_noise_density_ * gyr_noise_density_ * rate_hz_ * Mat33_t::Identity();
+    cov.block<3, 3>(3, 3) = acc_noise_density_ * acc_noise_density_ * rate_hz_ * Mat33_t::Identity();
+    return cov;
+}
+
+Mat66_t imu_params::get_bias_random_walk_covariance(const double dt) const {
+    Mat66_t cov = Mat66_t::Zero();
+    cov.block<3, 3>(0, 0) = gyr_random_walk_ * gyr_random_walk_ * dt * Mat33_t::Identity();
+    cov.block<3, 3>(3, 3) = acc_random_walk_ * acc_random_walk_ * dt * Mat33_t::Identity();
+    return cov;
+}
+
+std::ostream& operator<<(std::ostream& os, const imu_params& params) {
+    os << "- rate: " << params.rate_hz_ << std::endl;
+    os << "- gyroscope noise density: " << params.gyr_noise_density_ << std::endl;
+    os << "- accelerometer noise density: " << params.acc_noise_density_ << std::endl;
+    os << "- gyroscope random walk: " << params.gyr_random_walk_ << std::endl;
+    os << "- accelerometer random walk: " << params.acc_random_walk_ << std::endl;
+    return os;
+}
+
+} // namespace imu
+} // namespace stella_vslam
@@ -0,0 +1,51 @@
+#ifndef STELLA_VSLAM_IMU_IMU_PARAMS_H
+#define STELLA_VSLAM_IMU_IMU_PARAMS_H
+
+#include "stella_vslam/type.h"
+
+#include <yaml-cpp/yaml.h>
+
+namespace stella_vslam {
+namespace imu {
+
+struct imu_params {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    imu_params() = delete;
+
+    //! Constructor
+    imu_params(const double rate_hz, const double gyr_noise_density, const double acc_noise_density,
+               const double gyr_random_walk, const double acc_random_walk, const Mat44_t& rel_pose_bc);
+
+    //! Constructor
+    explicit imu_params(const YAML::Node& yaml_node);
+
+    //! Get the rotation from the camera frame to the body (IMU) frame
+    Mat33_t get_rot_bc() const { return rel_pose_bc_.block<3, 3>(0, 0); }
+
+    //! Get the covariance of the discrete-time gyroscope and accelerometer noise
+    Mat66_t get_measurement_covariance() const;
+
+    //! Get the covariance of the random walk of [gyroscope bias, accelerometer bias] over the interval dt
+    Mat66_t get_bias_random_walk_covariance(const double dt) const;
+
+    //! sampling rate [Hz]
+    const double rate_hz_ = 200.0;
+    //! gyroscope noise density [rad/s/sqrt(Hz)]
+    const double gyr_noise_density_ = 1.7e-4;
+    //! accelerometer noise density [m/s^2/sqrt(Hz)]
+    const double acc_noise_density_ = 2.0e-3;
+    //! gyroscope random walk [rad/s^2/sqrt(Hz)]
+    const double gyr_random_walk_ = 1.9e-5;
+    //! accelerometer random walk [m/s^3/sqrt(Hz)]
+    const double acc_random_walk_ = 3.0e-3;
+    //! pose of the camera in the body (IMU) frame
+    const Mat44_t rel_pose_bc_ = Mat44_t::Identity();
+};
+
+std::ostream& operator<<(std::ostream& os, const imu_params& params);
+
+} // namespace imu
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_IMU_IMU_PARAMS_H
@@ -0,0 +1,95 @@
+#include "stella_vslam/imu/imu_params.h"
+#include "stella_vslam/imu/initializer.h"
+#include "stella_vslam/imu/preintegrator.h"
+#include "stella_vslam/util/converter.h"
+
+#include <cmath>
+
+namespace stella_vslam {
+namespace imu {
+
+namespace {
+
+/**
+ * Build the linear system of the velocities (and the gravity if it is not given)
+ * v_2 - v_1 - g dt = R_wb_1 dv
+ * v_1 dt + 0.5 g dt^2 = p_2 - p_1 - R_wb_1 dp
+ */
+void build_linear_system(const eigen_alloc_vector<Mat44_t>& body_poses_wb,
+                         const std::vector<std::shared_ptr<const preintegrator>>& preints,
+                         const bias& b, const Vec3_t* gravity_w,
+                         MatX_t& A, VecX_t& rhs) {
+    const unsigned int num_keyfrms = body_poses_wb.size();
+    const unsigned int num_unknowns = 3 * num_keyfrms + (gravity_w ? 0 : 3);
+    A = MatX_t::Zero(6 * (num_keyfrms - 1), num_unknowns);
+    rhs = VecX_t::Zero(6 * (num_keyfrms - 1));
+
+    for (unsigned int i = 0; i + 1 < num_keyfrms; ++i) {
+        const auto& preint = preints.at(i);
+        const double dt = preint->get_integration_time();
+        const Mat33_t rot_wb_1 = body_poses_wb.at(i).block<3, 3>(0, 0);
+        const Vec3_t pos_w_1 = body_poses_wb.at(i).block<3, 1>(0, 3);
+        const Vec3_t pos_w_2 = body_poses_wb.at(i + 1).block<3, 1>(0, 3);
+
+        Vec3_t vel_rhs = rot_wb_1 * preint->get_delta_velocity(b);
+        Vec3_t pos_rhs = pos_w_2 - pos_w_1 - rot_wb_1 * preint->get_delta_position(b);
+
+        const unsigned int row = 6 * i;
+        A.block<3, 3>(row, 3 * (i + 1)) = Mat33_t::Identity();
+        A.block<3, 3>(row, 3 * i) = -Mat33_t::Identity();
+        A.block<3, 3>(row + 3, 3 * i) = dt * Mat33_t::Identity();
+        if (gravity_w) {
+            vel_rhs += *gravity_w * dt;
+            pos_rhs -= 0.5 * *gravity_w * dt * dt;
+        }
+        else {
+            A.block<3, 3>(row, 3 * num_keyfrms) = -dt * Mat33_t::Identity();
+            A.block<3, 3>(row + 3, 3 * num_keyfrms) = 0.5 * dt * dt * Mat33_t::Identity();
+        }
+        rhs.segment<3>(row) = vel_rhs;
+        rhs.segment<3>(row + 3) = pos_rhs;
+    }
+}
+
+} // namespace
+
+bool estimate_gravity_and_velocities(const imu_params& params,
+                                     const eigen_alloc_vector<Mat44_t>& cam_poses_cw,
+                                     const std::vector<std::shared_ptr<const preintegrator>>& preints,
+                                     const bias& b, const double max_gravity_error,
+                                     Vec3_t& gravity_w, eigen_alloc_vector<Vec3_t>& velocities_w) {
+    const unsigned int num_keyfrms = cam_poses_cw.size();
+    // the system is overdetermined with three or more keyframes
+    if (num_keyfrms < 3 || preints.size() + 1 != num_keyfrms) {
+        return false;
+    }
+
+    eigen_alloc_vector<Mat44_t> body_poses_wb;
+    body_poses_wb.reserve(num_keyfrms);
+    for (const auto& cam_pose_cw : cam_poses_cw) {
+        body_poses_wb.push_back(util::converter::inverse_pose(params.rel_pose_bc_ * cam_pose_cw));
+    }
+
+    // Step 1. Estimate the gravity with the velocities
+    MatX_t A;
+    VecX_t rhs;
+    build_linear_system(body_poses_wb, preints, b, nullptr, A, rhs);
+    const VecX_t x = A.colPivHouseholderQr().solve(rhs);
+    const Vec3_t estimated_gravity_w = x.tail<3>();
+    if (max_gravity_error < std::abs(estimated_gravity_w.norm() / standard_gravity - 1.0)) {
+        return false;
+    }
+
+    // Step 2. Re-estimate the velocities with the gravity of the standard norm
+    gravity_w = standard_gravity * estimated_gravity_w.normalized();
+    build_linear_system(body_poses_wb, preints, b, &gravity_w, A, rhs);
+    const VecX_t vels = A.colPivHouseholderQr().solve(rhs);
+    velocities_w.resize(num_keyfrms);
+    for (unsigned int i = 0; i < num_keyfrms; ++i) {
+        velocities_w.at(i) = vels.segment<3>(3 * i);
+    }
+    return true;
+}
+
+} // namespace imu
+} // namespace stella_vslam
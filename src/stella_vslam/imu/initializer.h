@@ -0,0 +1,41 @@
+#ifndef STELLA_VSLAM_IMU_INITIALIZER_H
+#define STELLA_VSLAM_IMU_INITIALIZER_H
+
+#include "stella_vslam/type.h"
+#include "stella_vslam/imu/measurement.h"
+
+#include <memory>
+#include <vector>
+
+namespace stella_vslam {
+namespace imu {
+
+struct imu_params;
+class preintegrator;
+
+//! standard gravity [m/s^2]
+constexpr double standard_gravity = 9.80665;
+
+/**
+ * Estimate the gravity and the velocities of the body at the consecutive keyframes
+ * by the linear least squares of the preintegrated velocities and positions (with the bias held fixed)
+ * (NOTE: the camera poses must have the metric scale)
+ * @param params IMU parameters
+ * @param cam_poses_cw camera poses of the keyframes (in the time order)
+ * @param preints preintegrations between the consecutive keyframes (one less than the keyframes)
+ * @param b IMU bias
+ * @param max_gravity_error maximum relative error of the estimated gravity norm to the standard gravity
+ * @param gravity_w estimated gravity in the world frame (scaled to the standard gravity)
+ * @param velocities_w estimated velocities of the body in the world frame
+ * @return true if the estimated gravity is consistent with the standard gravity
+ */
+bool estimate_gravity_and_velocities(const imu_params& params,
+                                     const eigen_alloc_vector<Mat44_t>& cam_poses_cw,
+                                     const std::vector<std::shared_ptr<const preintegrator>>& preints,
+                                     const bias& b, const double max_gravity_error,
+                                     Vec3_t& gravity_w, eigen_alloc_vector<Vec3_t>& velocities_w);
+
+} // namespace imu
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_IMU_INITIALIZER_H
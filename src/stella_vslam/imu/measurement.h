@@ -0,0 +1,50 @@
+#ifndef STELLA_VSLAM_IMU_MEASUREMENT_H
+#define STELLA_VSLAM_IMU_MEASUREMENT_H
+
+#include "stella_vslam/type.h"
+
+namespace stella_vslam {
+namespace imu {
+
+struct measurement {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    //! Constructor
+    measurement(const double timestamp, const Vec3_t& acc, const Vec3_t& gyr)
+        : timestamp_(timestamp), acc_(acc), gyr_(gyr) {}
+
+    //! timestamp [s]
+    double timestamp_;
+    //! linear acceleration in the body (IMU) frame [m/s^2]
+    Vec3_t acc_;
+    //! angular velocity in the body (IMU) frame [rad/s]
+    Vec3_t gyr_;
+};
+
+struct bias {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    //! Constructor
+    bias() = default;
+
+    //! Constructor from the vector of [gyroscope bias, accelerometer bias]
+    explicit bias(const Vec6_t& vec)
+        : acc_(vec.tail<3>()), gyr_(vec.head<3>()) {}
+
+    //! Get the vector of [gyroscope bias, accelerometer bias]
+    Vec6_t to_vector() const {
+        Vec6_t vec;
+        vec << gyr_, acc_;
+        return vec;
+    }
+
+    //! accelerometer bias [m/s^2]
+    Vec3_t acc_ = Vec3_t::Zero();
+    //! gyroscope bias [rad/s]
+    Vec3_t gyr_ = Vec3_t::Zero();
+};
+
+} // namespace imu
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_IMU_MEASUREMENT_H
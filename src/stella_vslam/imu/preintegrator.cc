@@ -0,0 +1,172 @@
+#include "stella_vslam/imu/imu_params.h"
+#include "stella_vslam/imu/preintegrator.h"
+#include "stella_vslam/util/converter.h"
+
+#include <algorithm>
+
+namespace stella_vslam {
+namespace imu {
+
+namespace {
+
+Mat33_t to_skew_symmetric_mat(const Vec3_t& vec) {
+    Mat33_t skew;
+    skew << 0, -vec(2), vec(1),
+        vec(2), 0, -vec(0),
+        -vec(1), vec(0), 0;
+    return skew;
+}
+
+//! Exponential map of SO(3) (keeps the small rotations between the high-rate samples)
+Mat33_t exp_so3(const Vec3_t& rot_vec) {
+    const double theta = rot_vec.norm();
+    if (theta < 1e-5) {
+        return Quat_t(1.0, 0.5 * rot_vec(0), 0.5 * rot_vec(1), 0.5 * rot_vec(2)).normalized().toRotationMatrix();
+    }
+    return Eigen::AngleAxisd(theta, rot_vec / theta).toRotationMatrix();
+}
+
+//! Right Jacobian of SO(3)
+Mat33_t compute_right_jacobian(const Vec3_t& rot_vec) {
+    const double theta = rot_vec.norm();
+    const Mat33_t skew = to_skew_symmetric_mat(rot_vec);
+    if (theta < 1e-5) {
+        return Mat33_t::Identity() - 0.5 * skew;
+    }
+    const double theta_sq = theta * theta;
+    return Mat33_t::Identity() - (1.0 - std::cos(theta)) / theta_sq * skew
+           + (theta - std::sin(theta)) / (theta_sq * theta) * skew * skew;
+}
+
+//! Interpolate the measurement at the timestamp
+measurement interpolate(const measurement& m_1, const measurement& m_2, const double timestamp) {
+    const double span = m_2.timestamp_ - m_1.timestamp_;
+    if (span <= 0.0) {
+        return measurement(timestamp, m_1.acc_, m_1.gyr_);
+    }
+    const double ratio = std::min(std::max((timestamp - m_1.timestamp_) / span, 0.0), 1.0);
+    return measurement(timestamp,
+                       (1.0 - ratio) * m_1.acc_ + ratio * m_2.acc_,
+                       (1.0 - ratio) * m_1.gyr_ + ratio * m_2.gyr_);
+}
+
+//! Pose of the body in the world frame
+Mat44_t compute_body_pose_wb(const Mat44_t& cam_pose_cw, const Mat44_t& rel_pose_bc) {
+    return util::converter::inverse_pose(rel_pose_bc * cam_pose_cw);
+}
+
+} // namespace
+
+preintegrator::preintegrator(const imu_params& params, const bias& b)
+    : bias_(b), meas_cov_(params.get_measurement_covariance()),
+      bias_random_walk_cov_(params.get_bias_random_walk_covariance(1.0)), rel_pose_bc_(params.rel_pose_bc_) {}
+
+void preintegrator::integrate(const Vec3_t& acc, const Vec3_t& gyr, const double dt) {
+    if (dt <= 0.0) {
+        return;
+    }
+
+    const Vec3_t unbiased_acc = acc - bias_.acc_;
+    const Vec3_t unbiased_gyr = gyr - bias_.gyr_;
+    const Vec3_t rot_vec = unbiased_gyr * dt;
+    const Mat33_t incr_rot = exp_so3(rot_vec);
+    const Mat33_t right_jac = compute_right_jacobian(rot_vec);
+    const Mat33_t skew_acc = to_skew_symmetric_mat(unbiased_acc);
+    const double dt_sq = dt * dt;
+
+    // Step 1. Propagate the Jacobians with respect to the biases (with the rotation before the update)
+    jac_pos_acc_ += jac_vel_acc_ * dt - 0.5 * delta_rot_ * dt_sq;
+    jac_pos_gyr_ += jac_vel_gyr_ * dt - 0.5 * delta_rot_ * skew_acc * jac_rot_gyr_ * dt_sq;
+    jac_vel_acc_ -= delta_rot_ * dt;
+    jac_vel_gyr_ -= delta_rot_ * skew_acc * jac_rot_gyr_ * dt;
+    jac_rot_gyr_ = incr_rot.transpose() * jac_rot_gyr_ - right_jac * dt;
+
+    // Step 2. Propagate the covariance
+    MatRC_t<9, 9> A = MatRC_t<9, 9>::Identity();
+    A.block<3, 3>(0, 0) = incr_rot.transpose();
+    A.block<3, 3>(3, 0) = -delta_rot_ * skew_acc * dt;
+    A.block<3, 3>(6, 0) = -0.5 * delta_rot_ * skew_acc * dt_sq;
+    A.block<3, 3>(6, 3) = Mat33_t::Identity() * dt;
+    MatRC_t<9, 6> B = MatRC_t<9, 6>::Zero();
+    B.block<3, 3>(0, 0) = right_jac * dt;
+    B.block<3, 3>(3, 3) = delta_rot_ * dt;
+    B.block<3, 3>(6, 3) = 0.5 * delta_rot_ * dt_sq;
+    cov_ = A * cov_ * A.transpose() + B * meas_cov_ * B.transpose();
+
+    // Step 3. Update the preintegrated values
+    delta_pos_ += delta_vel_ * dt + 0.5 * delta_rot_ * unbiased_acc * dt_sq;
+    delta_vel_ += delta_rot_ * unbiased_acc * dt;
+    delta_rot_ = Quat_t(delta_rot_ * incr_rot).normalized().toRotationMatrix();
+
+    integration_time_ += dt;
+    ++num_measurements_;
+}
+
+void preintegrator::integrate(const std::vector<measurement, Eigen::aligned_allocator<measurement>>& measurements,
+                              const double t_begin, const double t_end) {
+    if (measurements.empty() || t_end <= t_begin) {
+        return;
+    }
+
+    // Hold the first/last measurement if the interval is not covered
+    if (t_begin < measurements.front().timestamp_) {
+        const auto& m = measurements.front();
+        integrate(m.acc_, m.gyr_, std::min(m.timestamp_, t_end) - t_begin);
+    }
+    for (unsigned int i = 0; i + 1 < measurements.size(); ++i) {
+        const auto& m_1 = measurements.at(i);
+        const auto& m_2 = measurements.at(i + 1);
+        const double seg_begin = std::max(m_1.timestamp_, t_begin);
+        const double seg_end = std::min(m_2.timestamp_, t_end);
+        if (seg_end <= seg_begin) {
+            continue;
+        }
+        // midpoint of the segment
+        const auto m = interpolate(m_1, m_2, 0.5 * (seg_begin + seg_end));
+        integrate(m.acc_, m.gyr_, seg_end - seg_begin);
+    }
+    if (measurements.back().timestamp_ < t_end) {
+        const auto& m = measurements.back();
+        integrate(m.acc_, m.gyr_, t_end - std::max(m.timestamp_, t_begin));
+    }
+}
+
+Mat33_t preintegrator::get_delta_rotation(const bias& b) const {
+    const Vec3_t d_bias_gyr = b.gyr_ - bias_.gyr_;
+    return delta_rot_ * exp_so3(jac_rot_gyr_ * d_bias_gyr);
+}
+
+Vec3_t preintegrator::get_delta_velocity(const bias& b) const {
+    return delta_vel_ + jac_vel_gyr_ * (b.gyr_ - bias_.gyr_) + jac_vel_acc_ * (b.acc_ - bias_.acc_);
+}
+
+Vec3_t preintegrator::get_delta_position(const bias& b) const {
+    return delta_pos_ + jac_pos_gyr_ * (b.gyr_ - bias_.gyr_) + jac_pos_acc_ * (b.acc_ - bias_.acc_);
+}
+
+Vec9_t preintegrator::compute_error(const Mat44_t& cam_pose_cw_1, const Vec3_t& vel_w_1,
+                                    const Mat44_t& cam_pose_cw_2, const Vec3_t& vel_w_2,
+                                    const bias& b, const Vec3_t& gravity_w) const {
+    const Mat44_t body_pose_wb_1 = compute_body_pose_wb(cam_pose_cw_1, rel_pose_bc_);
+    const Mat44_t body_pose_wb_2 = compute_body_pose_wb(cam_pose_cw_2, rel_pose_bc_);
+    const Mat33_t rot_b1w = body_pose_wb_1.block<3, 3>(0, 0).transpose();
+    const Vec3_t pos_w_1 = body_pose_wb_1.block<3, 1>(0, 3);
+    const Vec3_t pos_w_2 = body_pose_wb_2.block<3, 1>(0, 3);
+    const double dt = integration_time_;
+
+    Vec9_t error;
+    error.head<3>() = compute_rotation_error(cam_pose_cw_1.block<3, 3>(0, 0), cam_pose_cw_2.block<3, 3>(0, 0), b);
+    error.segment<3>(3) = rot_b1w * (vel_w_2 - vel_w_1 - gravity_w * dt) - get_delta_velocity(b);
+    error.tail<3>() = rot_b1w * (pos_w_2 - pos_w_1 - vel_w_1 * dt - 0.5 * gravity_w * dt * dt) - get_delta_position(b);
+    return error;
+}
+
+Vec3_t preintegrator::compute_rotation_error(const Mat33_t& cam_rot_cw_1, const Mat33_t& cam_rot_cw_2, const bias& b) const {
+    // rotation of the body from the first frame to the second frame
+    const Mat33_t rot_bc = rel_pose_bc_.block<3, 3>(0, 0);
+    const Mat33_t rot_b1b2 = rot_bc * cam_rot_cw_1 * cam_rot_cw_2.transpose() * rot_bc.transpose();
+    return util::converter::to_angle_axis(get_delta_rotation(b).transpose() * rot_b1b2);
+}
+
+} // namespace imu
+} // namespace stella_vslam
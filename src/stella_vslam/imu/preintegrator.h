@@ -0,0 +1,101 @@
+#ifndef STELLA_VSLAM_IMU_PREINTEGRATOR_H
+#define STELLA_VSLAM_IMU_PREINTEGRATOR_H
+
+#include "stella_vslam/type.h"
+#include "stella_vslam/imu/measurement.h"
+
+#include <vector>
+
+namespace stella_vslam {
+namespace imu {
+
+struct imu_params;
+
+/**
+ * On-manifold preintegration of the IMU measurements between two frames
+ * (C. Forster et al., "On-Manifold Preintegration for Real-Time Visual-Inertial Odometry", T-RO 2017)
+ */
+class preintegrator {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    //! Constructor
+    preintegrator(const imu_params& params, const bias& b);
+
+    //! Integrate a single measurement held for dt seconds
+    void integrate(const Vec3_t& acc, const Vec3_t& gyr, const double dt);
+
+    //! Integrate the measurements (sorted by timestamp) between t_begin and t_end
+    //! (the measurements at both ends are linearly interpolated, or held if the interval is not covered)
+    void integrate(const std::vector<measurement, Eigen::aligned_allocator<measurement>>& measurements,
+                   const double t_begin, const double t_end);
+
+    //! Get the preintegrated rotation corrected to the given bias by the first-order approximation
+    Mat33_t get_delta_rotation(const bias& b) const;
+
+    //! Get the preintegrated velocity corrected to the given bias by the first-order approximation
+    Vec3_t get_delta_velocity(const bias& b) const;
+
+    //! Get the preintegrated position corrected to the given bias by the first-order approximation
+    Vec3_t get_delta_position(const bias& b) const;
+
+    //! Get the integrated time [s]
+    double get_integration_time() const { return integration_time_; }
+
+    //! Get the number of the integrated measurements
+    unsigned int get_num_measurements() const { return num_measurements_; }
+
+    //! Get the covariance of [delta rotation, delta velocity, delta position]
+    const MatRC_t<9, 9>& get_covariance() const { return cov_; }
+
+    //! Get the Jacobian of the delta rotation with respect to the gyroscope bias
+    const Mat33_t& get_jacobian_rot_gyr() const { return jac_rot_gyr_; }
+
+    //! Get the covariance of the random walk of [gyroscope bias, accelerometer bias] over the integrated time
+    Mat66_t get_bias_random_walk_covariance() const { return bias_random_walk_cov_ * integration_time_; }
+
+    //! Compute the residual of [rotation, velocity, position] between the two frames
+    //! from their camera poses (cw) and the velocities of the body in the world frame
+    Vec9_t compute_error(const Mat44_t& cam_pose_cw_1, const Vec3_t& vel_w_1,
+                         const Mat44_t& cam_pose_cw_2, const Vec3_t& vel_w_2,
+                         const bias& b, const Vec3_t& gravity_w) const;
+
+    //! Compute the residual of the rotation between the two frames from their camera rotations (cw)
+    Vec3_t compute_rotation_error(const Mat33_t& cam_rot_cw_1, const Mat33_t& cam_rot_cw_2, const bias& b) const;
+
+    //! bias used for the integration
+    const bias bias_;
+
+private:
+    //! covariance of the discrete-time gyroscope and accelerometer noise
+    const Mat66_t meas_cov_;
+    //! covariance of the bias random walk per second
+    const Mat66_t bias_random_walk_cov_;
+    //! pose of the camera in the body (IMU) frame
+    const Mat44_t rel_pose_bc_;
+
+    //! integrated time [s]
+    double integration_time_ = 0.0;
+    //! number of the integrated measurements
+    unsigned int num_measurements_ = 0;
+
+    //! preintegrated rotation, velocity and position
+    Mat33_t delta_rot_ = Mat33_t::Identity();
+    Vec3_t delta_vel_ = Vec3_t::Zero();
+    Vec3_t delta_pos_ = Vec3_t::Zero();
+
+    //! covariance of [delta rotation, delta velocity, delta position]
+    MatRC_t<9, 9> cov_ = MatRC_t<9, 9>::Zero();
+
+    //! Jacobians with respect to the biases
+    Mat33_t jac_rot_gyr_ = Mat33_t::Zero();
+    Mat33_t jac_vel_gyr_ = Mat33_t::Zero();
+    Mat33_t jac_vel_acc_ = Mat33_t::Zero();
+    Mat33_t jac_pos_gyr_ = Mat33_t::Zero();
+    Mat33_t jac_pos_acc_ = Mat33_t::Zero();
+};
+
+} // namespace imu
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_IMU_PREINTEGRATOR_H
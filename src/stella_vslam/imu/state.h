@@ -0,0 +1,48 @@
+#ifndef STELLA_VSLAM_IMU_STATE_H
+#define STELLA_VSLAM_IMU_STATE_H
+
+#include "stella_vslam/type.h"
+#include "stella_vslam/imu/measurement.h"
+
+#include <memory>
+
+namespace stella_vslam {
+namespace imu {
+
+class preintegrator;
+
+//! Inertial state of the body at a frame
+struct state {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    state() = default;
+
+    state(const Vec3_t& velocity, const bias& b)
+        : velocity_(velocity), bias_(b) {}
+
+    //! velocity of the body in the world frame [m/s]
+    Vec3_t velocity_ = Vec3_t::Zero();
+    //! IMU bias
+    bias bias_;
+};
+
+//! Inertial constraint from a reference frame, whose state is held fixed, to the frame being optimized
+struct constraint {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    //! preintegration from the reference frame
+    std::shared_ptr<const preintegrator> preint_ = nullptr;
+    //! camera pose of the reference frame
+    Mat44_t ref_pose_cw_ = Mat44_t::Identity();
+    //! inertial state of the reference frame
+    state ref_state_;
+    //! if false, only the rotation is constrained because the gravity (and the velocities) are unknown
+    bool gravity_is_initialized_ = false;
+    //! gravity in the world frame [m/s^2]
+    Vec3_t gravity_w_ = Vec3_t::Zero();
+};
+
+} // namespace imu
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_IMU_STATE_H
@@ -11,7 +11,7 @@ base::base(const data::frame& ref_frm,
            const unsigned int min_num_valid_pts,
            const float parallax_deg_thr,
            const float reproj_err_thr)
-    : ref_camera_(ref_frm.camera_), ref_undist_keypts_(ref_frm.frm_obs_.undist_keypts_), ref_bearings_(ref_frm.frm_obs_.bearings_),
+    : ref_camera_(ref_frm.camera_), ref_undist_keypts_(ref_frm.frm_obs_->undist_keypts_), ref_bearings_(ref_frm.frm_obs_->bearings_),
       num_ransac_iters_(num_ransac_iters), min_num_triangulated_(min_num_triangulated),
       min_num_valid_pts_(min_num_valid_pts),
       parallax_deg_thr_(parallax_deg_thr), reproj_err_thr_(reproj_err_thr) {}
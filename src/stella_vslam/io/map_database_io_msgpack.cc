@@ -57,7 +57,7 @@ bool map_database_io_msgpack::load(const std::string& path,
                                    data::bow_database* bow_db,
                                    data::bow_vocabulary* bow_vocab) {
     std::lock_guard<std::mutex> lock(data::map_database::mtx_database_);
-    assert(cam_db && orb_params_db && map_db && bow_db && bow_vocab);
+    assert(cam_db && orb_params_db && map_db);
 
     // load binary bytes
 
@@ -96,9 +96,11 @@ bool map_database_io_msgpack::load(const std::string& path,
     map_db->next_landmark_id_ += json.at("landmark_next_id").get<unsigned int>();
 
     // update bow database
-    const auto keyfrms = map_db->get_all_keyframes();
-    for (const auto& keyfrm : keyfrms) {
-        bow_db->add_keyframe(keyfrm);
+    if (bow_db) {
+        const auto keyfrms = map_db->get_all_keyframes();
+        for (const auto& keyfrm : keyfrms) {
+            bow_db->add_keyframe(keyfrm);
+        }
     }
     return true;
 }
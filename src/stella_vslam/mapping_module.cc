@@ -5,6 +5,8 @@
 #include "stella_vslam/data/keyframe.h"
 #include "stella_vslam/data/landmark.h"
 #include "stella_vslam/data/map_database.h"
+#include "stella_vslam/imu/initializer.h"
+#include "stella_vslam/match/base.h"
 #include "stella_vslam/match/fuse.h"
 #include "stella_vslam/match/robust.h"
 #include "stella_vslam/module/two_view_triangulator.h"
@@ -12,6 +14,7 @@
 #include "stella_vslam/solve/essential_solver.h"
 #include "stella_vslam/benchmark/timer.h"
 
+#include <algorithm>
 #include <thread>
 
 #include <spdlog/spdlog.h>
@@ -28,9 +31,16 @@ mapping_module::mapping_module(const YAML::Node& yaml_node, data::map_database*
       num_covisibilities_for_landmark_fusion_(yaml_node["num_covisibilities_for_landmark_fusion"].as<unsigned int>(10)),
       erase_temporal_keyframes_(yaml_node["erase_temporal_keyframes"].as<bool>(false)),
       num_temporal_keyframes_(yaml_node["num_temporal_keyframes"].as<unsigned int>(15)),
-      residual_rad_thr_(yaml_node["residual_deg_thr"].as<float>(0.2) * M_PI / 180.0) {
+      residual_rad_thr_(yaml_node["residual_deg_thr"].as<float>(0.2) * M_PI / 180.0),
+      lm_dedup_dist_ratio_(yaml_node["landmark_dedup_dist_ratio"].as<double>(0.01)),
+      num_keyframes_for_gravity_initialization_(yaml_node["num_keyframes_for_gravity_initialization"].as<unsigned int>(10)),
+      max_gravity_error_(yaml_node["max_gravity_error"].as<double>(0.1)) {
     spdlog::debug("CONSTRUCT: mapping_module");
 
+    if (yaml_node["enable_landmark_deduplication"].as<bool>(false)) {
+        lm_spatial_hash_ = stella_vslam::make_unique<data::landmark_spatial_hash>(yaml_node["landmark_hash_cell_size"].as<double>(0.1));
+    }
+
     spdlog::debug("load mapping parameters");
 
     spdlog::debug("load monocular mappping parameters");
@@ -103,6 +113,11 @@ void mapping_module::run() {
             }
         }
 
+        // apply the requested changes of the parameters between the keyframes
+        for (const auto& yaml_node : params_queue_.pop_all()) {
+            update_parameters(yaml_node);
+        }
+
         // if the queue is empty, the following process is not needed
         if (!keyframe_is_queued()) {
             continue;
@@ -132,6 +147,18 @@ unsigned int mapping_module::get_num_queued_keyframes() const {
     return keyfrms_queue_.size();
 }
 
+void mapping_module::request_update_parameters(const YAML::Node& yaml_node) {
+    params_queue_.push(yaml_node);
+}
+
+void mapping_module::update_parameters(const YAML::Node& yaml_node) {
+    const auto num_first_iter = yaml_node["local_ba_num_first_iter"].as<unsigned int>(local_bundle_adjuster_->get_num_first_iter());
+    const auto num_second_iter = yaml_node["local_ba_num_second_iter"].as<unsigned int>(local_bundle_adjuster_->get_num_second_iter());
+    util::record_param_change("mapping_module", "local_ba_num_first_iter", local_bundle_adjuster_->get_num_first_iter(), num_first_iter);
+    util::record_param_change("mapping_module", "local_ba_num_second_iter", local_bundle_adjuster_->get_num_second_iter(), num_second_iter);
+    local_bundle_adjuster_->set_num_iterations(num_first_iter, num_second_iter);
+}
+
 bool mapping_module::keyframe_is_queued() const {
     std::lock_guard<std::mutex> lock(mtx_keyfrm_queue_);
     return !keyfrms_queue_.empty();
@@ -146,6 +173,10 @@ void mapping_module::abort_local_BA() {
     abort_local_BA_ = true;
 }
 
+void mapping_module::invalidate_landmark_spatial_hash() {
+    lm_spatial_hash_is_invalidated_ = true;
+}
+
 void mapping_module::mapping_with_new_keyframe() {
     STELLA_BENCHMARK_TIMER("mapping_module", "mapping_with_new_keyframe");
     
@@ -210,6 +241,11 @@ void mapping_module::mapping_with_new_keyframe() {
         }
     }
 
+    // the full inertial constraints are used in the local BA after the gravity is estimated
+    if (tracker_ && tracker_->imu_params_) {
+        initialize_gravity();
+    }
+
     if (erase_temporal_keyframes_) {
         for (const auto& keyfrm : map_db_->get_all_keyframes()) {
             if (keyfrm->id_ <= map_db_->get_fixed_keyframe_id_threshold()) {
@@ -248,6 +284,60 @@ void mapping_module::mapping_with_new_keyframe() {
     }
 }
 
+void mapping_module::initialize_gravity() {
+    Vec3_t gravity_w;
+    if (map_db_->get_gravity(gravity_w)) {
+        return;
+    }
+    // the velocities cannot be estimated without the metric scale
+    if (!cur_keyfrm_->depth_is_available()) {
+        return;
+    }
+
+    // Follow the chain of the preintegrations back from the current keyframe
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms{cur_keyfrm_};
+    std::vector<std::shared_ptr<const imu::preintegrator>> preints;
+    while (keyfrms.size() < num_keyframes_for_gravity_initialization_) {
+        const auto prev_keyfrm = keyfrms.back()->get_imu_prev_keyframe();
+        const auto preint = keyfrms.back()->get_imu_preintegration();
+        if (!prev_keyfrm || !preint) {
+            break;
+        }
+        keyfrms.push_back(prev_keyfrm);
+        preints.push_back(preint);
+    }
+    if (keyfrms.size() < num_keyframes_for_gravity_initialization_) {
+        return;
+    }
+    std::reverse(keyfrms.begin(), keyfrms.end());
+    std::reverse(preints.begin(), preints.end());
+
+    eigen_alloc_vector<Mat44_t> cam_poses_cw;
+    cam_poses_cw.reserve(keyfrms.size());
+    for (const auto& keyfrm : keyfrms) {
+        cam_poses_cw.push_back(keyfrm->get_pose_cw());
+    }
+    // the bias is held at the one estimated by the tracking of the oldest keyframe
+    const auto b = keyfrms.front()->get_imu_state().bias_;
+    eigen_alloc_vector<Vec3_t> velocities_w;
+    if (!imu::estimate_gravity_and_velocities(*tracker_->imu_params_, cam_poses_cw, preints, b, max_gravity_error_,
+                                              gravity_w, velocities_w)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(data::map_database::mtx_database_);
+        for (unsigned int i = 0; i < keyfrms.size(); ++i) {
+            auto imu_state = keyfrms.at(i)->get_imu_state();
+            imu_state.velocity_ = velocities_w.at(i);
+            keyfrms.at(i)->set_imu_state(imu_state);
+        }
+        map_db_->set_gravity(gravity_w);
+    }
+    spdlog::info("initialize the gravity with {} keyframes: ({}, {}, {})",
+                 keyfrms.size(), gravity_w(0), gravity_w(1), gravity_w(2));
+}
+
 void mapping_module::store_new_keyframe() {
     // compute BoW feature vector
     if (bow_vocab_ && !cur_keyfrm_->bow_is_available()) {
@@ -269,7 +359,7 @@ void mapping_module::store_new_keyframe() {
     }
 
     // update graph
-    cur_keyfrm_->graph_node_->update_connections(map_db_->get_min_num_shared_lms());
+    cur_keyfrm_->graph_node_->update_connections(map_db_->get_min_num_shared_lms(), map_db_->get_max_num_covisibilities());
 
     // store the new keyframe to the map database
     map_db_->add_keyframe(cur_keyfrm_);
@@ -282,6 +372,13 @@ void mapping_module::create_new_landmarks(std::atomic<bool>& abort_create_new_la
     // in order to triangulate landmarks between `cur_keyfrm_` and each of the covisibilities
     const auto cur_covisibilities = cur_keyfrm_->graph_node_->get_top_n_covisibilities(num_covisibilities_for_landmark_generation_);
 
+    if (lm_spatial_hash_) {
+        // The landmarks of these keyframes may have been added or moved by the tracking and the last local BA
+        auto keyfrms_to_hash = cur_covisibilities;
+        keyfrms_to_hash.push_back(cur_keyfrm_);
+        update_landmark_spatial_hash(keyfrms_to_hash);
+    }
+
     match::bow_tree bow_tree_matcher(0.95, false);
     match::robust robust_matcher(0.95, false);
 
@@ -365,6 +462,28 @@ void mapping_module::triangulate_with_two_keyframes(const std::shared_ptr<data::
         }
         // succeeded
 
+        if (lm_spatial_hash_) {
+            bool is_merged = false;
+#ifdef USE_OPENMP
+#pragma omp critical
+#endif
+            {
+                auto duplicated_lm = find_duplicated_landmark(keyfrm_1, idx_1, keyfrm_2, idx_2, pos_w);
+                if (duplicated_lm) {
+                    // observe the existing landmark instead of creating the duplication
+                    duplicated_lm->connect_to_keyframe(keyfrm_1, idx_1);
+                    duplicated_lm->connect_to_keyframe(keyfrm_2, idx_2);
+                    duplicated_lm->compute_descriptor();
+                    duplicated_lm->update_mean_normal_and_obs_scale_variance();
+                    map_db_->record_changed_landmarks({duplicated_lm->id_});
+                    is_merged = true;
+                }
+            }
+            if (is_merged) {
+                continue;
+            }
+        }
+
         // create a landmark object
         auto lm = std::make_shared<data::landmark>(map_db_->next_landmark_id_++, pos_w, keyfrm_1);
 
@@ -381,11 +500,74 @@ void mapping_module::triangulate_with_two_keyframes(const std::shared_ptr<data::
 #endif
         {
             local_map_cleaner_->add_fresh_landmark(lm);
+            if (lm_spatial_hash_) {
+                lm_spatial_hash_->insert(lm);
+            }
+        }
+    }
+}
+
+void mapping_module::update_landmark_spatial_hash(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms) {
+    std::lock_guard<std::mutex> lock(data::map_database::mtx_database_);
+    if (lm_spatial_hash_is_invalidated_.exchange(false)) {
+        // the cells of the moved landmarks are stale
+        lm_spatial_hash_->clear();
+    }
+    if (lm_spatial_hash_->size() == 0) {
+        // e.g. after loading a map or the loop correction
+        for (const auto& lm : map_db_->get_all_landmarks()) {
+            if (!lm->will_be_erased()) {
+                lm_spatial_hash_->insert(lm);
+            }
+        }
+    }
+
+    for (const auto& keyfrm : keyfrms) {
+        for (const auto& lm : keyfrm->get_landmarks()) {
+            if (!lm || lm->will_be_erased()) {
+                continue;
+            }
+            lm_spatial_hash_->insert(lm);
         }
     }
 }
 
+std::shared_ptr<data::landmark> mapping_module::find_duplicated_landmark(const std::shared_ptr<data::keyframe>& keyfrm_1, const unsigned int idx_1,
+                                                                         const std::shared_ptr<data::keyframe>& keyfrm_2, const unsigned int idx_2,
+                                                                         const Vec3_t& pos_w) {
+    const double radius = lm_dedup_dist_ratio_ * (pos_w - keyfrm_1->get_trans_wc()).norm();
+    const auto nearby_lms = lm_spatial_hash_->get_landmarks_in_sphere(pos_w, radius);
+    if (nearby_lms.empty()) {
+        return nullptr;
+    }
+
+    const auto desc_1 = keyfrm_1->frm_obs_->descriptors_.row(idx_1);
+    const auto desc_2 = keyfrm_2->frm_obs_->descriptors_.row(idx_2);
+
+    std::shared_ptr<data::landmark> best_lm = nullptr;
+    unsigned int best_hamm_dist = match::HAMMING_DIST_THR_LOW + 1;
+    for (const auto& lm : nearby_lms) {
+        // The keypoints cannot be associated with the landmark which is already observed in the keyframes
+        if (lm->is_observed_in_keyframe(keyfrm_1) || lm->is_observed_in_keyframe(keyfrm_2)) {
+            continue;
+        }
+        if (!lm->has_representative_descriptor()) {
+            continue;
+        }
+
+        const auto lm_desc = lm->get_descriptor();
+        const auto hamm_dist = std::max(match::compute_descriptor_distance_32(lm_desc, desc_1),
+                                        match::compute_descriptor_distance_32(lm_desc, desc_2));
+        if (hamm_dist < best_hamm_dist) {
+            best_hamm_dist = hamm_dist;
+            best_lm = lm;
+        }
+    }
+    return best_lm;
+}
+
 void mapping_module::update_new_keyframe() {
+    STELLA_BENCHMARK_TIMER("mapping_module", "update_new_keyframe");
     std::lock_guard<std::mutex> lock(data::map_database::mtx_database_);
 
     // get the targets to check landmark fusion
@@ -405,6 +587,12 @@ void mapping_module::update_new_keyframe() {
         if (lm->will_be_erased()) {
             continue;
         }
+        // deactivating the redundant observations invalidates the geometries
+        if (lm->update_active_observations(map_db_->get_max_num_active_observations())) {
+            lm->compute_descriptor();
+            lm->update_mean_normal_and_obs_scale_variance();
+            continue;
+        }
         if (!lm->has_representative_descriptor()) {
             spdlog::warn("has not representative descriptor {}", lm->id_);
             lm->compute_descriptor();
@@ -416,7 +604,7 @@ void mapping_module::update_new_keyframe() {
     }
 
     // update the graph (Because fuse_landmark_duplication changes the landmark)
-    cur_keyfrm_->graph_node_->update_connections(map_db_->get_min_num_shared_lms());
+    cur_keyfrm_->graph_node_->update_connections(map_db_->get_min_num_shared_lms(), map_db_->get_max_num_covisibilities());
 }
 
 void mapping_module::fuse_landmark_duplication(const std::vector<std::shared_ptr<data::keyframe>>& fuse_tgt_keyfrms,
@@ -567,6 +755,9 @@ void mapping_module::reset() {
         }
     }
     local_map_cleaner_->reset();
+    if (lm_spatial_hash_) {
+        lm_spatial_hash_->clear();
+    }
     reset_is_requested_ = false;
     promise_reset_.set_value();
     promise_reset_ = std::promise<void>();
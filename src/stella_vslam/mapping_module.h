@@ -6,6 +6,8 @@
 #include "stella_vslam/module/local_map_cleaner.h"
 #include "stella_vslam/optimize/local_bundle_adjuster.h"
 #include "stella_vslam/data/bow_vocabulary_fwd.h"
+#include "stella_vslam/data/landmark_spatial_hash.h"
+#include "stella_vslam/util/runtime_params.h"
 
 #include <mutex>
 #include <atomic>
@@ -62,6 +64,9 @@ public:
     //! If the size of the queue exceeds this threshold, skip the localBA
     bool is_skipping_localBA() const;
 
+    //! Request to change the parameters (applied before processing the next keyframe)
+    void request_update_parameters(const YAML::Node& yaml_node);
+
     //-----------------------------------------
     // management for reset process
 
@@ -99,6 +104,13 @@ public:
     //! (NOTE: this function does not wait for abort)
     void abort_local_BA();
 
+    //-----------------------------------------
+    // management for the landmark spatial hash
+
+    //! Rebuild the spatial hash from the whole map before the next triangulation
+    //! (call this after the landmarks were moved outside the mapping module, e.g. by the loop correction)
+    void invalidate_landmark_spatial_hash();
+
 private:
     //-----------------------------------------
     // main process
@@ -116,9 +128,22 @@ private:
     void triangulate_with_two_keyframes(const std::shared_ptr<data::keyframe>& keyfrm_1, const std::shared_ptr<data::keyframe>& keyfrm_2,
                                         const std::vector<std::pair<unsigned int, unsigned int>>& matches);
 
+    //! Insert or re-hash the landmarks observed in the keyframes
+    //! (all the landmarks in the map are hashed if the spatial hash is empty)
+    void update_landmark_spatial_hash(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms);
+
+    //! Find the existing landmark which is close to pos_w and similar to both keypoints
+    std::shared_ptr<data::landmark> find_duplicated_landmark(const std::shared_ptr<data::keyframe>& keyfrm_1, const unsigned int idx_1,
+                                                             const std::shared_ptr<data::keyframe>& keyfrm_2, const unsigned int idx_2,
+                                                             const Vec3_t& pos_w);
+
     //! Update the new keyframe
     void update_new_keyframe();
 
+    //! Estimate the gravity and the velocities of the recent keyframes connected by the IMU preintegrations
+    //! (only if the map has the metric scale)
+    void initialize_gravity();
+
     //! Fuse duplicated landmarks between current keyframe and covisibility keyframes
     void fuse_landmark_duplication(const std::vector<std::shared_ptr<data::keyframe>>& fuse_tgt_keyfrms,
                                    nondeterministic::unordered_map<std::shared_ptr<data::landmark>, std::shared_ptr<data::landmark>>& replaced_lms);
@@ -231,6 +256,18 @@ private:
     //! bridge flag to abort local BA
     bool abort_local_BA_ = false;
 
+    //! requested changes of the parameters
+    util::runtime_params_queue params_queue_;
+
+    //! Apply the change of the parameters
+    void update_parameters(const YAML::Node& yaml_node);
+
+    //! spatial hash of the landmarks to avoid triangulating the existing structure (nullptr if disabled)
+    std::unique_ptr<data::landmark_spatial_hash> lm_spatial_hash_ = nullptr;
+
+    //! if true, the spatial hash is rebuilt from the whole map before the next use
+    std::atomic<bool> lm_spatial_hash_is_invalidated_{false};
+
     //-----------------------------------------
     // others
 
@@ -273,6 +310,15 @@ private:
     // The default inlier threshold value is 0.2 degree
     // (e.g. for the camera with width of 900-pixel and 90-degree FOV, 0.2 degree is equivalent to 2 pixel in the horizontal direction)
     float residual_rad_thr_ = 0.2 * M_PI / 180.0;
+
+    //! A triangulated point is merged into the existing landmark within the distance from the camera times this ratio
+    const double lm_dedup_dist_ratio_ = 0.01;
+
+    //! Number of consecutive keyframes used for the gravity initialization
+    const unsigned int num_keyframes_for_gravity_initialization_ = 10;
+
+    //! Maximum relative error of the estimated gravity norm to the standard gravity
+    const double max_gravity_error_ = 0.1;
 };
 
 } // namespace stella_vslam
@@ -9,13 +9,13 @@ unsigned int area::match_in_consistent_area(data::frame& frm_1, data::frame& frm
                                             std::vector<int>& matched_indices_2_in_frm_1, int margin) {
     unsigned int num_matches = 0;
 
-    matched_indices_2_in_frm_1 = std::vector<int>(frm_1.frm_obs_.undist_keypts_.size(), -1);
+    matched_indices_2_in_frm_1 = std::vector<int>(frm_1.frm_obs_->undist_keypts_.size(), -1);
 
-    std::vector<unsigned int> matched_dists_in_frm_2(frm_2.frm_obs_.undist_keypts_.size(), MAX_HAMMING_DIST);
-    std::vector<int> matched_indices_1_in_frm_2(frm_2.frm_obs_.undist_keypts_.size(), -1);
+    std::vector<unsigned int> matched_dists_in_frm_2(frm_2.frm_obs_->undist_keypts_.size(), MAX_HAMMING_DIST);
+    std::vector<int> matched_indices_1_in_frm_2(frm_2.frm_obs_->undist_keypts_.size(), -1);
 
-    for (unsigned int idx_1 = 0; idx_1 < frm_1.frm_obs_.undist_keypts_.size(); ++idx_1) {
-        const auto& undist_keypt_1 = frm_1.frm_obs_.undist_keypts_.at(idx_1);
+    for (unsigned int idx_1 = 0; idx_1 < frm_1.frm_obs_->undist_keypts_.size(); ++idx_1) {
+        const auto& undist_keypt_1 = frm_1.frm_obs_->undist_keypts_.at(idx_1);
         const auto scale_level_1 = undist_keypt_1.octave;
 
         // Use only keypoints with the 0-th scale
@@ -30,18 +30,18 @@ unsigned int area::match_in_consistent_area(data::frame& frm_1, data::frame& frm
             continue;
         }
 
-        const auto& desc_1 = frm_1.frm_obs_.descriptors_.row(idx_1);
+        const auto& desc_1 = frm_1.frm_obs_->descriptors_.row(idx_1);
 
         unsigned int best_hamm_dist = MAX_HAMMING_DIST;
         unsigned int second_best_hamm_dist = MAX_HAMMING_DIST;
         int best_idx_2 = -1;
 
         for (const auto idx_2 : indices) {
-            if (check_orientation_ && std::abs(util::angle::diff(frm_1.frm_obs_.undist_keypts_.at(idx_1).angle, frm_2.frm_obs_.undist_keypts_.at(idx_2).angle)) > 30.0) {
+            if (check_orientation_ && std::abs(util::angle::diff(frm_1.frm_obs_->undist_keypts_.at(idx_1).angle, frm_2.frm_obs_->undist_keypts_.at(idx_2).angle)) > 30.0) {
                 continue;
             }
 
-            const auto& desc_2 = frm_2.frm_obs_.descriptors_.row(idx_2);
+            const auto& desc_2 = frm_2.frm_obs_->descriptors_.row(idx_2);
 
             const auto hamm_dist = compute_descriptor_distance_32(desc_1, desc_2);
 
@@ -90,7 +90,7 @@ unsigned int area::match_in_consistent_area(data::frame& frm_1, data::frame& frm
     // Update the previous matches
     for (unsigned int idx_1 = 0; idx_1 < matched_indices_2_in_frm_1.size(); ++idx_1) {
         if (0 <= matched_indices_2_in_frm_1.at(idx_1)) {
-            prev_matched_pts.at(idx_1) = frm_2.frm_obs_.undist_keypts_.at(matched_indices_2_in_frm_1.at(idx_1)).pt;
+            prev_matched_pts.at(idx_1) = frm_2.frm_obs_->undist_keypts_.at(matched_indices_2_in_frm_1.at(idx_1)).pt;
         }
     }
 
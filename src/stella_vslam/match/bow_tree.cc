@@ -33,9 +33,9 @@ unsigned int bow_tree::match_for_triangulation(const std::shared_ptr<data::keyfr
     // Save the matching information
     // Discard the already matched keypoints in keyframe 2
     // to acquire a unique association to each keypoint in keyframe 1
-    std::vector<bool> is_already_matched_in_keyfrm_2(keyfrm_2->frm_obs_.undist_keypts_.size(), false);
+    std::vector<bool> is_already_matched_in_keyfrm_2(keyfrm_2->frm_obs_->undist_keypts_.size(), false);
     // Save the keypoint idx in keyframe 2 which is already associated to the keypoint idx in keyframe 1
-    std::vector<int> matched_indices_2_in_keyfrm_1(keyfrm_1->frm_obs_.undist_keypts_.size(), -1);
+    std::vector<int> matched_indices_2_in_keyfrm_1(keyfrm_1->frm_obs_->undist_keypts_.size(), -1);
 
     data::bow_feature_vector::const_iterator itr_1 = keyfrm_1->bow_feat_vec_.begin();
     data::bow_feature_vector::const_iterator itr_2 = keyfrm_2->bow_feat_vec_.begin();
@@ -58,12 +58,12 @@ unsigned int bow_tree::match_for_triangulation(const std::shared_ptr<data::keyfr
                 }
 
                 // Check if it's a stereo keypoint or not
-                const bool is_stereo_keypt_1 = !keyfrm_1->frm_obs_.stereo_x_right_.empty() && 0 <= keyfrm_1->frm_obs_.stereo_x_right_.at(idx_1);
+                const bool is_stereo_keypt_1 = !keyfrm_1->frm_obs_->stereo_x_right_.empty() && 0 <= keyfrm_1->frm_obs_->stereo_x_right_.at(idx_1);
 
                 // Acquire the keypoints and ORB feature vectors
-                const auto& keypt_1 = keyfrm_1->frm_obs_.undist_keypts_.at(idx_1);
-                const Vec3_t& bearing_1 = keyfrm_1->frm_obs_.bearings_.at(idx_1);
-                const auto& desc_1 = keyfrm_1->frm_obs_.descriptors_.row(idx_1);
+                const auto& keypt_1 = keyfrm_1->frm_obs_->undist_keypts_.at(idx_1);
+                const Vec3_t& bearing_1 = keyfrm_1->frm_obs_->bearings_.at(idx_1);
+                const auto& desc_1 = keyfrm_1->frm_obs_->descriptors_.row(idx_1);
 
                 // Find a keypoint in keyframe 2 that has the minimum hamming distance
                 unsigned int best_hamm_dist = HAMMING_DIST_THR_LOW;
@@ -83,16 +83,16 @@ unsigned int bow_tree::match_for_triangulation(const std::shared_ptr<data::keyfr
                         continue;
                     }
 
-                    if (check_orientation_ && std::abs(util::angle::diff(keypt_1.angle, keyfrm_2->frm_obs_.undist_keypts_.at(idx_2).angle)) > 30.0) {
+                    if (check_orientation_ && std::abs(util::angle::diff(keypt_1.angle, keyfrm_2->frm_obs_->undist_keypts_.at(idx_2).angle)) > 30.0) {
                         continue;
                     }
 
                     // Check if it's a stereo keypoint or not
-                    const bool is_stereo_keypt_2 = !keyfrm_2->frm_obs_.stereo_x_right_.empty() && 0 <= keyfrm_2->frm_obs_.stereo_x_right_.at(idx_2);
+                    const bool is_stereo_keypt_2 = !keyfrm_2->frm_obs_->stereo_x_right_.empty() && 0 <= keyfrm_2->frm_obs_->stereo_x_right_.at(idx_2);
 
                     // Acquire the keypoints and ORB feature vectors
-                    const Vec3_t& bearing_2 = keyfrm_2->frm_obs_.bearings_.at(idx_2);
-                    const auto& desc_2 = keyfrm_2->frm_obs_.descriptors_.row(idx_2);
+                    const Vec3_t& bearing_2 = keyfrm_2->frm_obs_->bearings_.at(idx_2);
+                    const auto& desc_2 = keyfrm_2->frm_obs_->descriptors_.row(idx_2);
 
                     // Compute the distance
                     const auto hamm_dist = compute_descriptor_distance_32(desc_1, desc_2);
@@ -174,7 +174,7 @@ unsigned int bow_tree::match_frame_and_keyframe(const std::shared_ptr<data::keyf
     
     unsigned int num_matches = 0;
 
-    matched_lms_in_frm = std::vector<std::shared_ptr<data::landmark>>(frm.frm_obs_.undist_keypts_.size(), nullptr);
+    matched_lms_in_frm = std::vector<std::shared_ptr<data::landmark>>(frm.frm_obs_->undist_keypts_.size(), nullptr);
 
     const auto keyfrm_lms = keyfrm->get_landmarks();
 
@@ -201,7 +201,7 @@ unsigned int bow_tree::match_frame_and_keyframe(const std::shared_ptr<data::keyf
                     continue;
                 }
 
-                const auto& keyfrm_desc = keyfrm->frm_obs_.descriptors_.row(keyfrm_idx);
+                const auto& keyfrm_desc = keyfrm->frm_obs_->descriptors_.row(keyfrm_idx);
 
                 unsigned int best_hamm_dist = MAX_HAMMING_DIST;
                 int best_frm_idx = -1;
@@ -212,11 +212,11 @@ unsigned int bow_tree::match_frame_and_keyframe(const std::shared_ptr<data::keyf
                         continue;
                     }
 
-                    if (check_orientation_ && std::abs(util::angle::diff(keyfrm->frm_obs_.undist_keypts_.at(keyfrm_idx).angle, frm.frm_obs_.undist_keypts_.at(frm_idx).angle)) > 30.0) {
+                    if (check_orientation_ && std::abs(util::angle::diff(keyfrm->frm_obs_->undist_keypts_.at(keyfrm_idx).angle, frm.frm_obs_->undist_keypts_.at(frm_idx).angle)) > 30.0) {
                         continue;
                     }
 
-                    const auto& frm_desc = frm.frm_obs_.descriptors_.row(frm_idx);
+                    const auto& frm_desc = frm.frm_obs_->descriptors_.row(frm_idx);
 
                     const auto hamm_dist = compute_descriptor_distance_32(keyfrm_desc, frm_desc);
 
@@ -296,7 +296,7 @@ unsigned int bow_tree::match_keyframes(const std::shared_ptr<data::keyframe>& ke
                     continue;
                 }
 
-                const auto& desc_1 = keyfrm_1->frm_obs_.descriptors_.row(idx_1);
+                const auto& desc_1 = keyfrm_1->frm_obs_->descriptors_.row(idx_1);
 
                 unsigned int best_hamm_dist = MAX_HAMMING_DIST;
                 int best_idx_2 = -1;
@@ -317,11 +317,11 @@ unsigned int bow_tree::match_keyframes(const std::shared_ptr<data::keyframe>& ke
                         continue;
                     }
 
-                    if (check_orientation_ && std::abs(util::angle::diff(keyfrm_1->frm_obs_.undist_keypts_.at(idx_1).angle, keyfrm_2->frm_obs_.undist_keypts_.at(idx_2).angle)) > 30.0) {
+                    if (check_orientation_ && std::abs(util::angle::diff(keyfrm_1->frm_obs_->undist_keypts_.at(idx_1).angle, keyfrm_2->frm_obs_->undist_keypts_.at(idx_2).angle)) > 30.0) {
                         continue;
                     }
 
-                    const auto& desc_2 = keyfrm_2->frm_obs_.descriptors_.row(idx_2);
+                    const auto& desc_2 = keyfrm_2->frm_obs_->descriptors_.row(idx_2);
 
                     const auto hamm_dist = compute_descriptor_distance_32(desc_1, desc_2);
 
@@ -87,15 +87,15 @@ unsigned int fuse::detect_duplication(const std::shared_ptr<data::keyframe>& key
             if (already_matched_idx_in_keyfrm.count(idx)) {
                 continue;
             }
-            const auto& undist_keypt = keyfrm->frm_obs_.undist_keypts_.at(idx);
+            const auto& undist_keypt = keyfrm->frm_obs_->undist_keypts_.at(idx);
 
             if (do_reprojection_matching) {
                 const auto scale_level = static_cast<unsigned int>(undist_keypt.octave);
-                if (!keyfrm->frm_obs_.stereo_x_right_.empty() && keyfrm->frm_obs_.stereo_x_right_.at(idx) >= 0) {
+                if (!keyfrm->frm_obs_->stereo_x_right_.empty() && keyfrm->frm_obs_->stereo_x_right_.at(idx) >= 0) {
                     // Compute reprojection error with 3 degrees of freedom if a stereo match exists
                     const auto e_x = reproj(0) - undist_keypt.pt.x;
                     const auto e_y = reproj(1) - undist_keypt.pt.y;
-                    const auto e_x_right = x_right - keyfrm->frm_obs_.stereo_x_right_.at(idx);
+                    const auto e_x_right = x_right - keyfrm->frm_obs_->stereo_x_right_.at(idx);
                     const auto reproj_error_sq = e_x * e_x + e_y * e_y + e_x_right * e_x_right;
 
                     // n=3
@@ -118,7 +118,7 @@ unsigned int fuse::detect_duplication(const std::shared_ptr<data::keyframe>& key
                 }
             }
 
-            const auto& desc = keyfrm->frm_obs_.descriptors_.row(idx);
+            const auto& desc = keyfrm->frm_obs_->descriptors_.row(idx);
 
             const auto hamm_dist = compute_descriptor_distance_32(lm_desc, desc);
 
@@ -56,14 +56,14 @@ unsigned int projection::match_frame_and_landmarks(data::frame& frm,
                 continue;
             }
 
-            if (!frm.frm_obs_.stereo_x_right_.empty() && 0 < frm.frm_obs_.stereo_x_right_.at(idx)) {
-                const auto reproj_error = std::abs(lm_to_x_right.at(local_lm->id_) - frm.frm_obs_.stereo_x_right_.at(idx));
+            if (!frm.frm_obs_->stereo_x_right_.empty() && 0 < frm.frm_obs_->stereo_x_right_.at(idx)) {
+                const auto reproj_error = std::abs(lm_to_x_right.at(local_lm->id_) - frm.frm_obs_->stereo_x_right_.at(idx));
                 if (margin * frm.orb_params_->scale_factors_.at(pred_scale_level) < reproj_error) {
                     continue;
                 }
             }
 
-            const cv::Mat& desc = frm.frm_obs_.descriptors_.row(idx);
+            const cv::Mat& desc = frm.frm_obs_->descriptors_.row(idx);
 
             const auto dist = compute_descriptor_distance_32(lm_desc, desc);
 
@@ -71,11 +71,11 @@ unsigned int projection::match_frame_and_landmarks(data::frame& frm,
                 second_best_hamm_dist = best_hamm_dist;
                 best_hamm_dist = dist;
                 second_best_scale_level = best_scale_level;
-                best_scale_level = frm.frm_obs_.undist_keypts_.at(idx).octave;
+                best_scale_level = frm.frm_obs_->undist_keypts_.at(idx).octave;
                 best_idx = idx;
             }
             else if (dist < second_best_hamm_dist) {
-                second_best_scale_level = frm.frm_obs_.undist_keypts_.at(idx).octave;
+                second_best_scale_level = frm.frm_obs_->undist_keypts_.at(idx).octave;
                 second_best_hamm_dist = dist;
             }
         }
@@ -120,7 +120,7 @@ unsigned int projection::match_current_and_last_frames(data::frame& curr_frm, co
 
     // Reproject the 3D points associated to the keypoints of the last frame,
     // then acquire the 2D-3D matches
-    for (unsigned int idx_last = 0; idx_last < last_frm.frm_obs_.undist_keypts_.size(); ++idx_last) {
+    for (unsigned int idx_last = 0; idx_last < last_frm.frm_obs_->undist_keypts_.size(); ++idx_last) {
         const auto& lm = last_frm.get_landmark(idx_last);
         if (!lm) {
             continue;
@@ -143,7 +143,7 @@ unsigned int projection::match_current_and_last_frames(data::frame& curr_frm, co
         }
 
         // Acquire keypoints in the cell where the reprojected 3D points exist
-        const unsigned int last_scale_level = last_frm.frm_obs_.undist_keypts_.at(idx_last).octave;
+        const unsigned int last_scale_level = last_frm.frm_obs_->undist_keypts_.at(idx_last).octave;
         int min_level;
         int max_level;
         if (assume_forward) {
@@ -176,18 +176,18 @@ unsigned int projection::match_current_and_last_frames(data::frame& curr_frm, co
                 continue;
             }
 
-            if (!curr_frm.frm_obs_.stereo_x_right_.empty() && curr_frm.frm_obs_.stereo_x_right_.at(curr_idx) > 0) {
-                const float reproj_error = std::fabs(x_right - curr_frm.frm_obs_.stereo_x_right_.at(curr_idx));
+            if (!curr_frm.frm_obs_->stereo_x_right_.empty() && curr_frm.frm_obs_->stereo_x_right_.at(curr_idx) > 0) {
+                const float reproj_error = std::fabs(x_right - curr_frm.frm_obs_->stereo_x_right_.at(curr_idx));
                 if (margin * curr_frm.orb_params_->scale_factors_.at(last_scale_level) < reproj_error) {
                     continue;
                 }
             }
 
-            if (check_orientation_ && std::abs(util::angle::diff(last_frm.frm_obs_.undist_keypts_.at(idx_last).angle, curr_frm.frm_obs_.undist_keypts_.at(curr_idx).angle)) > 30.0) {
+            if (check_orientation_ && std::abs(util::angle::diff(last_frm.frm_obs_->undist_keypts_.at(idx_last).angle, curr_frm.frm_obs_->undist_keypts_.at(curr_idx).angle)) > 30.0) {
                 continue;
             }
 
-            const auto& desc = curr_frm.frm_obs_.descriptors_.row(curr_idx);
+            const auto& desc = curr_frm.frm_obs_->descriptors_.row(curr_idx);
 
             const auto hamm_dist = compute_descriptor_distance_32(lm_desc, desc);
 
@@ -212,7 +212,7 @@ unsigned int projection::match_current_and_last_frames(data::frame& curr_frm, co
 unsigned int projection::match_frame_and_keyframe(data::frame& curr_frm, const std::shared_ptr<data::keyframe>& keyfrm, const std::set<std::shared_ptr<data::landmark>>& already_matched_lms,
                                                   const float margin, const unsigned int hamm_dist_thr) const {
     auto lms = curr_frm.get_landmarks();
-    auto num_matches = match_frame_and_keyframe(curr_frm.get_pose_cw(), curr_frm.camera_, curr_frm.frm_obs_, curr_frm.orb_params_, lms, keyfrm, already_matched_lms, margin, hamm_dist_thr);
+    auto num_matches = match_frame_and_keyframe(curr_frm.get_pose_cw(), curr_frm.camera_, *curr_frm.frm_obs_, curr_frm.orb_params_, lms, keyfrm, already_matched_lms, margin, hamm_dist_thr);
     curr_frm.set_landmarks(lms);
     return num_matches;
 }
@@ -295,7 +295,7 @@ unsigned int projection::match_frame_and_keyframe(const Mat44_t& cam_pose_cw,
                 continue;
             }
 
-            if (check_orientation_ && std::abs(util::angle::diff(keyfrm->frm_obs_.undist_keypts_.at(idx).angle, frm_obs.undist_keypts_.at(curr_idx).angle)) > 30.0) {
+            if (check_orientation_ && std::abs(util::angle::diff(keyfrm->frm_obs_->undist_keypts_.at(idx).angle, frm_obs.undist_keypts_.at(curr_idx).angle)) > 30.0) {
                 continue;
             }
 
@@ -397,7 +397,7 @@ unsigned int projection::match_by_Sim3_transform(const std::shared_ptr<data::key
                 continue;
             }
 
-            const auto& desc = keyfrm->frm_obs_.descriptors_.row(idx);
+            const auto& desc = keyfrm->frm_obs_->descriptors_.row(idx);
 
             const auto hamm_dist = compute_descriptor_distance_32(lm_desc, desc);
 
@@ -518,7 +518,7 @@ unsigned int projection::match_keyframes_mutually(const std::shared_ptr<data::ke
             int best_idx_2 = -1;
 
             for (const auto idx_2 : indices) {
-                const auto& desc = keyfrm_2->frm_obs_.descriptors_.row(idx_2);
+                const auto& desc = keyfrm_2->frm_obs_->descriptors_.row(idx_2);
 
                 const auto hamm_dist = compute_descriptor_distance_32(lm_desc, desc);
 
@@ -597,7 +597,7 @@ unsigned int projection::match_keyframes_mutually(const std::shared_ptr<data::ke
             int best_idx_1 = -1;
 
             for (const auto idx_1 : indices) {
-                const auto& desc = keyfrm_1->frm_obs_.descriptors_.row(idx_1);
+                const auto& desc = keyfrm_1->frm_obs_->descriptors_.row(idx_1);
 
                 const auto hamm_dist = compute_descriptor_distance_32(lm_desc, desc);
 
@@ -29,8 +29,8 @@ unsigned int robust::match_for_triangulation(const std::shared_ptr<data::keyfram
     // Acquire the 3D point information of the keframes
     const auto assoc_lms_in_keyfrm_1 = keyfrm_1->get_landmarks();
     const auto assoc_lms_in_keyfrm_2 = keyfrm_2->get_landmarks();
-    const auto num_keypts_1 = keyfrm_1->frm_obs_.undist_keypts_.size();
-    const auto num_keypts_2 = keyfrm_2->frm_obs_.undist_keypts_.size();
+    const auto num_keypts_1 = keyfrm_1->frm_obs_->undist_keypts_.size();
+    const auto num_keypts_2 = keyfrm_2->frm_obs_->undist_keypts_.size();
 
     // Save the matching information
     // Discard the already matched keypoints in keyframe 2
@@ -47,12 +47,12 @@ unsigned int robust::match_for_triangulation(const std::shared_ptr<data::keyfram
         }
 
         // Check if it's a stereo keypoint or not
-        const bool is_stereo_keypt_1 = !keyfrm_1->frm_obs_.stereo_x_right_.empty() && 0 <= keyfrm_1->frm_obs_.stereo_x_right_.at(idx_1);
+        const bool is_stereo_keypt_1 = !keyfrm_1->frm_obs_->stereo_x_right_.empty() && 0 <= keyfrm_1->frm_obs_->stereo_x_right_.at(idx_1);
 
         // Acquire the keypoints and ORB feature vectors
-        const auto& keypt_1 = keyfrm_1->frm_obs_.undist_keypts_.at(idx_1);
-        const Vec3_t& bearing_1 = keyfrm_1->frm_obs_.bearings_.at(idx_1);
-        const auto& desc_1 = keyfrm_1->frm_obs_.descriptors_.row(idx_1);
+        const auto& keypt_1 = keyfrm_1->frm_obs_->undist_keypts_.at(idx_1);
+        const Vec3_t& bearing_1 = keyfrm_1->frm_obs_->bearings_.at(idx_1);
+        const auto& desc_1 = keyfrm_1->frm_obs_->descriptors_.row(idx_1);
 
         // Find a keypoint in keyframe 2 that has the minimum hamming distance
         unsigned int best_hamm_dist = HAMMING_DIST_THR_LOW;
@@ -72,16 +72,16 @@ unsigned int robust::match_for_triangulation(const std::shared_ptr<data::keyfram
                 continue;
             }
 
-            if (check_orientation_ && std::abs(util::angle::diff(keypt_1.angle, keyfrm_2->frm_obs_.undist_keypts_.at(idx_2).angle)) > 30.0) {
+            if (check_orientation_ && std::abs(util::angle::diff(keypt_1.angle, keyfrm_2->frm_obs_->undist_keypts_.at(idx_2).angle)) > 30.0) {
                 continue;
             }
 
             // Check if it's a stereo keypoint or not
-            const bool is_stereo_keypt_2 = !keyfrm_2->frm_obs_.stereo_x_right_.empty() && 0 <= keyfrm_2->frm_obs_.stereo_x_right_.at(idx_2);
+            const bool is_stereo_keypt_2 = !keyfrm_2->frm_obs_->stereo_x_right_.empty() && 0 <= keyfrm_2->frm_obs_->stereo_x_right_.at(idx_2);
 
             // Acquire the keypoints and ORB feature vectors
-            const Vec3_t& bearing_2 = keyfrm_2->frm_obs_.bearings_.at(idx_2);
-            const auto& desc_2 = keyfrm_2->frm_obs_.descriptors_.row(idx_2);
+            const Vec3_t& bearing_2 = keyfrm_2->frm_obs_->bearings_.at(idx_2);
+            const auto& desc_2 = keyfrm_2->frm_obs_->descriptors_.row(idx_2);
 
             // Compute the distance
             const auto hamm_dist = compute_descriptor_distance_32(desc_1, desc_2);
@@ -149,18 +149,18 @@ unsigned int robust::match_keyframes(const std::shared_ptr<data::keyframe>& keyf
                                      std::vector<std::shared_ptr<data::landmark>>& matched_lms_in_frm,
                                      bool validate_with_essential_solver, bool use_fixed_seed) const {
     // Initialization
-    const auto num_frm_keypts = keyfrm1->frm_obs_.undist_keypts_.size();
+    const auto num_frm_keypts = keyfrm1->frm_obs_->undist_keypts_.size();
     const auto keyfrm_lms = keyfrm2->get_landmarks();
     unsigned int num_inlier_matches = 0;
     matched_lms_in_frm = std::vector<std::shared_ptr<data::landmark>>(num_frm_keypts, nullptr);
 
     // Compute brute-force match
     std::vector<std::pair<int, int>> matches;
-    brute_force_match(keyfrm1->frm_obs_, keyfrm2, matches);
+    brute_force_match(*keyfrm1->frm_obs_, keyfrm2, matches);
 
     // Extract only inliers with eight-point RANSAC
     if (validate_with_essential_solver) {
-        solve::essential_solver solver(keyfrm1->frm_obs_.bearings_, keyfrm2->frm_obs_.bearings_, matches, use_fixed_seed);
+        solve::essential_solver solver(keyfrm1->frm_obs_->bearings_, keyfrm2->frm_obs_->bearings_, matches, use_fixed_seed);
         solver.find_via_ransac(50, false);
         if (!solver.solution_is_valid()) {
             return 0;
@@ -197,17 +197,17 @@ unsigned int robust::match_frame_and_keyframe(data::frame& frm, const std::share
                                               std::vector<std::shared_ptr<data::landmark>>& matched_lms_in_frm,
                                               bool use_fixed_seed) const {
     // Initialization
-    const auto num_frm_keypts = frm.frm_obs_.undist_keypts_.size();
+    const auto num_frm_keypts = frm.frm_obs_->undist_keypts_.size();
     const auto keyfrm_lms = keyfrm->get_landmarks();
     unsigned int num_inlier_matches = 0;
     matched_lms_in_frm = std::vector<std::shared_ptr<data::landmark>>(num_frm_keypts, nullptr);
 
     // Compute brute-force match
     std::vector<std::pair<int, int>> matches;
-    brute_force_match(frm.frm_obs_, keyfrm, matches);
+    brute_force_match(*frm.frm_obs_, keyfrm, matches);
 
     // Extract only inliers with RANSAC
-    solve::essential_solver solver(frm.frm_obs_.bearings_, keyfrm->frm_obs_.bearings_, matches, use_fixed_seed);
+    solve::essential_solver solver(frm.frm_obs_->bearings_, keyfrm->frm_obs_->bearings_, matches, use_fixed_seed);
     solver.find_via_ransac(1000, true);
     if (!solver.solution_is_valid()) {
         return 0;
@@ -237,12 +237,12 @@ unsigned int robust::brute_force_match(const data::frame_observation& frm_obs,
     // 1. Acquire the frame and keyframe information
 
     const auto num_keypts_1 = frm_obs.undist_keypts_.size();
-    const auto num_keypts_2 = keyfrm->frm_obs_.undist_keypts_.size();
+    const auto num_keypts_2 = keyfrm->frm_obs_->undist_keypts_.size();
     const auto keypts_1 = frm_obs.undist_keypts_;
-    const auto keypts_2 = keyfrm->frm_obs_.undist_keypts_;
+    const auto keypts_2 = keyfrm->frm_obs_->undist_keypts_;
     const auto lms_2 = keyfrm->get_landmarks();
     const auto& descs_1 = frm_obs.descriptors_;
-    const auto& descs_2 = keyfrm->frm_obs_.descriptors_;
+    const auto& descs_2 = keyfrm->frm_obs_->descriptors_;
 
     // 2. Acquire ORB descriptors in the keyframe which are the first and second closest to the descriptors in the frame
     //    it is assumed that keypoint in the keyframe are associated to 3D points
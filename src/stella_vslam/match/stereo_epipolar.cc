@@ -0,0 +1,144 @@
+#include "stella_vslam/match/stereo_epipolar.h"
+#include "stella_vslam/benchmark/timer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace stella_vslam {
+namespace match {
+
+stereo_epipolar::stereo_epipolar(const std::vector<cv::KeyPoint>& undist_keypts_left, const eigen_alloc_vector<Vec3_t>& bearings_left,
+                                 const std::vector<cv::KeyPoint>& keypts_right, const eigen_alloc_vector<Vec3_t>& bearings_right,
+                                 const cv::Mat& descs_left, const cv::Mat& descs_right,
+                                 const std::vector<float>& scale_factors,
+                                 const Mat33_t& rot_rl, const Vec3_t& trans_rl,
+                                 const float focal_x_baseline, const float min_depth,
+                                 const float epipolar_margin_rad)
+    : undist_keypts_left_(undist_keypts_left), bearings_left_(bearings_left),
+      keypts_right_(keypts_right), bearings_right_(bearings_right),
+      descs_left_(descs_left), descs_right_(descs_right),
+      scale_factors_(scale_factors),
+      rot_lr_(rot_rl.transpose()), center_r_in_l_(-rot_rl.transpose() * trans_rl),
+      focal_x_baseline_(focal_x_baseline), min_depth_(min_depth),
+      epipolar_margin_rad_(std::max(epipolar_margin_rad, 1e-4f)),
+      num_bins_(static_cast<unsigned int>(std::ceil(2.0 * M_PI / epipolar_margin_rad_))) {
+    // Take the axes orthogonal to the baseline
+    const Vec3_t baseline_dir = center_r_in_l_.normalized();
+    const Vec3_t ref = (std::abs(baseline_dir(1)) < 0.9) ? Vec3_t::UnitY() : Vec3_t::UnitZ();
+    axis_x_ = ref.cross(baseline_dir).normalized();
+    axis_y_ = baseline_dir.cross(axis_x_);
+}
+
+void stereo_epipolar::compute(std::vector<float>& stereo_x_right, std::vector<float>& depths) const {
+    STELLA_BENCHMARK_TIMER("match::stereo_epipolar", "compute");
+
+    const auto indices_right_in_bin = get_right_keypoint_indices_in_each_bin();
+
+    const unsigned int num_keypts = undist_keypts_left_.size();
+    stereo_x_right.resize(num_keypts, -1.0f);
+    depths.resize(num_keypts, -1.0f);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int64_t idx_left = 0; idx_left < num_keypts; ++idx_left) {
+        const auto& keypt_left = undist_keypts_left_.at(idx_left);
+        const auto scale_level_left = keypt_left.octave;
+        const Vec3_t& bearing_left = bearings_left_.at(idx_left);
+
+        // The right keypoints on the same epipolar curve are the candidates
+        const auto& candidate_indices_right = indices_right_in_bin.at(get_bin(compute_epipolar_angle(bearing_left)));
+        if (candidate_indices_right.empty()) {
+            continue;
+        }
+
+        const cv::Mat& desc_left = descs_left_.row(idx_left);
+
+        unsigned int best_hamm_dist = hamm_dist_thr_;
+        float best_depth = -1.0f;
+        for (const auto idx_right : candidate_indices_right) {
+            // Discard if the ORB scale becomes significantly different
+            const auto scale_level_right = keypts_right_.at(idx_right).octave;
+            if (scale_level_right < scale_level_left - 1 || scale_level_left + 1 < scale_level_right) {
+                continue;
+            }
+
+            const unsigned int hamm_dist = match::compute_descriptor_distance_32(desc_left, descs_right_.row(idx_right));
+            if (best_hamm_dist <= hamm_dist) {
+                continue;
+            }
+
+            // Discard if the rays do not intersect in the valid range (like the disparity range of the rectified images)
+            float depth;
+            if (!triangulate_depth(bearing_left, bearings_right_.at(idx_right), depth)) {
+                continue;
+            }
+
+            best_hamm_dist = hamm_dist;
+            best_depth = depth;
+        }
+
+        if (best_depth <= 0.0f) {
+            continue;
+        }
+
+        // Set the results
+        depths.at(idx_left) = best_depth;
+        stereo_x_right.at(idx_left) = keypt_left.pt.x - focal_x_baseline_ / best_depth;
+    }
+}
+
+float stereo_epipolar::compute_epipolar_angle(const Vec3_t& bearing_left) const {
+    return std::atan2(bearing_left.dot(axis_y_), bearing_left.dot(axis_x_));
+}
+
+bool stereo_epipolar::triangulate_depth(const Vec3_t& bearing_left, const Vec3_t& bearing_right, float& depth) const {
+    // Find the closest points of the two rays: lambda_l * b_l and c_r + lambda_r * b_r
+    const Vec3_t bearing_right_in_l = rot_lr_ * bearing_right;
+    const double cos_parallax = bearing_left.dot(bearing_right_in_l);
+    const double denom = 1.0 - cos_parallax * cos_parallax;
+    if (denom < 1e-10) {
+        return false;
+    }
+    const double proj_l = bearing_left.dot(center_r_in_l_);
+    const double proj_r = bearing_right_in_l.dot(center_r_in_l_);
+    const double lambda_l = (proj_l - cos_parallax * proj_r) / denom;
+    const double lambda_r = (cos_parallax * proj_l - proj_r) / denom;
+    if (lambda_l <= 0.0 || lambda_r <= 0.0) {
+        return false;
+    }
+
+    depth = lambda_l * bearing_left(2);
+    return min_depth_ <= depth;
+}
+
+std::vector<std::vector<unsigned int>> stereo_epipolar::get_right_keypoint_indices_in_each_bin() const {
+    std::vector<std::vector<unsigned int>> indices_right_in_bin(num_bins_);
+
+    for (unsigned int idx_right = 0; idx_right < keypts_right_.size(); ++idx_right) {
+        const Vec3_t bearing_right_in_l = rot_lr_ * bearings_right_.at(idx_right);
+        const float angle = compute_epipolar_angle(bearing_right_in_l);
+        // Compute uncertainty of the angle according to scale
+        const float r = epipolar_margin_rad_ * scale_factors_.at(keypts_right_.at(idx_right).octave);
+        const int min_k = static_cast<int>(std::floor((angle - r + M_PI) / epipolar_margin_rad_));
+        const int max_k = std::min(static_cast<int>(std::floor((angle + r + M_PI) / epipolar_margin_rad_)),
+                                   min_k + static_cast<int>(num_bins_) - 1);
+
+        // Save the index of the keypoint for all the bins between the max and the min angles
+        for (int k = min_k; k <= max_k; ++k) {
+            const int num_bins = static_cast<int>(num_bins_);
+            indices_right_in_bin.at(((k % num_bins) + num_bins) % num_bins).push_back(idx_right);
+        }
+    }
+
+    return indices_right_in_bin;
+}
+
+unsigned int stereo_epipolar::get_bin(const float angle) const {
+    const int num_bins = static_cast<int>(num_bins_);
+    const int k = static_cast<int>(std::floor((angle + M_PI) / epipolar_margin_rad_));
+    return ((k % num_bins) + num_bins) % num_bins;
+}
+
+} // namespace match
+} // namespace stella_vslam
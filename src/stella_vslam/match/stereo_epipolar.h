@@ -0,0 +1,120 @@
+#ifndef STELLA_VSLAM_MATCH_STEREO_EPIPOLAR_H
+#define STELLA_VSLAM_MATCH_STEREO_EPIPOLAR_H
+
+#include "stella_vslam/match/base.h"
+
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+
+namespace stella_vslam {
+namespace match {
+
+/**
+ * Stereo matching on unrectified images
+ * Every epipolar plane of a calibrated stereo pair contains the baseline,
+ * so the epipolar curves are indexed by the rotation angle of their planes around the baseline.
+ * The right keypoints are binned by this angle (instead of the image rows of the rectified images),
+ * and each left keypoint is matched with the right keypoints in the bin of its own angle.
+ * The depths are triangulated from the bearings, then converted to the virtual right x coordinates.
+ */
+class stereo_epipolar {
+public:
+    stereo_epipolar() = delete;
+
+    /**
+     * Constructor
+     * @param undist_keypts_left
+     * @param bearings_left
+     * @param keypts_right
+     * @param bearings_right
+     * @param descs_left
+     * @param descs_right
+     * @param scale_factors
+     * @param rot_rl rotation from the left camera to the right camera
+     * @param trans_rl translation from the left camera to the right camera
+     * @param focal_x_baseline
+     * @param min_depth
+     * @param epipolar_margin_rad margin of the epipolar angle on the finest scale level
+     */
+    stereo_epipolar(const std::vector<cv::KeyPoint>& undist_keypts_left, const eigen_alloc_vector<Vec3_t>& bearings_left,
+                    const std::vector<cv::KeyPoint>& keypts_right, const eigen_alloc_vector<Vec3_t>& bearings_right,
+                    const cv::Mat& descs_left, const cv::Mat& descs_right,
+                    const std::vector<float>& scale_factors,
+                    const Mat33_t& rot_rl, const Vec3_t& trans_rl,
+                    const float focal_x_baseline, const float min_depth,
+                    const float epipolar_margin_rad);
+
+    virtual ~stereo_epipolar() = default;
+
+    /**
+     * Compute stereo matching along the epipolar curves
+     */
+    void compute(std::vector<float>& stereo_x_right, std::vector<float>& depths) const;
+
+    /**
+     * Compute the rotation angle of the epipolar plane containing the bearing (in the left camera)
+     */
+    float compute_epipolar_angle(const Vec3_t& bearing_left) const;
+
+    /**
+     * Triangulate the depth of the left keypoint from the pair of bearings
+     * @param bearing_left
+     * @param bearing_right
+     * @param depth
+     * @return false if the rays do not intersect in front of both cameras
+     */
+    bool triangulate_depth(const Vec3_t& bearing_left, const Vec3_t& bearing_right, float& depth) const;
+
+private:
+    /**
+     * Get the right keypoints in each angular bin of the epipolar planes
+     * @return
+     */
+    std::vector<std::vector<unsigned int>> get_right_keypoint_indices_in_each_bin() const;
+
+    //! Get the bin of the angle
+    unsigned int get_bin(const float angle) const;
+
+    //! reference to undistorted keypoints in left image
+    const std::vector<cv::KeyPoint>& undist_keypts_left_;
+    //! reference to bearings of left keypoints
+    const eigen_alloc_vector<Vec3_t>& bearings_left_;
+    //! reference to keypoints in right image
+    const std::vector<cv::KeyPoint>& keypts_right_;
+    //! reference to bearings of right keypoints (in the right camera)
+    const eigen_alloc_vector<Vec3_t>& bearings_right_;
+
+    //! reference to left descriptor
+    const cv::Mat& descs_left_;
+    //! reference to right descriptor
+    const cv::Mat& descs_right_;
+
+    //! reference to scale factors
+    const std::vector<float>& scale_factors_;
+
+    //! rotation from the right camera to the left camera
+    const Mat33_t rot_lr_;
+    //! center of the right camera in the left camera
+    const Vec3_t center_r_in_l_;
+    //! axes orthogonal to the baseline (to measure the angles of the epipolar planes)
+    Vec3_t axis_x_, axis_y_;
+
+    //! focal_x x baseline
+    const float focal_x_baseline_;
+    //! minimum depth
+    const float min_depth_;
+    //! margin of the epipolar angle on the finest scale level
+    const float epipolar_margin_rad_;
+    //! number of the angular bins
+    const unsigned int num_bins_;
+
+    //! maximum hamming distance
+    static constexpr unsigned int hamm_dist_thr_ = (match::HAMMING_DIST_THR_HIGH + match::HAMMING_DIST_THR_LOW) / 2;
+};
+
+} // namespace match
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_MATCH_STEREO_EPIPOLAR_H
@@ -0,0 +1,228 @@
+#include "stella_vslam/match/stereo_patch_search.h"
+#include "stella_vslam/benchmark/timer.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <opencv2/core.hpp>
+
+namespace stella_vslam {
+namespace match {
+
+namespace {
+
+//! L1 distance between the patches whose intensities are subtracted by that of the center
+inline unsigned int compute_patch_distance(const cv::Mat& left_img, const int x_left, const int y,
+                                           const cv::Mat& right_img, const int x_right, const int half_size) {
+    const int center_left = left_img.at<unsigned char>(y, x_left);
+    const int center_right = right_img.at<unsigned char>(y, x_right);
+    unsigned int dist = 0;
+    for (int v = -half_size; v <= half_size; ++v) {
+        const unsigned char* row_left = left_img.ptr<unsigned char>(y + v) + x_left;
+        const unsigned char* row_right = right_img.ptr<unsigned char>(y + v) + x_right;
+        for (int u = -half_size; u <= half_size; ++u) {
+            dist += std::abs((row_left[u] - center_left) - (row_right[u] - center_right));
+        }
+    }
+    return dist;
+}
+
+} // namespace
+
+stereo_patch_search::stereo_patch_search(const std::vector<cv::Mat>& left_image_pyramid, const std::vector<cv::Mat>& right_image_pyramid,
+                                         const std::vector<cv::KeyPoint>& keypts_left,
+                                         const std::vector<float>& scale_factors, const std::vector<float>& inv_scale_factors,
+                                         const float focal_x_baseline, const float true_baseline,
+                                         const unsigned int coarse_level_offset)
+    : left_image_pyramid_(left_image_pyramid), right_image_pyramid_(right_image_pyramid),
+      num_keypts_(keypts_left.size()), keypts_left_(keypts_left),
+      scale_factors_(scale_factors), inv_scale_factors_(inv_scale_factors),
+      focal_x_baseline_(focal_x_baseline), true_baseline_(true_baseline),
+      min_disp_(0.0f), max_disp_(focal_x_baseline_ / true_baseline_),
+      coarse_level_offset_(coarse_level_offset) {}
+
+void stereo_patch_search::compute(std::vector<float>& stereo_x_right, std::vector<float>& depths) const {
+    STELLA_BENCHMARK_TIMER("match::stereo_patch_search", "compute");
+
+    stereo_x_right.resize(num_keypts_, -1.0f);
+    depths.resize(num_keypts_, -1.0f);
+    std::vector<std::pair<float, int>> correlation_and_idx_left;
+    correlation_and_idx_left.reserve(num_keypts_);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int64_t idx_left = 0; idx_left < num_keypts_; ++idx_left) {
+        const auto& keypt_left = keypts_left_.at(idx_left);
+        const float x_left = keypt_left.pt.x;
+
+        // Search the corresponding point along the row on the coarse level
+        float x_right = -1.0f;
+        if (!search_coarse_disparity(keypt_left, x_right)) {
+            continue;
+        }
+
+        // Compute the parallax of the subpixel order by patch correlation
+        float best_x_right = -1.0f;
+        float best_disp = -1.0f;
+        float best_correlation = std::numeric_limits<float>::max();
+        if (!compute_subpixel_disparity(keypt_left, x_right, best_x_right, best_disp, best_correlation)) {
+            continue;
+        }
+        // Discard if the parallax lies outside the valid range
+        if (best_disp < min_disp_ || max_disp_ <= best_disp) {
+            continue;
+        }
+
+        if (best_disp <= 0.0f) {
+            // Set a low value if the parallax is 0 (zero)
+            best_disp = 0.01f;
+            best_x_right = x_left - best_disp;
+        }
+
+        // Set the results
+        depths.at(idx_left) = focal_x_baseline_ / best_disp;
+        stereo_x_right.at(idx_left) = best_x_right;
+#ifdef USE_OPENMP
+#pragma omp critical
+#endif
+        {
+            correlation_and_idx_left.emplace_back(best_correlation, idx_left);
+        }
+    }
+
+    // Discard if the correlation is weaker than the double median value of the correlation (same as match::stereo)
+    std::sort(correlation_and_idx_left.begin(), correlation_and_idx_left.end());
+    const auto median_i = correlation_and_idx_left.size() / 2;
+    const float median_correlation = correlation_and_idx_left.empty()
+                                         ? 0.0f
+                                         : correlation_and_idx_left.at(median_i).first;
+    const float correlation_thr = 2.0 * median_correlation;
+    for (unsigned int i = median_i; i < correlation_and_idx_left.size(); ++i) {
+        const auto correlation = correlation_and_idx_left.at(i).first;
+        const auto idx_left = correlation_and_idx_left.at(i).second;
+        if (correlation_thr < correlation) {
+            stereo_x_right.at(idx_left) = -1;
+            depths.at(idx_left) = -1;
+        }
+    }
+}
+
+int stereo_patch_search::get_coarse_level(const int level) const {
+    return std::min<int>(level + coarse_level_offset_, std::min(left_image_pyramid_.size(), right_image_pyramid_.size()) - 1);
+}
+
+bool stereo_patch_search::search_coarse_disparity(const cv::KeyPoint& keypt_left, float& x_right) const {
+    constexpr int half_size = 2;
+    // pixels around the best position which are not regarded as the second best
+    constexpr int non_max_width = 2;
+
+    const int level = get_coarse_level(keypt_left.octave);
+    const auto& left_img = left_image_pyramid_.at(level);
+    const auto& right_img = right_image_pyramid_.at(level);
+    const float inv_scale_factor = inv_scale_factors_.at(level);
+
+    const int x_left = cvRound(keypt_left.pt.x * inv_scale_factor);
+    const int y = cvRound(keypt_left.pt.y * inv_scale_factor);
+    if (x_left < half_size || left_img.cols - half_size <= x_left || y < half_size || left_img.rows - half_size <= y) {
+        return false;
+    }
+
+    // The corresponding point lies on the left side of the left keypoint
+    const int min_x_right = std::max(half_size, static_cast<int>(std::floor(x_left - max_disp_ * inv_scale_factor)));
+    const int max_x_right = std::min(right_img.cols - half_size - 1, static_cast<int>(std::ceil(x_left - min_disp_ * inv_scale_factor)));
+    if (max_x_right < min_x_right) {
+        return false;
+    }
+
+    std::vector<unsigned int> dists(max_x_right - min_x_right + 1);
+    unsigned int best_dist = std::numeric_limits<unsigned int>::max();
+    int best_x_right = -1;
+    for (int x = min_x_right; x <= max_x_right; ++x) {
+        const auto dist = compute_patch_distance(left_img, x_left, y, right_img, x, half_size);
+        dists.at(x - min_x_right) = dist;
+        if (dist < best_dist) {
+            best_dist = dist;
+            best_x_right = x;
+        }
+    }
+
+    // Discard the ambiguous matches (e.g. repetitive textures)
+    unsigned int second_best_dist = std::numeric_limits<unsigned int>::max();
+    for (int x = min_x_right; x <= max_x_right; ++x) {
+        if (std::abs(x - best_x_right) <= non_max_width) {
+            continue;
+        }
+        second_best_dist = std::min(second_best_dist, dists.at(x - min_x_right));
+    }
+    if (second_best_dist != std::numeric_limits<unsigned int>::max()
+        && uniqueness_ratio_ * second_best_dist < best_dist) {
+        return false;
+    }
+
+    x_right = best_x_right * scale_factors_.at(level);
+    return true;
+}
+
+bool stereo_patch_search::compute_subpixel_disparity(const cv::KeyPoint& keypt_left, const float x_right,
+                                                     float& best_x_right, float& best_disp, float& best_correlation) const {
+    const auto& left_img = left_image_pyramid_.at(keypt_left.octave);
+    const auto& right_img = right_image_pyramid_.at(keypt_left.octave);
+
+    // Convert cordinates to multiple scaling to compute patch correlation on the scaled image
+    const float inv_scale_factor = inv_scale_factors_.at(keypt_left.octave);
+    const int scaled_x_left = cvRound(keypt_left.pt.x * inv_scale_factor);
+    const int scaled_y_left = cvRound(keypt_left.pt.y * inv_scale_factor);
+    const int scaled_x_right = cvRound(x_right * inv_scale_factor);
+
+    // The search width covers the error (about one and a half pixels) of the coarse level
+    constexpr int win_size = 5;
+    const float level_ratio = scale_factors_.at(get_coarse_level(keypt_left.octave)) * inv_scale_factor;
+    const int slide_width = static_cast<int>(std::ceil(1.5 * level_ratio)) + 1;
+    if (scaled_x_left - win_size < 0 || left_img.cols <= scaled_x_left + win_size
+        || scaled_y_left - win_size < 0 || left_img.rows <= scaled_y_left + win_size) {
+        return false;
+    }
+    const int ini_x = scaled_x_right - slide_width - win_size;
+    const int end_x = scaled_x_right + slide_width + win_size;
+    if (ini_x < 0 || right_img.cols <= end_x) {
+        return false;
+    }
+
+    best_correlation = std::numeric_limits<float>::max();
+    int best_offset = 0;
+    std::vector<float> correlations(2 * slide_width + 1, -1);
+    for (int offset = -slide_width; offset <= +slide_width; ++offset) {
+        const float correlation = compute_patch_distance(left_img, scaled_x_left, scaled_y_left,
+                                                         right_img, scaled_x_right + offset, win_size);
+        if (correlation < best_correlation) {
+            best_correlation = correlation;
+            best_offset = offset;
+        }
+        correlations.at(slide_width + offset) = correlation;
+    }
+
+    if (best_offset == -slide_width || best_offset == slide_width) {
+        return false;
+    }
+
+    // Apply parabolic fitting to the three-point correlation value centering the point with the strongest correlation
+    const float correlation_1 = correlations.at(slide_width + best_offset - 1);
+    const float correlation_2 = correlations.at(slide_width + best_offset);
+    const float correlation_3 = correlations.at(slide_width + best_offset + 1);
+    const float denominator = 2.0 * (correlation_1 + correlation_3) - 4.0 * correlation_2;
+    const float x_delta = denominator == 0.0f ? 0.0f : (correlation_1 - correlation_3) / denominator;
+
+    if (x_delta < -1.0 || 1.0 < x_delta) {
+        return false;
+    }
+
+    // Compute the parallax
+    best_x_right = scale_factors_.at(keypt_left.octave) * (scaled_x_right + best_offset + x_delta);
+    best_disp = keypt_left.pt.x - best_x_right;
+
+    return true;
+}
+
+} // namespace match
+} // namespace stella_vslam
@@ -0,0 +1,95 @@
+#ifndef STELLA_VSLAM_MATCH_STEREO_PATCH_SEARCH_H
+#define STELLA_VSLAM_MATCH_STEREO_PATCH_SEARCH_H
+
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+
+namespace stella_vslam {
+namespace match {
+
+/**
+ * Stereo matching without the keypoints of the right image
+ * The disparity of each left keypoint is searched along the same row of the rectified right image pyramid
+ * (coarse search on a higher pyramid level, then subpixel refinement on the level of the keypoint).
+ */
+class stereo_patch_search {
+public:
+    stereo_patch_search() = delete;
+
+    stereo_patch_search(const std::vector<cv::Mat>& left_image_pyramid, const std::vector<cv::Mat>& right_image_pyramid,
+                        const std::vector<cv::KeyPoint>& keypts_left,
+                        const std::vector<float>& scale_factors, const std::vector<float>& inv_scale_factors,
+                        const float focal_x_baseline, const float true_baseline,
+                        const unsigned int coarse_level_offset = 3);
+
+    virtual ~stereo_patch_search() = default;
+
+    /**
+     * Compute stereo matching in subpixel order
+     */
+    void compute(std::vector<float>& stereo_x_right, std::vector<float>& depths) const;
+
+private:
+    /**
+     * Get the pyramid level used for the coarse search of the keypoint on the given level
+     */
+    int get_coarse_level(const int level) const;
+
+    /**
+     * Search the disparity along the row on the coarse pyramid level
+     * @param keypt_left
+     * @param x_right x coordinate on the right image (in the level 0)
+     * @return
+     */
+    bool search_coarse_disparity(const cv::KeyPoint& keypt_left, float& x_right) const;
+
+    /**
+     * Refine the disparity around the coarse estimate using patch correlation and parabola fitting
+     * @param keypt_left
+     * @param x_right
+     * @param best_x_right
+     * @param best_disp
+     * @param best_correlation
+     * @return
+     */
+    bool compute_subpixel_disparity(const cv::KeyPoint& keypt_left, const float x_right,
+                                    float& best_x_right, float& best_disp, float& best_correlation) const;
+
+    //! reference to left image pyramid
+    const std::vector<cv::Mat>& left_image_pyramid_;
+    //! reference to right image pyramid
+    const std::vector<cv::Mat>& right_image_pyramid_;
+
+    //! number of keypoints
+    const unsigned int num_keypts_;
+    //! reference to keypoints in left image
+    const std::vector<cv::KeyPoint>& keypts_left_;
+
+    //! reference to scale factors
+    const std::vector<float>& scale_factors_;
+    //! reference to inverse of scale factors
+    const std::vector<float>& inv_scale_factors_;
+
+    //! focal_x x baseline
+    const float focal_x_baseline_;
+    //! true baseline
+    const float true_baseline_;
+
+    //! minimum disparity
+    const float min_disp_;
+    //! maximum disparity
+    const float max_disp_;
+
+    //! the coarse search is performed on (the level of the keypoint + coarse_level_offset_)
+    const unsigned int coarse_level_offset_;
+
+    //! the best cost of the coarse search must be lower than this ratio of the second best one
+    static constexpr float uniqueness_ratio_ = 0.9;
+};
+
+} // namespace match
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_MATCH_STEREO_PATCH_SEARCH_H
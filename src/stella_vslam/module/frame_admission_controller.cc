@@ -0,0 +1,107 @@
+#include "stella_vslam/module/frame_admission_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <spdlog/spdlog.h>
+
+namespace stella_vslam {
+namespace module {
+
+frame_admission_controller::frame_admission_controller(const double fps,
+                                                       const double max_latency_ms,
+                                                       const unsigned int max_num_consecutive_drops,
+                                                       const double low_motion_rot_thr_deg,
+                                                       const double low_motion_trans_thr)
+    : frame_period_ms_(0.0 < fps ? 1000.0 / fps : 0.0),
+      max_latency_ms_(max_latency_ms),
+      max_num_consecutive_drops_(max_num_consecutive_drops),
+      low_motion_rot_thr_rad_(low_motion_rot_thr_deg * M_PI / 180.0),
+      low_motion_trans_thr_(low_motion_trans_thr) {
+    spdlog::debug("CONSTRUCT: module::frame_admission_controller");
+}
+
+frame_admission_controller::frame_admission_controller(const YAML::Node& yaml_node, const double fps)
+    : frame_admission_controller(fps,
+                                 yaml_node["max_latency_ms"].as<double>(100.0),
+                                 yaml_node["max_num_consecutive_drops"].as<unsigned int>(3),
+                                 yaml_node["low_motion_rot_thr_deg"].as<double>(0.5),
+                                 yaml_node["low_motion_trans_thr"].as<double>(0.01)) {}
+
+frame_admission_t frame_admission_controller::decide(const double timestamp, const bool keyfrm_is_likely, const bool motion_is_small) {
+    const double period_ms = get_period_ms(timestamp);
+    last_timestamp_ = timestamp;
+
+    frame_admission_t decision = frame_admission_t::Admitted;
+    if (max_latency_ms_ < stats_.latency_debt_ms_ && !keyfrm_is_likely
+        && num_consecutive_drops_ < max_num_consecutive_drops_) {
+        // Skip the low-motion frames first, and the other ones only under the heavy overload
+        if (motion_is_small) {
+            decision = frame_admission_t::DroppedLowMotion;
+        }
+        else if (2.0 * max_latency_ms_ < stats_.latency_debt_ms_) {
+            decision = frame_admission_t::DroppedOverload;
+        }
+    }
+
+    switch (decision) {
+        case frame_admission_t::Admitted: {
+            ++stats_.num_admitted_;
+            num_consecutive_drops_ = 0;
+            // The elapsed time is compared with this period in report_processing_time()
+            last_period_ms_ = period_ms;
+            SPDLOG_TRACE("frame_admission_controller: admit the frame at {} (latency: {} ms)", timestamp, stats_.latency_debt_ms_);
+            break;
+        }
+        case frame_admission_t::DroppedLowMotion: {
+            ++stats_.num_dropped_low_motion_;
+            ++num_consecutive_drops_;
+            stats_.latency_debt_ms_ = std::max(0.0, stats_.latency_debt_ms_ - period_ms);
+            spdlog::debug("frame_admission_controller: drop the low-motion frame at {} (latency: {} ms)", timestamp, stats_.latency_debt_ms_);
+            break;
+        }
+        case frame_admission_t::DroppedOverload: {
+            ++stats_.num_dropped_overload_;
+            ++num_consecutive_drops_;
+            stats_.latency_debt_ms_ = std::max(0.0, stats_.latency_debt_ms_ - period_ms);
+            spdlog::debug("frame_admission_controller: drop the frame at {} due to the overload (latency: {} ms)", timestamp, stats_.latency_debt_ms_);
+            break;
+        }
+    }
+    return decision;
+}
+
+void frame_admission_controller::report_processing_time(const double elapsed_ms) {
+    // The latency grows when the processing takes longer than the interval of the frames
+    stats_.latency_debt_ms_ = std::max(0.0, stats_.latency_debt_ms_ + elapsed_ms - last_period_ms_);
+
+    constexpr double alpha = 0.1;
+    stats_.mean_processing_time_ms_ = (stats_.num_admitted_ <= 1)
+                                          ? elapsed_ms
+                                          : (1.0 - alpha) * stats_.mean_processing_time_ms_ + alpha * elapsed_ms;
+}
+
+bool frame_admission_controller::motion_is_small(const Mat44_t& twist) const {
+    const Eigen::AngleAxisd angle_axis(Mat33_t(twist.block<3, 3>(0, 0)));
+    const double trans = twist.block<3, 1>(0, 3).norm();
+    return std::abs(angle_axis.angle()) < low_motion_rot_thr_rad_ && trans < low_motion_trans_thr_;
+}
+
+void frame_admission_controller::reset() {
+    stats_ = statistics();
+    num_consecutive_drops_ = 0;
+    last_timestamp_ = -1.0;
+    last_period_ms_ = 0.0;
+}
+
+double frame_admission_controller::get_period_ms(const double timestamp) const {
+    // Use the actual interval of the timestamps, which is bounded by the configured frame rate
+    if (last_timestamp_ < 0.0 || timestamp <= last_timestamp_) {
+        return frame_period_ms_;
+    }
+    const double period_ms = 1000.0 * (timestamp - last_timestamp_);
+    return (0.0 < frame_period_ms_) ? std::min(period_ms, 10.0 * frame_period_ms_) : period_ms;
+}
+
+} // namespace module
+} // namespace stella_vslam
@@ -0,0 +1,92 @@
+#ifndef STELLA_VSLAM_MODULE_FRAME_ADMISSION_CONTROLLER_H
+#define STELLA_VSLAM_MODULE_FRAME_ADMISSION_CONTROLLER_H
+
+#include "stella_vslam/type.h"
+
+#include <yaml-cpp/yaml.h>
+
+namespace stella_vslam {
+namespace module {
+
+enum class frame_admission_t {
+    Admitted,
+    DroppedLowMotion,
+    DroppedOverload
+};
+
+/**
+ * Decide whether an incoming frame is processed so that the latency stays bounded
+ * when the processing falls behind the camera rate
+ */
+class frame_admission_controller {
+public:
+    /**
+     * Statistics of the decisions
+     */
+    struct statistics {
+        unsigned int num_admitted_ = 0;
+        unsigned int num_dropped_low_motion_ = 0;
+        unsigned int num_dropped_overload_ = 0;
+        //! latency accumulated behind the camera rate [ms]
+        double latency_debt_ms_ = 0.0;
+        //! exponential moving average of the processing time of the admitted frames [ms]
+        double mean_processing_time_ms_ = 0.0;
+    };
+
+    //! Constructor
+    frame_admission_controller(const double fps,
+                               const double max_latency_ms = 100.0,
+                               const unsigned int max_num_consecutive_drops = 3,
+                               const double low_motion_rot_thr_deg = 0.5,
+                               const double low_motion_trans_thr = 0.01);
+
+    //! Constructor
+    frame_admission_controller(const YAML::Node& yaml_node, const double fps);
+
+    /**
+     * Decide whether the frame is processed
+     * @param timestamp
+     * @param keyfrm_is_likely the frame is likely to be promoted to a keyframe (never dropped)
+     * @param motion_is_small the predicted motion from the last frame is small
+     */
+    frame_admission_t decide(const double timestamp, const bool keyfrm_is_likely, const bool motion_is_small);
+
+    //! Report the processing time of the admitted frame
+    void report_processing_time(const double elapsed_ms);
+
+    //! Check the motion model (relative pose from the last frame to the current frame) is small
+    bool motion_is_small(const Mat44_t& twist) const;
+
+    //! Get the statistics of the decisions
+    statistics get_statistics() const { return stats_; }
+
+    //! Reset the statistics and the latency
+    void reset();
+
+    //! frame period of the camera [ms]
+    const double frame_period_ms_;
+    //! latency above which the frames are dropped [ms]
+    const double max_latency_ms_;
+    //! max number of the consecutively dropped frames
+    const unsigned int max_num_consecutive_drops_;
+    //! thresholds of the low-motion frames (per frame)
+    const double low_motion_rot_thr_rad_;
+    const double low_motion_trans_thr_;
+
+private:
+    //! Get the period between the last and current frames [ms]
+    double get_period_ms(const double timestamp) const;
+
+    statistics stats_;
+    //! number of the consecutively dropped frames
+    unsigned int num_consecutive_drops_ = 0;
+    //! timestamp of the last frame
+    double last_timestamp_ = -1.0;
+    //! period between the last admitted frame and the previous one [ms]
+    double last_period_ms_ = 0.0;
+};
+
+} // namespace module
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_MODULE_FRAME_ADMISSION_CONTROLLER_H
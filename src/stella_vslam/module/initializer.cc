@@ -117,9 +117,9 @@ void initializer::create_initializer(data::frame& curr_frm) {
     init_frm_ = data::frame(curr_frm);
 
     // initialize the previously matched coordinates
-    prev_matched_coords_.resize(init_frm_.frm_obs_.undist_keypts_.size());
-    for (unsigned int i = 0; i < init_frm_.frm_obs_.undist_keypts_.size(); ++i) {
-        prev_matched_coords_.at(i) = init_frm_.frm_obs_.undist_keypts_.at(i).pt;
+    prev_matched_coords_.resize(init_frm_.frm_obs_->undist_keypts_.size());
+    for (unsigned int i = 0; i < init_frm_.frm_obs_->undist_keypts_.size(); ++i) {
+        prev_matched_coords_.at(i) = init_frm_.frm_obs_->undist_keypts_.at(i).pt;
     }
 
     // initialize matchings (init_idx -> curr_idx)
@@ -307,6 +307,9 @@ bool initializer::create_map_for_monocular(data::bow_vocabulary* bow_vocab, data
         scale_map(init_keyfrm, curr_keyfrm, inv_median_scale * scaling_factor_);
     }
 
+    // the map was moved by the bundle adjustment and the scaling after it was added
+    map_db_->record_map_change();
+
     // update the current frame pose
     curr_frm.set_pose_cw(curr_keyfrm->get_pose_cw());
 
@@ -335,7 +338,7 @@ void initializer::scale_map(const std::shared_ptr<data::keyframe>& init_keyfrm,
 bool initializer::try_initialize_for_stereo(data::frame& curr_frm) {
     assert(state_ == initializer_state_t::Initializing);
     // count the number of valid depths
-    unsigned int num_valid_depths = std::count_if(curr_frm.frm_obs_.depths_.begin(), curr_frm.frm_obs_.depths_.end(),
+    unsigned int num_valid_depths = std::count_if(curr_frm.frm_obs_->depths_.begin(), curr_frm.frm_obs_->depths_.end(),
                                                   [](const float depth) {
                                                       return 0 < depth;
                                                   });
@@ -363,9 +366,9 @@ bool initializer::create_map_for_stereo(data::bow_vocabulary* bow_vocab, data::f
     curr_frm.ref_keyfrm_ = curr_keyfrm;
     map_db_->update_frame_statistics(curr_frm, false);
 
-    for (unsigned int idx = 0; idx < curr_frm.frm_obs_.undist_keypts_.size(); ++idx) {
+    for (unsigned int idx = 0; idx < curr_frm.frm_obs_->undist_keypts_.size(); ++idx) {
         // add a new landmark if tht corresponding depth is valid
-        const auto z = curr_frm.frm_obs_.depths_.at(idx);
+        const auto z = curr_frm.frm_obs_->depths_.at(idx);
         if (z <= 0) {
             continue;
         }
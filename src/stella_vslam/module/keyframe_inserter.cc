@@ -5,6 +5,7 @@
 #include "stella_vslam/marker_model/base.h"
 #include "stella_vslam/module/marker_initializer.h"
 #include "stella_vslam/module/keyframe_inserter.h"
+#include "stella_vslam/benchmark/timer.h"
 
 #include <spdlog/spdlog.h>
 
@@ -130,6 +131,7 @@ bool keyframe_inserter::new_keyframe_is_needed(data::map_database* map_db,
 std::shared_ptr<data::keyframe> keyframe_inserter::create_new_keyframe(
     data::map_database* map_db,
     data::frame& curr_frm) {
+    STELLA_BENCHMARK_TIMER("module::keyframe_inserter", "create_new_keyframe");
     std::lock_guard<std::mutex> lock(data::map_database::mtx_database_);
 
     auto keyfrm = data::keyframe::make_keyframe(map_db->next_keyframe_id_++, curr_frm);
@@ -159,10 +161,10 @@ std::shared_ptr<data::keyframe> keyframe_inserter::create_new_keyframe(
 
     // Save the valid depth and index pairs
     std::vector<std::pair<float, unsigned int>> depth_idx_pairs;
-    depth_idx_pairs.reserve(curr_frm.frm_obs_.undist_keypts_.size());
-    for (unsigned int idx = 0; idx < curr_frm.frm_obs_.undist_keypts_.size(); ++idx) {
-        assert(!curr_frm.frm_obs_.depths_.empty());
-        const auto depth = curr_frm.frm_obs_.depths_.at(idx);
+    depth_idx_pairs.reserve(curr_frm.frm_obs_->undist_keypts_.size());
+    for (unsigned int idx = 0; idx < curr_frm.frm_obs_->undist_keypts_.size(); ++idx) {
+        assert(!curr_frm.frm_obs_->depths_.empty());
+        const auto depth = curr_frm.frm_obs_->depths_.at(idx);
         // Add if the depth is valid
         if (0 < depth) {
             depth_idx_pairs.emplace_back(std::make_pair(depth, idx));
@@ -215,11 +217,38 @@ std::shared_ptr<data::keyframe> keyframe_inserter::create_new_keyframe(
     return keyfrm;
 }
 
+bool keyframe_inserter::new_keyframe_is_likely(data::map_database* map_db,
+                                               const double next_timestamp,
+                                               const double reliable_lms_ratio,
+                                               const double ratio_margin) const {
+    const auto last_inserted_keyfrm = map_db->get_last_inserted_keyframe();
+    if (!last_inserted_keyfrm) {
+        return true;
+    }
+    if (max_interval_ > 0.0 && last_inserted_keyfrm->timestamp_ + max_interval_ <= next_timestamp) {
+        return true;
+    }
+    if (lms_ratio_thr_view_changed_ > 0.0 && reliable_lms_ratio < lms_ratio_thr_view_changed_ + ratio_margin) {
+        return true;
+    }
+    return false;
+}
+
 void keyframe_inserter::insert_new_keyframe(data::map_database* map_db,
-                                            data::frame& curr_frm) {
+                                            data::frame& curr_frm,
+                                            const std::shared_ptr<data::keyframe>& imu_prev_keyfrm,
+                                            const std::shared_ptr<const imu::preintegrator>& imu_preint,
+                                            const imu::state& imu_state) {
     SPDLOG_TRACE("keyframe_inserter: insert_new_keyframe (curr_frm={})", curr_frm.id_);
     // insert the new keyframe
     const auto ref_keyfrm = create_new_keyframe(map_db, curr_frm);
+    // connect the inertial state before the mapping module optimizes it
+    if (ref_keyfrm) {
+        ref_keyfrm->set_imu_state(imu_state);
+        if (imu_prev_keyfrm && imu_preint) {
+            ref_keyfrm->set_imu_preintegration(imu_prev_keyfrm, imu_preint);
+        }
+    }
     auto future_add_keyframe = mapper_->async_add_keyframe(ref_keyfrm);
     if (wait_for_local_bundle_adjustment_) {
         future_add_keyframe.get();
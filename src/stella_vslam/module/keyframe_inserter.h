@@ -47,10 +47,23 @@ public:
                                 const data::keyframe& ref_keyfrm,
                                 const unsigned int min_num_obs_thr) const;
 
+    /**
+     * Check the new keyframe is likely to be needed at the next frame
+     * (the view change is checked with the margin on the ratio threshold)
+     */
+    bool new_keyframe_is_likely(data::map_database* map_db,
+                                const double next_timestamp,
+                                const double reliable_lms_ratio,
+                                const double ratio_margin) const;
+
     /**
      * Insert the new keyframe derived from the current frame
+     * (connected with the previous keyframe by the IMU preintegration if given)
      */
-    void insert_new_keyframe(data::map_database* map_db, data::frame& curr_frm);
+    void insert_new_keyframe(data::map_database* map_db, data::frame& curr_frm,
+                             const std::shared_ptr<data::keyframe>& imu_prev_keyfrm = nullptr,
+                             const std::shared_ptr<const imu::preintegrator>& imu_preint = nullptr,
+                             const imu::state& imu_state = imu::state());
 
     static void check_marker_initialization(data::marker& mkr, size_t needed_observations_for_initialization);
 
@@ -0,0 +1,88 @@
+#include "stella_vslam/camera/base.h"
+#include "stella_vslam/data/frame.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/module/local_landmark_ranker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <spdlog/spdlog.h>
+
+namespace stella_vslam {
+namespace module {
+
+local_landmark_ranker::local_landmark_ranker(const unsigned int num_matches_thr,
+                                             const unsigned int num_grid_cols,
+                                             const unsigned int num_grid_rows)
+    : num_matches_thr_(num_matches_thr),
+      num_grid_cols_(std::max(1u, num_grid_cols)), num_grid_rows_(std::max(1u, num_grid_rows)) {
+    spdlog::debug("CONSTRUCT: module::local_landmark_ranker");
+}
+
+local_landmark_ranker::local_landmark_ranker(const YAML::Node& yaml_node)
+    : local_landmark_ranker(yaml_node["num_matches_thr"].as<unsigned int>(0),
+                            yaml_node["num_grid_cols"].as<unsigned int>(8),
+                            yaml_node["num_grid_rows"].as<unsigned int>(6)) {}
+
+bool local_landmark_ranker::is_enabled() const {
+    return 0 < num_matches_thr_;
+}
+
+float local_landmark_ranker::compute_utility(const data::landmark& lm, const Vec3_t& cam_center) {
+    // The landmarks which have been matched reliably from many viewpoints similar to the current one come first
+    const Vec3_t cam_to_lm_vec = lm.get_pos_in_world() - cam_center;
+    const auto cam_to_lm_dist = cam_to_lm_vec.norm();
+    const float ray_cos = (0.0 < cam_to_lm_dist) ? cam_to_lm_vec.dot(lm.get_obs_mean_normal()) / cam_to_lm_dist : 0.0;
+    return lm.get_observed_ratio() * std::log2(1.0f + lm.num_observations()) * std::max(0.0f, ray_cos);
+}
+
+std::vector<std::shared_ptr<data::landmark>> local_landmark_ranker::rank(const data::frame& frm,
+                                                                         const std::vector<std::shared_ptr<data::landmark>>& candidates,
+                                                                         const eigen_alloc_unord_map<unsigned int, Vec2_t>& lm_to_reproj) const {
+    // 1. Rank the candidates in each cell
+
+    using utility_and_lm_t = std::pair<float, std::shared_ptr<data::landmark>>;
+    std::vector<std::vector<utility_and_lm_t>> cells(num_grid_cols_ * num_grid_rows_);
+    const Vec3_t cam_center = frm.get_trans_wc();
+    const float cell_width = static_cast<float>(frm.camera_->cols_) / num_grid_cols_;
+    const float cell_height = static_cast<float>(frm.camera_->rows_) / num_grid_rows_;
+    for (const auto& lm : candidates) {
+        const Vec2_t& reproj = lm_to_reproj.at(lm->id_);
+        const int col = std::min(std::max(0, static_cast<int>(reproj(0) / cell_width)), static_cast<int>(num_grid_cols_) - 1);
+        const int row = std::min(std::max(0, static_cast<int>(reproj(1) / cell_height)), static_cast<int>(num_grid_rows_) - 1);
+        cells.at(row * num_grid_cols_ + col).emplace_back(compute_utility(*lm, cam_center), lm);
+    }
+
+    // (the smaller ID first if tied for consistency)
+    const auto greater_utility = [](const utility_and_lm_t& a, const utility_and_lm_t& b) {
+        return a.first > b.first || (a.first == b.first && a.second->id_ < b.second->id_);
+    };
+    size_t max_num_in_cell = 0;
+    for (auto& cell : cells) {
+        std::sort(cell.begin(), cell.end(), greater_utility);
+        max_num_in_cell = std::max(max_num_in_cell, cell.size());
+    }
+
+    // 2. Take the n-th best candidates of all the cells in turn
+
+    std::vector<std::shared_ptr<data::landmark>> ranked_lms;
+    ranked_lms.reserve(candidates.size());
+    std::vector<utility_and_lm_t> nth_best_lms;
+    for (size_t n = 0; n < max_num_in_cell; ++n) {
+        nth_best_lms.clear();
+        for (const auto& cell : cells) {
+            if (n < cell.size()) {
+                nth_best_lms.push_back(cell.at(n));
+            }
+        }
+        std::sort(nth_best_lms.begin(), nth_best_lms.end(), greater_utility);
+        for (const auto& utility_and_lm : nth_best_lms) {
+            ranked_lms.push_back(utility_and_lm.second);
+        }
+    }
+
+    return ranked_lms;
+}
+
+} // namespace module
+} // namespace stella_vslam
@@ -0,0 +1,69 @@
+#ifndef STELLA_VSLAM_MODULE_LOCAL_LANDMARK_RANKER_H
+#define STELLA_VSLAM_MODULE_LOCAL_LANDMARK_RANKER_H
+
+#include "stella_vslam/type.h"
+
+#include <memory>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace stella_vslam {
+
+namespace data {
+class frame;
+class landmark;
+} // namespace data
+
+namespace module {
+
+/**
+ * Budget of the local landmarks matched in the tracking.
+ * The projection candidates are ordered by their expected utility
+ * (observation count, match success ratio and viewing angle),
+ * interleaving the cells of the image grid so that any prefix of the order is spread in the image.
+ * The matching stops once the frame has enough matches.
+ * All the candidates are matched with the default parameters.
+ */
+class local_landmark_ranker {
+public:
+    //! Constructor
+    explicit local_landmark_ranker(const unsigned int num_matches_thr = 0,
+                                   const unsigned int num_grid_cols = 8,
+                                   const unsigned int num_grid_rows = 6);
+
+    //! Constructor
+    explicit local_landmark_ranker(const YAML::Node& yaml_node);
+
+    //! Return true if the matching stops early
+    bool is_enabled() const;
+
+    //! Get the number of the matches with which the matching stops
+    unsigned int get_num_matches_threshold() const { return num_matches_thr_; }
+
+    /**
+     * Order the projection candidates in the processing order
+     * @param frm
+     * @param candidates
+     * @param lm_to_reproj reprojections of the candidates
+     * @return ranked candidates
+     */
+    std::vector<std::shared_ptr<data::landmark>> rank(const data::frame& frm,
+                                                      const std::vector<std::shared_ptr<data::landmark>>& candidates,
+                                                      const eigen_alloc_unord_map<unsigned int, Vec2_t>& lm_to_reproj) const;
+
+    //! Compute the expected utility of matching the landmark from the camera center (higher is better)
+    static float compute_utility(const data::landmark& lm, const Vec3_t& cam_center);
+
+private:
+    //! number of the matches with which the matching stops (0 means no early stop)
+    const unsigned int num_matches_thr_;
+    //! size of the image grid
+    const unsigned int num_grid_cols_;
+    const unsigned int num_grid_rows_;
+};
+
+} // namespace module
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_MODULE_LOCAL_LANDMARK_RANKER_H
@@ -140,8 +140,8 @@ void local_map_cleaner::count_redundant_observations(const std::shared_ptr<data:
 
         // if depth is within the valid range, it won't be considered
         if (keyfrm->depth_is_available()) {
-            assert(!keyfrm->frm_obs_.depths_.empty());
-            const auto depth = keyfrm->frm_obs_.depths_.at(idx);
+            assert(!keyfrm->frm_obs_->depths_.empty());
+            const auto depth = keyfrm->frm_obs_->depths_.at(idx);
             if (depth < 0.0 || keyfrm->camera_->depth_thr_ < depth) {
                 continue;
             }
@@ -155,9 +155,9 @@ void local_map_cleaner::count_redundant_observations(const std::shared_ptr<data:
         }
 
         // `keyfrm` observes `lm` with the scale level `scale_level`
-        const auto scale_level = keyfrm->frm_obs_.undist_keypts_.at(idx).octave;
+        const auto scale_level = keyfrm->frm_obs_->undist_keypts_.at(idx).octave;
         // get observers of `lm`
-        const auto observations = lm->get_observations();
+        const auto observations = lm->get_all_observations();
 
         bool obs_by_keyfrm_is_redundant = false;
 
@@ -171,7 +171,7 @@ void local_map_cleaner::count_redundant_observations(const std::shared_ptr<data:
             }
 
             // `ngh_keyfrm` observes `lm` with the scale level `ngh_scale_level`
-            const auto ngh_scale_level = ngh_keyfrm->frm_obs_.undist_keypts_.at(obs.second).octave;
+            const auto ngh_scale_level = ngh_keyfrm->frm_obs_->undist_keypts_.at(obs.second).octave;
 
             // compare the scale levels
             if (ngh_scale_level <= scale_level + 1) {
@@ -2,6 +2,7 @@
 #include "stella_vslam/data/keyframe.h"
 #include "stella_vslam/data/landmark.h"
 #include "stella_vslam/module/local_map_updater.h"
+#include "stella_vslam/benchmark/timer.h"
 
 #include <spdlog/spdlog.h>
 
@@ -34,6 +35,7 @@ bool local_map_updater::acquire_local_map(const std::vector<std::shared_ptr<data
 bool local_map_updater::acquire_local_map(const std::vector<std::shared_ptr<data::landmark>>& frm_lms,
                                           const unsigned int keyframe_id_threshold,
                                           unsigned int& num_temporal_keyfrms) {
+    STELLA_BENCHMARK_TIMER("module::local_map_updater", "acquire_local_map");
     num_temporal_keyfrms = 0;
     const auto local_keyfrms_was_found = find_local_keyframes(frm_lms, keyframe_id_threshold, num_temporal_keyfrms);
     const auto local_lms_was_found = find_local_landmarks(frm_lms);
@@ -74,7 +76,7 @@ auto local_map_updater::count_num_shared_lms(
         if (lm->will_be_erased()) {
             continue;
         }
-        const auto observations = lm->get_observations();
+        const auto observations = lm->get_all_observations();
         for (auto obs : observations) {
             auto keyfrm = obs.first.lock();
             ++keyfrm_to_num_shared_lms[keyfrm];
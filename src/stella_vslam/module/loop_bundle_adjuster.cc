@@ -5,7 +5,12 @@
 #include "stella_vslam/data/map_database.h"
 #include "stella_vslam/module/loop_bundle_adjuster.h"
 #include "stella_vslam/optimize/global_bundle_adjuster.h"
+#include "stella_vslam/optimize/hierarchical_bundle_adjuster.h"
+#include "stella_vslam/optimize/pose_graph_refiner.h"
+#include "stella_vslam/benchmark/timer.h"
 
+#include <algorithm>
+#include <future>
 #include <thread>
 
 #include <spdlog/spdlog.h>
@@ -16,11 +21,17 @@ namespace module {
 loop_bundle_adjuster::loop_bundle_adjuster(data::map_database* map_db,
                                            const unsigned int num_iter,
                                            const bool use_huber_kernel,
-                                           const bool verbose)
+                                           const bool verbose,
+                                           const bool use_hierarchical_BA,
+                                           const unsigned int max_num_keyfrms_in_submap,
+                                           const unsigned int min_num_shared_lms_in_refinement)
     : map_db_(map_db),
       num_iter_(num_iter),
       use_huber_kernel_(use_huber_kernel),
-      verbose_(verbose) {}
+      verbose_(verbose),
+      use_hierarchical_BA_(use_hierarchical_BA),
+      max_num_keyfrms_in_submap_(max_num_keyfrms_in_submap),
+      min_num_shared_lms_in_refinement_(min_num_shared_lms_in_refinement) {}
 
 void loop_bundle_adjuster::set_mapping_module(mapping_module* mapper) {
     mapper_ = mapper;
@@ -37,6 +48,7 @@ bool loop_bundle_adjuster::is_running() const {
 }
 
 void loop_bundle_adjuster::optimize(const std::shared_ptr<data::keyframe>& curr_keyfrm) {
+    STELLA_BENCHMARK_TIMER("module::loop_bundle_adjuster", "optimize");
     spdlog::info("start loop bundle adjustment");
 
     {
@@ -51,15 +63,64 @@ void loop_bundle_adjuster::optimize(const std::shared_ptr<data::keyframe>& curr_
     eigen_alloc_unord_map<unsigned int, Vec3_t> lm_to_pos_w_after_global_BA;
     eigen_alloc_unord_map<unsigned int, Mat44_t> keyfrm_to_pose_cw_after_global_BA;
     eigen_alloc_unord_map<unsigned int, std::array<Vec3_t, 4>> marker_to_pos_w_after_global_BA;
-    const auto global_BA = optimize::global_bundle_adjuster(num_iter_, use_huber_kernel_, verbose_);
-    bool ok = global_BA.optimize(curr_keyfrm->graph_node_->get_keyframes_from_root(),
-                                 optimized_keyfrm_ids, optimized_landmark_ids,
-                                 optimized_marker_ids,
-                                 lm_to_pos_w_after_global_BA,
-                                 keyfrm_to_pose_cw_after_global_BA,
-                                 marker_to_pos_w_after_global_BA,
-                                 &abort_loop_BA_);
+    const auto keyfrms_to_optimize = curr_keyfrm->graph_node_->get_keyframes_from_root();
+    bool ok = false;
+    if (use_hierarchical_BA_ && max_num_keyfrms_in_submap_ < keyfrms_to_optimize.size()) {
+        const auto hierarchical_BA = optimize::hierarchical_bundle_adjuster(max_num_keyfrms_in_submap_, num_iter_, use_huber_kernel_, verbose_);
+        ok = hierarchical_BA.optimize(keyfrms_to_optimize,
+                                      optimized_keyfrm_ids, optimized_landmark_ids,
+                                      optimized_marker_ids,
+                                      lm_to_pos_w_after_global_BA,
+                                      keyfrm_to_pose_cw_after_global_BA,
+                                      marker_to_pos_w_after_global_BA,
+                                      &abort_loop_BA_);
+    }
+    else {
+        const auto global_BA = optimize::global_bundle_adjuster(num_iter_, use_huber_kernel_, verbose_);
+        ok = global_BA.optimize(keyfrms_to_optimize,
+                                optimized_keyfrm_ids, optimized_landmark_ids,
+                                optimized_marker_ids,
+                                lm_to_pos_w_after_global_BA,
+                                keyfrm_to_pose_cw_after_global_BA,
+                                marker_to_pos_w_after_global_BA,
+                                &abort_loop_BA_);
+    }
+
+    update_map(curr_keyfrm, ok, optimized_keyfrm_ids, optimized_landmark_ids, optimized_marker_ids,
+               lm_to_pos_w_after_global_BA, keyfrm_to_pose_cw_after_global_BA, marker_to_pos_w_after_global_BA);
+}
+
+void loop_bundle_adjuster::refine_poses(const std::shared_ptr<data::keyframe>& curr_keyfrm) {
+    STELLA_BENCHMARK_TIMER("module::loop_bundle_adjuster", "refine_poses");
+    spdlog::info("start pose-only loop refinement");
 
+    {
+        std::lock_guard<std::mutex> lock(mtx_thread_);
+        loop_BA_is_running_ = true;
+        abort_loop_BA_ = false;
+    }
+
+    eigen_alloc_unord_map<unsigned int, Mat44_t> keyfrm_to_pose_cw_after_refinement;
+    const auto keyfrms_to_optimize = curr_keyfrm->graph_node_->get_keyframes_from_root();
+    const auto refiner = optimize::pose_graph_refiner(min_num_shared_lms_in_refinement_);
+    const bool ok = refiner.optimize(keyfrms_to_optimize, keyfrm_to_pose_cw_after_refinement, &abort_loop_BA_);
+
+    // all the landmarks are re-anchored to their reference keyframes
+    std::unordered_set<unsigned int> optimized_keyfrm_ids;
+    for (const auto& id_pose : keyfrm_to_pose_cw_after_refinement) {
+        optimized_keyfrm_ids.insert(id_pose.first);
+    }
+    update_map(curr_keyfrm, ok, optimized_keyfrm_ids, {}, {}, {}, keyfrm_to_pose_cw_after_refinement, {});
+}
+
+void loop_bundle_adjuster::update_map(const std::shared_ptr<data::keyframe>& curr_keyfrm,
+                                      const bool ok,
+                                      std::unordered_set<unsigned int>& optimized_keyfrm_ids,
+                                      const std::unordered_set<unsigned int>& optimized_landmark_ids,
+                                      const std::unordered_set<unsigned int>& optimized_marker_ids,
+                                      const eigen_alloc_unord_map<unsigned int, Vec3_t>& lm_to_pos_w_after_global_BA,
+                                      eigen_alloc_unord_map<unsigned int, Mat44_t>& keyfrm_to_pose_cw_after_global_BA,
+                                      const eigen_alloc_unord_map<unsigned int, std::array<Vec3_t, 4>>& marker_to_pos_w_after_global_BA) {
     {
         std::lock_guard<std::mutex> lock1(mtx_thread_);
 
@@ -136,11 +197,8 @@ void loop_bundle_adjuster::optimize(const std::shared_ptr<data::keyframe>& curr_
             }
         }
 
-        for (const auto& lm : lms) {
-            if (lm->will_be_erased()) {
-                continue;
-            }
-
+        // the landmarks are updated independently, so update them in parallel
+        const auto update_landmark = [&](const std::shared_ptr<data::landmark>& lm) {
             if (optimized_landmark_ids.count(lm->id_)) {
                 // if `lm` is optimized by the loop BA
 
@@ -168,6 +226,22 @@ void loop_bundle_adjuster::optimize(const std::shared_ptr<data::keyframe>& curr_
                 lm->set_pos_in_world(rot_wc * pos_c + trans_wc);
             }
             lm->update_mean_normal_and_obs_scale_variance();
+        };
+        const unsigned int num_threads = std::max(1u, std::thread::hardware_concurrency());
+        const unsigned int chunk_size = (lms.size() + num_threads - 1) / num_threads;
+        std::vector<std::future<void>> futures;
+        for (unsigned int begin = 0; begin < lms.size(); begin += chunk_size) {
+            const unsigned int end = std::min<unsigned int>(begin + chunk_size, lms.size());
+            futures.push_back(std::async(std::launch::async, [&, begin, end] {
+                for (unsigned int i = begin; i < end; ++i) {
+                    if (!lms.at(i)->will_be_erased()) {
+                        update_landmark(lms.at(i));
+                    }
+                }
+            }));
+        }
+        for (auto& future : futures) {
+            future.get();
         }
 
         spdlog::debug("update the positions of the markers");
@@ -200,6 +274,8 @@ void loop_bundle_adjuster::optimize(const std::shared_ptr<data::keyframe>& curr_
             }
         }
 
+        map_db_->record_map_change();
+        mapper_->invalidate_landmark_spatial_hash();
         mapper_->resume();
         loop_BA_is_running_ = false;
 
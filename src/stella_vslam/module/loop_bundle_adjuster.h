@@ -1,7 +1,12 @@
 #ifndef STELLA_VSLAM_MODULE_LOOP_BUNDLE_ADJUSTER_H
 #define STELLA_VSLAM_MODULE_LOOP_BUNDLE_ADJUSTER_H
 
+#include "stella_vslam/type.h"
+
+#include <array>
+#include <memory>
 #include <mutex>
+#include <unordered_set>
 
 namespace stella_vslam {
 
@@ -22,7 +27,10 @@ public:
     explicit loop_bundle_adjuster(data::map_database* map_db,
                                   const unsigned int num_iter = 10,
                                   const bool use_huber_kernel = false,
-                                  const bool verbose = false);
+                                  const bool verbose = false,
+                                  const bool use_hierarchical_BA = false,
+                                  const unsigned int max_num_keyfrms_in_submap = 100,
+                                  const unsigned int min_num_shared_lms_in_refinement = 15);
 
     /**
      * Destructor
@@ -49,7 +57,26 @@ public:
      */
     void optimize(const std::shared_ptr<data::keyframe>& curr_keyfrm);
 
+    /**
+     * Run pose-only loop refinement (cheaper alternative of loop BA)
+     * The landmarks are re-anchored to their reference keyframes instead of being optimized
+     */
+    void refine_poses(const std::shared_ptr<data::keyframe>& curr_keyfrm);
+
 private:
+    /**
+     * Update the map with the optimized poses and positions
+     * The keyframes (landmarks) not optimized follow their spanning parents (reference keyframes)
+     */
+    void update_map(const std::shared_ptr<data::keyframe>& curr_keyfrm,
+                    const bool ok,
+                    std::unordered_set<unsigned int>& optimized_keyfrm_ids,
+                    const std::unordered_set<unsigned int>& optimized_landmark_ids,
+                    const std::unordered_set<unsigned int>& optimized_marker_ids,
+                    const eigen_alloc_unord_map<unsigned int, Vec3_t>& lm_to_pos_w_after_global_BA,
+                    eigen_alloc_unord_map<unsigned int, Mat44_t>& keyfrm_to_pose_cw_after_global_BA,
+                    const eigen_alloc_unord_map<unsigned int, std::array<Vec3_t, 4>>& marker_to_pos_w_after_global_BA);
+
     //! map database
     data::map_database* map_db_ = nullptr;
 
@@ -62,6 +89,12 @@ private:
     const bool use_huber_kernel_ = false;
     //! Verbosity (for g2o)
     const bool verbose_ = false;
+    //! If true, use the hierarchical bundle adjustment over submaps for the maps larger than a submap
+    const bool use_hierarchical_BA_ = false;
+    //! maximum number of keyframes in a submap of the hierarchical bundle adjustment
+    const unsigned int max_num_keyfrms_in_submap_ = 100;
+    //! minimum number of the shared landmarks to distill a relative pose constraint in the pose-only refinement
+    const unsigned int min_num_shared_lms_in_refinement_ = 15;
 
     //-----------------------------------------
     // thread management
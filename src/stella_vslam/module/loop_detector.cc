@@ -10,6 +10,7 @@
 #include "stella_vslam/solve/pnp_solver.h"
 #include "stella_vslam/util/converter.h"
 #include "stella_vslam/util/fancy_index.h"
+#include "stella_vslam/util/runtime_params.h"
 #include "stella_vslam/benchmark/timer.h"
 
 #include <spdlog/spdlog.h>
@@ -34,6 +35,16 @@ loop_detector::loop_detector(data::bow_database* bow_db, data::bow_vocabulary* b
     spdlog::debug("CONSTRUCT: loop_detector");
 }
 
+void loop_detector::update_parameters(const YAML::Node& yaml_node) {
+    const auto num_final_matches_thr = yaml_node["num_final_matches_threshold"].as<unsigned int>(num_final_matches_thr_);
+    util::record_param_change("loop_detector", "num_final_matches_threshold", num_final_matches_thr_, num_final_matches_thr);
+    num_final_matches_thr_ = num_final_matches_thr;
+
+    const auto min_continuity = yaml_node["min_continuity"].as<unsigned int>(min_continuity_);
+    util::record_param_change("loop_detector", "min_continuity", min_continuity_, min_continuity);
+    min_continuity_ = min_continuity;
+}
+
 void loop_detector::enable_loop_detector() {
     loop_detector_is_enabled_ = true;
 }
@@ -411,8 +422,8 @@ bool loop_detector::select_loop_candidate_via_Sim3(const std::unordered_set<std:
         }
 
         // Resample valid elements
-        const auto valid_bearings = util::resample_by_indices(cur_keyfrm_->frm_obs_.bearings_, valid_indices);
-        const auto valid_keypts = util::resample_by_indices(cur_keyfrm_->frm_obs_.undist_keypts_, valid_indices);
+        const auto valid_bearings = util::resample_by_indices(cur_keyfrm_->frm_obs_->bearings_, valid_indices);
+        const auto valid_keypts = util::resample_by_indices(cur_keyfrm_->frm_obs_->undist_keypts_, valid_indices);
         std::vector<int> octaves(valid_indices.size());
         for (unsigned int i = 0; i < valid_indices.size(); ++i) {
             octaves.at(i) = valid_keypts.at(i).octave;
@@ -436,7 +447,7 @@ bool loop_detector::select_loop_candidate_via_Sim3(const std::unordered_set<std:
         const auto inlier_indices = util::resample_by_indices(valid_indices, pnp_solver->get_inlier_flags());
 
         // Set 2D-3D matches for the pose optimization
-        auto lms_in_cand = std::vector<std::shared_ptr<data::landmark>>(cur_keyfrm_->frm_obs_.undist_keypts_.size(), nullptr);
+        auto lms_in_cand = std::vector<std::shared_ptr<data::landmark>>(cur_keyfrm_->frm_obs_->undist_keypts_.size(), nullptr);
         for (const auto idx : inlier_indices) {
             // Set only the valid 3D points to the current frame
             lms_in_cand.at(idx) = curr_match_lms_observed_in_cand.at(idx);
@@ -446,7 +457,7 @@ bool loop_detector::select_loop_candidate_via_Sim3(const std::unordered_set<std:
         // Pose optimization
         std::vector<bool> outlier_flags;
         Mat44_t optimized_pose;
-        auto num_valid_obs = pose_optimizer_->optimize(pnp_solver->get_best_cam_pose(), cur_keyfrm_->frm_obs_, cur_keyfrm_->orb_params_, cur_keyfrm_->camera_,
+        auto num_valid_obs = pose_optimizer_->optimize(pnp_solver->get_best_cam_pose(), *cur_keyfrm_->frm_obs_, cur_keyfrm_->orb_params_, cur_keyfrm_->camera_,
                                                        curr_match_lms_observed_in_cand, optimized_pose, outlier_flags);
 
         // Discard the candidate if the number of the inliers is less than the threshold
@@ -457,7 +468,7 @@ bool loop_detector::select_loop_candidate_via_Sim3(const std::unordered_set<std:
         }
 
         // Reject outliers
-        for (unsigned int idx = 0; idx < cur_keyfrm_->frm_obs_.undist_keypts_.size(); idx++) {
+        for (unsigned int idx = 0; idx < cur_keyfrm_->frm_obs_->undist_keypts_.size(); idx++) {
             if (!outlier_flags.at(idx)) {
                 continue;
             }
@@ -474,7 +485,7 @@ bool loop_detector::select_loop_candidate_via_Sim3(const std::unordered_set<std:
         }
 
         // Projection match based on the pre-optimized camera pose
-        auto num_found = projection_matcher.match_frame_and_keyframe(optimized_pose, cur_keyfrm_->camera_, cur_keyfrm_->frm_obs_,
+        auto num_found = projection_matcher.match_frame_and_keyframe(optimized_pose, cur_keyfrm_->camera_, *cur_keyfrm_->frm_obs_,
                                                                      cur_keyfrm_->orb_params_, curr_match_lms_observed_in_cand,
                                                                      candidate, already_found_landmarks, 10, 100);
         // Discard the candidate if the number of the inliers is less than the threshold
@@ -488,7 +499,7 @@ bool loop_detector::select_loop_candidate_via_Sim3(const std::unordered_set<std:
         Mat44_t optimized_pose1;
         std::vector<bool> outlier_flags1;
         auto num_valid_obs1 = pose_optimizer_->optimize(optimized_pose,
-                                                        cur_keyfrm_->frm_obs_, cur_keyfrm_->orb_params_, cur_keyfrm_->camera_,
+                                                        *cur_keyfrm_->frm_obs_, cur_keyfrm_->orb_params_, cur_keyfrm_->camera_,
                                                         curr_match_lms_observed_in_cand, optimized_pose1, outlier_flags1);
 
         if (num_valid_obs1 < min_num_valid_obs1) {
@@ -498,14 +509,14 @@ bool loop_detector::select_loop_candidate_via_Sim3(const std::unordered_set<std:
 
         // Exclude the already-associated landmarks
         std::set<std::shared_ptr<data::landmark>> already_found_landmarks1;
-        for (unsigned int idx = 0; idx < cur_keyfrm_->frm_obs_.undist_keypts_.size(); ++idx) {
+        for (unsigned int idx = 0; idx < cur_keyfrm_->frm_obs_->undist_keypts_.size(); ++idx) {
             if (!curr_match_lms_observed_in_cand.at(idx)) {
                 continue;
             }
             already_found_landmarks1.insert(curr_match_lms_observed_in_cand.at(idx));
         }
         // Apply projection match again, then set the 2D-3D matches
-        auto num_additional = projection_matcher.match_frame_and_keyframe(optimized_pose1, cur_keyfrm_->camera_, cur_keyfrm_->frm_obs_,
+        auto num_additional = projection_matcher.match_frame_and_keyframe(optimized_pose1, cur_keyfrm_->camera_, *cur_keyfrm_->frm_obs_,
                                                                           cur_keyfrm_->orb_params_, curr_match_lms_observed_in_cand,
                                                                           candidate, already_found_landmarks, 3, 64);
 
@@ -520,7 +531,7 @@ bool loop_detector::select_loop_candidate_via_Sim3(const std::unordered_set<std:
         Mat44_t optimized_pose2;
         std::vector<bool> outlier_flags2;
         auto num_valid_obs2 = pose_optimizer_->optimize(optimized_pose1,
-                                                        cur_keyfrm_->frm_obs_, cur_keyfrm_->orb_params_, cur_keyfrm_->camera_,
+                                                        *cur_keyfrm_->frm_obs_, cur_keyfrm_->orb_params_, cur_keyfrm_->camera_,
                                                         curr_match_lms_observed_in_cand, optimized_pose2, outlier_flags2);
 
         // Discard if falling below the threshold
@@ -530,7 +541,7 @@ bool loop_detector::select_loop_candidate_via_Sim3(const std::unordered_set<std:
         }
 
         // Reject outliers
-        for (unsigned int idx = 0; idx < cur_keyfrm_->frm_obs_.undist_keypts_.size(); ++idx) {
+        for (unsigned int idx = 0; idx < cur_keyfrm_->frm_obs_->undist_keypts_.size(); ++idx) {
             if (!outlier_flags2.at(idx)) {
                 continue;
             }
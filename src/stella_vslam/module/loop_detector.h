@@ -44,6 +44,12 @@ public:
      */
     bool is_enabled() const;
 
+    /**
+     * Update the thresholds (num_final_matches_threshold, min_continuity) given in the node
+     * (NOTE: call it while the loop detection is not running)
+     */
+    void update_parameters(const YAML::Node& yaml_node);
+
     /**
      * Set the current keyframe
      */
@@ -138,10 +144,10 @@ private:
     const bool fix_scale_in_Sim3_estimation_;
 
     //! the threshold of the number of mutual matches after the Sim3 estimation
-    const unsigned int num_final_matches_thr_;
+    unsigned int num_final_matches_thr_;
 
     //! the threshold of the continuity of continuously detected keyframe set
-    const unsigned int min_continuity_;
+    unsigned int min_continuity_;
 
     //-----------------------------------------
     // Parameters
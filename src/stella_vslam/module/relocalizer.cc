@@ -1,5 +1,6 @@
 #include "stella_vslam/data/frame.h"
 #include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/keyframe_region.h"
 #include "stella_vslam/data/landmark.h"
 #include "stella_vslam/data/bow_database.h"
 #include "stella_vslam/module/local_map_updater.h"
@@ -53,19 +54,21 @@ relocalizer::~relocalizer() {
     spdlog::debug("DESTRUCT: module::relocalizer");
 }
 
-bool relocalizer::relocalize(data::bow_database* bow_db, data::frame& curr_frm) {
-    // Acquire relocalization candidates
-    const auto reloc_candidates = bow_db->acquire_keyframes(curr_frm.bow_vec_, 0.0f, num_common_words_thr_ratio_);
+bool relocalizer::relocalize(data::bow_database* bow_db, data::frame& curr_frm,
+                             const data::keyframe_region* region) {
+    // Acquire relocalization candidates (in the region if given)
+    const auto reloc_candidates = bow_db->acquire_keyframes(curr_frm.bow_vec_, 0.0f, num_common_words_thr_ratio_, {}, region);
     if (reloc_candidates.empty()) {
         return false;
     }
 
-    return reloc_by_candidates(curr_frm, reloc_candidates);
+    return reloc_by_candidates(curr_frm, reloc_candidates, false, region);
 }
 
 bool relocalizer::reloc_by_candidates(data::frame& curr_frm,
                                       const std::vector<std::shared_ptr<stella_vslam::data::keyframe>>& reloc_candidates,
-                                      bool use_robust_matcher) {
+                                      bool use_robust_matcher,
+                                      const data::keyframe_region* region) {
     const auto num_candidates = reloc_candidates.size();
 
     spdlog::debug("Start relocalization. Number of candidate keyframes is {}", num_candidates);
@@ -78,10 +81,10 @@ bool relocalizer::reloc_by_candidates(data::frame& curr_frm,
             continue;
         }
 
-        bool ok = reloc_by_candidate(curr_frm, candidate_keyfrm, use_robust_matcher);
+        bool ok = reloc_by_candidate(curr_frm, candidate_keyfrm, use_robust_matcher, region);
         if (ok) {
             spdlog::info("relocalization succeeded (frame={}, keyframe={})", curr_frm.id_, candidate_keyfrm->id_);
-            // TODO: should set the reference keyframe of the current frame
+            curr_frm.ref_keyfrm_ = candidate_keyfrm;
             return true;
         }
     }
@@ -92,14 +95,21 @@ bool relocalizer::reloc_by_candidates(data::frame& curr_frm,
 
 bool relocalizer::reloc_by_candidate(data::frame& curr_frm,
                                      const std::shared_ptr<stella_vslam::data::keyframe>& candidate_keyfrm,
-                                     bool use_robust_matcher) {
+                                     bool use_robust_matcher,
+                                     const data::keyframe_region* region) {
     std::vector<unsigned int> inlier_indices;
     std::vector<std::shared_ptr<data::landmark>> matched_landmarks;
-    bool ok = relocalize_by_pnp_solver(curr_frm, candidate_keyfrm, use_robust_matcher, inlier_indices, matched_landmarks);
+    bool ok = relocalize_by_pnp_solver(curr_frm, candidate_keyfrm, use_robust_matcher, inlier_indices, matched_landmarks, region);
     if (!ok) {
         return false;
     }
 
+    // Reject the aliased candidate whose PnP solution is outside of the region before the costly refinement
+    if (region && !region->contains(curr_frm.get_trans_wc())) {
+        spdlog::debug("estimated pose is outside of the region. candidate keyframe id is {}", candidate_keyfrm->id_);
+        return false;
+    }
+
     // Set 2D-3D matches for the pose optimization
     curr_frm.erase_landmarks();
     for (const auto idx : inlier_indices) {
@@ -135,7 +145,8 @@ bool relocalizer::relocalize_by_pnp_solver(data::frame& curr_frm,
                                            const std::shared_ptr<stella_vslam::data::keyframe>& candidate_keyfrm,
                                            bool use_robust_matcher,
                                            std::vector<unsigned int>& inlier_indices,
-                                           std::vector<std::shared_ptr<data::landmark>>& matched_landmarks) const {
+                                           std::vector<std::shared_ptr<data::landmark>>& matched_landmarks,
+                                           const data::keyframe_region* region) const {
     const auto num_matches = use_robust_matcher ? robust_matcher_.match_frame_and_keyframe(curr_frm, candidate_keyfrm, matched_landmarks)
                                                 : bow_matcher_.match_frame_and_keyframe(candidate_keyfrm, curr_frm, matched_landmarks);
     // Discard the candidate if the number of 2D-3D matches is less than the threshold
@@ -159,6 +170,9 @@ bool relocalizer::relocalize_by_pnp_solver(data::frame& curr_frm,
         }
 
         for (const auto& ngh_keyfrm : ngh_keyfrms) {
+            if (region && !region->contains(ngh_keyfrm)) {
+                continue;
+            }
             std::vector<std::shared_ptr<data::landmark>> additional_matched_landmarks;
             const auto num_additional_matches = use_robust_matcher ? robust_matcher_.match_frame_and_keyframe(curr_frm, ngh_keyfrm, additional_matched_landmarks)
                                                                    : bow_matcher_.match_frame_and_keyframe(ngh_keyfrm, curr_frm, additional_matched_landmarks);
@@ -189,7 +203,7 @@ bool relocalizer::relocalize_by_pnp_solver(data::frame& curr_frm,
 
     // Setup an PnP solver with the current 2D-3D matches
     const auto valid_indices = extract_valid_indices(matched_landmarks);
-    auto pnp_solver = setup_pnp_solver(valid_indices, curr_frm.frm_obs_.bearings_, curr_frm.frm_obs_.undist_keypts_,
+    auto pnp_solver = setup_pnp_solver(valid_indices, curr_frm.frm_obs_->bearings_, curr_frm.frm_obs_->undist_keypts_,
                                        matched_landmarks, curr_frm.orb_params_->scale_factors_);
 
     // 1. Estimate the camera pose using EPnP (+ RANSAC)
@@ -223,7 +237,7 @@ bool relocalizer::optimize_pose(data::frame& curr_frm,
     }
 
     // Reject outliers
-    for (unsigned int idx = 0; idx < curr_frm.frm_obs_.undist_keypts_.size(); idx++) {
+    for (unsigned int idx = 0; idx < curr_frm.frm_obs_->undist_keypts_.size(); idx++) {
         if (!outlier_flags.at(idx)) {
             continue;
         }
@@ -256,7 +270,7 @@ bool relocalizer::refine_pose(data::frame& curr_frm,
 
     // Exclude the already-associated landmarks
     std::set<std::shared_ptr<data::landmark>> already_found_landmarks1;
-    for (unsigned int idx = 0; idx < curr_frm.frm_obs_.undist_keypts_.size(); ++idx) {
+    for (unsigned int idx = 0; idx < curr_frm.frm_obs_->undist_keypts_.size(); ++idx) {
         const auto& lm = curr_frm.get_landmark(idx);
         if (!lm) {
             continue;
@@ -286,7 +300,7 @@ bool relocalizer::refine_pose(data::frame& curr_frm,
     }
 
     // Reject outliers
-    for (unsigned int idx = 0; idx < curr_frm.frm_obs_.undist_keypts_.size(); ++idx) {
+    for (unsigned int idx = 0; idx < curr_frm.frm_obs_->undist_keypts_.size(); ++idx) {
         if (!outlier_flags2.at(idx)) {
             continue;
         }
@@ -367,7 +381,7 @@ bool relocalizer::refine_pose_by_local_map(data::frame& curr_frm,
         curr_frm.set_pose_cw(optimized_pose);
 
         // Reject outliers
-        for (unsigned int idx = 0; idx < curr_frm.frm_obs_.undist_keypts_.size(); ++idx) {
+        for (unsigned int idx = 0; idx < curr_frm.frm_obs_->undist_keypts_.size(); ++idx) {
             if (!outlier_flags.at(idx)) {
                 continue;
             }
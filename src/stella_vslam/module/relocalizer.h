@@ -14,6 +14,7 @@ namespace stella_vslam {
 namespace data {
 class frame;
 class bow_database;
+class keyframe_region;
 } // namespace data
 
 namespace module {
@@ -38,20 +39,25 @@ public:
     virtual ~relocalizer();
 
     //! Relocalize the specified frame
-    bool relocalize(data::bow_database* bow_db, data::frame& curr_frm);
+    //! (if the region is given, the candidates and the estimated pose are restricted to it)
+    bool relocalize(data::bow_database* bow_db, data::frame& curr_frm,
+                    const data::keyframe_region* region = nullptr);
 
     //! Relocalize the specified frame by given candidates list
     bool reloc_by_candidates(data::frame& curr_frm,
                              const std::vector<std::shared_ptr<stella_vslam::data::keyframe>>& reloc_candidates,
-                             bool use_robust_matcher = false);
+                             bool use_robust_matcher = false,
+                             const data::keyframe_region* region = nullptr);
     bool reloc_by_candidate(data::frame& curr_frm,
                             const std::shared_ptr<stella_vslam::data::keyframe>& candidate_keyfrm,
-                            bool use_robust_matcher);
+                            bool use_robust_matcher,
+                            const data::keyframe_region* region = nullptr);
     bool relocalize_by_pnp_solver(data::frame& curr_frm,
                                   const std::shared_ptr<stella_vslam::data::keyframe>& candidate_keyfrm,
                                   bool use_robust_matcher,
                                   std::vector<unsigned int>& inlier_indices,
-                                  std::vector<std::shared_ptr<data::landmark>>& matched_landmarks) const;
+                                  std::vector<std::shared_ptr<data::landmark>>& matched_landmarks,
+                                  const data::keyframe_region* region = nullptr) const;
     bool optimize_pose(data::frame& curr_frm,
                        const std::shared_ptr<stella_vslam::data::keyframe>& candidate_keyfrm,
                        std::vector<bool>& outlier_flags) const;
@@ -0,0 +1,281 @@
+#include "stella_vslam/camera/base.h"
+#include "stella_vslam/data/frame.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/module/sparse_image_aligner.h"
+#include "stella_vslam/benchmark/timer.h"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+namespace stella_vslam {
+namespace module {
+
+namespace {
+
+//! Bilinear interpolation of the intensity (the point must be inside the image by one pixel)
+inline float interpolate(const cv::Mat& img, const float x, const float y) {
+    const int ix = static_cast<int>(x);
+    const int iy = static_cast<int>(y);
+    const float dx = x - ix;
+    const float dy = y - iy;
+    const unsigned char* row_0 = img.ptr<unsigned char>(iy) + ix;
+    const unsigned char* row_1 = img.ptr<unsigned char>(iy + 1) + ix;
+    return (1.0f - dy) * ((1.0f - dx) * row_0[0] + dx * row_0[1])
+           + dy * ((1.0f - dx) * row_1[0] + dx * row_1[1]);
+}
+
+//! Check whether the patch around the point fits in the image (including the margin for the gradient)
+inline bool patch_is_inside(const cv::Mat& img, const float x, const float y, const int half_patch_size) {
+    constexpr int margin = 2;
+    return half_patch_size + margin <= x && x < img.cols - half_patch_size - margin
+           && half_patch_size + margin <= y && y < img.rows - half_patch_size - margin;
+}
+
+//! Exponential map of se(3), in the order of (translation, rotation)
+Mat44_t exp_se3(const Vec6_t& xi) {
+    Mat44_t transform = Mat44_t::Identity();
+    const Vec3_t omega = xi.tail<3>();
+    const double theta = omega.norm();
+    if (theta < 1e-10) {
+        transform.block<3, 3>(0, 0) = Mat33_t::Identity();
+    }
+    else {
+        transform.block<3, 3>(0, 0) = Eigen::AngleAxisd(theta, omega / theta).toRotationMatrix();
+    }
+    // first order approximation of the translation, which is enough for the small increments
+    transform.block<3, 1>(0, 3) = xi.head<3>();
+    return transform;
+}
+
+inline Mat44_t inverse_pose(const Mat44_t& pose) {
+    Mat44_t inv = Mat44_t::Identity();
+    inv.block<3, 3>(0, 0) = pose.block<3, 3>(0, 0).transpose();
+    inv.block<3, 1>(0, 3) = -pose.block<3, 3>(0, 0).transpose() * pose.block<3, 1>(0, 3);
+    return inv;
+}
+
+} // namespace
+
+sparse_image_aligner::sparse_image_aligner(const camera::base* camera, const unsigned int max_level, const unsigned int min_level,
+                                           const unsigned int max_num_iter, const unsigned int min_num_valid_patches,
+                                           const float huber_thr)
+    : camera_(camera), max_level_(max_level), min_level_(min_level), max_num_iter_(max_num_iter),
+      min_num_valid_patches_(min_num_valid_patches), huber_thr_(huber_thr) {}
+
+sparse_image_aligner::sparse_image_aligner(const camera::base* camera, const YAML::Node& yaml_node)
+    : sparse_image_aligner(camera,
+                           yaml_node["max_level"].as<unsigned int>(5),
+                           yaml_node["min_level"].as<unsigned int>(1),
+                           yaml_node["max_num_iter"].as<unsigned int>(10),
+                           yaml_node["min_num_valid_patches"].as<unsigned int>(20),
+                           yaml_node["huber_threshold"].as<float>(15.0)) {}
+
+bool sparse_image_aligner::align(const data::frame& curr_frm, const data::frame& last_frm, Mat44_t& velocity) const {
+    STELLA_BENCHMARK_TIMER("module::sparse_image_aligner", "align");
+
+    const auto& curr_image_pyramid = curr_frm.get_image_pyramid();
+    const auto& last_image_pyramid = last_frm.get_image_pyramid();
+    const auto& last_keypts = last_frm.get_keypoints();
+    if (curr_image_pyramid.empty() || last_image_pyramid.empty() || !last_frm.pose_is_valid()) {
+        return false;
+    }
+    if (last_keypts.size() != last_frm.frm_obs_->undist_keypts_.size()) {
+        return false;
+    }
+
+    // collect the tracked landmarks of the last frame
+    const Mat33_t rot_cw = last_frm.get_rot_cw();
+    const Vec3_t trans_cw = last_frm.get_trans_cw();
+    eigen_alloc_vector<Vec3_t> pos_refs;
+    eigen_alloc_vector<Vec2_t> undist_pts;
+    eigen_alloc_vector<Vec2_t> dist_pts;
+    const auto landmarks = last_frm.get_landmarks();
+    for (unsigned int idx = 0; idx < landmarks.size(); ++idx) {
+        const auto& lm = landmarks.at(idx);
+        if (!lm || lm->will_be_erased()) {
+            continue;
+        }
+        const Vec3_t pos_ref = rot_cw * lm->get_pos_in_world() + trans_cw;
+        Vec2_t undist_pt;
+        if (!project(pos_ref, undist_pt)) {
+            continue;
+        }
+        pos_refs.push_back(pos_ref);
+        undist_pts.push_back(undist_pt);
+        const auto& dist_pt = last_keypts.at(idx).pt;
+        dist_pts.emplace_back(dist_pt.x, dist_pt.y);
+    }
+    if (pos_refs.size() < min_num_valid_patches_) {
+        return false;
+    }
+
+    const auto num_levels = std::min(curr_image_pyramid.size(), last_image_pyramid.size());
+    const unsigned int max_level = std::min<unsigned int>(max_level_, num_levels - 1);
+    const unsigned int min_level = std::min(min_level_, max_level);
+
+    // coarse-to-fine
+    Mat44_t aligned_velocity = velocity;
+    for (int level = max_level; static_cast<int>(min_level) <= level; --level) {
+        const float scale_factor = last_frm.orb_params_->scale_factors_.at(level);
+        if (!align_at_level(curr_image_pyramid.at(level), last_image_pyramid.at(level), scale_factor,
+                            pos_refs, undist_pts, dist_pts, aligned_velocity)) {
+            SPDLOG_TRACE("sparse image alignment failed at level {}", level);
+            return false;
+        }
+    }
+
+    velocity = aligned_velocity;
+    return true;
+}
+
+bool sparse_image_aligner::project(const Vec3_t& pos_c, Vec2_t& pt) const {
+    float x_right;
+    return camera_->reproject_to_image(Mat33_t::Identity(), Vec3_t::Zero(), pos_c, pt, x_right);
+}
+
+bool sparse_image_aligner::align_at_level(const cv::Mat& curr_img, const cv::Mat& last_img, const float scale_factor,
+                                          const eigen_alloc_vector<Vec3_t>& pos_refs, const eigen_alloc_vector<Vec2_t>& undist_pts,
+                                          const eigen_alloc_vector<Vec2_t>& dist_pts, Mat44_t& velocity) const {
+    constexpr int half_patch_size = patch_size_ / 2;
+    const float inv_scale_factor = 1.0 / scale_factor;
+
+    // precompute the reference patches and their Jacobians (inverse compositional)
+    eigen_alloc_vector<patch> patches;
+    patches.reserve(pos_refs.size());
+    for (unsigned int i = 0; i < pos_refs.size(); ++i) {
+        const float x = dist_pts.at(i)(0) * inv_scale_factor;
+        const float y = dist_pts.at(i)(1) * inv_scale_factor;
+        if (!patch_is_inside(last_img, x, y, half_patch_size)) {
+            continue;
+        }
+
+        // Jacobian of the projection by central differences, since the camera models provide no analytical one
+        const Vec3_t& pos_ref = pos_refs.at(i);
+        const double eps = 1e-4 * pos_ref.norm();
+        Eigen::Matrix<double, 2, 3> proj_jacobian;
+        bool jacobian_is_valid = true;
+        for (unsigned int axis = 0; axis < 3 && jacobian_is_valid; ++axis) {
+            Vec3_t delta = Vec3_t::Zero();
+            delta(axis) = eps;
+            Vec2_t pt_plus, pt_minus;
+            jacobian_is_valid = project(pos_ref + delta, pt_plus) && project(pos_ref - delta, pt_minus);
+            proj_jacobian.col(axis) = (pt_plus - pt_minus) / (2.0 * eps);
+        }
+        if (!jacobian_is_valid) {
+            continue;
+        }
+
+        // d(exp(xi) * p)/d(xi) = [I | -[p]x]
+        Eigen::Matrix<double, 3, 6> point_jacobian;
+        point_jacobian.block<3, 3>(0, 0) = Mat33_t::Identity();
+        point_jacobian.block<3, 3>(0, 3) << 0.0, pos_ref(2), -pos_ref(1),
+            -pos_ref(2), 0.0, pos_ref(0),
+            pos_ref(1), -pos_ref(0), 0.0;
+        const Eigen::Matrix<double, 2, 6> pixel_jacobian = inv_scale_factor * proj_jacobian * point_jacobian;
+
+        patch ref_patch;
+        ref_patch.pos_ref_ = pos_ref;
+        ref_patch.dist_offset_ = dist_pts.at(i) - undist_pts.at(i);
+        unsigned int k = 0;
+        for (int v = -half_patch_size; v < half_patch_size; ++v) {
+            for (int u = -half_patch_size; u < half_patch_size; ++u, ++k) {
+                const float px = x + u;
+                const float py = y + v;
+                ref_patch.intensities_[k] = interpolate(last_img, px, py);
+                const double grad_x = 0.5 * (interpolate(last_img, px + 1.0f, py) - interpolate(last_img, px - 1.0f, py));
+                const double grad_y = 0.5 * (interpolate(last_img, px, py + 1.0f) - interpolate(last_img, px, py - 1.0f));
+                ref_patch.jacobians_[k] = (grad_x * pixel_jacobian.row(0) + grad_y * pixel_jacobian.row(1)).transpose();
+            }
+        }
+        patches.push_back(ref_patch);
+    }
+    if (patches.size() < min_num_valid_patches_) {
+        return false;
+    }
+
+    // Gauss-Newton
+    Mat66_t H;
+    Vec6_t b;
+    double chi_sq = 0.0;
+    if (compute_residuals(curr_img, scale_factor, patches, velocity, H, b, chi_sq) < min_num_valid_patches_) {
+        return false;
+    }
+    for (unsigned int iter = 0; iter < max_num_iter_; ++iter) {
+        const Vec6_t increment = H.ldlt().solve(b);
+        if (!increment.allFinite()) {
+            break;
+        }
+        const Mat44_t new_velocity = velocity * inverse_pose(exp_se3(increment));
+
+        Mat66_t new_H;
+        Vec6_t new_b;
+        double new_chi_sq = 0.0;
+        if (compute_residuals(curr_img, scale_factor, patches, new_velocity, new_H, new_b, new_chi_sq) < min_num_valid_patches_
+            || chi_sq < new_chi_sq) {
+            // the error increased, keep the last estimate
+            break;
+        }
+
+        velocity = new_velocity;
+        H = new_H;
+        b = new_b;
+        chi_sq = new_chi_sq;
+
+        if (increment.norm() < 1e-6) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+unsigned int sparse_image_aligner::compute_residuals(const cv::Mat& curr_img, const float scale_factor,
+                                                     const eigen_alloc_vector<patch>& patches, const Mat44_t& velocity,
+                                                     Mat66_t& H, Vec6_t& b, double& chi_sq) const {
+    constexpr int half_patch_size = patch_size_ / 2;
+    const float inv_scale_factor = 1.0 / scale_factor;
+    const Mat33_t rot = velocity.block<3, 3>(0, 0);
+    const Vec3_t trans = velocity.block<3, 1>(0, 3);
+
+    H.setZero();
+    b.setZero();
+    chi_sq = 0.0;
+    unsigned int num_valid_patches = 0;
+    unsigned int num_residuals = 0;
+    for (const auto& ref_patch : patches) {
+        Vec2_t undist_pt;
+        if (!project(rot * ref_patch.pos_ref_ + trans, undist_pt)) {
+            continue;
+        }
+        const Vec2_t dist_pt = undist_pt + ref_patch.dist_offset_;
+        const float x = dist_pt(0) * inv_scale_factor;
+        const float y = dist_pt(1) * inv_scale_factor;
+        if (!patch_is_inside(curr_img, x, y, half_patch_size)) {
+            continue;
+        }
+
+        unsigned int k = 0;
+        for (int v = -half_patch_size; v < half_patch_size; ++v) {
+            for (int u = -half_patch_size; u < half_patch_size; ++u, ++k) {
+                const double residual = interpolate(curr_img, x + u, y + v) - ref_patch.intensities_[k];
+                const double abs_residual = std::abs(residual);
+                const double weight = abs_residual < huber_thr_ ? 1.0 : huber_thr_ / abs_residual;
+                const auto& jacobian = ref_patch.jacobians_[k];
+                H.noalias() += weight * jacobian * jacobian.transpose();
+                b.noalias() += weight * residual * jacobian;
+                chi_sq += weight * residual * residual;
+            }
+        }
+        num_residuals += patch_area_;
+        ++num_valid_patches;
+    }
+
+    if (0 < num_residuals) {
+        chi_sq /= num_residuals;
+    }
+    return num_valid_patches;
+}
+
+} // namespace module
+} // namespace stella_vslam
@@ -0,0 +1,94 @@
+#ifndef STELLA_VSLAM_MODULE_SPARSE_IMAGE_ALIGNER_H
+#define STELLA_VSLAM_MODULE_SPARSE_IMAGE_ALIGNER_H
+
+#include "stella_vslam/type.h"
+
+#include <opencv2/core/mat.hpp>
+#include <yaml-cpp/yaml.h>
+
+namespace stella_vslam {
+
+namespace camera {
+class base;
+} // namespace camera
+
+namespace data {
+class frame;
+} // namespace data
+
+namespace module {
+
+/**
+ * Sparse direct image alignment (inverse compositional, coarse-to-fine)
+ * It estimates the relative pose between the last and current frames by minimizing the photometric error
+ * of small patches around the keypoints of the last frame which have the tracked landmarks.
+ * The image pyramids of the both frames are required (data::frame::get_image_pyramid()).
+ */
+class sparse_image_aligner {
+public:
+    explicit sparse_image_aligner(const camera::base* camera,
+                                  const unsigned int max_level = 5,
+                                  const unsigned int min_level = 1,
+                                  const unsigned int max_num_iter = 10,
+                                  const unsigned int min_num_valid_patches = 20,
+                                  const float huber_thr = 15.0);
+
+    explicit sparse_image_aligner(const camera::base* camera, const YAML::Node& yaml_node);
+
+    /**
+     * Refine the relative pose from the last frame to the current frame
+     * @param curr_frm
+     * @param last_frm
+     * @param velocity the relative pose (pose_cw of curr_frm = velocity * pose_cw of last_frm), initial guess is used
+     * @return true if the alignment succeeded
+     */
+    bool align(const data::frame& curr_frm, const data::frame& last_frm, Mat44_t& velocity) const;
+
+private:
+    //! patch size (in pixels) used at each level
+    static constexpr int patch_size_ = 4;
+    static constexpr int patch_area_ = patch_size_ * patch_size_;
+
+    //! A patch around the keypoint of the last frame
+    struct patch {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        //! 3D point in the camera coordinates of the last frame
+        Vec3_t pos_ref_;
+        //! distorted minus undistorted keypoint position (assumed to be locally constant)
+        Vec2_t dist_offset_;
+        //! intensities and Jacobians w.r.t. the inverse compositional increment
+        float intensities_[patch_area_];
+        VecR_t<6> jacobians_[patch_area_];
+    };
+
+    //! Project the point in the camera coordinates onto the (undistorted) image
+    bool project(const Vec3_t& pos_c, Vec2_t& pt) const;
+
+    //! Align at the given pyramid level
+    bool align_at_level(const cv::Mat& curr_img, const cv::Mat& last_img, const float scale_factor,
+                        const eigen_alloc_vector<Vec3_t>& pos_refs, const eigen_alloc_vector<Vec2_t>& undist_pts,
+                        const eigen_alloc_vector<Vec2_t>& dist_pts, Mat44_t& velocity) const;
+
+    //! Compute the photometric error of the patches with the given relative pose
+    unsigned int compute_residuals(const cv::Mat& curr_img, const float scale_factor,
+                                   const eigen_alloc_vector<patch>& patches, const Mat44_t& velocity,
+                                   Mat66_t& H, Vec6_t& b, double& chi_sq) const;
+
+    const camera::base* camera_;
+
+    //! coarsest/finest pyramid level used for the alignment
+    const unsigned int max_level_;
+    const unsigned int min_level_;
+    //! maximum number of Gauss-Newton iterations at each level
+    const unsigned int max_num_iter_;
+    //! minimum number of patches to accept the alignment
+    const unsigned int min_num_valid_patches_;
+    //! threshold of the photometric error for the Huber weight
+    const float huber_thr_;
+};
+
+} // namespace module
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_MODULE_SPARSE_IMAGE_ALIGNER_H
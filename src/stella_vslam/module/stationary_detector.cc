@@ -0,0 +1,92 @@
+#include "stella_vslam/module/stationary_detector.h"
+#include "stella_vslam/util/image_converter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <opencv2/imgproc.hpp>
+#include <spdlog/spdlog.h>
+
+namespace stella_vslam {
+namespace module {
+
+stationary_detector::stationary_detector(const unsigned int downscale,
+                                         const double mean_abs_diff_thr,
+                                         const unsigned int max_num_skipped_frames,
+                                         const bool use_motion_prior,
+                                         const double motion_rot_thr_deg,
+                                         const double motion_trans_thr)
+    : downscale_(std::max(1u, downscale)),
+      mean_abs_diff_thr_(mean_abs_diff_thr),
+      max_num_skipped_frames_(max_num_skipped_frames),
+      use_motion_prior_(use_motion_prior),
+      motion_rot_thr_rad_(motion_rot_thr_deg * M_PI / 180.0),
+      motion_trans_thr_(motion_trans_thr) {
+    spdlog::debug("CONSTRUCT: module::stationary_detector");
+}
+
+stationary_detector::stationary_detector(const YAML::Node& yaml_node)
+    : stationary_detector(yaml_node["downscale"].as<unsigned int>(8),
+                          yaml_node["mean_abs_diff_thr"].as<double>(2.0),
+                          yaml_node["max_num_skipped_frames"].as<unsigned int>(15),
+                          yaml_node["use_motion_prior"].as<bool>(true),
+                          yaml_node["motion_rot_thr_deg"].as<double>(0.1),
+                          yaml_node["motion_trans_thr"].as<double>(0.002)) {}
+
+bool stationary_detector::is_stationary(const cv::Mat& img, const camera::color_order_t color_order,
+                                        const bool can_skip, const Mat44_t* twist) {
+    cv::Mat thumbnail = create_thumbnail(img, color_order);
+
+    bool stationary = can_skip
+                      && !ref_thumbnail_.empty()
+                      && num_consecutive_skips_ < max_num_skipped_frames_;
+    if (stationary && use_motion_prior_) {
+        stationary = twist && motion_is_small(*twist);
+    }
+    if (stationary) {
+        stationary = compute_mean_abs_diff(ref_thumbnail_, thumbnail) < mean_abs_diff_thr_;
+    }
+
+    if (stationary) {
+        ++num_consecutive_skips_;
+        ++num_skipped_frames_;
+    }
+    else {
+        // The frame is processed, so compare the following frames with it
+        ref_thumbnail_ = thumbnail;
+        num_consecutive_skips_ = 0;
+    }
+    return stationary;
+}
+
+double stationary_detector::compute_mean_abs_diff(const cv::Mat& img1, const cv::Mat& img2) {
+    if (img1.size() != img2.size() || img1.type() != img2.type() || img1.empty()) {
+        return std::numeric_limits<double>::max();
+    }
+    cv::Mat abs_diff;
+    cv::absdiff(img1, img2, abs_diff);
+    return cv::mean(abs_diff)[0];
+}
+
+void stationary_detector::reset() {
+    ref_thumbnail_ = cv::Mat();
+    num_consecutive_skips_ = 0;
+}
+
+cv::Mat stationary_detector::create_thumbnail(const cv::Mat& img, const camera::color_order_t color_order) const {
+    // Downscale before the color conversion to keep the cost independent of the input size
+    cv::Mat thumbnail;
+    cv::resize(img, thumbnail, cv::Size(), 1.0 / downscale_, 1.0 / downscale_, cv::INTER_AREA);
+    util::convert_to_grayscale(thumbnail, color_order);
+    return thumbnail;
+}
+
+bool stationary_detector::motion_is_small(const Mat44_t& twist) const {
+    const Eigen::AngleAxisd angle_axis(Mat33_t(twist.block<3, 3>(0, 0)));
+    const double trans = twist.block<3, 1>(0, 3).norm();
+    return std::abs(angle_axis.angle()) < motion_rot_thr_rad_ && trans < motion_trans_thr_;
+}
+
+} // namespace module
+} // namespace stella_vslam
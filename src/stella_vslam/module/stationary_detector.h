@@ -0,0 +1,82 @@
+#ifndef STELLA_VSLAM_MODULE_STATIONARY_DETECTOR_H
+#define STELLA_VSLAM_MODULE_STATIONARY_DETECTOR_H
+
+#include "stella_vslam/type.h"
+#include "stella_vslam/camera/base.h"
+
+#include <opencv2/core/mat.hpp>
+#include <yaml-cpp/yaml.h>
+
+namespace stella_vslam {
+namespace module {
+
+/**
+ * Detect the frames in which the scene does not change from the last processed frame,
+ * by comparing the heavily downscaled images, so that the feature extraction and the tracking are skipped.
+ * The reference image is updated only when the frame is processed,
+ * so that the slow changes are not accumulated over the skipped frames.
+ */
+class stationary_detector {
+public:
+    //! Constructor
+    stationary_detector(const unsigned int downscale = 8,
+                        const double mean_abs_diff_thr = 2.0,
+                        const unsigned int max_num_skipped_frames = 15,
+                        const bool use_motion_prior = true,
+                        const double motion_rot_thr_deg = 0.1,
+                        const double motion_trans_thr = 0.002);
+
+    //! Constructor
+    explicit stationary_detector(const YAML::Node& yaml_node);
+
+    /**
+     * Check if the frame can be skipped
+     * (if not, the frame is used as the new reference and must be processed)
+     * @param img input image (color or grayscale)
+     * @param color_order
+     * @param can_skip the tracker can reuse the last pose (e.g. it is tracking)
+     * @param twist motion model of the tracker (nullptr if unavailable, used only with the motion prior)
+     */
+    bool is_stationary(const cv::Mat& img, const camera::color_order_t color_order,
+                       const bool can_skip, const Mat44_t* twist = nullptr);
+
+    //! Compute the mean absolute difference of the downscaled images
+    static double compute_mean_abs_diff(const cv::Mat& img1, const cv::Mat& img2);
+
+    //! Get the number of the skipped frames in total
+    unsigned int get_num_skipped_frames() const { return num_skipped_frames_; }
+
+    //! Discard the reference image
+    void reset();
+
+    //! scale of the downscaled image (e.g. 8: 1/8 of the width and height)
+    const unsigned int downscale_;
+    //! threshold of the mean absolute difference of the intensities
+    const double mean_abs_diff_thr_;
+    //! max number of the consecutively skipped frames
+    const unsigned int max_num_skipped_frames_;
+    //! the motion model must also be small to skip the frame
+    const bool use_motion_prior_;
+    //! thresholds of the motion model (per frame)
+    const double motion_rot_thr_rad_;
+    const double motion_trans_thr_;
+
+private:
+    //! Create the downscaled grayscale image
+    cv::Mat create_thumbnail(const cv::Mat& img, const camera::color_order_t color_order) const;
+
+    //! Check the motion model is small enough
+    bool motion_is_small(const Mat44_t& twist) const;
+
+    //! downscaled image of the last processed frame
+    cv::Mat ref_thumbnail_;
+    //! number of the frames skipped after the last processed frame
+    unsigned int num_consecutive_skips_ = 0;
+    //! number of the skipped frames in total
+    unsigned int num_skipped_frames_ = 0;
+};
+
+} // namespace module
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_MODULE_STATIONARY_DETECTOR_H
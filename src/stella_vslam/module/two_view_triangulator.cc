@@ -16,28 +16,28 @@ two_view_triangulator::two_view_triangulator(const std::shared_ptr<data::keyfram
       cos_rays_parallax_thr_(std::cos(rays_parallax_deg_thr * M_PI / 180.0)) {}
 
 bool two_view_triangulator::triangulate(const unsigned idx_1, const unsigned int idx_2, Vec3_t& pos_w) const {
-    const auto& keypt_1 = keyfrm_1_->frm_obs_.undist_keypts_.at(idx_1);
-    const float keypt_1_x_right = keyfrm_1_->frm_obs_.stereo_x_right_.empty() ? -1.0f : keyfrm_1_->frm_obs_.stereo_x_right_.at(idx_1);
+    const auto& keypt_1 = keyfrm_1_->frm_obs_->undist_keypts_.at(idx_1);
+    const float keypt_1_x_right = keyfrm_1_->frm_obs_->stereo_x_right_.empty() ? -1.0f : keyfrm_1_->frm_obs_->stereo_x_right_.at(idx_1);
     const bool is_stereo_1 = 0 <= keypt_1_x_right;
 
-    const auto& keypt_2 = keyfrm_2_->frm_obs_.undist_keypts_.at(idx_2);
-    const float keypt_2_x_right = keyfrm_2_->frm_obs_.stereo_x_right_.empty() ? -1.0f : keyfrm_2_->frm_obs_.stereo_x_right_.at(idx_2);
+    const auto& keypt_2 = keyfrm_2_->frm_obs_->undist_keypts_.at(idx_2);
+    const float keypt_2_x_right = keyfrm_2_->frm_obs_->stereo_x_right_.empty() ? -1.0f : keyfrm_2_->frm_obs_->stereo_x_right_.at(idx_2);
     const bool is_stereo_2 = 0 <= keypt_2_x_right;
 
     // rays with reference of each camera
-    const Vec3_t ray_c_1 = keyfrm_1_->frm_obs_.bearings_.at(idx_1);
-    const Vec3_t ray_c_2 = keyfrm_2_->frm_obs_.bearings_.at(idx_2);
+    const Vec3_t ray_c_1 = keyfrm_1_->frm_obs_->bearings_.at(idx_1);
+    const Vec3_t ray_c_2 = keyfrm_2_->frm_obs_->bearings_.at(idx_2);
     // rays with the world reference
     const Vec3_t ray_w_1 = rot_w1_ * ray_c_1;
     const Vec3_t ray_w_2 = rot_w2_ * ray_c_2;
     const auto cos_rays_parallax = ray_w_1.dot(ray_w_2);
 
     // compute the stereo parallax if the keypoint is observed as stereo
-    const float depth_1 = keyfrm_1_->frm_obs_.depths_.empty() ? -1.0f : keyfrm_1_->frm_obs_.depths_.at(idx_1);
+    const float depth_1 = keyfrm_1_->frm_obs_->depths_.empty() ? -1.0f : keyfrm_1_->frm_obs_->depths_.at(idx_1);
     const auto cos_stereo_parallax_1 = is_stereo_1
                                            ? std::cos(2.0 * atan2(camera_1_->true_baseline_ / 2.0, depth_1))
                                            : 2.0;
-    const float depth_2 = keyfrm_2_->frm_obs_.depths_.empty() ? -1.0f : keyfrm_2_->frm_obs_.depths_.at(idx_2);
+    const float depth_2 = keyfrm_2_->frm_obs_->depths_.empty() ? -1.0f : keyfrm_2_->frm_obs_->depths_.at(idx_2);
     const auto cos_stereo_parallax_2 = is_stereo_2
                                            ? std::cos(2.0 * atan2(camera_2_->true_baseline_ / 2.0, depth_2))
                                            : 2.0;
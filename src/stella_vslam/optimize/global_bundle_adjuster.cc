@@ -10,6 +10,7 @@
 #include "stella_vslam/optimize/internal/se3/shot_vertex_container.h"
 #include "stella_vslam/optimize/internal/se3/reproj_edge_wrapper.h"
 #include "stella_vslam/util/converter.h"
+#include "stella_vslam/benchmark/timer.h"
 
 #include <g2o/core/solver.h>
 #include <g2o/core/block_solver.h>
@@ -109,8 +110,8 @@ void optimize_impl(g2o::SparseOptimizer& optimizer,
             }
 
             const auto keyfrm_vtx = keyfrm_vtx_container.get_vertex(keyfrm);
-            const auto& undist_keypt = keyfrm->frm_obs_.undist_keypts_.at(idx);
-            const float x_right = keyfrm->frm_obs_.stereo_x_right_.empty() ? -1.0f : keyfrm->frm_obs_.stereo_x_right_.at(idx);
+            const auto& undist_keypt = keyfrm->frm_obs_->undist_keypts_.at(idx);
+            const float x_right = keyfrm->frm_obs_->stereo_x_right_.empty() ? -1.0f : keyfrm->frm_obs_->stereo_x_right_.at(idx);
             const float inv_sigma_sq = keyfrm->orb_params_->inv_level_sigma_sq_.at(undist_keypt.octave);
             const auto sqrt_chi_sq = (keyfrm->camera_->setup_type_ == camera::setup_type_t::Monocular)
                                          ? sqrt_chi_sq_2D
@@ -284,6 +285,8 @@ bool global_bundle_adjuster::optimize(const std::vector<std::shared_ptr<data::ke
                                       eigen_alloc_unord_map<unsigned int, Mat44_t>& keyfrm_to_pose_cw_after_global_BA,
                                       eigen_alloc_unord_map<unsigned int, std::array<Vec3_t, 4>>& marker_to_pos_w_after_global_BA,
                                       bool* const force_stop_flag) const {
+    STELLA_BENCHMARK_TIMER("optimize::global_bundle_adjuster", "optimize");
+
     std::unordered_set<unsigned int> already_found_landmark_ids;
     std::vector<std::shared_ptr<data::landmark>> lms;
     for (const auto& keyfrm : keyfrms) {
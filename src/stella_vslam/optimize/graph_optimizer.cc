@@ -6,6 +6,7 @@
 #include "stella_vslam/optimize/internal/sim3/shot_vertex.h"
 #include "stella_vslam/optimize/internal/sim3/graph_opt_edge.h"
 #include "stella_vslam/util/converter.h"
+#include "stella_vslam/benchmark/timer.h"
 
 #include <Eigen/StdVector>
 #include <g2o/core/solver.h>
@@ -28,6 +29,8 @@ void graph_optimizer::optimize(const std::shared_ptr<data::keyframe>& loop_keyfr
                                const module::keyframe_Sim3_pairs_t& pre_corrected_Sim3s,
                                const std::map<std::shared_ptr<data::keyframe>, std::set<std::shared_ptr<data::keyframe>>>& loop_connections,
                                std::unordered_map<unsigned int, unsigned int>& found_lm_to_ref_keyfrm_id) const {
+    STELLA_BENCHMARK_TIMER("optimize::graph_optimizer", "optimize");
+
     // 1. Construct an optimizer
 
     auto linear_solver = stella_vslam::make_unique<g2o::LinearSolverCSparse<g2o::BlockSolver_7_3::PoseMatrixType>>();
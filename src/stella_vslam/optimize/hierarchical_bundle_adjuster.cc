@@ -0,0 +1,868 @@
+#include "stella_vslam/camera/base.h"
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/data/marker.h"
+#include "stella_vslam/optimize/hierarchical_bundle_adjuster.h"
+#include "stella_vslam/optimize/internal/landmark_vertex_container.h"
+#include "stella_vslam/optimize/internal/marker_vertex_container.h"
+#include "stella_vslam/optimize/internal/se3/shot_vertex_container.h"
+#include "stella_vslam/optimize/internal/se3/reproj_edge_wrapper.h"
+#include "stella_vslam/util/converter.h"
+#include "stella_vslam/benchmark/timer.h"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
+#include <g2o/core/solver.h>
+#include <g2o/core/block_solver.h>
+#include <g2o/core/sparse_optimizer.h>
+#include <g2o/core/robust_kernel_impl.h>
+#include <g2o/types/sba/types_six_dof_expmap.h>
+#include <g2o/solvers/csparse/linear_solver_csparse.h>
+#include <g2o/core/optimization_algorithm_levenberg.h>
+
+#include <Eigen/Sparse>
+
+#include <spdlog/spdlog.h>
+
+namespace stella_vslam {
+namespace optimize {
+
+namespace {
+
+//! number of iterations of the reduced separator problem
+constexpr unsigned int num_separator_iter = 3;
+
+//! estimates of the keyframes, the landmarks and the marker corners (keyed by ID)
+struct ba_estimates {
+    eigen_alloc_unord_map<unsigned int, Mat44_t> keyfrm_to_pose_cw_;
+    eigen_alloc_unord_map<unsigned int, Vec3_t> lm_to_pos_w_;
+    eigen_alloc_unord_map<unsigned int, std::array<Vec3_t, 4>> marker_to_pos_w_;
+};
+
+/**
+ * Keyframes, landmarks and markers of a submap
+ * The free variables are the interior keyframes and the landmarks owned by the submap.
+ * The separators and the markers are fixed.
+ */
+struct ba_subproblem {
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms_;
+    std::vector<std::shared_ptr<data::landmark>> lms_;
+    std::vector<std::shared_ptr<data::marker>> markers_;
+    std::unordered_set<unsigned int> fixed_keyfrm_ids_;
+    std::unordered_set<unsigned int> fixed_lm_ids_;
+    //! keyframes of the submap (their observations of the separator landmarks and the markers belong to this submap)
+    std::unordered_set<unsigned int> submap_keyfrm_ids_;
+};
+
+//! reprojection edge and the variables connected by it
+struct ba_edge {
+    g2o::OptimizableGraph::Edge* edge_;
+    std::shared_ptr<data::keyframe> keyfrm_;
+    //! landmark ID, or marker ID * 4 + corner ID
+    unsigned int point_id_;
+    bool is_marker_;
+};
+
+//! offsets of the separator variables in the reduced problem
+struct separator_indices {
+    std::unordered_map<unsigned int, unsigned int> keyfrm_id_to_offset_;
+    std::unordered_map<unsigned int, unsigned int> lm_id_to_offset_;
+    //! key: marker ID * 4 + corner ID
+    std::unordered_map<unsigned int, unsigned int> marker_corner_to_offset_;
+    unsigned int dim_ = 0;
+};
+
+//! Schur complement of a submap onto its separators
+struct reduced_system {
+    //! offset in the reduced problem and dimension of each separator variable (in the order of the rows)
+    std::vector<std::pair<unsigned int, unsigned int>> separator_offsets_;
+    MatX_t hessian_;
+    VecX_t gradient_;
+    //! robustified chi-squared error of the observations which belong to the submap
+    double chi_sq_ = 0.0;
+};
+
+//! normal equations of a reprojection edge
+struct linearized_edge {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    Mat66_t H_kk_;
+    MatRC_t<6, 3> H_kp_;
+    Mat33_t H_pp_;
+    Vec6_t g_k_;
+    Vec3_t g_p_;
+    double chi_sq_ = 0.0;
+    //! offsets in the system of the submap (-1 if constant)
+    int keyfrm_offset_ = -1;
+    int point_offset_ = -1;
+    //! index of the eliminated landmark (-1 if the point is not eliminated)
+    int eliminated_lm_idx_ = -1;
+};
+
+inline bool is_free_keyfrm(const ba_subproblem& subproblem, const std::shared_ptr<data::keyframe>& keyfrm) {
+    return !subproblem.fixed_keyfrm_ids_.count(keyfrm->id_) && !keyfrm->graph_node_->is_spanning_root();
+}
+
+/**
+ * Create the vertices and the edges of the subproblem at the estimates
+ * (the observations are restricted to the keyframes, the landmarks and the markers in the subproblem)
+ */
+std::vector<ba_edge> build_graph(const ba_subproblem& subproblem,
+                                 const ba_estimates& estimates,
+                                 const bool use_huber_kernel,
+                                 g2o::SparseOptimizer& optimizer,
+                                 internal::se3::shot_vertex_container& keyfrm_vtx_container,
+                                 internal::landmark_vertex_container& lm_vtx_container,
+                                 internal::marker_vertex_container& marker_vtx_container) {
+    for (const auto& keyfrm : subproblem.keyfrms_) {
+        auto keyfrm_vtx = keyfrm_vtx_container.create_vertex(keyfrm->id_, estimates.keyfrm_to_pose_cw_.at(keyfrm->id_),
+                                                             !is_free_keyfrm(subproblem, keyfrm));
+        optimizer.addVertex(keyfrm_vtx);
+    }
+
+    // Chi-squared value with significance level of 5%
+    // Two degree-of-freedom (n=2)
+    constexpr float chi_sq_2D = 5.99146;
+    const float sqrt_chi_sq_2D = std::sqrt(chi_sq_2D);
+    // Three degree-of-freedom (n=3)
+    constexpr float chi_sq_3D = 7.81473;
+    const float sqrt_chi_sq_3D = std::sqrt(chi_sq_3D);
+
+    using reproj_edge_wrapper = internal::se3::reproj_edge_wrapper<data::keyframe>;
+    std::vector<ba_edge> edges;
+    for (const auto& lm : subproblem.lms_) {
+        auto lm_vtx = lm_vtx_container.create_vertex(lm->id_, estimates.lm_to_pos_w_.at(lm->id_), subproblem.fixed_lm_ids_.count(lm->id_));
+        optimizer.addVertex(lm_vtx);
+
+        const auto num_edges = edges.size();
+        for (const auto& obs : lm->get_observations()) {
+            auto keyfrm = obs.first.lock();
+            const auto idx = obs.second;
+            if (!keyfrm || keyfrm->will_be_erased() || !keyfrm_vtx_container.contain(keyfrm)) {
+                continue;
+            }
+            const auto keyfrm_vtx = keyfrm_vtx_container.get_vertex(keyfrm);
+            const auto& undist_keypt = keyfrm->frm_obs_->undist_keypts_.at(idx);
+            const float x_right = keyfrm->frm_obs_->stereo_x_right_.empty() ? -1.0f : keyfrm->frm_obs_->stereo_x_right_.at(idx);
+            const float inv_sigma_sq = keyfrm->orb_params_->inv_level_sigma_sq_.at(undist_keypt.octave);
+            const auto sqrt_chi_sq = (keyfrm->camera_->setup_type_ == camera::setup_type_t::Monocular)
+                                         ? sqrt_chi_sq_2D
+                                         : sqrt_chi_sq_3D;
+            auto reproj_edge_wrap = reproj_edge_wrapper(keyfrm, keyfrm_vtx, lm, lm_vtx,
+                                                        idx, undist_keypt.pt.x, undist_keypt.pt.y, x_right,
+                                                        inv_sigma_sq, sqrt_chi_sq, use_huber_kernel);
+            optimizer.addEdge(reproj_edge_wrap.edge_);
+            edges.push_back(ba_edge{reproj_edge_wrap.edge_, keyfrm, lm->id_, false});
+        }
+
+        if (edges.size() == num_edges) {
+            optimizer.removeVertex(lm_vtx);
+        }
+    }
+
+    for (const auto& mkr : subproblem.markers_) {
+        const auto& corners_pos_w = estimates.marker_to_pos_w_.at(mkr->id_);
+        const auto corner_vertices = marker_vtx_container.create_vertices(mkr, true);
+        for (unsigned int corner_idx = 0; corner_idx < corner_vertices.size(); ++corner_idx) {
+            const auto corner_vtx = corner_vertices.at(corner_idx);
+            corner_vtx->setEstimate(corners_pos_w.at(corner_idx));
+            optimizer.addVertex(corner_vtx);
+
+            for (const auto& id_keyfrm : mkr->observations_) {
+                const auto& keyfrm = id_keyfrm.second;
+                if (!keyfrm || keyfrm->will_be_erased() || !keyfrm_vtx_container.contain(keyfrm)) {
+                    continue;
+                }
+                const auto keyfrm_vtx = keyfrm_vtx_container.get_vertex(keyfrm);
+                const auto& undist_pt = keyfrm->markers_2d_.at(mkr->id_).undist_corners_.at(corner_idx);
+                auto reproj_edge_wrap = reproj_edge_wrapper(keyfrm, keyfrm_vtx, nullptr, corner_vtx,
+                                                            0, undist_pt.x, undist_pt.y, -1.0,
+                                                            1.0, sqrt_chi_sq_2D, false);
+                optimizer.addEdge(reproj_edge_wrap.edge_);
+                edges.push_back(ba_edge{reproj_edge_wrap.edge_, keyfrm, mkr->id_ * 4 + corner_idx, true});
+            }
+        }
+    }
+
+    return edges;
+}
+
+/**
+ * Optimize the free variables of the subproblem, and return their estimates
+ */
+ba_estimates optimize_subproblem(const ba_subproblem& subproblem,
+                                 const ba_estimates& estimates,
+                                 const unsigned int num_iter,
+                                 const bool use_huber_kernel,
+                                 const bool verbose,
+                                 bool* const force_stop_flag) {
+    ba_estimates result;
+
+    auto linear_solver = stella_vslam::make_unique<g2o::LinearSolverCSparse<g2o::BlockSolver_6_3::PoseMatrixType>>();
+    auto block_solver = stella_vslam::make_unique<g2o::BlockSolver_6_3>(std::move(linear_solver));
+    auto algorithm = new g2o::OptimizationAlgorithmLevenberg(std::move(block_solver));
+
+    g2o::SparseOptimizer optimizer;
+    optimizer.setAlgorithm(algorithm);
+    if (force_stop_flag) {
+        optimizer.setForceStopFlag(force_stop_flag);
+    }
+
+    auto vtx_id_offset = std::make_shared<unsigned int>(0);
+    internal::se3::shot_vertex_container keyfrm_vtx_container(vtx_id_offset, subproblem.keyfrms_.size());
+    internal::landmark_vertex_container lm_vtx_container(vtx_id_offset, subproblem.lms_.size());
+    internal::marker_vertex_container marker_vtx_container(vtx_id_offset, subproblem.markers_.size());
+    const auto edges = build_graph(subproblem, estimates, use_huber_kernel, optimizer,
+                                   keyfrm_vtx_container, lm_vtx_container, marker_vtx_container);
+
+    std::unordered_set<unsigned int> optimized_lm_ids;
+    bool has_free_vertex = false;
+    for (const auto& edge : edges) {
+        has_free_vertex |= is_free_keyfrm(subproblem, edge.keyfrm_);
+        if (!edge.is_marker_ && !subproblem.fixed_lm_ids_.count(edge.point_id_)) {
+            optimized_lm_ids.insert(edge.point_id_);
+            has_free_vertex = true;
+        }
+    }
+    if (!has_free_vertex) {
+        return result;
+    }
+
+    optimizer.initializeOptimization();
+    optimizer.setVerbose(verbose);
+    optimizer.optimize(num_iter);
+
+    if (force_stop_flag && *force_stop_flag) {
+        return result;
+    }
+
+    for (const auto& keyfrm : subproblem.keyfrms_) {
+        if (!is_free_keyfrm(subproblem, keyfrm)) {
+            continue;
+        }
+        result.keyfrm_to_pose_cw_[keyfrm->id_] = util::converter::to_eigen_mat(keyfrm_vtx_container.get_vertex(keyfrm)->estimate());
+    }
+    for (const auto& lm_id : optimized_lm_ids) {
+        result.lm_to_pos_w_[lm_id] = lm_vtx_container.get_vertex(lm_id)->estimate();
+    }
+    return result;
+}
+
+//! Linearize the reprojection edge whose measurement has D dimensions (return false if the edge is of another type)
+template<int D, typename E>
+bool linearize_edge(g2o::OptimizableGraph::Edge* base_edge, linearized_edge& lin) {
+    auto edge = dynamic_cast<g2o::BaseBinaryEdge<D, E, internal::landmark_vertex, internal::se3::shot_vertex>*>(base_edge);
+    if (!edge) {
+        return false;
+    }
+    edge->computeError();
+    edge->linearizeOplus();
+
+    // weight the information with the derivative of the robust kernel, as g2o does
+    const double chi_sq = edge->chi2();
+    double weight = 1.0;
+    lin.chi_sq_ = chi_sq;
+    if (edge->robustKernel()) {
+        Vec3_t rho;
+        edge->robustKernel()->robustify(chi_sq, rho);
+        lin.chi_sq_ = rho(0);
+        weight = rho(1);
+    }
+    const MatRC_t<D, D> info = weight * edge->information();
+    const MatRC_t<D, 3> jacobian_p = edge->jacobianOplusXi();
+    const MatRC_t<D, 6> jacobian_k = edge->jacobianOplusXj();
+    const VecR_t<D> error = edge->error();
+
+    lin.H_kk_ = jacobian_k.transpose() * info * jacobian_k;
+    lin.H_kp_ = jacobian_k.transpose() * info * jacobian_p;
+    lin.H_pp_ = jacobian_p.transpose() * info * jacobian_p;
+    lin.g_k_ = jacobian_k.transpose() * info * error;
+    lin.g_p_ = jacobian_p.transpose() * info * error;
+    return true;
+}
+
+/**
+ * Linearize the observations which belong to the submap, and eliminate its interior
+ * (the owned landmarks first, which are independent of each other, then the interior keyframes)
+ */
+reduced_system reduce_subproblem(const ba_subproblem& subproblem,
+                                 const ba_estimates& estimates,
+                                 const separator_indices& separators,
+                                 const bool use_huber_kernel) {
+    reduced_system reduced;
+
+    // the optimizer owns the vertices and the edges, but is not run
+    g2o::SparseOptimizer optimizer;
+    auto vtx_id_offset = std::make_shared<unsigned int>(0);
+    internal::se3::shot_vertex_container keyfrm_vtx_container(vtx_id_offset, subproblem.keyfrms_.size());
+    internal::landmark_vertex_container lm_vtx_container(vtx_id_offset, subproblem.lms_.size());
+    internal::marker_vertex_container marker_vtx_container(vtx_id_offset, subproblem.markers_.size());
+    const auto edges = build_graph(subproblem, estimates, use_huber_kernel, optimizer,
+                                   keyfrm_vtx_container, lm_vtx_container, marker_vtx_container);
+
+    // the interior keyframes come first, then the separator variables in order of appearance
+    std::unordered_map<unsigned int, int> keyfrm_id_to_offset;
+    int dim = 0;
+    for (const auto& keyfrm : subproblem.keyfrms_) {
+        if (is_free_keyfrm(subproblem, keyfrm)) {
+            keyfrm_id_to_offset[keyfrm->id_] = dim;
+            dim += 6;
+        }
+    }
+    const int interior_dim = dim;
+    std::unordered_map<unsigned int, int> lm_id_to_offset;
+    std::unordered_map<unsigned int, int> marker_corner_to_offset;
+    // offset of the interior keyframe or the separator variable (-1 if it is constant)
+    const auto get_separator_offset = [&](std::unordered_map<unsigned int, int>& local_offsets,
+                                          const std::unordered_map<unsigned int, unsigned int>& offsets,
+                                          const unsigned int id, const unsigned int var_dim) -> int {
+        const auto local_offset = local_offsets.find(id);
+        if (local_offset != local_offsets.end()) {
+            return local_offset->second;
+        }
+        const auto offset = offsets.find(id);
+        if (offset == offsets.end()) {
+            // constant
+            return -1;
+        }
+        reduced.separator_offsets_.emplace_back(offset->second, var_dim);
+        local_offsets[id] = dim;
+        dim += var_dim;
+        return local_offsets.at(id);
+    };
+
+    // 1. Linearize the observations which belong to the submap
+
+    eigen_alloc_vector<linearized_edge> lins;
+    lins.reserve(edges.size());
+    std::unordered_map<unsigned int, int> lm_id_to_eliminated_idx;
+    std::vector<std::vector<unsigned int>> eliminated_lm_edge_indices;
+    for (const auto& edge : edges) {
+        const bool point_is_owned = !edge.is_marker_ && !subproblem.fixed_lm_ids_.count(edge.point_id_);
+        if (!point_is_owned && !subproblem.submap_keyfrm_ids_.count(edge.keyfrm_->id_)) {
+            // belongs to another submap
+            continue;
+        }
+
+        linearized_edge lin;
+        if (!linearize_edge<2, Vec2_t>(edge.edge_, lin) && !linearize_edge<3, Vec3_t>(edge.edge_, lin)) {
+            continue;
+        }
+        reduced.chi_sq_ += lin.chi_sq_;
+
+        lin.keyfrm_offset_ = get_separator_offset(keyfrm_id_to_offset, separators.keyfrm_id_to_offset_, edge.keyfrm_->id_, 6);
+
+        if (point_is_owned) {
+            if (!lm_id_to_eliminated_idx.count(edge.point_id_)) {
+                lm_id_to_eliminated_idx[edge.point_id_] = eliminated_lm_edge_indices.size();
+                eliminated_lm_edge_indices.emplace_back();
+            }
+            lin.eliminated_lm_idx_ = lm_id_to_eliminated_idx.at(edge.point_id_);
+            eliminated_lm_edge_indices.at(lin.eliminated_lm_idx_).push_back(lins.size());
+        }
+        else if (edge.is_marker_) {
+            lin.point_offset_ = get_separator_offset(marker_corner_to_offset, separators.marker_corner_to_offset_, edge.point_id_, 3);
+        }
+        else {
+            lin.point_offset_ = get_separator_offset(lm_id_to_offset, separators.lm_id_to_offset_, edge.point_id_, 3);
+        }
+        lins.push_back(lin);
+    }
+
+    // 2. Accumulate the normal equations, with the owned landmarks eliminated
+
+    MatX_t hessian = MatX_t::Zero(dim, dim);
+    VecX_t gradient = VecX_t::Zero(dim);
+    for (const auto& lin : lins) {
+        const int k = lin.keyfrm_offset_;
+        const int p = lin.point_offset_;
+        if (0 <= k) {
+            hessian.block<6, 6>(k, k) += lin.H_kk_;
+            gradient.segment<6>(k) += lin.g_k_;
+        }
+        if (0 <= p) {
+            hessian.block<3, 3>(p, p) += lin.H_pp_;
+            gradient.segment<3>(p) += lin.g_p_;
+            if (0 <= k) {
+                hessian.block<6, 3>(k, p) += lin.H_kp_;
+                hessian.block<3, 6>(p, k) += lin.H_kp_.transpose();
+            }
+        }
+    }
+    for (const auto& edge_indices : eliminated_lm_edge_indices) {
+        Mat33_t H_pp = Mat33_t::Zero();
+        Vec3_t g_p = Vec3_t::Zero();
+        for (const auto edge_idx : edge_indices) {
+            H_pp += lins.at(edge_idx).H_pp_;
+            g_p += lins.at(edge_idx).g_p_;
+        }
+        const Mat33_t H_pp_inv = (H_pp + 1e-9 * Mat33_t::Identity()).inverse();
+        for (const auto edge_idx_a : edge_indices) {
+            const auto& lin_a = lins.at(edge_idx_a);
+            if (lin_a.keyfrm_offset_ < 0) {
+                continue;
+            }
+            const MatRC_t<6, 3> H_kp_inv = lin_a.H_kp_ * H_pp_inv;
+            gradient.segment<6>(lin_a.keyfrm_offset_) -= H_kp_inv * g_p;
+            for (const auto edge_idx_b : edge_indices) {
+                const auto& lin_b = lins.at(edge_idx_b);
+                if (lin_b.keyfrm_offset_ < 0) {
+                    continue;
+                }
+                hessian.block<6, 6>(lin_a.keyfrm_offset_, lin_b.keyfrm_offset_) -= H_kp_inv * lin_b.H_kp_.transpose();
+            }
+        }
+    }
+
+    // 3. Eliminate the interior keyframes (Schur complement onto the separators)
+
+    const int separator_dim = dim - interior_dim;
+    if (separator_dim == 0) {
+        return reduced;
+    }
+    reduced.hessian_ = hessian.bottomRightCorner(separator_dim, separator_dim);
+    reduced.gradient_ = gradient.tail(separator_dim);
+    if (0 < interior_dim) {
+        MatX_t H_ii = hessian.topLeftCorner(interior_dim, interior_dim);
+        // slight damping for the directions which are not constrained by the separators
+        H_ii.diagonal() += 1e-6 * H_ii.diagonal() + VecX_t::Constant(interior_dim, 1e-9);
+        const Eigen::LDLT<MatX_t> H_ii_ldlt(H_ii);
+        const MatX_t H_is = hessian.topRightCorner(interior_dim, separator_dim);
+        reduced.hessian_ -= H_is.transpose() * H_ii_ldlt.solve(H_is);
+        reduced.gradient_ -= H_is.transpose() * H_ii_ldlt.solve(gradient.head(interior_dim));
+    }
+    return reduced;
+}
+
+//! Run the function on each subproblem in parallel
+template<typename T, typename F>
+std::vector<T> run_in_parallel(const std::vector<ba_subproblem>& subproblems, const F& func) {
+    std::vector<T> results;
+    results.reserve(subproblems.size());
+    const unsigned int batch_size = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int begin = 0; begin < subproblems.size(); begin += batch_size) {
+        const unsigned int end = std::min<unsigned int>(begin + batch_size, subproblems.size());
+        std::vector<std::future<T>> futures;
+        for (unsigned int i = begin; i < end; ++i) {
+            futures.push_back(std::async(std::launch::async, func, std::cref(subproblems.at(i))));
+        }
+        for (auto& future : futures) {
+            results.push_back(future.get());
+        }
+    }
+    return results;
+}
+
+//! Optimize the subproblems in parallel and merge their results into the estimates
+bool optimize_subproblems_in_parallel(const std::vector<ba_subproblem>& subproblems,
+                                      ba_estimates& estimates,
+                                      const unsigned int num_iter,
+                                      const bool use_huber_kernel,
+                                      const bool verbose,
+                                      bool* const force_stop_flag) {
+    // The subproblems share only the fixed variables, so the estimates can be read concurrently
+    const auto results = run_in_parallel<ba_estimates>(subproblems, [&](const ba_subproblem& subproblem) {
+        return optimize_subproblem(subproblem, estimates, num_iter, use_huber_kernel, verbose, force_stop_flag);
+    });
+    if (force_stop_flag && *force_stop_flag) {
+        return false;
+    }
+    for (const auto& result : results) {
+        for (const auto& id_pose : result.keyfrm_to_pose_cw_) {
+            estimates.keyfrm_to_pose_cw_[id_pose.first] = id_pose.second;
+        }
+        for (const auto& id_pos : result.lm_to_pos_w_) {
+            estimates.lm_to_pos_w_[id_pos.first] = id_pos.second;
+        }
+    }
+    return true;
+}
+
+/**
+ * Take a Levenberg-Marquardt step of the separators on the sum of the reduced systems
+ * @return false if the reduced problem cannot be solved
+ */
+bool update_separators(const std::vector<reduced_system>& reduced_systems,
+                       const separator_indices& separators,
+                       ba_estimates& estimates) {
+    std::vector<Eigen::Triplet<double>> triplets;
+    VecX_t gradient = VecX_t::Zero(separators.dim_);
+    VecX_t diagonal = VecX_t::Zero(separators.dim_);
+    for (const auto& reduced : reduced_systems) {
+        unsigned int row = 0;
+        for (const auto& offset_dim_a : reduced.separator_offsets_) {
+            unsigned int col = 0;
+            for (const auto& offset_dim_b : reduced.separator_offsets_) {
+                for (unsigned int r = 0; r < offset_dim_a.second; ++r) {
+                    for (unsigned int c = 0; c < offset_dim_b.second; ++c) {
+                        triplets.emplace_back(offset_dim_a.first + r, offset_dim_b.first + c, reduced.hessian_(row + r, col + c));
+                    }
+                }
+                col += offset_dim_b.second;
+            }
+            gradient.segment(offset_dim_a.first, offset_dim_a.second) += reduced.gradient_.segment(row, offset_dim_a.second);
+            diagonal.segment(offset_dim_a.first, offset_dim_a.second) += reduced.hessian_.diagonal().segment(row, offset_dim_a.second);
+            row += offset_dim_a.second;
+        }
+    }
+    // the scale of the monocular map is free, so the system is damped
+    constexpr double lambda = 1e-4;
+    for (unsigned int i = 0; i < separators.dim_; ++i) {
+        triplets.emplace_back(i, i, lambda * diagonal(i) + 1e-9);
+    }
+
+    Eigen::SparseMatrix<double> hessian(separators.dim_, separators.dim_);
+    hessian.setFromTriplets(triplets.begin(), triplets.end());
+    const Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(hessian);
+    if (solver.info() != Eigen::Success) {
+        return false;
+    }
+    const VecX_t step = -solver.solve(gradient);
+    if (!step.allFinite()) {
+        return false;
+    }
+
+    for (const auto& id_offset : separators.keyfrm_id_to_offset_) {
+        const Vec6_t delta = step.segment<6>(id_offset.second);
+        auto& pose_cw = estimates.keyfrm_to_pose_cw_.at(id_offset.first);
+        pose_cw = util::converter::to_eigen_mat(g2o::SE3Quat::exp(delta) * util::converter::to_g2o_SE3(pose_cw));
+    }
+    for (const auto& id_offset : separators.lm_id_to_offset_) {
+        estimates.lm_to_pos_w_.at(id_offset.first) += step.segment<3>(id_offset.second);
+    }
+    for (const auto& corner_offset : separators.marker_corner_to_offset_) {
+        estimates.marker_to_pos_w_.at(corner_offset.first / 4).at(corner_offset.first % 4) += step.segment<3>(corner_offset.second);
+    }
+    return true;
+}
+
+} // namespace
+
+hierarchical_bundle_adjuster::hierarchical_bundle_adjuster(
+    const unsigned int max_num_keyfrms_in_submap,
+    const unsigned int num_iter,
+    const bool use_huber_kernel,
+    const bool verbose)
+    : max_num_keyfrms_in_submap_(std::max(1u, max_num_keyfrms_in_submap)),
+      num_iter_(num_iter),
+      use_huber_kernel_(use_huber_kernel),
+      verbose_(verbose) {}
+
+std::vector<std::vector<std::shared_ptr<data::keyframe>>> hierarchical_bundle_adjuster::partition(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms) const {
+    // Grow each submap from the oldest unassigned keyframe by breadth-first search over the covisibility graph
+    // (the covisibilities are visited in descending order of the number of shared landmarks)
+    std::vector<std::shared_ptr<data::keyframe>> sorted_keyfrms;
+    sorted_keyfrms.reserve(keyfrms.size());
+    for (const auto& keyfrm : keyfrms) {
+        if (keyfrm && !keyfrm->will_be_erased()) {
+            sorted_keyfrms.push_back(keyfrm);
+        }
+    }
+    std::sort(sorted_keyfrms.begin(), sorted_keyfrms.end(), [](const std::shared_ptr<data::keyframe>& a, const std::shared_ptr<data::keyframe>& b) {
+        return a->id_ < b->id_;
+    });
+
+    std::unordered_set<unsigned int> keyfrm_ids;
+    for (const auto& keyfrm : sorted_keyfrms) {
+        keyfrm_ids.insert(keyfrm->id_);
+    }
+
+    std::vector<std::vector<std::shared_ptr<data::keyframe>>> submaps;
+    std::unordered_set<unsigned int> assigned_keyfrm_ids;
+    for (const auto& seed : sorted_keyfrms) {
+        if (assigned_keyfrm_ids.count(seed->id_)) {
+            continue;
+        }
+        std::vector<std::shared_ptr<data::keyframe>> submap;
+        std::deque<std::shared_ptr<data::keyframe>> queue{seed};
+        assigned_keyfrm_ids.insert(seed->id_);
+        while (!queue.empty() && submap.size() < max_num_keyfrms_in_submap_) {
+            const auto keyfrm = queue.front();
+            queue.pop_front();
+            submap.push_back(keyfrm);
+            for (const auto& covisibility : keyfrm->graph_node_->get_covisibilities()) {
+                if (!keyfrm_ids.count(covisibility->id_) || assigned_keyfrm_ids.count(covisibility->id_)) {
+                    continue;
+                }
+                assigned_keyfrm_ids.insert(covisibility->id_);
+                queue.push_back(covisibility);
+            }
+        }
+        // release the keyframes which were queued but did not fit into the submap
+        for (const auto& keyfrm : queue) {
+            assigned_keyfrm_ids.erase(keyfrm->id_);
+        }
+        submaps.push_back(submap);
+    }
+    return submaps;
+}
+
+bool hierarchical_bundle_adjuster::optimize(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                                            std::unordered_set<unsigned int>& optimized_keyfrm_ids,
+                                            std::unordered_set<unsigned int>& optimized_landmark_ids,
+                                            std::unordered_set<unsigned int>& optimized_marker_ids,
+                                            eigen_alloc_unord_map<unsigned int, Vec3_t>& lm_to_pos_w_after_global_BA,
+                                            eigen_alloc_unord_map<unsigned int, Mat44_t>& keyfrm_to_pose_cw_after_global_BA,
+                                            eigen_alloc_unord_map<unsigned int, std::array<Vec3_t, 4>>& marker_to_pos_w_after_global_BA,
+                                            bool* const force_stop_flag) const {
+    STELLA_BENCHMARK_TIMER("optimize::hierarchical_bundle_adjuster", "optimize");
+
+    // 1. Partition the map and find the separators
+
+    const auto submaps = partition(keyfrms);
+
+    ba_estimates estimates;
+    std::unordered_map<unsigned int, unsigned int> keyfrm_id_to_submap_idx;
+    for (unsigned int submap_idx = 0; submap_idx < submaps.size(); ++submap_idx) {
+        for (const auto& keyfrm : submaps.at(submap_idx)) {
+            keyfrm_id_to_submap_idx[keyfrm->id_] = submap_idx;
+            estimates.keyfrm_to_pose_cw_[keyfrm->id_] = keyfrm->get_pose_cw();
+        }
+    }
+
+    // The separator keyframes are on the boundaries of the submaps in the covisibility graph,
+    // and the spanning root is fixed everywhere
+    std::unordered_set<unsigned int> non_interior_keyfrm_ids;
+    separator_indices separators;
+    for (unsigned int submap_idx = 0; submap_idx < submaps.size(); ++submap_idx) {
+        for (const auto& keyfrm : submaps.at(submap_idx)) {
+            if (keyfrm->graph_node_->is_spanning_root()) {
+                non_interior_keyfrm_ids.insert(keyfrm->id_);
+                continue;
+            }
+            for (const auto& covisibility : keyfrm->graph_node_->get_covisibilities()) {
+                const auto covisibility_submap_idx = keyfrm_id_to_submap_idx.find(covisibility->id_);
+                if (covisibility_submap_idx != keyfrm_id_to_submap_idx.end() && covisibility_submap_idx->second != submap_idx) {
+                    non_interior_keyfrm_ids.insert(keyfrm->id_);
+                    separators.keyfrm_id_to_offset_[keyfrm->id_] = separators.dim_;
+                    separators.dim_ += 6;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Each landmark is owned by the submap of its interior observers.
+    // A landmark is a separator only if it is observed from the interiors of multiple submaps,
+    // which are weakly covisible across the cut.
+    std::vector<std::shared_ptr<data::landmark>> lms;
+    std::unordered_map<unsigned int, unsigned int> lm_id_to_owner_idx;
+    std::vector<std::vector<std::shared_ptr<data::keyframe>>> observers_of_owned_lms(submaps.size());
+    std::unordered_set<unsigned int> separator_lm_ids;
+    for (const auto& keyfrm : keyfrms) {
+        if (!keyfrm || !keyfrm_id_to_submap_idx.count(keyfrm->id_)) {
+            continue;
+        }
+        for (const auto& lm : keyfrm->get_landmarks()) {
+            if (!lm || lm->will_be_erased() || estimates.lm_to_pos_w_.count(lm->id_)) {
+                continue;
+            }
+            estimates.lm_to_pos_w_[lm->id_] = lm->get_pos_in_world();
+            lms.push_back(lm);
+
+            std::vector<std::shared_ptr<data::keyframe>> observers;
+            std::unordered_map<unsigned int, unsigned int> submap_idx_to_num_obs;
+            std::unordered_set<unsigned int> interior_submap_indices;
+            for (const auto& obs : lm->get_observations()) {
+                auto observer = obs.first.lock();
+                if (!observer || !keyfrm_id_to_submap_idx.count(observer->id_)) {
+                    continue;
+                }
+                observers.push_back(observer);
+                const auto submap_idx = keyfrm_id_to_submap_idx.at(observer->id_);
+                ++submap_idx_to_num_obs[submap_idx];
+                if (!non_interior_keyfrm_ids.count(observer->id_)) {
+                    interior_submap_indices.insert(submap_idx);
+                }
+            }
+
+            if (1 < interior_submap_indices.size()) {
+                separator_lm_ids.insert(lm->id_);
+                separators.lm_id_to_offset_[lm->id_] = separators.dim_;
+                separators.dim_ += 3;
+                continue;
+            }
+            unsigned int owner_idx = 0;
+            if (interior_submap_indices.size() == 1) {
+                owner_idx = *interior_submap_indices.begin();
+            }
+            else {
+                // observed only from the separators: owned by the submap with the most observations
+                unsigned int max_num_obs = 0;
+                for (const auto& idx_num_obs : submap_idx_to_num_obs) {
+                    if (max_num_obs < idx_num_obs.second
+                        || (max_num_obs == idx_num_obs.second && idx_num_obs.first < owner_idx)) {
+                        max_num_obs = idx_num_obs.second;
+                        owner_idx = idx_num_obs.first;
+                    }
+                }
+            }
+            lm_id_to_owner_idx[lm->id_] = owner_idx;
+            for (const auto& observer : observers) {
+                if (keyfrm_id_to_submap_idx.at(observer->id_) != owner_idx) {
+                    observers_of_owned_lms.at(owner_idx).push_back(observer);
+                }
+            }
+        }
+    }
+
+    // Markers are separators, because they are observed from anywhere
+    std::vector<std::shared_ptr<data::marker>> markers;
+    for (const auto& keyfrm : keyfrms) {
+        if (!keyfrm || !keyfrm_id_to_submap_idx.count(keyfrm->id_)) {
+            continue;
+        }
+        for (const auto& mkr : keyfrm->get_markers()) {
+            if (!mkr || estimates.marker_to_pos_w_.count(mkr->id_)) {
+                continue;
+            }
+            // Markers which are not initialized enough are skipped, as done in the global BA
+            if (!mkr->keep_fixed_ && !mkr->initialized_before_) {
+                continue;
+            }
+            std::array<Vec3_t, 4> corners_pos_w;
+            for (unsigned int corner_idx = 0; corner_idx < 4; ++corner_idx) {
+                corners_pos_w.at(corner_idx) = mkr->corners_pos_w_.at(corner_idx);
+                if (!mkr->keep_fixed_) {
+                    separators.marker_corner_to_offset_[mkr->id_ * 4 + corner_idx] = separators.dim_;
+                    separators.dim_ += 3;
+                }
+            }
+            estimates.marker_to_pos_w_[mkr->id_] = corners_pos_w;
+            markers.push_back(mkr);
+        }
+    }
+
+    spdlog::debug("hierarchical bundle adjustment: {} submaps, {} separator keyframes, {} separator landmarks",
+                  submaps.size(), separators.keyfrm_id_to_offset_.size(), separators.lm_id_to_offset_.size());
+
+    std::vector<ba_subproblem> subproblems(submaps.size());
+    for (unsigned int submap_idx = 0; submap_idx < submaps.size(); ++submap_idx) {
+        auto& subproblem = subproblems.at(submap_idx);
+        std::unordered_set<unsigned int> added_keyfrm_ids;
+        for (const auto& keyfrm : submaps.at(submap_idx)) {
+            subproblem.keyfrms_.push_back(keyfrm);
+            subproblem.submap_keyfrm_ids_.insert(keyfrm->id_);
+            added_keyfrm_ids.insert(keyfrm->id_);
+        }
+        // the separators of the other submaps which observe the owned landmarks
+        for (const auto& observer : observers_of_owned_lms.at(submap_idx)) {
+            if (added_keyfrm_ids.insert(observer->id_).second) {
+                subproblem.keyfrms_.push_back(observer);
+            }
+        }
+        for (const auto& keyfrm : subproblem.keyfrms_) {
+            if (non_interior_keyfrm_ids.count(keyfrm->id_)) {
+                subproblem.fixed_keyfrm_ids_.insert(keyfrm->id_);
+            }
+        }
+    }
+    for (const auto& lm : lms) {
+        if (!separator_lm_ids.count(lm->id_)) {
+            subproblems.at(lm_id_to_owner_idx.at(lm->id_)).lms_.push_back(lm);
+            continue;
+        }
+        std::unordered_set<unsigned int> observer_submap_indices;
+        for (const auto& obs : lm->get_observations()) {
+            auto observer = obs.first.lock();
+            if (observer && keyfrm_id_to_submap_idx.count(observer->id_)) {
+                observer_submap_indices.insert(keyfrm_id_to_submap_idx.at(observer->id_));
+            }
+        }
+        for (const auto submap_idx : observer_submap_indices) {
+            subproblems.at(submap_idx).lms_.push_back(lm);
+            subproblems.at(submap_idx).fixed_lm_ids_.insert(lm->id_);
+        }
+    }
+    for (const auto& mkr : markers) {
+        std::unordered_set<unsigned int> observer_submap_indices;
+        for (const auto& id_keyfrm : mkr->observations_) {
+            if (id_keyfrm.second && keyfrm_id_to_submap_idx.count(id_keyfrm.second->id_)) {
+                observer_submap_indices.insert(keyfrm_id_to_submap_idx.at(id_keyfrm.second->id_));
+            }
+        }
+        for (const auto submap_idx : observer_submap_indices) {
+            subproblems.at(submap_idx).markers_.push_back(mkr);
+        }
+    }
+
+    // 2. Optimize the interior of each submap with the separators fixed
+
+    if (!optimize_subproblems_in_parallel(subproblems, estimates, num_iter_, use_huber_kernel_, verbose_, force_stop_flag)) {
+        return false;
+    }
+
+    // 3. Optimize the separators on the Schur complements of the interiors (reduced problem),
+    //    then back-substitute them into the interiors
+
+    double prev_chi_sq = std::numeric_limits<double>::infinity();
+    ba_estimates prev_estimates;
+    for (unsigned int iter = 0; 0 < separators.dim_ && iter <= num_separator_iter; ++iter) {
+        const auto reduced_systems = run_in_parallel<reduced_system>(subproblems, [&](const ba_subproblem& subproblem) {
+            return reduce_subproblem(subproblem, estimates, separators, use_huber_kernel_);
+        });
+        double chi_sq = 0.0;
+        for (const auto& reduced : reduced_systems) {
+            chi_sq += reduced.chi_sq_;
+        }
+        SPDLOG_TRACE("hierarchical bundle adjustment: chi2 {} after {} separator iterations", chi_sq, iter);
+        if (prev_chi_sq < chi_sq) {
+            // the last step increased the error
+            estimates = prev_estimates;
+            break;
+        }
+        if (iter == num_separator_iter) {
+            break;
+        }
+
+        prev_chi_sq = chi_sq;
+        prev_estimates = estimates;
+        if (!update_separators(reduced_systems, separators, estimates)) {
+            spdlog::debug("hierarchical bundle adjustment: cannot solve the reduced problem");
+            break;
+        }
+        if (!optimize_subproblems_in_parallel(subproblems, estimates, num_iter_, use_huber_kernel_, verbose_, force_stop_flag)) {
+            return false;
+        }
+    }
+    if (force_stop_flag && *force_stop_flag) {
+        return false;
+    }
+
+    // Extract the result
+
+    for (const auto& id_pose : estimates.keyfrm_to_pose_cw_) {
+        keyfrm_to_pose_cw_after_global_BA[id_pose.first] = id_pose.second;
+        optimized_keyfrm_ids.insert(id_pose.first);
+    }
+    for (const auto& id_pos : estimates.lm_to_pos_w_) {
+        lm_to_pos_w_after_global_BA[id_pos.first] = id_pos.second;
+        optimized_landmark_ids.insert(id_pos.first);
+    }
+    for (const auto& mkr : markers) {
+        if (mkr->keep_fixed_) {
+            continue;
+        }
+        const auto& corners_pos_w = estimates.marker_to_pos_w_.at(mkr->id_);
+        bool changed = false;
+        for (unsigned int corner_idx = 0; corner_idx < 4; ++corner_idx) {
+            changed |= corners_pos_w.at(corner_idx) != mkr->corners_pos_w_.at(corner_idx);
+        }
+        if (!changed) {
+            continue;
+        }
+        optimized_marker_ids.insert(mkr->id_);
+        marker_to_pos_w_after_global_BA[mkr->id_] = corners_pos_w;
+    }
+
+    return true;
+}
+
+} // namespace optimize
+} // namespace stella_vslam
@@ -0,0 +1,93 @@
+#ifndef STELLA_VSLAM_OPTIMIZE_HIERARCHICAL_BUNDLE_ADJUSTER_H
+#define STELLA_VSLAM_OPTIMIZE_HIERARCHICAL_BUNDLE_ADJUSTER_H
+
+#include "stella_vslam/type.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <unordered_set>
+
+namespace stella_vslam {
+
+namespace data {
+class keyframe;
+class landmark;
+} // namespace data
+
+namespace optimize {
+
+/**
+ * Global bundle adjustment over submaps
+ * The keyframes are partitioned into submaps along the covisibility graph.
+ * The separators are the keyframes covisible across the cut, the landmarks observed from the interiors of
+ * multiple submaps, and the markers. Each of the other landmarks is owned by a single submap.
+ *   1. the interior of each submap is optimized in parallel, with the separators fixed
+ *   2. the interior of each submap is eliminated from its linearized system (Schur complement),
+ *      and the separators are updated on the sum of the reduced systems
+ *   3. the interiors are optimized again with the updated separators (back-substitution)
+ * Steps 2 and 3 are repeated while the error decreases.
+ */
+class hierarchical_bundle_adjuster {
+public:
+    /**
+     * Constructor
+     * @param max_num_keyfrms_in_submap
+     * @param num_iter
+     * @param use_huber_kernel
+     * @param verbose
+     */
+    explicit hierarchical_bundle_adjuster(
+        unsigned int max_num_keyfrms_in_submap = 100,
+        unsigned int num_iter = 10,
+        bool use_huber_kernel = true,
+        bool verbose = false);
+
+    /**
+     * Destructor
+     */
+    virtual ~hierarchical_bundle_adjuster() = default;
+
+    /**
+     * Perform optimization (same interface as global_bundle_adjuster::optimize)
+     * @param keyfrms
+     * @param optimized_keyfrm_ids
+     * @param optimized_landmark_ids
+     * @param optimized_marker_ids
+     * @param lm_to_pos_w_after_global_BA
+     * @param keyfrm_to_pose_cw_after_global_BA
+     * @param marker_to_pos_w_after_global_BA
+     * @param force_stop_flag
+     * @return false if aborted
+     */
+    bool optimize(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                  std::unordered_set<unsigned int>& optimized_keyfrm_ids,
+                  std::unordered_set<unsigned int>& optimized_landmark_ids,
+                  std::unordered_set<unsigned int>& optimized_marker_ids,
+                  eigen_alloc_unord_map<unsigned int, Vec3_t>& lm_to_pos_w_after_global_BA,
+                  eigen_alloc_unord_map<unsigned int, Mat44_t>& keyfrm_to_pose_cw_after_global_BA,
+                  eigen_alloc_unord_map<unsigned int, std::array<Vec3_t, 4>>& marker_to_pos_w_after_global_BA,
+                  bool* const force_stop_flag = nullptr) const;
+
+    /**
+     * Partition the keyframes into submaps along the covisibility graph
+     * @param keyfrms
+     * @return keyframes in each submap
+     */
+    std::vector<std::vector<std::shared_ptr<data::keyframe>>> partition(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms) const;
+
+private:
+    //! maximum number of keyframes in a submap
+    const unsigned int max_num_keyfrms_in_submap_;
+    //! number of iterations of optimization
+    const unsigned int num_iter_;
+    //! use Huber loss or not
+    const bool use_huber_kernel_;
+    //! Verbosity (for g2o)
+    const bool verbose_ = false;
+};
+
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZE_HIERARCHICAL_BUNDLE_ADJUSTER_H
@@ -0,0 +1,70 @@
+#ifndef STELLA_VSLAM_OPTIMIZER_G2O_IMU_BIAS_RANDOM_WALK_EDGE_H
+#define STELLA_VSLAM_OPTIMIZER_G2O_IMU_BIAS_RANDOM_WALK_EDGE_H
+
+#include "stella_vslam/type.h"
+#include "stella_vslam/optimize/internal/imu/bias_vertex.h"
+
+#include <g2o/core/base_binary_edge.h>
+
+namespace stella_vslam {
+namespace optimize {
+namespace internal {
+namespace imu {
+
+//! Random walk of the IMU bias between two shots
+class bias_random_walk_edge final : public g2o::BaseBinaryEdge<6, Vec6_t, bias_vertex, bias_vertex> {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    bias_random_walk_edge();
+
+    bool read(std::istream& is) override;
+
+    bool write(std::ostream& os) const override;
+
+    void computeError() override;
+
+    void linearizeOplus() override;
+};
+
+inline bias_random_walk_edge::bias_random_walk_edge()
+    : g2o::BaseBinaryEdge<6, Vec6_t, bias_vertex, bias_vertex>() {}
+
+inline bool bias_random_walk_edge::read(std::istream& is) {
+    for (int i = 0; i < information().rows(); ++i) {
+        for (int j = i; j < information().cols(); ++j) {
+            is >> information()(i, j);
+            if (i != j) {
+                information()(j, i) = information()(i, j);
+            }
+        }
+    }
+    return true;
+}
+
+inline bool bias_random_walk_edge::write(std::ostream& os) const {
+    for (int i = 0; i < information().rows(); ++i) {
+        for (int j = i; j < information().cols(); ++j) {
+            os << " " << information()(i, j);
+        }
+    }
+    return os.good();
+}
+
+inline void bias_random_walk_edge::computeError() {
+    const auto bias_vtx_1 = static_cast<const bias_vertex*>(_vertices.at(0));
+    const auto bias_vtx_2 = static_cast<const bias_vertex*>(_vertices.at(1));
+    _error = bias_vtx_2->estimate() - bias_vtx_1->estimate();
+}
+
+inline void bias_random_walk_edge::linearizeOplus() {
+    _jacobianOplusXi = -Mat66_t::Identity();
+    _jacobianOplusXj = Mat66_t::Identity();
+}
+
+} // namespace imu
+} // namespace internal
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZER_G2O_IMU_BIAS_RANDOM_WALK_EDGE_H
@@ -0,0 +1,61 @@
+#ifndef STELLA_VSLAM_OPTIMIZER_G2O_IMU_BIAS_VERTEX_H
+#define STELLA_VSLAM_OPTIMIZER_G2O_IMU_BIAS_VERTEX_H
+
+#include "stella_vslam/type.h"
+
+#include <g2o/core/base_vertex.h>
+
+namespace stella_vslam {
+namespace optimize {
+namespace internal {
+namespace imu {
+
+//! IMU bias of [gyroscope, accelerometer]
+class bias_vertex final : public g2o::BaseVertex<6, Vec6_t> {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    bias_vertex();
+
+    bool read(std::istream& is) override;
+
+    bool write(std::ostream& os) const override;
+
+    void setToOriginImpl() override;
+
+    void oplusImpl(const double* update) override;
+};
+
+inline bias_vertex::bias_vertex()
+    : g2o::BaseVertex<6, Vec6_t>() {}
+
+inline bool bias_vertex::read(std::istream& is) {
+    for (unsigned int i = 0; i < 6; ++i) {
+        is >> _estimate(i);
+    }
+    return true;
+}
+
+inline bool bias_vertex::write(std::ostream& os) const {
+    const Vec6_t b = estimate();
+    for (unsigned int i = 0; i < 6; ++i) {
+        os << b(i) << " ";
+    }
+    return os.good();
+}
+
+inline void bias_vertex::setToOriginImpl() {
+    _estimate.fill(0);
+}
+
+inline void bias_vertex::oplusImpl(const double* update) {
+    Eigen::Map<const Vec6_t> v(update);
+    _estimate += v;
+}
+
+} // namespace imu
+} // namespace internal
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZER_G2O_IMU_BIAS_VERTEX_H
@@ -0,0 +1,85 @@
+#ifndef STELLA_VSLAM_OPTIMIZER_G2O_IMU_INERTIAL_EDGE_H
+#define STELLA_VSLAM_OPTIMIZER_G2O_IMU_INERTIAL_EDGE_H
+
+#include "stella_vslam/type.h"
+#include "stella_vslam/imu/preintegrator.h"
+#include "stella_vslam/optimize/internal/se3/shot_vertex.h"
+#include "stella_vslam/optimize/internal/imu/bias_vertex.h"
+#include "stella_vslam/optimize/internal/imu/velocity_vertex.h"
+#include "stella_vslam/util/converter.h"
+
+#include <memory>
+
+#include <g2o/core/base_multi_edge.h>
+
+namespace stella_vslam {
+namespace optimize {
+namespace internal {
+namespace imu {
+
+/**
+ * Preintegrated IMU constraint on [rotation, velocity, position] between two shots
+ * (vertices: shot 1, velocity 1, shot 2, velocity 2, bias)
+ * (NOTE: the Jacobians are computed numerically)
+ */
+class inertial_edge final : public g2o::BaseMultiEdge<9, Vec9_t> {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    inertial_edge(const std::shared_ptr<const stella_vslam::imu::preintegrator>& preint, const Vec3_t& gravity_w);
+
+    bool read(std::istream& is) override;
+
+    bool write(std::ostream& os) const override;
+
+    void computeError() override;
+
+    //! preintegration between the shots
+    const std::shared_ptr<const stella_vslam::imu::preintegrator> preint_;
+    //! gravity in the world frame
+    const Vec3_t gravity_w_;
+};
+
+inline inertial_edge::inertial_edge(const std::shared_ptr<const stella_vslam::imu::preintegrator>& preint, const Vec3_t& gravity_w)
+    : g2o::BaseMultiEdge<9, Vec9_t>(), preint_(preint), gravity_w_(gravity_w) {
+    resize(5);
+}
+
+inline bool inertial_edge::read(std::istream& is) {
+    for (int i = 0; i < information().rows(); ++i) {
+        for (int j = i; j < information().cols(); ++j) {
+            is >> information()(i, j);
+            if (i != j) {
+                information()(j, i) = information()(i, j);
+            }
+        }
+    }
+    return true;
+}
+
+inline bool inertial_edge::write(std::ostream& os) const {
+    for (int i = 0; i < information().rows(); ++i) {
+        for (int j = i; j < information().cols(); ++j) {
+            os << " " << information()(i, j);
+        }
+    }
+    return os.good();
+}
+
+inline void inertial_edge::computeError() {
+    const auto shot_vtx_1 = static_cast<const se3::shot_vertex*>(_vertices.at(0));
+    const auto vel_vtx_1 = static_cast<const velocity_vertex*>(_vertices.at(1));
+    const auto shot_vtx_2 = static_cast<const se3::shot_vertex*>(_vertices.at(2));
+    const auto vel_vtx_2 = static_cast<const velocity_vertex*>(_vertices.at(3));
+    const auto bias_vtx = static_cast<const bias_vertex*>(_vertices.at(4));
+    _error = preint_->compute_error(util::converter::to_eigen_mat(shot_vtx_1->estimate()), vel_vtx_1->estimate(),
+                                    util::converter::to_eigen_mat(shot_vtx_2->estimate()), vel_vtx_2->estimate(),
+                                    stella_vslam::imu::bias(bias_vtx->estimate()), gravity_w_);
+}
+
+} // namespace imu
+} // namespace internal
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZER_G2O_IMU_INERTIAL_EDGE_H
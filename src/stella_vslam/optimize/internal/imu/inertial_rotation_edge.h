@@ -0,0 +1,80 @@
+#ifndef STELLA_VSLAM_OPTIMIZER_G2O_IMU_INERTIAL_ROTATION_EDGE_H
+#define STELLA_VSLAM_OPTIMIZER_G2O_IMU_INERTIAL_ROTATION_EDGE_H
+
+#include "stella_vslam/type.h"
+#include "stella_vslam/imu/preintegrator.h"
+#include "stella_vslam/optimize/internal/se3/shot_vertex.h"
+#include "stella_vslam/optimize/internal/imu/bias_vertex.h"
+
+#include <memory>
+
+#include <g2o/core/base_multi_edge.h>
+
+namespace stella_vslam {
+namespace optimize {
+namespace internal {
+namespace imu {
+
+/**
+ * Preintegrated gyroscope constraint on the rotation between two shots,
+ * used while the gravity and the velocities are unknown
+ * (vertices: shot 1, shot 2, bias)
+ * (NOTE: the Jacobians are computed numerically)
+ */
+class inertial_rotation_edge final : public g2o::BaseMultiEdge<3, Vec3_t> {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    explicit inertial_rotation_edge(const std::shared_ptr<const stella_vslam::imu::preintegrator>& preint);
+
+    bool read(std::istream& is) override;
+
+    bool write(std::ostream& os) const override;
+
+    void computeError() override;
+
+    //! preintegration between the shots
+    const std::shared_ptr<const stella_vslam::imu::preintegrator> preint_;
+};
+
+inline inertial_rotation_edge::inertial_rotation_edge(const std::shared_ptr<const stella_vslam::imu::preintegrator>& preint)
+    : g2o::BaseMultiEdge<3, Vec3_t>(), preint_(preint) {
+    resize(3);
+}
+
+inline bool inertial_rotation_edge::read(std::istream& is) {
+    for (int i = 0; i < information().rows(); ++i) {
+        for (int j = i; j < information().cols(); ++j) {
+            is >> information()(i, j);
+            if (i != j) {
+                information()(j, i) = information()(i, j);
+            }
+        }
+    }
+    return true;
+}
+
+inline bool inertial_rotation_edge::write(std::ostream& os) const {
+    for (int i = 0; i < information().rows(); ++i) {
+        for (int j = i; j < information().cols(); ++j) {
+            os << " " << information()(i, j);
+        }
+    }
+    return os.good();
+}
+
+inline void inertial_rotation_edge::computeError() {
+    const auto shot_vtx_1 = static_cast<const se3::shot_vertex*>(_vertices.at(0));
+    const auto shot_vtx_2 = static_cast<const se3::shot_vertex*>(_vertices.at(1));
+    const auto bias_vtx = static_cast<const bias_vertex*>(_vertices.at(2));
+    _error = preint_->compute_rotation_error(shot_vtx_1->estimate().rotation().toRotationMatrix(),
+                                             shot_vtx_2->estimate().rotation().toRotationMatrix(),
+                                             stella_vslam::imu::bias(bias_vtx->estimate()));
+}
+
+} // namespace imu
+} // namespace internal
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZER_G2O_IMU_INERTIAL_ROTATION_EDGE_H
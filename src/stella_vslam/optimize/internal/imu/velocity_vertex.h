@@ -0,0 +1,61 @@
+#ifndef STELLA_VSLAM_OPTIMIZER_G2O_IMU_VELOCITY_VERTEX_H
+#define STELLA_VSLAM_OPTIMIZER_G2O_IMU_VELOCITY_VERTEX_H
+
+#include "stella_vslam/type.h"
+
+#include <g2o/core/base_vertex.h>
+
+namespace stella_vslam {
+namespace optimize {
+namespace internal {
+namespace imu {
+
+//! Velocity of the body in the world frame
+class velocity_vertex final : public g2o::BaseVertex<3, Vec3_t> {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    velocity_vertex();
+
+    bool read(std::istream& is) override;
+
+    bool write(std::ostream& os) const override;
+
+    void setToOriginImpl() override;
+
+    void oplusImpl(const double* update) override;
+};
+
+inline velocity_vertex::velocity_vertex()
+    : g2o::BaseVertex<3, Vec3_t>() {}
+
+inline bool velocity_vertex::read(std::istream& is) {
+    for (unsigned int i = 0; i < 3; ++i) {
+        is >> _estimate(i);
+    }
+    return true;
+}
+
+inline bool velocity_vertex::write(std::ostream& os) const {
+    const Vec3_t vel_w = estimate();
+    for (unsigned int i = 0; i < 3; ++i) {
+        os << vel_w(i) << " ";
+    }
+    return os.good();
+}
+
+inline void velocity_vertex::setToOriginImpl() {
+    _estimate.fill(0);
+}
+
+inline void velocity_vertex::oplusImpl(const double* update) {
+    Eigen::Map<const Vec3_t> v(update);
+    _estimate += v;
+}
+
+} // namespace imu
+} // namespace internal
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZER_G2O_IMU_VELOCITY_VERTEX_H
@@ -0,0 +1,214 @@
+#ifndef STELLA_VSLAM_OPTIMIZE_INTERNAL_GTSAM_INERTIAL_FACTOR_H
+#define STELLA_VSLAM_OPTIMIZE_INTERNAL_GTSAM_INERTIAL_FACTOR_H
+
+#include "stella_vslam/type.h"
+#include "stella_vslam/imu/preintegrator.h"
+#include "stella_vslam/util/converter.h"
+
+#include <memory>
+
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <boost/optional.hpp>
+
+namespace stella_vslam {
+namespace optimize {
+namespace internal_gtsam {
+
+// NOTE: the poses are the camera poses from the camera to the world (wc) as in the projection factors,
+// the velocities are the ones of the body in the world frame, and the bias is [gyroscope, accelerometer].
+// The Jacobians are computed numerically.
+
+//! Preintegrated IMU factor on [rotation, velocity, position] between two frames
+class InertialFactor : public gtsam::NoiseModelFactor5<gtsam::Pose3, gtsam::Vector3, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6> {
+private:
+    typedef gtsam::NoiseModelFactor5<gtsam::Pose3, gtsam::Vector3, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6> Base;
+    typedef InertialFactor This;
+
+protected:
+    std::shared_ptr<const imu::preintegrator> preint_;
+    gtsam::Vector3 gravity_w_;
+
+public:
+    InertialFactor(const std::shared_ptr<const imu::preintegrator>& preint, const gtsam::Vector3& gravity_w,
+                   const gtsam::SharedNoiseModel& model,
+                   gtsam::Key key_pose_1, gtsam::Key key_vel_1, gtsam::Key key_pose_2, gtsam::Key key_vel_2, gtsam::Key key_bias)
+        : Base(model, key_pose_1, key_vel_1, key_pose_2, key_vel_2, key_bias), preint_(preint), gravity_w_(gravity_w) {}
+    virtual ~InertialFactor() {}
+
+    gtsam::Vector evaluateError(const gtsam::Pose3& pose_1, const gtsam::Vector3& vel_1,
+                                const gtsam::Pose3& pose_2, const gtsam::Vector3& vel_2, const gtsam::Vector6& b,
+                                boost::optional<gtsam::Matrix&> H1 = boost::none, boost::optional<gtsam::Matrix&> H2 = boost::none,
+                                boost::optional<gtsam::Matrix&> H3 = boost::none, boost::optional<gtsam::Matrix&> H4 = boost::none,
+                                boost::optional<gtsam::Matrix&> H5 = boost::none) const override {
+        const auto error_func = [this](const gtsam::Pose3& pose_1, const gtsam::Vector3& vel_1,
+                                       const gtsam::Pose3& pose_2, const gtsam::Vector3& vel_2, const gtsam::Vector6& b) {
+            return compute_error(pose_1, vel_1, pose_2, vel_2, b);
+        };
+        if (H1)
+            *H1 = gtsam::numericalDerivative51<gtsam::Vector9, gtsam::Pose3, gtsam::Vector3, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6>(error_func, pose_1, vel_1, pose_2, vel_2, b);
+        if (H2)
+            *H2 = gtsam::numericalDerivative52<gtsam::Vector9, gtsam::Pose3, gtsam::Vector3, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6>(error_func, pose_1, vel_1, pose_2, vel_2, b);
+        if (H3)
+            *H3 = gtsam::numericalDerivative53<gtsam::Vector9, gtsam::Pose3, gtsam::Vector3, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6>(error_func, pose_1, vel_1, pose_2, vel_2, b);
+        if (H4)
+            *H4 = gtsam::numericalDerivative54<gtsam::Vector9, gtsam::Pose3, gtsam::Vector3, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6>(error_func, pose_1, vel_1, pose_2, vel_2, b);
+        if (H5)
+            *H5 = gtsam::numericalDerivative55<gtsam::Vector9, gtsam::Pose3, gtsam::Vector3, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6>(error_func, pose_1, vel_1, pose_2, vel_2, b);
+        return compute_error(pose_1, vel_1, pose_2, vel_2, b);
+    }
+
+    gtsam::Vector9 compute_error(const gtsam::Pose3& pose_1, const gtsam::Vector3& vel_1,
+                                 const gtsam::Pose3& pose_2, const gtsam::Vector3& vel_2, const gtsam::Vector6& b) const {
+        return preint_->compute_error(util::converter::inverse_pose(pose_1.matrix()), vel_1,
+                                      util::converter::inverse_pose(pose_2.matrix()), vel_2,
+                                      imu::bias(b), gravity_w_);
+    }
+
+    gtsam::NonlinearFactor::shared_ptr clone() const override {
+        return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+            gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+    }
+
+    GTSAM_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+//! Preintegrated IMU factor from the fixed state of the reference frame to the pose, the velocity and the bias of the frame
+class InertialPoseOptFactor : public gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Vector3, gtsam::Vector6> {
+private:
+    typedef gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Vector3, gtsam::Vector6> Base;
+    typedef InertialPoseOptFactor This;
+
+protected:
+    std::shared_ptr<const imu::preintegrator> preint_;
+    gtsam::Vector3 gravity_w_;
+    Mat44_t ref_pose_cw_;
+    gtsam::Vector3 ref_vel_;
+
+public:
+    InertialPoseOptFactor(const std::shared_ptr<const imu::preintegrator>& preint, const gtsam::Vector3& gravity_w,
+                          const Mat44_t& ref_pose_cw, const gtsam::Vector3& ref_vel,
+                          const gtsam::SharedNoiseModel& model,
+                          gtsam::Key key_pose, gtsam::Key key_vel, gtsam::Key key_bias)
+        : Base(model, key_pose, key_vel, key_bias), preint_(preint), gravity_w_(gravity_w),
+          ref_pose_cw_(ref_pose_cw), ref_vel_(ref_vel) {}
+    virtual ~InertialPoseOptFactor() {}
+
+    gtsam::Vector evaluateError(const gtsam::Pose3& pose, const gtsam::Vector3& vel, const gtsam::Vector6& b,
+                                boost::optional<gtsam::Matrix&> H1 = boost::none, boost::optional<gtsam::Matrix&> H2 = boost::none,
+                                boost::optional<gtsam::Matrix&> H3 = boost::none) const override {
+        const auto error_func = [this](const gtsam::Pose3& pose, const gtsam::Vector3& vel, const gtsam::Vector6& b) {
+            return compute_error(pose, vel, b);
+        };
+        if (H1)
+            *H1 = gtsam::numericalDerivative31<gtsam::Vector9, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6>(error_func, pose, vel, b);
+        if (H2)
+            *H2 = gtsam::numericalDerivative32<gtsam::Vector9, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6>(error_func, pose, vel, b);
+        if (H3)
+            *H3 = gtsam::numericalDerivative33<gtsam::Vector9, gtsam::Pose3, gtsam::Vector3, gtsam::Vector6>(error_func, pose, vel, b);
+        return compute_error(pose, vel, b);
+    }
+
+    gtsam::Vector9 compute_error(const gtsam::Pose3& pose, const gtsam::Vector3& vel, const gtsam::Vector6& b) const {
+        return preint_->compute_error(ref_pose_cw_, ref_vel_, util::converter::inverse_pose(pose.matrix()), vel,
+                                      imu::bias(b), gravity_w_);
+    }
+
+    gtsam::NonlinearFactor::shared_ptr clone() const override {
+        return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+            gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+    }
+
+    GTSAM_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+//! Preintegrated gyroscope factor on the rotation between two frames, used while the gravity and the velocities are unknown
+class InertialRotationFactor : public gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Pose3, gtsam::Vector6> {
+private:
+    typedef gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Pose3, gtsam::Vector6> Base;
+    typedef InertialRotationFactor This;
+
+protected:
+    std::shared_ptr<const imu::preintegrator> preint_;
+
+public:
+    InertialRotationFactor(const std::shared_ptr<const imu::preintegrator>& preint, const gtsam::SharedNoiseModel& model,
+                           gtsam::Key key_pose_1, gtsam::Key key_pose_2, gtsam::Key key_bias)
+        : Base(model, key_pose_1, key_pose_2, key_bias), preint_(preint) {}
+    virtual ~InertialRotationFactor() {}
+
+    gtsam::Vector evaluateError(const gtsam::Pose3& pose_1, const gtsam::Pose3& pose_2, const gtsam::Vector6& b,
+                                boost::optional<gtsam::Matrix&> H1 = boost::none, boost::optional<gtsam::Matrix&> H2 = boost::none,
+                                boost::optional<gtsam::Matrix&> H3 = boost::none) const override {
+        const auto error_func = [this](const gtsam::Pose3& pose_1, const gtsam::Pose3& pose_2, const gtsam::Vector6& b) {
+            return compute_error(pose_1, pose_2, b);
+        };
+        if (H1)
+            *H1 = gtsam::numericalDerivative31<gtsam::Vector3, gtsam::Pose3, gtsam::Pose3, gtsam::Vector6>(error_func, pose_1, pose_2, b);
+        if (H2)
+            *H2 = gtsam::numericalDerivative32<gtsam::Vector3, gtsam::Pose3, gtsam::Pose3, gtsam::Vector6>(error_func, pose_1, pose_2, b);
+        if (H3)
+            *H3 = gtsam::numericalDerivative33<gtsam::Vector3, gtsam::Pose3, gtsam::Pose3, gtsam::Vector6>(error_func, pose_1, pose_2, b);
+        return compute_error(pose_1, pose_2, b);
+    }
+
+    gtsam::Vector3 compute_error(const gtsam::Pose3& pose_1, const gtsam::Pose3& pose_2, const gtsam::Vector6& b) const {
+        return preint_->compute_rotation_error(pose_1.rotation().matrix().transpose(), pose_2.rotation().matrix().transpose(),
+                                               imu::bias(b));
+    }
+
+    gtsam::NonlinearFactor::shared_ptr clone() const override {
+        return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+            gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+    }
+
+    GTSAM_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+//! Preintegrated gyroscope factor from the fixed rotation of the reference frame to the pose and the bias of the frame
+class InertialRotationPoseOptFactor : public gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Vector6> {
+private:
+    typedef gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Vector6> Base;
+    typedef InertialRotationPoseOptFactor This;
+
+protected:
+    std::shared_ptr<const imu::preintegrator> preint_;
+    Mat33_t ref_rot_cw_;
+
+public:
+    InertialRotationPoseOptFactor(const std::shared_ptr<const imu::preintegrator>& preint, const Mat33_t& ref_rot_cw,
+                                  const gtsam::SharedNoiseModel& model,
+                                  gtsam::Key key_pose, gtsam::Key key_bias)
+        : Base(model, key_pose, key_bias), preint_(preint), ref_rot_cw_(ref_rot_cw) {}
+    virtual ~InertialRotationPoseOptFactor() {}
+
+    gtsam::Vector evaluateError(const gtsam::Pose3& pose, const gtsam::Vector6& b,
+                                boost::optional<gtsam::Matrix&> H1 = boost::none, boost::optional<gtsam::Matrix&> H2 = boost::none) const override {
+        const auto error_func = [this](const gtsam::Pose3& pose, const gtsam::Vector6& b) {
+            return compute_error(pose, b);
+        };
+        if (H1)
+            *H1 = gtsam::numericalDerivative21<gtsam::Vector3, gtsam::Pose3, gtsam::Vector6>(error_func, pose, b);
+        if (H2)
+            *H2 = gtsam::numericalDerivative22<gtsam::Vector3, gtsam::Pose3, gtsam::Vector6>(error_func, pose, b);
+        return compute_error(pose, b);
+    }
+
+    gtsam::Vector3 compute_error(const gtsam::Pose3& pose, const gtsam::Vector6& b) const {
+        return preint_->compute_rotation_error(ref_rot_cw_, pose.rotation().matrix().transpose(), imu::bias(b));
+    }
+
+    gtsam::NonlinearFactor::shared_ptr clone() const override {
+        return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+            gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+    }
+
+    GTSAM_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // namespace internal_gtsam
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZE_INTERNAL_GTSAM_INERTIAL_FACTOR_H
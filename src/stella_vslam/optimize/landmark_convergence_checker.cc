@@ -0,0 +1,49 @@
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/optimize/landmark_convergence_checker.h"
+
+namespace stella_vslam {
+namespace optimize {
+
+landmark_convergence_checker::landmark_convergence_checker(const unsigned int min_num_obs,
+                                                           const float max_relative_pos_uncertainty,
+                                                           const float max_relative_BA_update,
+                                                           const unsigned int refresh_interval)
+    : min_num_obs_(min_num_obs), max_relative_pos_uncertainty_(max_relative_pos_uncertainty),
+      max_relative_BA_update_(max_relative_BA_update), refresh_interval_(refresh_interval) {}
+
+landmark_convergence_checker::landmark_convergence_checker(const YAML::Node& yaml_node)
+    : landmark_convergence_checker(yaml_node["min_num_obs"].as<unsigned int>(0),
+                                   yaml_node["max_relative_pos_uncertainty"].as<float>(5.0),
+                                   yaml_node["max_relative_BA_update"].as<float>(1e-3),
+                                   yaml_node["refresh_interval"].as<unsigned int>(10)) {}
+
+bool landmark_convergence_checker::is_enabled() const {
+    return 0 < min_num_obs_;
+}
+
+bool landmark_convergence_checker::is_converged(const data::landmark& lm) const {
+    if (!is_enabled()) {
+        return false;
+    }
+    if (lm.num_observations() < min_num_obs_) {
+        return false;
+    }
+    if (max_relative_BA_update_ < lm.get_relative_BA_update()) {
+        return false;
+    }
+    return lm.get_relative_pos_uncertainty() <= max_relative_pos_uncertainty_;
+}
+
+bool landmark_convergence_checker::is_fixed(const data::landmark& lm, const unsigned int keyfrm_id) const {
+    if (!is_converged(lm)) {
+        return false;
+    }
+    if (refresh_interval_ == 0) {
+        return true;
+    }
+    // The turns are staggered by the landmark IDs, so that only a fraction of them rejoins at once
+    return (lm.id_ + keyfrm_id) % refresh_interval_ != 0;
+}
+
+} // namespace optimize
+} // namespace stella_vslam
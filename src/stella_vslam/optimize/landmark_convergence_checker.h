@@ -0,0 +1,58 @@
+#ifndef STELLA_VSLAM_OPTIMIZE_LANDMARK_CONVERGENCE_CHECKER_H
+#define STELLA_VSLAM_OPTIMIZE_LANDMARK_CONVERGENCE_CHECKER_H
+
+#include <yaml-cpp/yaml.h>
+
+namespace stella_vslam {
+
+namespace data {
+class landmark;
+} // namespace data
+
+namespace optimize {
+
+/**
+ * Policy to hold the converged landmarks fixed in the local bundle adjustment.
+ * A landmark is regarded as converged if it is observed from well-spread viewpoints
+ * (small uncertainty of the position from the observation geometry)
+ * and the recent bundle adjustments hardly moved it.
+ * The fixed landmarks still constrain the optimizable keyframes, but are excluded from the Schur complement.
+ * A converged landmark rejoins the optimization once every refresh_interval keyframes,
+ * so that it follows the drift of the map around it.
+ * No landmark is fixed with the default parameters.
+ */
+class landmark_convergence_checker {
+public:
+    //! Constructor
+    explicit landmark_convergence_checker(const unsigned int min_num_obs = 0,
+                                          const float max_relative_pos_uncertainty = 5.0,
+                                          const float max_relative_BA_update = 1e-3,
+                                          const unsigned int refresh_interval = 10);
+
+    //! Constructor
+    explicit landmark_convergence_checker(const YAML::Node& yaml_node);
+
+    //! Return true if the converged landmarks are fixed
+    bool is_enabled() const;
+
+    //! Return true if the landmark can be fixed in the local bundle adjustment
+    bool is_converged(const data::landmark& lm) const;
+
+    //! Return true if the landmark is held fixed in the local bundle adjustment around the keyframe
+    //! (the converged landmarks take turns to rejoin the optimization)
+    bool is_fixed(const data::landmark& lm, const unsigned int keyfrm_id) const;
+
+    //! min number of the observations of a converged landmark (0 means disabled)
+    const unsigned int min_num_obs_;
+    //! max uncertainty of a converged landmark (relative stddev per unit angular noise of the keypoints)
+    const float max_relative_pos_uncertainty_;
+    //! max moving average of the relative position updates of a converged landmark
+    const float max_relative_BA_update_;
+    //! a converged landmark is optimized once every this number of keyframes (0: never)
+    const unsigned int refresh_interval_;
+};
+
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZE_LANDMARK_CONVERGENCE_CHECKER_H
@@ -21,6 +21,20 @@ public:
      * @param force_stop_flag
      */
     virtual void optimize(data::map_database* map_db, const std::shared_ptr<data::keyframe>& curr_keyfrm, bool* const force_stop_flag) const = 0;
+
+    /**
+     * Set the numbers of iterations
+     * (NOTE: call it while the optimization is not running)
+     * @param num_first_iter
+     * @param num_second_iter
+     */
+    virtual void set_num_iterations(const unsigned int num_first_iter, const unsigned int num_second_iter) = 0;
+
+    //! Get the number of iterations of the first optimization
+    virtual unsigned int get_num_first_iter() const = 0;
+
+    //! Get the number of iterations of the second optimization
+    virtual unsigned int get_num_second_iter() const = 0;
 };
 
 } // namespace optimize
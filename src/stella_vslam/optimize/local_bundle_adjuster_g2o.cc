@@ -2,6 +2,7 @@
 #include "stella_vslam/data/landmark.h"
 #include "stella_vslam/data/marker.h"
 #include "stella_vslam/data/map_database.h"
+#include "stella_vslam/imu/preintegrator.h"
 #include "stella_vslam/marker_model/base.h"
 #include "stella_vslam/optimize/local_bundle_adjuster_g2o.h"
 #include "stella_vslam/optimize/terminate_action.h"
@@ -9,10 +10,15 @@
 #include "stella_vslam/optimize/internal/marker_vertex_container.h"
 #include "stella_vslam/optimize/internal/se3/shot_vertex_container.h"
 #include "stella_vslam/optimize/internal/se3/reproj_edge_wrapper.h"
+#include "stella_vslam/optimize/internal/imu/bias_random_walk_edge.h"
+#include "stella_vslam/optimize/internal/imu/inertial_edge.h"
+#include "stella_vslam/optimize/internal/imu/inertial_rotation_edge.h"
 #include "stella_vslam/util/converter.h"
+#include "stella_vslam/util/yaml.h"
 #include "stella_vslam/benchmark/timer.h"
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include <Eigen/StdVector>
 #include <g2o/core/solver.h>
@@ -32,7 +38,9 @@ local_bundle_adjuster_g2o::local_bundle_adjuster_g2o(const YAML::Node& yaml_node
                                                      const unsigned int num_first_iter,
                                                      const unsigned int num_second_iter)
     : num_first_iter_(num_first_iter), num_second_iter_(num_second_iter),
-      use_additional_keyframes_for_monocular_(yaml_node["use_additional_keyframes_for_monocular"].as<bool>(false)) {}
+      use_additional_keyframes_for_monocular_(yaml_node["use_additional_keyframes_for_monocular"].as<bool>(false)),
+      window_selector_(util::yaml_optional_ref(yaml_node, "local_ba_window")),
+      convergence_checker_(util::yaml_optional_ref(yaml_node, "landmark_fixing")) {}
 
 void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
                                          const std::shared_ptr<stella_vslam::data::keyframe>& curr_keyfrm, bool* const force_stop_flag) const {
@@ -45,8 +53,11 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
     bool has_scale = false;
 
     local_keyfrms[curr_keyfrm->id_] = curr_keyfrm;
-    const auto curr_covisibilities = curr_keyfrm->graph_node_->get_covisibilities();
-    for (const auto& local_keyfrm : curr_covisibilities) {
+    std::unordered_map<unsigned int, std::shared_ptr<data::keyframe>> local_keyfrm_candidates;
+    std::vector<std::pair<unsigned int, unsigned int>> local_keyfrm_weights;
+    const auto curr_covisibilities = curr_keyfrm->graph_node_->get_covisibilities_and_num_shared_lms();
+    for (const auto& local_keyfrm_weight : curr_covisibilities) {
+        const auto& local_keyfrm = local_keyfrm_weight.first;
         if (!local_keyfrm) {
             continue;
         }
@@ -60,7 +71,13 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
             continue;
         }
 
-        local_keyfrms[local_keyfrm->id_] = local_keyfrm;
+        local_keyfrm_candidates[local_keyfrm->id_] = local_keyfrm;
+        local_keyfrm_weights.emplace_back(local_keyfrm->id_, local_keyfrm_weight.second);
+    }
+    // Keep the keyframes sharing the most observations with the current keyframe
+    for (const auto id : window_selector_.select_local_keyframes(local_keyfrm_weights)) {
+        const auto& local_keyfrm = local_keyfrm_candidates.at(id);
+        local_keyfrms[id] = local_keyfrm;
         if (local_keyfrm->camera_->setup_type_ != camera::setup_type_t::Monocular) {
             has_scale = true;
         }
@@ -88,6 +105,18 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
         }
     }
 
+    // Converged landmarks are held fixed
+    std::unordered_set<unsigned int> fixed_lm_ids;
+    if (convergence_checker_.is_enabled()) {
+        for (const auto& id_local_lm_pair : local_lms) {
+            if (convergence_checker_.is_fixed(*id_local_lm_pair.second, curr_keyfrm->id_)) {
+                fixed_lm_ids.insert(id_local_lm_pair.first);
+            }
+        }
+        spdlog::debug("local_bundle_adjuster: keyframe {} (fixed landmarks: {}/{})",
+                      curr_keyfrm->id_, fixed_lm_ids.size(), local_lms.size());
+    }
+
     // Correct markers seen in local keyframes
     std::unordered_map<unsigned int, std::shared_ptr<data::marker>> local_mkrs;
 
@@ -109,8 +138,15 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
 
     // Fixed keyframes: keyframes which observe local landmarks but which are NOT in local keyframes
     std::unordered_map<unsigned int, std::shared_ptr<data::keyframe>> fixed_keyfrms;
+    // Local landmarks observed by each fixed keyframe, and the number of observations in the local keyframes
+    std::unordered_map<unsigned int, std::vector<unsigned int>> lm_ids_of_fixed_keyfrms;
+    std::unordered_map<unsigned int, unsigned int> num_local_obs_of_lms;
 
     for (const auto& local_lm : local_lms) {
+        // A fixed landmark does not constrain the other fixed keyframes
+        if (fixed_lm_ids.count(local_lm.first)) {
+            continue;
+        }
         const auto observations = local_lm.second->get_observations();
         for (const auto& obs : observations) {
             const auto fixed_keyfrm = obs.first.lock();
@@ -123,9 +159,14 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
 
             // Do not add if it's in the local keyframes
             if (local_keyfrms.count(fixed_keyfrm->id_)) {
+                ++num_local_obs_of_lms[local_lm.first];
                 continue;
             }
 
+            if (window_selector_.is_enabled()) {
+                lm_ids_of_fixed_keyfrms[fixed_keyfrm->id_].push_back(local_lm.first);
+            }
+
             // Avoid duplication
             if (fixed_keyfrms.count(fixed_keyfrm->id_)) {
                 continue;
@@ -135,6 +176,19 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
         }
     }
 
+    if (window_selector_.is_enabled()) {
+        // Keep the informative fixed keyframes, and skip the ones whose constraints are redundant
+        const auto num_fixed_keyfrm_candidates = fixed_keyfrms.size();
+        std::unordered_map<unsigned int, std::shared_ptr<data::keyframe>> selected_fixed_keyfrms;
+        for (const auto id : window_selector_.select_fixed_keyframes(lm_ids_of_fixed_keyfrms, num_local_obs_of_lms)) {
+            selected_fixed_keyfrms[id] = fixed_keyfrms.at(id);
+        }
+        fixed_keyfrms = std::move(selected_fixed_keyfrms);
+        spdlog::debug("local_bundle_adjuster: window of keyframe {} (local: {}/{}, fixed: {}/{})",
+                      curr_keyfrm->id_, local_keyfrms.size(), local_keyfrm_candidates.size() + 1,
+                      fixed_keyfrms.size(), num_fixed_keyfrm_candidates);
+    }
+
     if (use_additional_keyframes_for_monocular_) {
         // Ensure that there are always at least two fixed keyframes
         auto additional_keyfrms_size = 2 - fixed_keyfrms.size();
@@ -149,11 +203,32 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
         }
     }
 
+    // Local keyframes connected with the previous keyframes (in time) by the IMU preintegration
+    std::vector<std::pair<std::shared_ptr<data::keyframe>, std::shared_ptr<data::keyframe>>> inertial_keyfrm_pairs;
+    for (const auto& id_local_keyfrm_pair : local_keyfrms) {
+        const auto& local_keyfrm = id_local_keyfrm_pair.second;
+        const auto prev_keyfrm = local_keyfrm->get_imu_prev_keyframe();
+        if (!prev_keyfrm || !local_keyfrm->get_imu_preintegration()) {
+            continue;
+        }
+        inertial_keyfrm_pairs.emplace_back(prev_keyfrm, local_keyfrm);
+    }
+    // The velocities are optimized only after the gravity is estimated
+    Vec3_t gravity_w;
+    const bool gravity_is_initialized = map_db->get_gravity(gravity_w);
+
     // 2. Construct an optimizer
 
     std::unique_ptr<g2o::BlockSolverBase> block_solver;
-    auto linear_solver = stella_vslam::make_unique<g2o::LinearSolverEigen<g2o::BlockSolver_6_3::PoseMatrixType>>();
-    block_solver = stella_vslam::make_unique<g2o::BlockSolver_6_3>(std::move(linear_solver));
+    if (!inertial_keyfrm_pairs.empty()) {
+        // The velocity and bias vertices have the different dimensions from the shot vertex
+        auto linear_solver = stella_vslam::make_unique<g2o::LinearSolverEigen<g2o::BlockSolverX::PoseMatrixType>>();
+        block_solver = stella_vslam::make_unique<g2o::BlockSolverX>(std::move(linear_solver));
+    }
+    else {
+        auto linear_solver = stella_vslam::make_unique<g2o::LinearSolverEigen<g2o::BlockSolver_6_3::PoseMatrixType>>();
+        block_solver = stella_vslam::make_unique<g2o::BlockSolver_6_3>(std::move(linear_solver));
+    }
     auto algorithm = new g2o::OptimizationAlgorithmLevenberg(std::move(block_solver));
 
     g2o::SparseOptimizer optimizer;
@@ -192,6 +267,83 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
         optimizer.addVertex(keyfrm_vtx);
     }
 
+    // Connect the inertial states of the keyframes by using the inertial edges
+    // (the states of the keyframes other than the local ones are held fixed)
+    std::unordered_map<unsigned int, internal::imu::velocity_vertex*> vel_vtxs;
+    std::unordered_map<unsigned int, internal::imu::bias_vertex*> bias_vtxs;
+    const auto create_inertial_vertices = [&](const std::shared_ptr<data::keyframe>& keyfrm) {
+        if (bias_vtxs.count(keyfrm->id_)) {
+            return;
+        }
+        const bool is_constant = !local_keyfrms.count(keyfrm->id_);
+        const auto imu_state = keyfrm->get_imu_state();
+
+        auto bias_vtx = new internal::imu::bias_vertex();
+        bias_vtx->setId(*vtx_id_offset);
+        (*vtx_id_offset)++;
+        bias_vtx->setEstimate(imu_state.bias_.to_vector());
+        bias_vtx->setFixed(is_constant);
+        optimizer.addVertex(bias_vtx);
+        bias_vtxs[keyfrm->id_] = bias_vtx;
+
+        if (gravity_is_initialized) {
+            auto vel_vtx = new internal::imu::velocity_vertex();
+            vel_vtx->setId(*vtx_id_offset);
+            (*vtx_id_offset)++;
+            vel_vtx->setEstimate(imu_state.velocity_);
+            vel_vtx->setFixed(is_constant);
+            optimizer.addVertex(vel_vtx);
+            vel_vtxs[keyfrm->id_] = vel_vtx;
+        }
+    };
+
+    for (const auto& keyfrm_pair : inertial_keyfrm_pairs) {
+        const auto& prev_keyfrm = keyfrm_pair.first;
+        const auto& keyfrm = keyfrm_pair.second;
+        const auto preint = keyfrm->get_imu_preintegration();
+
+        // The previous keyframe which is neither local nor fixed is added as a fixed one
+        if (!keyfrm_vtx_container.contain(prev_keyfrm)) {
+            all_keyfrms.emplace(prev_keyfrm->id_, prev_keyfrm);
+            auto keyfrm_vtx = keyfrm_vtx_container.create_vertex(prev_keyfrm, true);
+            optimizer.addVertex(keyfrm_vtx);
+        }
+        create_inertial_vertices(prev_keyfrm);
+        create_inertial_vertices(keyfrm);
+
+        const auto prev_keyfrm_vtx = keyfrm_vtx_container.get_vertex(prev_keyfrm);
+        const auto keyfrm_vtx = keyfrm_vtx_container.get_vertex(keyfrm);
+        const auto prev_bias_vtx = bias_vtxs.at(prev_keyfrm->id_);
+        const auto bias_vtx = bias_vtxs.at(keyfrm->id_);
+
+        if (gravity_is_initialized) {
+            auto inertial_edge = new internal::imu::inertial_edge(preint, gravity_w);
+            inertial_edge->setVertex(0, prev_keyfrm_vtx);
+            inertial_edge->setVertex(1, vel_vtxs.at(prev_keyfrm->id_));
+            inertial_edge->setVertex(2, keyfrm_vtx);
+            inertial_edge->setVertex(3, vel_vtxs.at(keyfrm->id_));
+            inertial_edge->setVertex(4, prev_bias_vtx);
+            inertial_edge->setInformation(preint->get_covariance().inverse());
+            optimizer.addEdge(inertial_edge);
+        }
+        else {
+            // Only the rotation is constrained without the gravity
+            auto inertial_edge = new internal::imu::inertial_rotation_edge(preint);
+            inertial_edge->setVertex(0, prev_keyfrm_vtx);
+            inertial_edge->setVertex(1, keyfrm_vtx);
+            inertial_edge->setVertex(2, prev_bias_vtx);
+            inertial_edge->setInformation(preint->get_covariance().block<3, 3>(0, 0).inverse());
+            optimizer.addEdge(inertial_edge);
+        }
+
+        // The bias follows the random walk between the keyframes
+        auto bias_edge = new internal::imu::bias_random_walk_edge();
+        bias_edge->setVertex(0, prev_bias_vtx);
+        bias_edge->setVertex(1, bias_vtx);
+        bias_edge->setInformation(preint->get_bias_random_walk_covariance().inverse());
+        optimizer.addEdge(bias_edge);
+    }
+
     // 4. Connect the vertices of the keyframe and the landmark by using an edge of reprojection constraint
 
     // Container of the landmark vertices
@@ -219,7 +371,8 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
         }
 
         // Convert the landmark to the g2o vertex, then set to the optimizer
-        auto lm_vtx = lm_vtx_container.create_vertex(local_lm, false);
+        const bool lm_is_fixed = fixed_lm_ids.count(id_local_lm_pair.first);
+        auto lm_vtx = lm_vtx_container.create_vertex(local_lm, lm_is_fixed);
         optimizer.addVertex(lm_vtx);
 
         for (const auto& obs : observations) {
@@ -234,10 +387,14 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
             if (!keyfrm_vtx_container.contain(keyfrm)) {
                 continue;
             }
+            // The edge between the fixed vertices has no effect
+            if (lm_is_fixed && !local_keyfrms.count(keyfrm->id_)) {
+                continue;
+            }
 
             const auto keyfrm_vtx = keyfrm_vtx_container.get_vertex(keyfrm);
-            const auto& undist_keypt = keyfrm->frm_obs_.undist_keypts_.at(idx);
-            const float x_right = keyfrm->frm_obs_.stereo_x_right_.empty() ? -1.0f : keyfrm->frm_obs_.stereo_x_right_.at(idx);
+            const auto& undist_keypt = keyfrm->frm_obs_->undist_keypts_.at(idx);
+            const float x_right = keyfrm->frm_obs_->stereo_x_right_.empty() ? -1.0f : keyfrm->frm_obs_->stereo_x_right_.at(idx);
             const float inv_sigma_sq = keyfrm->orb_params_->inv_level_sigma_sq_.at(undist_keypt.octave);
             const auto sqrt_chi_sq = (keyfrm->camera_->setup_type_ == camera::setup_type_t::Monocular)
                                          ? sqrt_chi_sq_2D
@@ -356,6 +513,9 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
 
     std::vector<std::pair<std::shared_ptr<data::keyframe>, std::shared_ptr<data::landmark>>> outlier_observations;
     outlier_observations.reserve(reproj_edge_wraps.size());
+    // Residual of the inliers to measure the accuracy with the bounded window
+    double inlier_chi_sq_sum = 0.0;
+    unsigned int num_inliers = 0;
 
     for (auto& reproj_edge_wrap : reproj_edge_wraps) {
         auto edge = reproj_edge_wrap.edge_;
@@ -368,13 +528,23 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
         if (reproj_edge_wrap.is_monocular_) {
             if (chi_sq_2D < edge->chi2() || !reproj_edge_wrap.depth_is_positive()) {
                 outlier_observations.emplace_back(std::make_pair(reproj_edge_wrap.shot_, reproj_edge_wrap.lm_));
+                continue;
             }
         }
         else {
             if (chi_sq_3D < edge->chi2() || !reproj_edge_wrap.depth_is_positive()) {
                 outlier_observations.emplace_back(std::make_pair(reproj_edge_wrap.shot_, reproj_edge_wrap.lm_));
+                continue;
             }
         }
+        inlier_chi_sq_sum += edge->chi2();
+        ++num_inliers;
+    }
+
+    if (window_selector_.is_enabled()) {
+        spdlog::debug("local_bundle_adjuster: keyframe {} (edges: {}, outliers: {}, mean chi2 of inliers: {})",
+                      curr_keyfrm->id_, reproj_edge_wraps.size(), outlier_observations.size(),
+                      (0 < num_inliers) ? inlier_chi_sq_sum / num_inliers : 0.0);
     }
 
     // 8. Update the information
@@ -393,23 +563,44 @@ void local_bundle_adjuster_g2o::optimize(data::map_database* map_db,
             }
         }
 
+        std::vector<unsigned int> changed_keyfrm_ids;
+        changed_keyfrm_ids.reserve(local_keyfrms.size());
         for (const auto& id_local_keyfrm_pair : local_keyfrms) {
             const auto& local_keyfrm = id_local_keyfrm_pair.second;
 
             auto keyfrm_vtx = keyfrm_vtx_container.get_vertex(local_keyfrm);
             local_keyfrm->set_pose_cw(util::converter::to_eigen_mat(keyfrm_vtx->estimate()));
+            changed_keyfrm_ids.push_back(id_local_keyfrm_pair.first);
+
+            if (bias_vtxs.count(id_local_keyfrm_pair.first)) {
+                auto imu_state = local_keyfrm->get_imu_state();
+                imu_state.bias_ = imu::bias(bias_vtxs.at(id_local_keyfrm_pair.first)->estimate());
+                if (vel_vtxs.count(id_local_keyfrm_pair.first)) {
+                    imu_state.velocity_ = vel_vtxs.at(id_local_keyfrm_pair.first)->estimate();
+                }
+                local_keyfrm->set_imu_state(imu_state);
+            }
         }
+        map_db->record_changed_keyframes(changed_keyfrm_ids);
 
+        std::vector<unsigned int> changed_lm_ids;
+        changed_lm_ids.reserve(local_lms.size());
         for (const auto& id_local_lm_pair : local_lms) {
             const auto& local_lm = id_local_lm_pair.second;
             if (local_lm->will_be_erased()) {
                 continue;
             }
 
+            if (fixed_lm_ids.count(id_local_lm_pair.first)) {
+                continue;
+            }
+
             auto lm_vtx = lm_vtx_container.get_vertex(local_lm);
-            local_lm->set_pos_in_world(lm_vtx->estimate());
+            local_lm->set_pos_in_world_by_BA(lm_vtx->estimate());
             local_lm->update_mean_normal_and_obs_scale_variance();
+            changed_lm_ids.push_back(id_local_lm_pair.first);
         }
+        map_db->record_changed_landmarks(changed_lm_ids);
 
         // Also update the marker positions
         for (auto& id_mkr_pair : local_mkrs) {
@@ -2,6 +2,8 @@
 #define STELLA_VSLAM_OPTIMIZE_LOCAL_BUNDLE_ADJUSTER_G2O_H
 
 #include "stella_vslam/optimize/local_bundle_adjuster.h"
+#include "stella_vslam/optimize/local_window_selector.h"
+#include "stella_vslam/optimize/landmark_convergence_checker.h"
 
 #include <memory>
 
@@ -39,13 +41,26 @@ public:
      */
     void optimize(data::map_database* map_db, const std::shared_ptr<data::keyframe>& curr_keyfrm, bool* const force_stop_flag) const override;
 
+    void set_num_iterations(const unsigned int num_first_iter, const unsigned int num_second_iter) override {
+        num_first_iter_ = num_first_iter;
+        num_second_iter_ = num_second_iter;
+    }
+
+    unsigned int get_num_first_iter() const override { return num_first_iter_; }
+
+    unsigned int get_num_second_iter() const override { return num_second_iter_; }
+
 private:
     //! number of iterations of first optimization
-    const unsigned int num_first_iter_;
+    unsigned int num_first_iter_;
     //! number of iterations of second optimization
-    const unsigned int num_second_iter_;
+    unsigned int num_second_iter_;
     //!
     const unsigned int use_additional_keyframes_for_monocular_ = false;
+    //! policy to bound the optimizable and fixed keyframes
+    const local_window_selector window_selector_;
+    //! policy to hold the converged landmarks fixed
+    const landmark_convergence_checker convergence_checker_;
 };
 
 } // namespace optimize
@@ -3,11 +3,15 @@
 #include "stella_vslam/data/keyframe.h"
 #include "stella_vslam/data/landmark.h"
 #include "stella_vslam/data/map_database.h"
+#include "stella_vslam/imu/preintegrator.h"
 #include "stella_vslam/optimize/local_bundle_adjuster_gtsam.h"
+#include "stella_vslam/optimize/internal_gtsam/inertial_factor.h"
 #include "stella_vslam/optimize/internal_gtsam/projection_factor.h"
 #include "stella_vslam/util/converter.h"
+#include "stella_vslam/util/yaml.h"
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include <gtsam/geometry/Cal3_S2Stereo.h>
 #include <gtsam/geometry/Cal3_S2.h>
@@ -17,6 +21,8 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
 
 #include <spdlog/spdlog.h>
 
@@ -27,7 +33,9 @@ local_bundle_adjuster_gtsam::local_bundle_adjuster_gtsam(const YAML::Node& yaml_
                                                          const unsigned int num_first_iter,
                                                          const unsigned int num_second_iter)
     : num_first_iter_(num_first_iter), num_second_iter_(num_second_iter),
-      use_additional_keyframes_for_monocular_(yaml_node["use_additional_keyframes_for_monocular"].as<bool>(false)) {
+      use_additional_keyframes_for_monocular_(yaml_node["use_additional_keyframes_for_monocular"].as<bool>(false)),
+      window_selector_(util::yaml_optional_ref(yaml_node, "local_ba_window")),
+      convergence_checker_(util::yaml_optional_ref(yaml_node, "landmark_fixing")) {
 }
 
 void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
@@ -39,8 +47,11 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
     bool has_scale = false;
 
     local_keyfrms[curr_keyfrm->id_] = curr_keyfrm;
-    const auto curr_covisibilities = curr_keyfrm->graph_node_->get_covisibilities();
-    for (const auto& local_keyfrm : curr_covisibilities) {
+    std::unordered_map<unsigned int, std::shared_ptr<data::keyframe>> local_keyfrm_candidates;
+    std::vector<std::pair<unsigned int, unsigned int>> local_keyfrm_weights;
+    const auto curr_covisibilities = curr_keyfrm->graph_node_->get_covisibilities_and_num_shared_lms();
+    for (const auto& local_keyfrm_weight : curr_covisibilities) {
+        const auto& local_keyfrm = local_keyfrm_weight.first;
         if (!local_keyfrm) {
             continue;
         }
@@ -54,7 +65,13 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
             continue;
         }
 
-        local_keyfrms[local_keyfrm->id_] = local_keyfrm;
+        local_keyfrm_candidates[local_keyfrm->id_] = local_keyfrm;
+        local_keyfrm_weights.emplace_back(local_keyfrm->id_, local_keyfrm_weight.second);
+    }
+    // Keep the keyframes sharing the most observations with the current keyframe
+    for (const auto id : window_selector_.select_local_keyframes(local_keyfrm_weights)) {
+        const auto& local_keyfrm = local_keyfrm_candidates.at(id);
+        local_keyfrms[id] = local_keyfrm;
         if (local_keyfrm->camera_->setup_type_ != camera::setup_type_t::Monocular) {
             has_scale = true;
         }
@@ -82,10 +99,29 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
         }
     }
 
+    // Converged landmarks are held fixed
+    std::unordered_set<unsigned int> fixed_lm_ids;
+    if (convergence_checker_.is_enabled()) {
+        for (const auto& id_local_lm_pair : local_lms) {
+            if (convergence_checker_.is_fixed(*id_local_lm_pair.second, curr_keyfrm->id_)) {
+                fixed_lm_ids.insert(id_local_lm_pair.first);
+            }
+        }
+        spdlog::debug("local_bundle_adjuster: keyframe {} (fixed landmarks: {}/{})",
+                      curr_keyfrm->id_, fixed_lm_ids.size(), local_lms.size());
+    }
+
     // Fixed keyframes: keyframes which observe local landmarks but which are NOT in local keyframes
     std::unordered_map<unsigned int, std::shared_ptr<data::keyframe>> fixed_keyfrms;
+    // Local landmarks observed by each fixed keyframe, and the number of observations in the local keyframes
+    std::unordered_map<unsigned int, std::vector<unsigned int>> lm_ids_of_fixed_keyfrms;
+    std::unordered_map<unsigned int, unsigned int> num_local_obs_of_lms;
 
     for (const auto& local_lm : local_lms) {
+        // A fixed landmark does not constrain the other fixed keyframes
+        if (fixed_lm_ids.count(local_lm.first)) {
+            continue;
+        }
         const auto observations = local_lm.second->get_observations();
         for (const auto& obs : observations) {
             const auto fixed_keyfrm = obs.first.lock();
@@ -98,9 +134,14 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
 
             // Do not add if it's in the local keyframes
             if (local_keyfrms.count(fixed_keyfrm->id_)) {
+                ++num_local_obs_of_lms[local_lm.first];
                 continue;
             }
 
+            if (window_selector_.is_enabled()) {
+                lm_ids_of_fixed_keyfrms[fixed_keyfrm->id_].push_back(local_lm.first);
+            }
+
             // Avoid duplication
             if (fixed_keyfrms.count(fixed_keyfrm->id_)) {
                 continue;
@@ -110,6 +151,19 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
         }
     }
 
+    if (window_selector_.is_enabled()) {
+        // Keep the informative fixed keyframes, and skip the ones whose constraints are redundant
+        const auto num_fixed_keyfrm_candidates = fixed_keyfrms.size();
+        std::unordered_map<unsigned int, std::shared_ptr<data::keyframe>> selected_fixed_keyfrms;
+        for (const auto id : window_selector_.select_fixed_keyframes(lm_ids_of_fixed_keyfrms, num_local_obs_of_lms)) {
+            selected_fixed_keyfrms[id] = fixed_keyfrms.at(id);
+        }
+        fixed_keyfrms = std::move(selected_fixed_keyfrms);
+        spdlog::debug("local_bundle_adjuster: window of keyframe {} (local: {}/{}, fixed: {}/{})",
+                      curr_keyfrm->id_, local_keyfrms.size(), local_keyfrm_candidates.size() + 1,
+                      fixed_keyfrms.size(), num_fixed_keyfrm_candidates);
+    }
+
     if (use_additional_keyframes_for_monocular_) {
         // Ensure that there are always at least two fixed keyframes
         auto additional_keyfrms_size = 2 - fixed_keyfrms.size();
@@ -124,6 +178,20 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
         }
     }
 
+    // Local keyframes connected with the previous keyframes (in time) by the IMU preintegration
+    std::vector<std::pair<std::shared_ptr<data::keyframe>, std::shared_ptr<data::keyframe>>> inertial_keyfrm_pairs;
+    for (const auto& id_local_keyfrm_pair : local_keyfrms) {
+        const auto& local_keyfrm = id_local_keyfrm_pair.second;
+        const auto prev_keyfrm = local_keyfrm->get_imu_prev_keyframe();
+        if (!prev_keyfrm || !local_keyfrm->get_imu_preintegration()) {
+            continue;
+        }
+        inertial_keyfrm_pairs.emplace_back(prev_keyfrm, local_keyfrm);
+    }
+    // The velocities are optimized only after the gravity is estimated
+    Vec3_t gravity_w;
+    const bool gravity_is_initialized = map_db->get_gravity(gravity_w);
+
     // 2. Construct an optimizer
 
     gtsam::NonlinearFactorGraph graph;
@@ -158,10 +226,76 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
         graph.addPrior(gtsam::Symbol('x', id_fixed_keyfrm_pair.first), pose, poseNoise);
     }
 
+    // Connect the inertial states of the keyframes by using the inertial factors
+    // (the states of the keyframes other than the local ones are held fixed by the priors)
+    const auto insert_inertial_states = [&](const std::shared_ptr<data::keyframe>& keyfrm) {
+        if (initial_estimate.exists(gtsam::Symbol('b', keyfrm->id_))) {
+            return;
+        }
+        const bool is_constant = !local_keyfrms.count(keyfrm->id_);
+        const auto imu_state = keyfrm->get_imu_state();
+
+        const gtsam::Vector6 b(imu_state.bias_.to_vector());
+        initial_estimate.insert(gtsam::Symbol('b', keyfrm->id_), b);
+        if (is_constant) {
+            graph.addPrior(gtsam::Symbol('b', keyfrm->id_), b, gtsam::noiseModel::Isotropic::Sigma(6, 1e-6));
+        }
+
+        if (gravity_is_initialized) {
+            const gtsam::Vector3 vel(imu_state.velocity_);
+            initial_estimate.insert(gtsam::Symbol('v', keyfrm->id_), vel);
+            if (is_constant) {
+                graph.addPrior(gtsam::Symbol('v', keyfrm->id_), vel, gtsam::noiseModel::Isotropic::Sigma(3, 1e-4));
+            }
+        }
+    };
+
+    for (const auto& keyfrm_pair : inertial_keyfrm_pairs) {
+        const auto& prev_keyfrm = keyfrm_pair.first;
+        const auto& keyfrm = keyfrm_pair.second;
+        const auto preint = keyfrm->get_imu_preintegration();
+
+        // The previous keyframe which is neither local nor fixed is added as a fixed one
+        if (!initial_estimate.exists(gtsam::Symbol('x', prev_keyfrm->id_))) {
+            all_keyfrms.emplace(prev_keyfrm->id_, prev_keyfrm);
+            auto pose = gtsam::Pose3(prev_keyfrm->get_pose_wc());
+            initial_estimate.insert(gtsam::Symbol('x', prev_keyfrm->id_), pose);
+            auto poseNoise = gtsam::noiseModel::Diagonal::Sigmas(
+                (gtsam::Vector(6) << gtsam::Vector3::Constant(1e-3), gtsam::Vector3::Constant(1e-2))
+                    .finished());
+            graph.addPrior(gtsam::Symbol('x', prev_keyfrm->id_), pose, poseNoise);
+        }
+        insert_inertial_states(prev_keyfrm);
+        insert_inertial_states(keyfrm);
+
+        if (gravity_is_initialized) {
+            graph.emplace_shared<internal_gtsam::InertialFactor>(
+                preint, gravity_w, gtsam::noiseModel::Gaussian::Covariance(preint->get_covariance()),
+                gtsam::Symbol('x', prev_keyfrm->id_), gtsam::Symbol('v', prev_keyfrm->id_),
+                gtsam::Symbol('x', keyfrm->id_), gtsam::Symbol('v', keyfrm->id_),
+                gtsam::Symbol('b', prev_keyfrm->id_));
+        }
+        else {
+            // Only the rotation is constrained without the gravity
+            graph.emplace_shared<internal_gtsam::InertialRotationFactor>(
+                preint, gtsam::noiseModel::Gaussian::Covariance(preint->get_covariance().block<3, 3>(0, 0)),
+                gtsam::Symbol('x', prev_keyfrm->id_), gtsam::Symbol('x', keyfrm->id_),
+                gtsam::Symbol('b', prev_keyfrm->id_));
+        }
+
+        // The bias follows the random walk between the keyframes
+        graph.emplace_shared<gtsam::BetweenFactor<gtsam::Vector6>>(
+            gtsam::Symbol('b', prev_keyfrm->id_), gtsam::Symbol('b', keyfrm->id_), gtsam::Vector6::Zero(),
+            gtsam::noiseModel::Gaussian::Covariance(preint->get_bias_random_walk_covariance()));
+    }
+
     // 4. Connect the vertices of the keyframe and the landmark by using an edge of reprojection constraint
 
     const double huber_k = 1.345;
 
+    // The fixed landmarks are embedded in the pose-only factors (indexed by the position in the graph)
+    std::unordered_map<size_t, std::shared_ptr<data::landmark>> fixed_lms_of_factors;
+
     for (const auto& id_local_lm_pair : local_lms) {
         const auto local_lm = id_local_lm_pair.second;
         const auto observations = local_lm->get_observations();
@@ -171,9 +305,12 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
         }
 
         // Convert the landmark to the gtsam vertex, then set to the optimizer
+        const bool lm_is_fixed = fixed_lm_ids.count(id_local_lm_pair.first);
         auto point = gtsam::Point3(local_lm->get_pos_in_world());
-        initial_estimate.insert(gtsam::Symbol('l', id_local_lm_pair.first),
-                                point);
+        if (!lm_is_fixed) {
+            initial_estimate.insert(gtsam::Symbol('l', id_local_lm_pair.first),
+                                    point);
+        }
 
         unsigned int num_edges = 0;
         for (const auto& obs : observations) {
@@ -188,9 +325,13 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
             if (!initial_estimate.exists(gtsam::Symbol('x', keyfrm->id_))) {
                 continue;
             }
+            // The factor between the fixed variables has no effect
+            if (lm_is_fixed && !local_keyfrms.count(keyfrm->id_)) {
+                continue;
+            }
 
-            const auto& undist_keypt = keyfrm->frm_obs_.undist_keypts_.at(idx);
-            const float x_right = keyfrm->frm_obs_.stereo_x_right_.empty() ? -1.0f : keyfrm->frm_obs_.stereo_x_right_.at(idx);
+            const auto& undist_keypt = keyfrm->frm_obs_->undist_keypts_.at(idx);
+            const float x_right = keyfrm->frm_obs_->stereo_x_right_.empty() ? -1.0f : keyfrm->frm_obs_->stereo_x_right_.at(idx);
             const float sigma_sq = keyfrm->orb_params_->level_sigma_sq_.at(undist_keypt.octave);
             // TODO: Support other models
             assert(keyfrm->camera_->model_type_ == camera::model_type_t::Perspective);
@@ -199,6 +340,9 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
             auto gaussian_noise_model = gtsam::noiseModel::Isotropic::Sigma(dim, sigma_sq);
             auto huber_noise_model = gtsam::noiseModel::Robust::Create(
                 gtsam::noiseModel::mEstimator::Huber::Create(huber_k), gaussian_noise_model);
+            if (lm_is_fixed) {
+                fixed_lms_of_factors[graph.size()] = local_lm;
+            }
             if (x_right < 0.0) {
                 gtsam::Point2 measurement(undist_keypt.pt.x, undist_keypt.pt.y);
                 switch (keyfrm->camera_->model_type_) {
@@ -208,6 +352,13 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
                         using monocular_factor_type = internal_gtsam::ProjectionFactor<gtsam::Pose3, gtsam::Point3,
                                                                                        monocular_calibration_type, internal_gtsam::PinholeCamera<monocular_calibration_type>>;
                         monocular_calibration_type::shared_ptr monocular_calibration(new monocular_calibration_type(cam->fx_, cam->fy_, 0.0, cam->cx_, cam->cy_));
+                        if (lm_is_fixed) {
+                            using fixed_monocular_factor_type = internal_gtsam::PoseOptFactor<gtsam::Pose3, gtsam::Point3,
+                                                                                              monocular_calibration_type, internal_gtsam::PinholeCamera<monocular_calibration_type>>;
+                            graph.emplace_shared<fixed_monocular_factor_type>(
+                                point, idx, measurement, huber_noise_model, gtsam::Symbol('x', keyfrm->id_), monocular_calibration);
+                            break;
+                        }
                         graph.emplace_shared<monocular_factor_type>(
                             measurement, huber_noise_model, gtsam::Symbol('x', keyfrm->id_), gtsam::Symbol('l', id_local_lm_pair.first), monocular_calibration);
                         break;
@@ -218,6 +369,13 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
                         using monocular_factor_type = internal_gtsam::ProjectionFactor<gtsam::Pose3, gtsam::Point3,
                                                                                        monocular_calibration_type, internal_gtsam::SphericalCamera<monocular_calibration_type>>;
                         boost::shared_ptr<monocular_calibration_type> monocular_calibration(new monocular_calibration_type(cam->rows_, cam->cols_));
+                        if (lm_is_fixed) {
+                            using fixed_monocular_factor_type = internal_gtsam::PoseOptFactor<gtsam::Pose3, gtsam::Point3,
+                                                                                              monocular_calibration_type, internal_gtsam::SphericalCamera<monocular_calibration_type>>;
+                            graph.emplace_shared<fixed_monocular_factor_type>(
+                                point, idx, measurement, huber_noise_model, gtsam::Symbol('x', keyfrm->id_), monocular_calibration);
+                            break;
+                        }
                         graph.emplace_shared<monocular_factor_type>(
                             measurement, huber_noise_model, gtsam::Symbol('x', keyfrm->id_), gtsam::Symbol('l', id_local_lm_pair.first), monocular_calibration);
                         break;
@@ -237,13 +395,21 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
                                                                                   stereo_calibration_type, gtsam::StereoCamera>;
                 gtsam::StereoPoint2 measurement(undist_keypt.pt.x, x_right, undist_keypt.pt.y);
                 stereo_calibration_type::shared_ptr stereo_calibration(new stereo_calibration_type(cam->fx_, cam->fy_, 0.0, cam->cx_, cam->cy_, cam->true_baseline_));
-                graph.emplace_shared<stereo_factor_type>(
-                    measurement, huber_noise_model, gtsam::Symbol('x', keyfrm->id_), gtsam::Symbol('l', id_local_lm_pair.first), stereo_calibration);
+                if (lm_is_fixed) {
+                    using fixed_stereo_factor_type = internal_gtsam::StereoPoseOptFactor<gtsam::Pose3, gtsam::Point3,
+                                                                                         stereo_calibration_type, gtsam::StereoCamera>;
+                    graph.emplace_shared<fixed_stereo_factor_type>(
+                        point, idx, measurement, huber_noise_model, gtsam::Symbol('x', keyfrm->id_), stereo_calibration);
+                }
+                else {
+                    graph.emplace_shared<stereo_factor_type>(
+                        measurement, huber_noise_model, gtsam::Symbol('x', keyfrm->id_), gtsam::Symbol('l', id_local_lm_pair.first), stereo_calibration);
+                }
             }
             ++num_edges;
         }
 
-        if (num_edges == 0) {
+        if (num_edges == 0 && !lm_is_fixed) {
             initial_estimate.erase(gtsam::Symbol('l', id_local_lm_pair.first));
             spdlog::warn("lm({}) no edges", local_lm->id_);
         }
@@ -266,8 +432,12 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
     // 7. Count the outliers
 
     std::vector<std::pair<std::shared_ptr<data::keyframe>, std::shared_ptr<data::landmark>>> outlier_observations;
+    // Residual of the inliers to measure the accuracy with the bounded window
+    double inlier_chi_sq_sum = 0.0;
+    unsigned int num_inliers = 0;
 
-    for (const auto& nonlinear_factor : graph) {
+    for (size_t factor_idx = 0; factor_idx < graph.size(); ++factor_idx) {
+        const auto& nonlinear_factor = graph.at(factor_idx);
         double mahalanobis_distance = -1.0;
         bool depth_is_positive = true;
 
@@ -302,11 +472,45 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
             }
         }
 
-        auto& lm = local_lms.at(gtsam::Symbol(nonlinear_factor->back()).index());
+        // filter reprojection factor of the fixed landmark
+        const auto& pose_opt_factor = boost::dynamic_pointer_cast<internal_gtsam::PoseOptFactorBase<gtsam::Pose3, gtsam::Point3>>(nonlinear_factor);
+        if (pose_opt_factor != nullptr) {
+            gtsam::Pose3 pose = result.at<gtsam::Pose3>(pose_opt_factor->key());
+            gtsam::Values values;
+            values.insert(pose_opt_factor->key(), pose);
+            const gtsam::Vector b = pose_opt_factor->unwhitenedError(values);
+            mahalanobis_distance = std::sqrt(pose_opt_factor->noiseModel()->squaredMahalanobisDistance(b));
+            try {
+                pose_opt_factor->project(pose);
+            }
+            catch (gtsam::CheiralityException& e) {
+                depth_is_positive = false;
+            }
+            catch (gtsam::StereoCheiralityException& e) {
+                depth_is_positive = false;
+            }
+        }
+
+        // filter the factors other than the reprojection ones
+        if (noise_model_factor == nullptr && pose_opt_factor == nullptr) {
+            continue;
+        }
+
+        auto& lm = (pose_opt_factor != nullptr) ? fixed_lms_of_factors.at(factor_idx)
+                                                : local_lms.at(gtsam::Symbol(nonlinear_factor->back()).index());
         auto& keyfrm = all_keyfrms.at(gtsam::Symbol(nonlinear_factor->front()).index());
         if (huber_k < mahalanobis_distance || !depth_is_positive) {
             outlier_observations.emplace_back(std::make_pair(keyfrm, lm));
+            continue;
         }
+        inlier_chi_sq_sum += mahalanobis_distance * mahalanobis_distance;
+        ++num_inliers;
+    }
+
+    if (window_selector_.is_enabled()) {
+        spdlog::debug("local_bundle_adjuster: keyframe {} (factors: {}, outliers: {}, mean chi2 of inliers: {})",
+                      curr_keyfrm->id_, graph.size(), outlier_observations.size(),
+                      (0 < num_inliers) ? inlier_chi_sq_sum / num_inliers : 0.0);
     }
 
     // 8. Update the information
@@ -326,12 +530,27 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
             }
         }
 
+        std::vector<unsigned int> changed_keyfrm_ids;
+        changed_keyfrm_ids.reserve(local_keyfrms.size());
         for (const auto& id_local_keyfrm_pair : local_keyfrms) {
             const auto& local_keyfrm = id_local_keyfrm_pair.second;
             auto pose = result.at<gtsam::Pose3>(gtsam::Symbol('x', id_local_keyfrm_pair.first));
             local_keyfrm->set_pose_cw(util::converter::inverse_pose(pose.matrix()));
+            changed_keyfrm_ids.push_back(id_local_keyfrm_pair.first);
+
+            if (result.exists(gtsam::Symbol('b', id_local_keyfrm_pair.first))) {
+                auto imu_state = local_keyfrm->get_imu_state();
+                imu_state.bias_ = imu::bias(Vec6_t(result.at<gtsam::Vector6>(gtsam::Symbol('b', id_local_keyfrm_pair.first))));
+                if (result.exists(gtsam::Symbol('v', id_local_keyfrm_pair.first))) {
+                    imu_state.velocity_ = result.at<gtsam::Vector3>(gtsam::Symbol('v', id_local_keyfrm_pair.first));
+                }
+                local_keyfrm->set_imu_state(imu_state);
+            }
         }
+        map_db->record_changed_keyframes(changed_keyfrm_ids);
 
+        std::vector<unsigned int> changed_lm_ids;
+        changed_lm_ids.reserve(local_lms.size());
         for (const auto& id_local_lm_pair : local_lms) {
             const auto& local_lm = id_local_lm_pair.second;
             if (local_lm->will_be_erased()) {
@@ -342,9 +561,11 @@ void local_bundle_adjuster_gtsam::optimize(data::map_database* map_db,
             }
 
             auto point = result.at<gtsam::Point3>(gtsam::Symbol('l', id_local_lm_pair.first));
-            local_lm->set_pos_in_world(point);
+            local_lm->set_pos_in_world_by_BA(point);
             local_lm->update_mean_normal_and_obs_scale_variance();
+            changed_lm_ids.push_back(id_local_lm_pair.first);
         }
+        map_db->record_changed_landmarks(changed_lm_ids);
     }
 }
 
@@ -0,0 +1,85 @@
+#include "stella_vslam/optimize/local_window_selector.h"
+
+#include <algorithm>
+
+namespace stella_vslam {
+namespace optimize {
+
+local_window_selector::local_window_selector(const unsigned int max_num_local_keyfrms,
+                                             const unsigned int max_num_fixed_keyfrms,
+                                             const unsigned int num_obs_per_lm_thr)
+    : max_num_local_keyfrms_(max_num_local_keyfrms), max_num_fixed_keyfrms_(max_num_fixed_keyfrms),
+      num_obs_per_lm_thr_(num_obs_per_lm_thr) {}
+
+local_window_selector::local_window_selector(const YAML::Node& yaml_node)
+    : local_window_selector(yaml_node["max_num_local_keyfrms"].as<unsigned int>(0),
+                            yaml_node["max_num_fixed_keyfrms"].as<unsigned int>(0),
+                            yaml_node["num_obs_per_lm_thr"].as<unsigned int>(0)) {}
+
+bool local_window_selector::is_enabled() const {
+    return 0 < max_num_local_keyfrms_ || 0 < max_num_fixed_keyfrms_ || 0 < num_obs_per_lm_thr_;
+}
+
+namespace {
+
+void sort_by_information(std::vector<std::pair<unsigned int, unsigned int>>& candidates) {
+    // Descending order of the number of observations (the newer keyframe first if tied)
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<unsigned int, unsigned int>& a, const std::pair<unsigned int, unsigned int>& b) {
+                  return (a.second != b.second) ? (a.second > b.second) : (a.first > b.first);
+              });
+}
+
+} // namespace
+
+std::vector<unsigned int> local_window_selector::select_local_keyframes(std::vector<std::pair<unsigned int, unsigned int>> candidates) const {
+    sort_by_information(candidates);
+    // The current keyframe is counted in the max number
+    if (0 < max_num_local_keyfrms_ && max_num_local_keyfrms_ - 1 < candidates.size()) {
+        candidates.resize(max_num_local_keyfrms_ - 1);
+    }
+
+    std::vector<unsigned int> selected_ids;
+    selected_ids.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        selected_ids.push_back(candidate.first);
+    }
+    return selected_ids;
+}
+
+std::vector<unsigned int> local_window_selector::select_fixed_keyframes(const std::unordered_map<unsigned int, std::vector<unsigned int>>& lm_ids_of_candidates,
+                                                                        std::unordered_map<unsigned int, unsigned int> num_obs_of_lms) const {
+    std::vector<std::pair<unsigned int, unsigned int>> candidates;
+    candidates.reserve(lm_ids_of_candidates.size());
+    for (const auto& id_lm_ids : lm_ids_of_candidates) {
+        candidates.emplace_back(id_lm_ids.first, id_lm_ids.second.size());
+    }
+    sort_by_information(candidates);
+
+    std::vector<unsigned int> selected_ids;
+    for (const auto& candidate : candidates) {
+        if (0 < max_num_fixed_keyfrms_ && max_num_fixed_keyfrms_ <= selected_ids.size()) {
+            break;
+        }
+
+        const auto& lm_ids = lm_ids_of_candidates.at(candidate.first);
+        if (0 < num_obs_per_lm_thr_) {
+            // Skip the keyframe whose constraints are redundant
+            const bool is_redundant = std::all_of(lm_ids.begin(), lm_ids.end(), [&](const unsigned int lm_id) {
+                return num_obs_per_lm_thr_ <= num_obs_of_lms[lm_id];
+            });
+            if (is_redundant) {
+                continue;
+            }
+        }
+
+        selected_ids.push_back(candidate.first);
+        for (const auto lm_id : lm_ids) {
+            ++num_obs_of_lms[lm_id];
+        }
+    }
+    return selected_ids;
+}
+
+} // namespace optimize
+} // namespace stella_vslam
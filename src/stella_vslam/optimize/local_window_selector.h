@@ -0,0 +1,60 @@
+#ifndef STELLA_VSLAM_OPTIMIZE_LOCAL_WINDOW_SELECTOR_H
+#define STELLA_VSLAM_OPTIMIZE_LOCAL_WINDOW_SELECTOR_H
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace stella_vslam {
+namespace optimize {
+
+/**
+ * Policy to bound the window of the local bundle adjustment.
+ * The optimizable keyframes are ranked by the number of observations shared with the current keyframe,
+ * and the fixed keyframes by the number of observations of the local landmarks.
+ * A fixed keyframe is skipped as redundant if all of its local landmarks are already constrained enough.
+ * All the keyframes are selected with the default parameters.
+ */
+class local_window_selector {
+public:
+    //! Constructor
+    explicit local_window_selector(const unsigned int max_num_local_keyfrms = 0,
+                                   const unsigned int max_num_fixed_keyfrms = 0,
+                                   const unsigned int num_obs_per_lm_thr = 0);
+
+    //! Constructor
+    explicit local_window_selector(const YAML::Node& yaml_node);
+
+    //! Return true if the window is bounded
+    bool is_enabled() const;
+
+    /**
+     * Select the optimizable keyframes other than the current keyframe
+     * @param candidates keyframe IDs and the numbers of observations shared with the current keyframe
+     * @return selected keyframe IDs
+     */
+    std::vector<unsigned int> select_local_keyframes(std::vector<std::pair<unsigned int, unsigned int>> candidates) const;
+
+    /**
+     * Select the fixed keyframes
+     * @param lm_ids_of_candidates keyframe IDs and the IDs of the local landmarks observed by them
+     * @param num_obs_of_lms number of the observations of each local landmark in the optimizable keyframes
+     * @return selected keyframe IDs
+     */
+    std::vector<unsigned int> select_fixed_keyframes(const std::unordered_map<unsigned int, std::vector<unsigned int>>& lm_ids_of_candidates,
+                                                     std::unordered_map<unsigned int, unsigned int> num_obs_of_lms) const;
+
+    //! max number of the optimizable keyframes including the current keyframe (0 means unlimited)
+    const unsigned int max_num_local_keyfrms_;
+    //! max number of the fixed keyframes (0 means unlimited)
+    const unsigned int max_num_fixed_keyfrms_;
+    //! a local landmark with this number of observations in the window is constrained enough (0 means no subsampling)
+    const unsigned int num_obs_per_lm_thr_;
+};
+
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZE_LOCAL_WINDOW_SELECTOR_H
@@ -0,0 +1,236 @@
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/optimize/pose_graph_refiner.h"
+#include "stella_vslam/optimize/pose_optimizer_g2o.h"
+#include "stella_vslam/optimize/terminate_action.h"
+#include "stella_vslam/optimize/internal/sim3/shot_vertex.h"
+#include "stella_vslam/optimize/internal/sim3/graph_opt_edge.h"
+#include "stella_vslam/util/converter.h"
+#include "stella_vslam/benchmark/timer.h"
+
+#include <algorithm>
+#include <future>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+#include <Eigen/StdVector>
+#include <g2o/core/solver.h>
+#include <g2o/core/block_solver.h>
+#include <g2o/core/sparse_optimizer.h>
+#include <g2o/solvers/csparse/linear_solver_csparse.h>
+#include <g2o/core/optimization_algorithm_levenberg.h>
+
+namespace stella_vslam {
+namespace optimize {
+
+pose_graph_refiner::pose_graph_refiner(const unsigned int min_num_shared_lms, const unsigned int num_iter)
+    : min_num_shared_lms_(min_num_shared_lms), num_iter_(num_iter) {}
+
+bool pose_graph_refiner::optimize(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                                  eigen_alloc_unord_map<unsigned int, Mat44_t>& keyfrm_to_pose_cw_after_refinement,
+                                  bool* const force_stop_flag) const {
+    STELLA_BENCHMARK_TIMER("optimize::pose_graph_refiner", "optimize");
+
+    // 1. Collect the keyframe pairs to be constrained
+
+    std::unordered_map<unsigned int, std::shared_ptr<data::keyframe>> id_to_keyfrm;
+    for (const auto& keyfrm : keyfrms) {
+        if (!keyfrm || keyfrm->will_be_erased()) {
+            continue;
+        }
+        id_to_keyfrm[keyfrm->id_] = keyfrm;
+    }
+
+    // The spanning tree and the loop edges are always constrained to keep the graph connected
+    std::vector<std::pair<std::shared_ptr<data::keyframe>, std::shared_ptr<data::keyframe>>> keyfrm_pairs;
+    std::vector<bool> is_tree_edge;
+    std::set<std::pair<unsigned int, unsigned int>> inserted_pairs;
+    const auto add_pair = [&](const std::shared_ptr<data::keyframe>& keyfrm_1, const std::shared_ptr<data::keyframe>& keyfrm_2, const bool tree_edge) {
+        if (!keyfrm_2 || !id_to_keyfrm.count(keyfrm_2->id_)) {
+            return;
+        }
+        const auto key = std::make_pair(std::min(keyfrm_1->id_, keyfrm_2->id_), std::max(keyfrm_1->id_, keyfrm_2->id_));
+        if (key.first == key.second || !inserted_pairs.insert(key).second) {
+            return;
+        }
+        keyfrm_pairs.emplace_back(keyfrm_1, keyfrm_2);
+        is_tree_edge.push_back(tree_edge);
+    };
+    for (const auto& id_keyfrm : id_to_keyfrm) {
+        const auto& keyfrm = id_keyfrm.second;
+        add_pair(keyfrm, keyfrm->graph_node_->get_spanning_parent(), true);
+        for (const auto& loop_keyfrm : keyfrm->graph_node_->get_loop_edges()) {
+            add_pair(keyfrm, loop_keyfrm, true);
+        }
+        for (const auto& covisibility : keyfrm->graph_node_->get_covisibilities_over_min_num_shared_lms(min_num_shared_lms_)) {
+            add_pair(keyfrm, covisibility, false);
+        }
+    }
+
+    // 2. Localize each keyframe against its landmarks in parallel
+    //    (each keyframe is solved only once, and the localizations are shared by all the pairs)
+
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms_to_localize;
+    std::unordered_map<unsigned int, unsigned int> keyfrm_id_to_idx;
+    keyfrms_to_localize.reserve(id_to_keyfrm.size());
+    for (const auto& id_keyfrm : id_to_keyfrm) {
+        keyfrm_id_to_idx[id_keyfrm.first] = keyfrms_to_localize.size();
+        keyfrms_to_localize.push_back(id_keyfrm.second);
+    }
+
+    eigen_alloc_vector<Mat44_t> localized_poses_cw(keyfrms_to_localize.size());
+    std::vector<std::vector<bool>> outlier_flags(keyfrms_to_localize.size());
+    std::vector<unsigned int> nums_localization_inliers(keyfrms_to_localize.size(), 0);
+    const unsigned int num_threads = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned int chunk_size = std::max(1u, static_cast<unsigned int>((keyfrms_to_localize.size() + num_threads - 1) / num_threads));
+    std::vector<std::future<void>> futures;
+    for (unsigned int begin = 0; begin < keyfrms_to_localize.size(); begin += chunk_size) {
+        const unsigned int end = std::min<unsigned int>(begin + chunk_size, keyfrms_to_localize.size());
+        futures.push_back(std::async(std::launch::async, [&, begin, end] {
+            const pose_optimizer_g2o pose_optimizer;
+            for (unsigned int i = begin; i < end; ++i) {
+                if (force_stop_flag && *force_stop_flag) {
+                    return;
+                }
+                nums_localization_inliers.at(i) = pose_optimizer.optimize(keyfrms_to_localize.at(i).get(), localized_poses_cw.at(i), outlier_flags.at(i));
+            }
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+    if (force_stop_flag && *force_stop_flag) {
+        return false;
+    }
+
+    // Distill the relative pose constraints from the localizations
+
+    eigen_alloc_vector<Mat44_t> rel_poses_21(keyfrm_pairs.size());
+    std::vector<unsigned int> nums_inliers(keyfrm_pairs.size(), 0);
+    for (unsigned int i = 0; i < keyfrm_pairs.size(); ++i) {
+        const auto idx_1 = keyfrm_id_to_idx.at(keyfrm_pairs.at(i).first->id_);
+        const auto idx_2 = keyfrm_id_to_idx.at(keyfrm_pairs.at(i).second->id_);
+        if (nums_localization_inliers.at(idx_1) < min_num_shared_lms_ || nums_localization_inliers.at(idx_2) < min_num_shared_lms_) {
+            continue;
+        }
+        const auto num_shared_inliers = count_shared_inliers(keyfrm_pairs.at(i).first, outlier_flags.at(idx_1),
+                                                             keyfrm_pairs.at(i).second, outlier_flags.at(idx_2));
+        if (num_shared_inliers < min_num_shared_lms_) {
+            continue;
+        }
+        rel_poses_21.at(i) = localized_poses_cw.at(idx_2) * util::converter::inverse_pose(localized_poses_cw.at(idx_1));
+        nums_inliers.at(i) = num_shared_inliers;
+    }
+
+    // 3. Construct an optimizer
+
+    auto linear_solver = stella_vslam::make_unique<g2o::LinearSolverCSparse<g2o::BlockSolver_7_3::PoseMatrixType>>();
+    auto block_solver = stella_vslam::make_unique<g2o::BlockSolver_7_3>(std::move(linear_solver));
+    auto algorithm = new g2o::OptimizationAlgorithmLevenberg(std::move(block_solver));
+
+    g2o::SparseOptimizer optimizer;
+    auto terminateAction = new terminate_action;
+    terminateAction->setGainThreshold(1e-3);
+    optimizer.addPostIterationAction(terminateAction);
+    optimizer.setAlgorithm(algorithm);
+    if (force_stop_flag) {
+        optimizer.setForceStopFlag(force_stop_flag);
+    }
+
+    // 4. Add the keyframe vertices (the scale is fixed)
+
+    bool has_fixed_vertex = false;
+    for (const auto& id_keyfrm : id_to_keyfrm) {
+        const auto& keyfrm = id_keyfrm.second;
+        auto keyfrm_vtx = new internal::sim3::shot_vertex();
+        keyfrm_vtx->setEstimate(g2o::Sim3(keyfrm->get_rot_cw(), keyfrm->get_trans_cw(), 1.0));
+        keyfrm_vtx->setFixed(keyfrm->graph_node_->is_spanning_root());
+        has_fixed_vertex |= keyfrm_vtx->fixed();
+        keyfrm_vtx->setId(keyfrm->id_);
+        keyfrm_vtx->fix_scale_ = true;
+        optimizer.addVertex(keyfrm_vtx);
+    }
+    if (!has_fixed_vertex && !id_to_keyfrm.empty()) {
+        optimizer.vertex(id_to_keyfrm.begin()->first)->setFixed(true);
+    }
+
+    // 5. Add the relative pose edges weighted with the number of the shared landmarks
+
+    for (unsigned int i = 0; i < keyfrm_pairs.size(); ++i) {
+        const auto& keyfrm_1 = keyfrm_pairs.at(i).first;
+        const auto& keyfrm_2 = keyfrm_pairs.at(i).second;
+
+        Mat44_t rel_pose_21;
+        double weight;
+        if (nums_inliers.at(i) != 0) {
+            rel_pose_21 = rel_poses_21.at(i);
+            weight = nums_inliers.at(i);
+        }
+        else if (is_tree_edge.at(i)) {
+            // Keep the current relative pose with the lowest weight
+            rel_pose_21 = keyfrm_2->get_pose_cw() * keyfrm_1->get_pose_wc();
+            weight = 1.0;
+        }
+        else {
+            continue;
+        }
+
+        auto edge = new internal::sim3::graph_opt_edge();
+        edge->setVertex(0, optimizer.vertex(keyfrm_1->id_));
+        edge->setVertex(1, optimizer.vertex(keyfrm_2->id_));
+        edge->setMeasurement(g2o::Sim3(rel_pose_21.block<3, 3>(0, 0), rel_pose_21.block<3, 1>(0, 3), 1.0));
+        edge->information() = weight * MatRC_t<7, 7>::Identity();
+        optimizer.addEdge(edge);
+    }
+
+    // 6. Perform a pose graph optimization
+
+    optimizer.initializeOptimization();
+    optimizer.optimize(num_iter_);
+
+    const bool aborted = force_stop_flag && *force_stop_flag && !terminateAction->stopped_by_terminate_action_;
+    delete terminateAction;
+    if (aborted) {
+        return false;
+    }
+
+    // 7. Extract the result
+
+    for (const auto& id_keyfrm : id_to_keyfrm) {
+        const auto keyfrm_vtx = static_cast<internal::sim3::shot_vertex*>(optimizer.vertex(id_keyfrm.first));
+        const g2o::Sim3& Sim3_cw = keyfrm_vtx->estimate();
+        const Mat33_t rot_cw = Sim3_cw.rotation().toRotationMatrix();
+        const Vec3_t trans_cw = Sim3_cw.translation() / Sim3_cw.scale();
+        keyfrm_to_pose_cw_after_refinement[id_keyfrm.first] = util::converter::to_eigen_pose(rot_cw, trans_cw);
+    }
+
+    return true;
+}
+
+unsigned int pose_graph_refiner::count_shared_inliers(const std::shared_ptr<data::keyframe>& keyfrm_1,
+                                                      const std::vector<bool>& outlier_flags_1,
+                                                      const std::shared_ptr<data::keyframe>& keyfrm_2,
+                                                      const std::vector<bool>& outlier_flags_2) const {
+    const auto lms_1 = keyfrm_1->get_landmarks();
+    const auto lms_2 = keyfrm_2->get_landmarks();
+    unsigned int num_shared_inliers = 0;
+    for (unsigned int idx_2 = 0; idx_2 < lms_2.size(); ++idx_2) {
+        const auto& lm = lms_2.at(idx_2);
+        if (!lm || lm->will_be_erased() || outlier_flags_2.at(idx_2)) {
+            continue;
+        }
+        const int idx_1 = lm->get_index_in_keyframe(keyfrm_1);
+        if (idx_1 < 0 || lms_1.size() <= static_cast<unsigned int>(idx_1) || lms_1.at(idx_1) != lm) {
+            continue;
+        }
+        if (outlier_flags_1.at(idx_1)) {
+            continue;
+        }
+        ++num_shared_inliers;
+    }
+    return num_shared_inliers;
+}
+
+} // namespace optimize
+} // namespace stella_vslam
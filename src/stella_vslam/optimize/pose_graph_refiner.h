@@ -0,0 +1,75 @@
+#ifndef STELLA_VSLAM_OPTIMIZE_POSE_GRAPH_REFINER_H
+#define STELLA_VSLAM_OPTIMIZE_POSE_GRAPH_REFINER_H
+
+#include "stella_vslam/type.h"
+
+#include <memory>
+#include <vector>
+
+namespace stella_vslam {
+
+namespace data {
+class keyframe;
+} // namespace data
+
+namespace optimize {
+
+/**
+ * Pose-only refinement of the keyframes (cheaper alternative of the global bundle adjustment)
+ * The relative pose constraints between the covisible keyframes are distilled from their shared landmarks:
+ * each keyframe is localized once against its landmarks, and the relative pose of a pair is taken from
+ * the two localizations if enough shared landmarks are inliers in both,
+ * so the error of the shared landmark positions largely cancels out in their relative pose.
+ * The landmarks are not optimized, and have to be re-anchored to their reference keyframes afterwards.
+ */
+class pose_graph_refiner {
+public:
+    /**
+     * Constructor
+     * @param min_num_shared_lms
+     * @param num_iter
+     */
+    explicit pose_graph_refiner(
+        unsigned int min_num_shared_lms = 15,
+        unsigned int num_iter = 20);
+
+    /**
+     * Destructor
+     */
+    virtual ~pose_graph_refiner() = default;
+
+    /**
+     * Perform optimization
+     * @param keyfrms
+     * @param keyfrm_to_pose_cw_after_refinement
+     * @param force_stop_flag
+     * @return false if aborted
+     */
+    bool optimize(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                  eigen_alloc_unord_map<unsigned int, Mat44_t>& keyfrm_to_pose_cw_after_refinement,
+                  bool* const force_stop_flag = nullptr) const;
+
+private:
+    /**
+     * Count the landmarks shared by keyfrm_1 and keyfrm_2 which are inliers in both of their localizations
+     * @param keyfrm_1
+     * @param outlier_flags_1
+     * @param keyfrm_2
+     * @param outlier_flags_2
+     * @return number of the shared landmarks which are inliers in both keyframes
+     */
+    unsigned int count_shared_inliers(const std::shared_ptr<data::keyframe>& keyfrm_1,
+                                      const std::vector<bool>& outlier_flags_1,
+                                      const std::shared_ptr<data::keyframe>& keyfrm_2,
+                                      const std::vector<bool>& outlier_flags_2) const;
+
+    //! minimum number of the shared landmarks to distill a relative pose constraint
+    const unsigned int min_num_shared_lms_;
+    //! number of iterations of optimization
+    const unsigned int num_iter_;
+};
+
+} // namespace optimize
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_OPTIMIZE_POSE_GRAPH_REFINER_H
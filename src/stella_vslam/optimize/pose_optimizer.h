@@ -19,6 +19,11 @@ namespace feature {
 struct orb_params;
 } // namespace feature
 
+namespace imu {
+struct constraint;
+struct state;
+} // namespace imu
+
 namespace optimize {
 
 class pose_optimizer {
@@ -31,6 +36,19 @@ public:
     virtual unsigned int optimize(const data::frame& frm, Mat44_t& optimized_pose, std::vector<bool>& outlier_flags) const = 0;
     virtual unsigned int optimize(const data::keyframe* keyfrm, Mat44_t& optimized_pose, std::vector<bool>& outlier_flags) const = 0;
 
+    /**
+     * Perform pose optimization with the inertial constraint from the reference frame
+     * @param frm
+     * @param imu_constraint
+     * @param optimized_pose
+     * @param optimized_imu_state velocity and IMU bias of the frame
+     * @param outlier_flags
+     * @return
+     */
+    virtual unsigned int optimize(const data::frame& frm, const imu::constraint& imu_constraint,
+                                  Mat44_t& optimized_pose, imu::state& optimized_imu_state,
+                                  std::vector<bool>& outlier_flags) const = 0;
+
     virtual unsigned int optimize(const Mat44_t& cam_pose_cw, const data::frame_observation& frm_obs,
                                   const feature::orb_params* orb_params,
                                   const camera::base* camera,
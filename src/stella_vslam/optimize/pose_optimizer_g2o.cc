@@ -1,9 +1,14 @@
 #include "stella_vslam/data/frame.h"
 #include "stella_vslam/data/keyframe.h"
 #include "stella_vslam/data/landmark.h"
+#include "stella_vslam/imu/preintegrator.h"
+#include "stella_vslam/imu/state.h"
 #include "stella_vslam/optimize/pose_optimizer_g2o.h"
 #include "stella_vslam/optimize/terminate_action.h"
 #include "stella_vslam/optimize/internal/se3/pose_opt_edge_wrapper.h"
+#include "stella_vslam/optimize/internal/imu/bias_random_walk_edge.h"
+#include "stella_vslam/optimize/internal/imu/inertial_edge.h"
+#include "stella_vslam/optimize/internal/imu/inertial_rotation_edge.h"
 #include "stella_vslam/util/converter.h"
 #include "stella_vslam/benchmark/timer.h"
 
@@ -25,29 +30,56 @@ pose_optimizer_g2o::pose_optimizer_g2o(const unsigned int num_trials_robust, con
     : num_trials_robust_(num_trials_robust), num_trials_(num_trials), num_each_iter_(num_each_iter) {}
 
 unsigned int pose_optimizer_g2o::optimize(const data::frame& frm, Mat44_t& optimized_pose, std::vector<bool>& outlier_flags) const {
-    auto num_valid_obs = optimize(frm.get_pose_cw(), frm.frm_obs_, frm.orb_params_, frm.camera_,
+    auto num_valid_obs = optimize(frm.get_pose_cw(), *frm.frm_obs_, frm.orb_params_, frm.camera_,
                                   frm.get_landmarks(), optimized_pose, outlier_flags);
     return num_valid_obs;
 }
 
 unsigned int pose_optimizer_g2o::optimize(const data::keyframe* keyfrm, Mat44_t& optimized_pose, std::vector<bool>& outlier_flags) const {
-    auto num_valid_obs = optimize(keyfrm->get_pose_cw(), keyfrm->frm_obs_, keyfrm->orb_params_, keyfrm->camera_,
+    auto num_valid_obs = optimize(keyfrm->get_pose_cw(), *keyfrm->frm_obs_, keyfrm->orb_params_, keyfrm->camera_,
                                   keyfrm->get_landmarks(), optimized_pose, outlier_flags);
     return num_valid_obs;
 }
 
+unsigned int pose_optimizer_g2o::optimize(const data::frame& frm, const imu::constraint& imu_constraint,
+                                          Mat44_t& optimized_pose, imu::state& optimized_imu_state,
+                                          std::vector<bool>& outlier_flags) const {
+    auto num_valid_obs = optimize(frm.get_pose_cw(), *frm.frm_obs_, frm.orb_params_, frm.camera_,
+                                  frm.get_landmarks(), &imu_constraint, optimized_pose, &optimized_imu_state, outlier_flags);
+    return num_valid_obs;
+}
+
+unsigned int pose_optimizer_g2o::optimize(const Mat44_t& cam_pose_cw, const data::frame_observation& frm_obs,
+                                          const feature::orb_params* orb_params,
+                                          const camera::base* camera,
+                                          const std::vector<std::shared_ptr<data::landmark>>& landmarks,
+                                          Mat44_t& optimized_pose,
+                                          std::vector<bool>& outlier_flags) const {
+    return optimize(cam_pose_cw, frm_obs, orb_params, camera, landmarks, nullptr, optimized_pose, nullptr, outlier_flags);
+}
+
 unsigned int pose_optimizer_g2o::optimize(const Mat44_t& cam_pose_cw, const data::frame_observation& frm_obs,
                                           const feature::orb_params* orb_params,
                                           const camera::base* camera,
                                           const std::vector<std::shared_ptr<data::landmark>>& landmarks,
+                                          const imu::constraint* imu_constraint,
                                           Mat44_t& optimized_pose,
+                                          imu::state* optimized_imu_state,
                                           std::vector<bool>& outlier_flags) const {
     STELLA_BENCHMARK_TIMER("optimize::pose_optimizer", "optimize");
     
     // 1. Construct an optimizer
 
-    auto linear_solver = stella_vslam::make_unique<g2o::LinearSolverEigen<g2o::BlockSolver_6_3::PoseMatrixType>>();
-    auto block_solver = stella_vslam::make_unique<g2o::BlockSolver_6_3>(std::move(linear_solver));
+    std::unique_ptr<g2o::BlockSolverBase> block_solver;
+    if (imu_constraint) {
+        // The velocity and bias vertices have the different dimensions from the shot vertex
+        auto linear_solver = stella_vslam::make_unique<g2o::LinearSolverEigen<g2o::BlockSolverX::PoseMatrixType>>();
+        block_solver = stella_vslam::make_unique<g2o::BlockSolverX>(std::move(linear_solver));
+    }
+    else {
+        auto linear_solver = stella_vslam::make_unique<g2o::LinearSolverEigen<g2o::BlockSolver_6_3::PoseMatrixType>>();
+        block_solver = stella_vslam::make_unique<g2o::BlockSolver_6_3>(std::move(linear_solver));
+    }
     auto algorithm = new g2o::OptimizationAlgorithmLevenberg(std::move(block_solver));
 
     g2o::SparseOptimizer optimizer;
@@ -70,7 +102,76 @@ unsigned int pose_optimizer_g2o::optimize(const Mat44_t& cam_pose_cw, const data
     outlier_flags.resize(num_keypts);
     std::fill(outlier_flags.begin(), outlier_flags.end(), false);
 
-    // 3. Connect the landmark vertices by using projection edges
+    // 3. Connect the fixed state of the reference frame by using the inertial edges
+
+    internal::imu::velocity_vertex* vel_vtx = nullptr;
+    internal::imu::bias_vertex* bias_vtx = nullptr;
+    if (imu_constraint) {
+        const auto& preint = imu_constraint->preint_;
+        const auto& ref_state = imu_constraint->ref_state_;
+        if (optimized_imu_state) {
+            *optimized_imu_state = ref_state;
+        }
+
+        auto ref_frm_vtx = new internal::se3::shot_vertex();
+        ref_frm_vtx->setId(1);
+        ref_frm_vtx->setEstimate(util::converter::to_g2o_SE3(imu_constraint->ref_pose_cw_));
+        ref_frm_vtx->setFixed(true);
+        optimizer.addVertex(ref_frm_vtx);
+
+        auto ref_bias_vtx = new internal::imu::bias_vertex();
+        ref_bias_vtx->setId(2);
+        ref_bias_vtx->setEstimate(ref_state.bias_.to_vector());
+        ref_bias_vtx->setFixed(true);
+        optimizer.addVertex(ref_bias_vtx);
+
+        bias_vtx = new internal::imu::bias_vertex();
+        bias_vtx->setId(3);
+        bias_vtx->setEstimate(ref_state.bias_.to_vector());
+        bias_vtx->setFixed(false);
+        optimizer.addVertex(bias_vtx);
+
+        // The bias follows the random walk from the reference frame
+        auto bias_edge = new internal::imu::bias_random_walk_edge();
+        bias_edge->setVertex(0, ref_bias_vtx);
+        bias_edge->setVertex(1, bias_vtx);
+        bias_edge->setInformation(preint->get_bias_random_walk_covariance().inverse());
+        optimizer.addEdge(bias_edge);
+
+        if (imu_constraint->gravity_is_initialized_) {
+            auto ref_vel_vtx = new internal::imu::velocity_vertex();
+            ref_vel_vtx->setId(4);
+            ref_vel_vtx->setEstimate(ref_state.velocity_);
+            ref_vel_vtx->setFixed(true);
+            optimizer.addVertex(ref_vel_vtx);
+
+            vel_vtx = new internal::imu::velocity_vertex();
+            vel_vtx->setId(5);
+            vel_vtx->setEstimate(ref_state.velocity_);
+            vel_vtx->setFixed(false);
+            optimizer.addVertex(vel_vtx);
+
+            auto inertial_edge = new internal::imu::inertial_edge(preint, imu_constraint->gravity_w_);
+            inertial_edge->setVertex(0, ref_frm_vtx);
+            inertial_edge->setVertex(1, ref_vel_vtx);
+            inertial_edge->setVertex(2, frm_vtx);
+            inertial_edge->setVertex(3, vel_vtx);
+            inertial_edge->setVertex(4, bias_vtx);
+            inertial_edge->setInformation(preint->get_covariance().inverse());
+            optimizer.addEdge(inertial_edge);
+        }
+        else {
+            // Only the rotation is constrained without the gravity
+            auto inertial_edge = new internal::imu::inertial_rotation_edge(preint);
+            inertial_edge->setVertex(0, ref_frm_vtx);
+            inertial_edge->setVertex(1, frm_vtx);
+            inertial_edge->setVertex(2, bias_vtx);
+            inertial_edge->setInformation(preint->get_covariance().block<3, 3>(0, 0).inverse());
+            optimizer.addEdge(inertial_edge);
+        }
+    }
+
+    // 4. Connect the landmark vertices by using projection edges
 
     // Container of the reprojection edges
     using pose_opt_edge_wrapper = internal::se3::pose_opt_edge_wrapper;
@@ -114,7 +215,7 @@ unsigned int pose_optimizer_g2o::optimize(const Mat44_t& cam_pose_cw, const data
         return 0;
     }
 
-    // 4. Perform robust Bundle Adjustment (BA)
+    // 5. Perform robust Bundle Adjustment (BA)
 
     unsigned int num_bad_obs = 0;
     if (num_trials_robust_ == 0) {
@@ -170,9 +271,17 @@ unsigned int pose_optimizer_g2o::optimize(const Mat44_t& cam_pose_cw, const data
 
     delete terminateAction;
 
-    // 5. Update the information
+    // 6. Update the information
 
     optimized_pose = util::converter::to_eigen_mat(frm_vtx->estimate());
+    if (optimized_imu_state) {
+        if (vel_vtx) {
+            optimized_imu_state->velocity_ = vel_vtx->estimate();
+        }
+        if (bias_vtx) {
+            optimized_imu_state->bias_ = imu::bias(bias_vtx->estimate());
+        }
+    }
 
     return num_init_obs - num_bad_obs;
 }
@@ -21,6 +21,11 @@ namespace feature {
 struct orb_params;
 } // namespace feature
 
+namespace imu {
+struct constraint;
+struct state;
+} // namespace imu
+
 namespace optimize {
 
 class pose_optimizer_g2o : public pose_optimizer {
@@ -49,6 +54,10 @@ public:
     unsigned int optimize(const data::frame& frm, Mat44_t& optimized_pose, std::vector<bool>& outlier_flags) const override;
     unsigned int optimize(const data::keyframe* keyfrm, Mat44_t& optimized_pose, std::vector<bool>& outlier_flags) const override;
 
+    unsigned int optimize(const data::frame& frm, const imu::constraint& imu_constraint,
+                          Mat44_t& optimized_pose, imu::state& optimized_imu_state,
+                          std::vector<bool>& outlier_flags) const override;
+
     unsigned int optimize(const Mat44_t& cam_pose_cw, const data::frame_observation& frm_obs,
                           const feature::orb_params* orb_params,
                           const camera::base* camera,
@@ -57,6 +66,18 @@ public:
                           std::vector<bool>& outlier_flags) const override;
 
 private:
+    /**
+     * Perform pose optimization (with the inertial constraint if given)
+     */
+    unsigned int optimize(const Mat44_t& cam_pose_cw, const data::frame_observation& frm_obs,
+                          const feature::orb_params* orb_params,
+                          const camera::base* camera,
+                          const std::vector<std::shared_ptr<data::landmark>>& landmarks,
+                          const imu::constraint* imu_constraint,
+                          Mat44_t& optimized_pose,
+                          imu::state* optimized_imu_state,
+                          std::vector<bool>& outlier_flags) const;
+
     //! Number of robust optimization (with outlier rejection) attempts
     const unsigned int num_trials_robust_ = 2;
 
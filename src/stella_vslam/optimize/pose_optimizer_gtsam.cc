@@ -3,7 +3,10 @@
 #include "stella_vslam/data/frame.h"
 #include "stella_vslam/data/keyframe.h"
 #include "stella_vslam/data/landmark.h"
+#include "stella_vslam/imu/preintegrator.h"
+#include "stella_vslam/imu/state.h"
 #include "stella_vslam/optimize/pose_optimizer_gtsam.h"
+#include "stella_vslam/optimize/internal_gtsam/inertial_factor.h"
 #include "stella_vslam/optimize/internal_gtsam/projection_factor.h"
 #include "stella_vslam/util/converter.h"
 
@@ -16,6 +19,7 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
+#include <gtsam/slam/PriorFactor.h>
 
 #include <vector>
 
@@ -35,22 +39,41 @@ pose_optimizer_gtsam::pose_optimizer_gtsam(unsigned int num_iter,
       enable_outlier_elimination_(enable_outlier_elimination), verbosity_(verbosity) {}
 
 unsigned int pose_optimizer_gtsam::optimize(const data::frame& frm, Mat44_t& optimized_pose, std::vector<bool>& outlier_flags) const {
-    auto num_valid_obs = optimize(frm.get_pose_cw(), frm.frm_obs_, frm.orb_params_, frm.camera_,
+    auto num_valid_obs = optimize(frm.get_pose_cw(), *frm.frm_obs_, frm.orb_params_, frm.camera_,
                                   frm.get_landmarks(), optimized_pose, outlier_flags);
     return num_valid_obs;
 }
 
 unsigned int pose_optimizer_gtsam::optimize(const data::keyframe* keyfrm, Mat44_t& optimized_pose, std::vector<bool>& outlier_flags) const {
-    auto num_valid_obs = optimize(keyfrm->get_pose_cw(), keyfrm->frm_obs_, keyfrm->orb_params_, keyfrm->camera_,
+    auto num_valid_obs = optimize(keyfrm->get_pose_cw(), *keyfrm->frm_obs_, keyfrm->orb_params_, keyfrm->camera_,
                                   keyfrm->get_landmarks(), optimized_pose, outlier_flags);
     return num_valid_obs;
 }
 
+unsigned int pose_optimizer_gtsam::optimize(const data::frame& frm, const imu::constraint& imu_constraint,
+                                            Mat44_t& optimized_pose, imu::state& optimized_imu_state,
+                                            std::vector<bool>& outlier_flags) const {
+    auto num_valid_obs = optimize(frm.get_pose_cw(), *frm.frm_obs_, frm.orb_params_, frm.camera_,
+                                  frm.get_landmarks(), &imu_constraint, optimized_pose, &optimized_imu_state, outlier_flags);
+    return num_valid_obs;
+}
+
+unsigned int pose_optimizer_gtsam::optimize(const Mat44_t& cam_pose_cw, const data::frame_observation& frm_obs,
+                                            const feature::orb_params* orb_params,
+                                            const camera::base* camera,
+                                            const std::vector<std::shared_ptr<data::landmark>>& landmarks,
+                                            Mat44_t& optimized_pose,
+                                            std::vector<bool>& outlier_flags) const {
+    return optimize(cam_pose_cw, frm_obs, orb_params, camera, landmarks, nullptr, optimized_pose, nullptr, outlier_flags);
+}
+
 unsigned int pose_optimizer_gtsam::optimize(const Mat44_t& cam_pose_cw, const data::frame_observation& frm_obs,
                                             const feature::orb_params* orb_params,
                                             const camera::base* camera,
                                             const std::vector<std::shared_ptr<data::landmark>>& landmarks,
+                                            const imu::constraint* imu_constraint,
                                             Mat44_t& optimized_pose,
+                                            imu::state* optimized_imu_state,
                                             std::vector<bool>& outlier_flags) const {
     // 1. Construct an optimizer
 
@@ -72,7 +95,39 @@ unsigned int pose_optimizer_gtsam::optimize(const Mat44_t& cam_pose_cw, const da
     outlier_flags.resize(num_keypts);
     std::fill(outlier_flags.begin(), outlier_flags.end(), false);
 
-    // 3. Connect the landmark vertices by using projection edges
+    // 3. Connect the fixed state of the reference frame by using the inertial factors
+
+    if (imu_constraint) {
+        const auto& preint = imu_constraint->preint_;
+        const auto& ref_state = imu_constraint->ref_state_;
+        if (optimized_imu_state) {
+            *optimized_imu_state = ref_state;
+        }
+
+        // The bias follows the random walk from the reference frame
+        values.insert(gtsam::Symbol('b', 0), gtsam::Vector6(ref_state.bias_.to_vector()));
+        graph.emplace_shared<gtsam::PriorFactor<gtsam::Vector6>>(
+            gtsam::Symbol('b', 0), gtsam::Vector6(ref_state.bias_.to_vector()),
+            gtsam::noiseModel::Gaussian::Covariance(preint->get_bias_random_walk_covariance()));
+
+        if (imu_constraint->gravity_is_initialized_) {
+            values.insert(gtsam::Symbol('v', 0), gtsam::Vector3(ref_state.velocity_));
+            graph.emplace_shared<internal_gtsam::InertialPoseOptFactor>(
+                preint, imu_constraint->gravity_w_, imu_constraint->ref_pose_cw_, ref_state.velocity_,
+                gtsam::noiseModel::Gaussian::Covariance(preint->get_covariance()),
+                gtsam::Symbol('x', 0), gtsam::Symbol('v', 0), gtsam::Symbol('b', 0));
+        }
+        else {
+            // Only the rotation is constrained without the gravity
+            const Mat33_t ref_rot_cw = imu_constraint->ref_pose_cw_.block<3, 3>(0, 0);
+            graph.emplace_shared<internal_gtsam::InertialRotationPoseOptFactor>(
+                preint, ref_rot_cw,
+                gtsam::noiseModel::Gaussian::Covariance(preint->get_covariance().block<3, 3>(0, 0)),
+                gtsam::Symbol('x', 0), gtsam::Symbol('b', 0));
+        }
+    }
+
+    // 4. Connect the landmark vertices by using projection edges
 
     const double huber_k = 1.345;
     const double sq_huber_k = huber_k * huber_k;
@@ -160,7 +215,7 @@ unsigned int pose_optimizer_gtsam::optimize(const Mat44_t& cam_pose_cw, const da
         return 0;
     }
 
-    // 4. Perform robust Bundle Adjustment (BA)
+    // 5. Perform robust Bundle Adjustment (BA)
     gtsam::LevenbergMarquardtParams lm_params;
     lm_params.setMaxIterations(num_iter_);
     lm_params.setRelativeErrorTol(relative_error_tol_);
@@ -171,7 +226,7 @@ unsigned int pose_optimizer_gtsam::optimize(const Mat44_t& cam_pose_cw, const da
 
     unsigned int num_bad_obs = 0;
     if (enable_outlier_elimination_) {
-        std::vector<boost::shared_ptr<internal_gtsam::PoseOptFactorBase<gtsam::Pose3, gtsam::Point3>>> outlier_factors(num_keypts, nullptr);
+        std::vector<boost::shared_ptr<internal_gtsam::PoseOptFactorBase<gtsam::Pose3, gtsam::Point3>>> outlier_factors(graph.size(), nullptr);
         const unsigned int num_trials = 2;
         for (unsigned int trial = 0; trial < num_trials; ++trial) {
             gtsam::LevenbergMarquardtOptimizer optimizer(graph, values, lm_params);
@@ -226,10 +281,18 @@ unsigned int pose_optimizer_gtsam::optimize(const Mat44_t& cam_pose_cw, const da
         values = optimizer.optimize();
     }
 
-    // 5. Update the information
+    // 6. Update the information
 
     auto pose = values.at<gtsam::Pose3>(gtsam::Symbol('x', 0));
     optimized_pose = util::converter::inverse_pose(pose.matrix());
+    if (optimized_imu_state) {
+        if (values.exists(gtsam::Symbol('v', 0))) {
+            optimized_imu_state->velocity_ = values.at<gtsam::Vector3>(gtsam::Symbol('v', 0));
+        }
+        if (values.exists(gtsam::Symbol('b', 0))) {
+            optimized_imu_state->bias_ = imu::bias(Vec6_t(values.at<gtsam::Vector6>(gtsam::Symbol('b', 0))));
+        }
+    }
 
     return num_init_obs - num_bad_obs;
 }
@@ -0,0 +1,396 @@
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/data/map_database.h"
+#include "stella_vslam/publish/shared_memory_exporter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace stella_vslam {
+namespace publish {
+
+shared_memory_exporter::shared_memory_exporter(const std::string& name,
+                                               data::map_database* map_db,
+                                               const unsigned int pose_capacity,
+                                               const unsigned int delta_capacity,
+                                               const unsigned int snapshot_capacity,
+                                               const unsigned int map_export_interval_ms,
+                                               const unsigned int snapshot_interval,
+                                               const bool overwrite_existing)
+    : name_(name),
+      pose_capacity_(std::max(1u, pose_capacity)),
+      delta_capacity_(std::max(1u, delta_capacity)),
+      snapshot_capacity_(snapshot_capacity),
+      map_export_interval_ms_(map_export_interval_ms),
+      snapshot_interval_(snapshot_interval),
+      map_db_(map_db) {
+    spdlog::debug("CONSTRUCT: publish::shared_memory_exporter");
+
+    if (overwrite_existing) {
+        // Remove the stale one so that the readers of it are not confused by the new layout
+        shm_unlink(name_.c_str());
+    }
+    // Fail if it exists, so that the shared memory of another running instance is not taken over
+    const int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        if (errno == EEXIST) {
+            throw std::runtime_error("the shared memory " + name_ + " already exists (used by another instance or left by a crashed one); "
+                                     + "remove it or set overwrite_existing");
+        }
+        throw std::runtime_error("cannot create the shared memory " + name_ + ": " + std::strerror(errno));
+    }
+    size_ = shm::get_size(pose_capacity_, delta_capacity_, snapshot_capacity_);
+    // The memory extended by ftruncate is zero-filled, so all the slots are initially empty
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        const std::string error = std::strerror(errno);
+        close(fd);
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("cannot allocate the shared memory " + name_ + ": " + error);
+    }
+    addr_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr_ == MAP_FAILED) {
+        addr_ = nullptr;
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("cannot map the shared memory " + name_ + ": " + std::strerror(errno));
+    }
+
+    auto base = static_cast<char*>(addr_);
+    header_ = new (base) shm::header();
+    header_->layout_version_ = shm::layout_version;
+    header_->pose_capacity_ = pose_capacity_;
+    header_->delta_capacity_ = delta_capacity_;
+    header_->snapshot_capacity_ = snapshot_capacity_;
+    header_->pose_offset_ = shm::get_pose_offset();
+    header_->delta_offset_ = shm::get_delta_offset(pose_capacity_);
+    header_->snapshot_offset_ = shm::get_snapshot_offset(pose_capacity_, delta_capacity_);
+    header_->num_poses_.store(0, std::memory_order_relaxed);
+    header_->num_deltas_.store(0, std::memory_order_relaxed);
+    header_->map_version_.store(0, std::memory_order_relaxed);
+    header_->num_snapshots_.store(0, std::memory_order_relaxed);
+    pose_slots_ = reinterpret_cast<shm::pose_slot*>(base + header_->pose_offset_);
+    delta_slots_ = reinterpret_cast<shm::map_delta_slot*>(base + header_->delta_offset_);
+    for (unsigned int i = 0; i < 2; ++i) {
+        snapshots_[i] = new (base + header_->snapshot_offset_ + i * shm::get_snapshot_size(snapshot_capacity_)) shm::snapshot_header();
+        snapshots_[i]->seq_.store(0, std::memory_order_relaxed);
+    }
+    // The readers accept the memory after the magic number is written
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic_ = shm::magic;
+
+    if (map_db_) {
+        map_db_->enable_change_recording();
+    }
+
+    spdlog::info("export the poses and the map to the shared memory {} ({} bytes)", name_, size_);
+}
+
+shared_memory_exporter::shared_memory_exporter(const YAML::Node& yaml_node, data::map_database* map_db)
+    : shared_memory_exporter(yaml_node["name"].as<std::string>("/stella_vslam"),
+                             map_db,
+                             yaml_node["pose_capacity"].as<unsigned int>(64),
+                             yaml_node["delta_capacity"].as<unsigned int>(65536),
+                             yaml_node["snapshot_capacity"].as<unsigned int>(131072),
+                             yaml_node["map_export_interval_ms"].as<unsigned int>(200),
+                             yaml_node["snapshot_interval"].as<unsigned int>(50),
+                             yaml_node["overwrite_existing"].as<bool>(false)) {}
+
+shared_memory_exporter::~shared_memory_exporter() {
+    terminate();
+    if (addr_) {
+        munmap(addr_, size_);
+        addr_ = nullptr;
+    }
+    shm_unlink(name_.c_str());
+    spdlog::debug("DESTRUCT: publish::shared_memory_exporter");
+}
+
+void shared_memory_exporter::publish_pose(const double timestamp, const tracker_state_t tracking_state,
+                                          const std::shared_ptr<Mat44_t>& cam_pose_wc) {
+    const uint64_t n = header_->num_poses_.load(std::memory_order_relaxed);
+    auto& slot = pose_slots_[n % pose_capacity_];
+
+    slot.seq_.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.data_.timestamp_ = timestamp;
+    slot.data_.tracking_state_ = static_cast<uint32_t>(tracking_state);
+    slot.data_.pose_is_valid_ = cam_pose_wc ? 1 : 0;
+    Eigen::Map<Mat44_t>(slot.data_.pose_wc_) = cam_pose_wc ? *cam_pose_wc : Mat44_t::Identity();
+    slot.seq_.store(n + 1, std::memory_order_release);
+
+    header_->num_poses_.store(n + 1, std::memory_order_release);
+}
+
+void shared_memory_exporter::publish_map_changes(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                                                 const std::vector<std::shared_ptr<data::landmark>>& lms,
+                                                 const std::vector<unsigned int>& erased_keyfrm_ids,
+                                                 const std::vector<unsigned int>& erased_lm_ids) {
+    const uint64_t num_deltas_before = header_->num_deltas_.load(std::memory_order_relaxed);
+
+    shm::map_delta_data delta;
+    std::memset(&delta, 0, sizeof(delta));
+    delta.map_version_ = next_map_version_;
+
+    // Keyframes
+    delta.entity_ = static_cast<uint32_t>(shm::entity_t::Keyframe);
+    delta.op_ = static_cast<uint32_t>(shm::delta_op_t::Upsert);
+    for (const auto& keyfrm : keyfrms) {
+        if (keyfrm->will_be_erased()) {
+            continue;
+        }
+        delta.id_ = keyfrm->id_;
+        Eigen::Map<Mat44_t>(delta.data_) = keyfrm->get_pose_wc();
+        write_map_delta(delta);
+    }
+    delta.op_ = static_cast<uint32_t>(shm::delta_op_t::Erase);
+    std::fill(delta.data_, delta.data_ + 16, 0.0);
+    for (const auto& keyfrm : keyfrms) {
+        if (keyfrm->will_be_erased()) {
+            delta.id_ = keyfrm->id_;
+            write_map_delta(delta);
+        }
+    }
+    for (const auto id : erased_keyfrm_ids) {
+        delta.id_ = id;
+        write_map_delta(delta);
+    }
+
+    // Landmarks
+    delta.entity_ = static_cast<uint32_t>(shm::entity_t::Landmark);
+    delta.op_ = static_cast<uint32_t>(shm::delta_op_t::Upsert);
+    for (const auto& lm : lms) {
+        if (lm->will_be_erased()) {
+            continue;
+        }
+        delta.id_ = lm->id_;
+        delta.aux_ = lm->num_observations();
+        Eigen::Map<Vec3_t>(delta.data_) = lm->get_pos_in_world();
+        write_map_delta(delta);
+    }
+    delta.op_ = static_cast<uint32_t>(shm::delta_op_t::Erase);
+    delta.aux_ = 0;
+    std::fill(delta.data_, delta.data_ + 16, 0.0);
+    for (const auto& lm : lms) {
+        if (lm->will_be_erased()) {
+            delta.id_ = lm->id_;
+            write_map_delta(delta);
+        }
+    }
+    for (const auto id : erased_lm_ids) {
+        delta.id_ = id;
+        write_map_delta(delta);
+    }
+
+    publish_map_version(num_deltas_before);
+}
+
+bool shared_memory_exporter::publish_map_reset(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                                               const std::vector<std::shared_ptr<data::landmark>>& lms) {
+    // The Reset delta is written only after the snapshot fits, so that the readers always have a snapshot to resync with
+    if (!write_snapshot(keyfrms, lms, next_map_version_)) {
+        return false;
+    }
+
+    const uint64_t num_deltas_before = header_->num_deltas_.load(std::memory_order_relaxed);
+
+    shm::map_delta_data delta;
+    std::memset(&delta, 0, sizeof(delta));
+    delta.map_version_ = next_map_version_;
+    delta.op_ = static_cast<uint32_t>(shm::delta_op_t::Reset);
+    write_map_delta(delta);
+
+    publish_map_version(num_deltas_before);
+    // The snapshot follows the Reset delta
+    commit_snapshot(delta.map_version_);
+    return true;
+}
+
+bool shared_memory_exporter::publish_snapshot(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                                              const std::vector<std::shared_ptr<data::landmark>>& lms) {
+    const uint64_t map_version = header_->map_version_.load(std::memory_order_relaxed);
+    if (!write_snapshot(keyfrms, lms, map_version)) {
+        return false;
+    }
+    commit_snapshot(map_version);
+    return true;
+}
+
+bool shared_memory_exporter::write_snapshot(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                                            const std::vector<std::shared_ptr<data::landmark>>& lms,
+                                            const uint64_t map_version) {
+    // Write to the older buffer, so that the readers can keep copying the latest one
+    const uint64_t n = header_->num_snapshots_.load(std::memory_order_relaxed);
+    auto snapshot = snapshots_[n % 2];
+    auto entities = reinterpret_cast<shm::map_delta_data*>(snapshot + 1);
+
+    snapshot->seq_.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    shm::map_delta_data entity;
+    std::memset(&entity, 0, sizeof(entity));
+    entity.map_version_ = map_version;
+    entity.op_ = static_cast<uint32_t>(shm::delta_op_t::Upsert);
+
+    uint64_t num_entities = 0;
+    entity.entity_ = static_cast<uint32_t>(shm::entity_t::Keyframe);
+    for (const auto& keyfrm : keyfrms) {
+        if (!keyfrm || keyfrm->will_be_erased()) {
+            continue;
+        }
+        if (snapshot_capacity_ <= num_entities) {
+            spdlog::warn("shared_memory_exporter: the map exceeds the snapshot capacity ({})", snapshot_capacity_);
+            return false;
+        }
+        entity.id_ = keyfrm->id_;
+        Eigen::Map<Mat44_t>(entity.data_) = keyfrm->get_pose_wc();
+        entities[num_entities++] = entity;
+    }
+    entity.entity_ = static_cast<uint32_t>(shm::entity_t::Landmark);
+    std::fill(entity.data_, entity.data_ + 16, 0.0);
+    for (const auto& lm : lms) {
+        if (!lm || lm->will_be_erased()) {
+            continue;
+        }
+        if (snapshot_capacity_ <= num_entities) {
+            spdlog::warn("shared_memory_exporter: the map exceeds the snapshot capacity ({})", snapshot_capacity_);
+            return false;
+        }
+        entity.id_ = lm->id_;
+        entity.aux_ = lm->num_observations();
+        Eigen::Map<Vec3_t>(entity.data_) = lm->get_pos_in_world();
+        entities[num_entities++] = entity;
+    }
+
+    snapshot->num_entities_ = num_entities;
+    return true;
+}
+
+void shared_memory_exporter::commit_snapshot(const uint64_t map_version) {
+    const uint64_t n = header_->num_snapshots_.load(std::memory_order_relaxed);
+    auto snapshot = snapshots_[n % 2];
+    snapshot->map_version_ = map_version;
+    snapshot->next_delta_ = header_->num_deltas_.load(std::memory_order_relaxed);
+    snapshot->seq_.store(n + 1, std::memory_order_release);
+
+    header_->num_snapshots_.store(n + 1, std::memory_order_release);
+    num_versions_since_snapshot_ = 0;
+}
+
+void shared_memory_exporter::export_map_changes() {
+    auto changes = map_db_->take_changes();
+
+    if (changes.is_cleared_ || changes.all_changed_ || reset_is_pending_) {
+        // Writing the whole map to the ring would overwrite itself, so let the readers resync with the snapshot.
+        // If it does not fit, the readers keep the last consistent map, and the reset is retried in the next export
+        // (the changes until then are included in the snapshot)
+        snapshot_is_requested_ = false;
+        reset_is_pending_ = !publish_map_reset(map_db_->get_all_keyframes(), map_db_->get_all_landmarks());
+        return;
+    }
+
+    const bool snapshot_is_needed = snapshot_is_requested_.exchange(false)
+                                    || (0 < snapshot_interval_ && snapshot_interval_ <= num_versions_since_snapshot_);
+    if (!changes.keyfrm_ids_.empty() || !changes.lm_ids_.empty()) {
+        std::vector<std::shared_ptr<data::keyframe>> keyfrms;
+        std::vector<unsigned int> erased_keyfrm_ids;
+        for (const auto id : changes.keyfrm_ids_) {
+            auto keyfrm = map_db_->get_keyframe(id);
+            if (keyfrm) {
+                keyfrms.push_back(keyfrm);
+            }
+            else {
+                erased_keyfrm_ids.push_back(id);
+            }
+        }
+        std::vector<std::shared_ptr<data::landmark>> lms;
+        std::vector<unsigned int> erased_lm_ids;
+        for (const auto id : changes.lm_ids_) {
+            auto lm = map_db_->get_landmark(id);
+            if (lm) {
+                lms.push_back(lm);
+            }
+            else {
+                erased_lm_ids.push_back(id);
+            }
+        }
+        publish_map_changes(keyfrms, lms, erased_keyfrm_ids, erased_lm_ids);
+    }
+
+    if (snapshot_is_needed) {
+        publish_snapshot(map_db_->get_all_keyframes(), map_db_->get_all_landmarks());
+    }
+}
+
+void shared_memory_exporter::request_snapshot() {
+    snapshot_is_requested_ = true;
+}
+
+void shared_memory_exporter::start() {
+    if (thread_ || !map_db_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx_terminate_);
+        terminate_is_requested_ = false;
+    }
+    thread_ = std::unique_ptr<std::thread>(new std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mtx_terminate_);
+        while (!cv_terminate_.wait_for(lock, std::chrono::milliseconds(map_export_interval_ms_),
+                                       [this]() { return terminate_is_requested_; })) {
+            lock.unlock();
+            export_map_changes();
+            lock.lock();
+        }
+    }));
+}
+
+void shared_memory_exporter::terminate() {
+    if (!thread_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx_terminate_);
+        terminate_is_requested_ = true;
+    }
+    cv_terminate_.notify_all();
+    thread_->join();
+    thread_.reset(nullptr);
+}
+
+void shared_memory_exporter::publish_map_version(const uint64_t num_deltas_before) {
+    const uint64_t num_deltas = header_->num_deltas_.load(std::memory_order_relaxed) - num_deltas_before;
+    if (num_deltas == 0) {
+        return;
+    }
+    if (delta_capacity_ < num_deltas) {
+        spdlog::warn("shared_memory_exporter: {} map deltas exceed the capacity ({})", num_deltas, delta_capacity_);
+    }
+    header_->map_version_.store(next_map_version_, std::memory_order_release);
+    ++next_map_version_;
+    ++num_versions_since_snapshot_;
+}
+
+void shared_memory_exporter::write_map_delta(const shm::map_delta_data& delta) {
+    const uint64_t n = header_->num_deltas_.load(std::memory_order_relaxed);
+    auto& slot = delta_slots_[n % delta_capacity_];
+
+    slot.seq_.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.data_ = delta;
+    slot.seq_.store(n + 1, std::memory_order_release);
+
+    header_->num_deltas_.store(n + 1, std::memory_order_release);
+}
+
+} // namespace publish
+} // namespace stella_vslam
@@ -0,0 +1,145 @@
+#ifndef STELLA_VSLAM_PUBLISH_SHARED_MEMORY_EXPORTER_H
+#define STELLA_VSLAM_PUBLISH_SHARED_MEMORY_EXPORTER_H
+
+#include "stella_vslam/type.h"
+#include "stella_vslam/tracking_module.h"
+#include "stella_vslam/publish/shared_memory_layout.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace stella_vslam {
+
+namespace data {
+class keyframe;
+class landmark;
+class map_database;
+} // namespace data
+
+namespace publish {
+
+/**
+ * Export the latest camera poses and the versioned map deltas to the POSIX shared memory,
+ * so that the processes on the same machine can read them without any request to the SLAM process.
+ * See shared_memory_layout.h for the layout, and shared_memory_reader for the reader.
+ * The keyframes and landmarks recorded as changed in the map database are written periodically in the own thread,
+ * and the full map is written only to the snapshot buffers (periodically, on request, and after the whole map changed).
+ */
+class shared_memory_exporter {
+public:
+    //! Constructor (throw std::runtime_error if the shared memory cannot be created)
+    //! (the existing shared memory of the name is removed only if overwrite_existing is true)
+    shared_memory_exporter(const std::string& name,
+                           data::map_database* map_db,
+                           const unsigned int pose_capacity = 64,
+                           const unsigned int delta_capacity = 65536,
+                           const unsigned int snapshot_capacity = 131072,
+                           const unsigned int map_export_interval_ms = 200,
+                           const unsigned int snapshot_interval = 50,
+                           const bool overwrite_existing = false);
+
+    //! Constructor
+    shared_memory_exporter(const YAML::Node& yaml_node, data::map_database* map_db);
+
+    //! Destructor (the shared memory is unlinked)
+    ~shared_memory_exporter();
+
+    //! Write the camera pose of the frame
+    //! (NOTE: call it from the tracker thread)
+    void publish_pose(const double timestamp, const tracker_state_t tracking_state,
+                      const std::shared_ptr<Mat44_t>& cam_pose_wc);
+
+    //! Write the changed keyframes and landmarks as a new map version
+    //! (the ones which will be erased are written as the erasures)
+    void publish_map_changes(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                             const std::vector<std::shared_ptr<data::landmark>>& lms,
+                             const std::vector<unsigned int>& erased_keyfrm_ids,
+                             const std::vector<unsigned int>& erased_lm_ids);
+
+    //! Write the full map to the snapshot buffer, then a Reset delta as a new map version followed by the snapshot
+    //! (return false and write nothing if it exceeds the capacity)
+    bool publish_map_reset(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                           const std::vector<std::shared_ptr<data::landmark>>& lms);
+
+    //! Write the full map to the snapshot buffer (return false if it exceeds the capacity)
+    bool publish_snapshot(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                          const std::vector<std::shared_ptr<data::landmark>>& lms);
+
+    //! Write the changes recorded in the map database after the last call
+    //! (NOTE: called by the exporter thread while it is running)
+    void export_map_changes();
+
+    //! Request a snapshot of the map in the next export
+    void request_snapshot();
+
+    //! Start the thread which exports the map periodically
+    void start();
+
+    //! Stop the thread
+    void terminate();
+
+    //! name of the shared memory
+    const std::string name_;
+    //! number of the pose slots
+    const unsigned int pose_capacity_;
+    //! number of the map delta slots
+    const unsigned int delta_capacity_;
+    //! maximum number of the keyframes and landmarks in a snapshot
+    const unsigned int snapshot_capacity_;
+    //! interval of the map export [ms]
+    const unsigned int map_export_interval_ms_;
+    //! a snapshot is written every this number of the map versions (0: only on request)
+    const unsigned int snapshot_interval_;
+
+private:
+    //! Write a map delta record
+    void write_map_delta(const shm::map_delta_data& delta);
+
+    //! Publish the map deltas written after num_deltas_before as a new map version
+    void publish_map_version(const uint64_t num_deltas_before);
+
+    //! Write the full map to the older snapshot buffer without publishing it (return false if it exceeds the capacity)
+    bool write_snapshot(const std::vector<std::shared_ptr<data::keyframe>>& keyfrms,
+                        const std::vector<std::shared_ptr<data::landmark>>& lms,
+                        const uint64_t map_version);
+
+    //! Publish the snapshot written by write_snapshot(), followed by the map deltas written after it
+    void commit_snapshot(const uint64_t map_version);
+
+    //! map database
+    data::map_database* map_db_ = nullptr;
+
+    //! mapped shared memory
+    void* addr_ = nullptr;
+    size_t size_ = 0;
+    shm::header* header_ = nullptr;
+    shm::pose_slot* pose_slots_ = nullptr;
+    shm::map_delta_slot* delta_slots_ = nullptr;
+    shm::snapshot_header* snapshots_[2] = {nullptr, nullptr};
+
+    //! version of the next map deltas
+    uint64_t next_map_version_ = 1;
+    //! number of the map versions after the last snapshot
+    unsigned int num_versions_since_snapshot_ = 0;
+    std::atomic<bool> snapshot_is_requested_{true};
+    //! the whole map changed, but the reset has not been written because the snapshot did not fit
+    bool reset_is_pending_ = false;
+
+    //! exporter thread
+    std::unique_ptr<std::thread> thread_ = nullptr;
+    std::mutex mtx_terminate_;
+    std::condition_variable cv_terminate_;
+    bool terminate_is_requested_ = false;
+};
+
+} // namespace publish
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_PUBLISH_SHARED_MEMORY_EXPORTER_H
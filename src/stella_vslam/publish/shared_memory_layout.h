@@ -0,0 +1,167 @@
+#ifndef STELLA_VSLAM_PUBLISH_SHARED_MEMORY_LAYOUT_H
+#define STELLA_VSLAM_PUBLISH_SHARED_MEMORY_LAYOUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace stella_vslam {
+namespace publish {
+namespace shm {
+
+/**
+ * Layout of the shared memory written by publish::shared_memory_exporter
+ *
+ *   [header][pose slot x pose_capacity_][map delta slot x delta_capacity_][snapshot x 2]
+ *   snapshot: [snapshot_header][map_delta_data x snapshot_capacity_]
+ *
+ * The pose and map delta arrays are ring buffers with a single writer (the SLAM process) and any number of readers.
+ * The n-th record (n = 0, 1, ...) is stored in the slot n % capacity, and is published
+ * by setting the sequence number of the slot to n + 1 after the payload is written
+ * (it is 0 while the payload is being written).
+ * A reader copies the payload and accepts it only if the sequence number is n + 1 before and after the copy.
+ * The readers never write to the shared memory, so they cannot block or slow down the writer.
+ *
+ * The full map is written to the snapshot buffers, not to the ring, in the same way:
+ * the n-th snapshot is stored in the buffer n % 2 and published by its sequence number,
+ * so a reader can copy the latest one while the writer fills the other one.
+ * A reader which missed some map deltas, or read a Reset delta, resyncs with the latest snapshot
+ * and continues with the map deltas written after it.
+ *
+ * All the values are in the native byte order, and the matrices are stored in column-major order.
+ */
+
+//! magic number at the beginning of the shared memory ("SVSM")
+constexpr uint32_t magic = 0x5356534d;
+//! version of this layout (incremented on any incompatible change)
+constexpr uint32_t layout_version = 2;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64-bit atomics must be lock-free to be shared between processes");
+
+//! tracking state (same values as stella_vslam::tracker_state_t)
+enum class tracking_state_t : uint32_t {
+    Initializing = 0,
+    Tracking = 1,
+    Lost = 2
+};
+
+//! kind of the map entity
+enum class entity_t : uint32_t {
+    //! data_: camera pose in the world (pose_wc, 4x4)
+    Keyframe = 0,
+    //! data_: position in the world (3), aux_: number of the observations when the record is written
+    Landmark = 1
+};
+
+//! operation of the map delta
+enum class delta_op_t : uint32_t {
+    //! the entity is added or moved
+    Upsert = 0,
+    //! the entity is removed
+    Erase = 1,
+    //! the readers must discard all the entities and resync with a snapshot published after this delta
+    Reset = 2
+};
+
+struct pose_data {
+    //! timestamp of the frame [s]
+    double timestamp_;
+    //! tracking_state_t
+    uint32_t tracking_state_;
+    //! 1 if pose_wc_ is valid
+    uint32_t pose_is_valid_;
+    //! camera pose in the world (4x4)
+    double pose_wc_[16];
+};
+
+struct map_delta_data {
+    //! map version which the delta belongs to
+    uint64_t map_version_;
+    //! entity_t
+    uint32_t entity_;
+    //! delta_op_t
+    uint32_t op_;
+    //! ID of the keyframe or the landmark
+    uint32_t id_;
+    //! additional value (see entity_t)
+    uint32_t aux_;
+    //! values of the entity (see entity_t)
+    double data_[16];
+};
+
+struct pose_slot {
+    std::atomic<uint64_t> seq_;
+    pose_data data_;
+};
+
+struct map_delta_slot {
+    std::atomic<uint64_t> seq_;
+    map_delta_data data_;
+};
+
+struct snapshot_header {
+    std::atomic<uint64_t> seq_;
+    //! latest map version whose deltas are all included
+    uint64_t map_version_;
+    //! index of the first map delta written after the snapshot
+    uint64_t next_delta_;
+    //! number of the entity records (Upsert only) following this header
+    uint64_t num_entities_;
+};
+
+struct header {
+    uint32_t magic_;
+    uint32_t layout_version_;
+    uint32_t pose_capacity_;
+    uint32_t delta_capacity_;
+    //! maximum number of the entities in a snapshot
+    uint32_t snapshot_capacity_;
+    uint32_t reserved_;
+    //! byte offsets of the slot arrays and the first snapshot from the beginning of the shared memory
+    uint64_t pose_offset_;
+    uint64_t delta_offset_;
+    uint64_t snapshot_offset_;
+    //! number of the written pose records
+    std::atomic<uint64_t> num_poses_;
+    //! number of the written map delta records
+    std::atomic<uint64_t> num_deltas_;
+    //! latest map version whose deltas are all written
+    std::atomic<uint64_t> map_version_;
+    //! number of the written snapshots
+    std::atomic<uint64_t> num_snapshots_;
+};
+
+//! Get the offset of the pose slots
+inline uint64_t get_pose_offset() {
+    return (sizeof(header) + alignof(pose_slot) - 1) / alignof(pose_slot) * alignof(pose_slot);
+}
+
+//! Get the offset of the map delta slots
+inline uint64_t get_delta_offset(const uint32_t pose_capacity) {
+    const uint64_t end = get_pose_offset() + pose_capacity * sizeof(pose_slot);
+    return (end + alignof(map_delta_slot) - 1) / alignof(map_delta_slot) * alignof(map_delta_slot);
+}
+
+//! Get the offset of the first snapshot
+inline uint64_t get_snapshot_offset(const uint32_t pose_capacity, const uint32_t delta_capacity) {
+    const uint64_t end = get_delta_offset(pose_capacity) + delta_capacity * sizeof(map_delta_slot);
+    return (end + alignof(snapshot_header) - 1) / alignof(snapshot_header) * alignof(snapshot_header);
+}
+
+//! Get the size of a snapshot (both of the snapshots have the same size)
+inline uint64_t get_snapshot_size(const uint32_t snapshot_capacity) {
+    static_assert(sizeof(snapshot_header) % alignof(map_delta_data) == 0, "the entity records must be aligned");
+    static_assert(sizeof(map_delta_data) % alignof(snapshot_header) == 0, "the second snapshot must be aligned");
+    return sizeof(snapshot_header) + snapshot_capacity * sizeof(map_delta_data);
+}
+
+//! Get the total size of the shared memory
+inline size_t get_size(const uint32_t pose_capacity, const uint32_t delta_capacity, const uint32_t snapshot_capacity) {
+    return get_snapshot_offset(pose_capacity, delta_capacity) + 2 * get_snapshot_size(snapshot_capacity);
+}
+
+} // namespace shm
+} // namespace publish
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_PUBLISH_SHARED_MEMORY_LAYOUT_H
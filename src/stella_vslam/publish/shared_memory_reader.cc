@@ -0,0 +1,163 @@
+#include "stella_vslam/publish/shared_memory_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace stella_vslam {
+namespace publish {
+
+namespace {
+
+//! Copy the payload of the n-th record (return false if the slot holds another record)
+template<typename T, typename U>
+bool read_slot(const T& slot, const uint64_t n, U& data) {
+    if (slot.seq_.load(std::memory_order_acquire) != n + 1) {
+        return false;
+    }
+    std::memcpy(&data, &slot.data_, sizeof(U));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq_.load(std::memory_order_relaxed) == n + 1;
+}
+
+} // namespace
+
+shared_memory_reader::shared_memory_reader(const std::string& name) {
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open the shared memory " + name + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(shm::header)) {
+        close(fd);
+        throw std::runtime_error("the shared memory " + name + " is not initialized");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    addr_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr_ == MAP_FAILED) {
+        addr_ = nullptr;
+        throw std::runtime_error("cannot map the shared memory " + name + ": " + std::strerror(errno));
+    }
+
+    const auto base = static_cast<const char*>(addr_);
+    header_ = reinterpret_cast<const shm::header*>(base);
+    if (header_->magic_ != shm::magic || header_->layout_version_ != shm::layout_version
+        || size_ < shm::get_size(header_->pose_capacity_, header_->delta_capacity_, header_->snapshot_capacity_)) {
+        munmap(addr_, size_);
+        addr_ = nullptr;
+        throw std::runtime_error("the shared memory " + name + " has an unknown layout");
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    pose_slots_ = reinterpret_cast<const shm::pose_slot*>(base + header_->pose_offset_);
+    delta_slots_ = reinterpret_cast<const shm::map_delta_slot*>(base + header_->delta_offset_);
+    for (unsigned int i = 0; i < 2; ++i) {
+        snapshots_[i] = reinterpret_cast<const shm::snapshot_header*>(base + header_->snapshot_offset_
+                                                                      + i * shm::get_snapshot_size(header_->snapshot_capacity_));
+    }
+}
+
+shared_memory_reader::~shared_memory_reader() {
+    if (addr_) {
+        munmap(addr_, size_);
+        addr_ = nullptr;
+    }
+}
+
+bool shared_memory_reader::read_latest_pose(shm::pose_data& pose) const {
+    // Retry if the writer overtakes the reader
+    for (unsigned int trial = 0; trial < 4; ++trial) {
+        const uint64_t num_poses = header_->num_poses_.load(std::memory_order_acquire);
+        if (num_poses == 0) {
+            return false;
+        }
+        const uint64_t n = num_poses - 1;
+        if (read_slot(pose_slots_[n % header_->pose_capacity_], n, pose)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool shared_memory_reader::read_map_deltas(std::vector<shm::map_delta_data>& deltas) {
+    deltas.clear();
+    const uint64_t num_deltas = header_->num_deltas_.load(std::memory_order_acquire);
+    const uint64_t capacity = header_->delta_capacity_;
+
+    if (next_delta_ + capacity < num_deltas) {
+        // Some of them were overwritten
+        next_delta_ = num_deltas;
+        return false;
+    }
+    deltas.reserve(num_deltas - next_delta_);
+    for (uint64_t n = next_delta_; n < num_deltas; ++n) {
+        shm::map_delta_data delta;
+        if (!read_slot(delta_slots_[n % capacity], n, delta)) {
+            // Overwritten while reading
+            next_delta_ = num_deltas;
+            return false;
+        }
+        if (delta.op_ == static_cast<uint32_t>(shm::delta_op_t::Reset)) {
+            next_delta_ = n + 1;
+            min_snapshot_delta_ = n + 1;
+            return false;
+        }
+        deltas.push_back(delta);
+    }
+    next_delta_ = num_deltas;
+    return true;
+}
+
+bool shared_memory_reader::read_snapshot(std::vector<shm::map_delta_data>& entities, uint64_t& map_version) {
+    entities.clear();
+    // Retry if the writer overtakes the reader
+    for (unsigned int trial = 0; trial < 4; ++trial) {
+        const uint64_t num_snapshots = header_->num_snapshots_.load(std::memory_order_acquire);
+        if (num_snapshots == 0) {
+            return false;
+        }
+        const uint64_t n = num_snapshots - 1;
+        const auto snapshot = snapshots_[n % 2];
+        if (snapshot->seq_.load(std::memory_order_acquire) != n + 1) {
+            continue;
+        }
+        const uint64_t snapshot_map_version = snapshot->map_version_;
+        const uint64_t snapshot_next_delta = snapshot->next_delta_;
+        const uint64_t num_entities = std::min<uint64_t>(snapshot->num_entities_, header_->snapshot_capacity_);
+        entities.resize(num_entities);
+        std::memcpy(entities.data(), snapshot + 1, num_entities * sizeof(shm::map_delta_data));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (snapshot->seq_.load(std::memory_order_relaxed) != n + 1) {
+            continue;
+        }
+
+        // The snapshot before the last Reset, or the one whose following deltas were overwritten, cannot be used
+        if (snapshot_next_delta < min_snapshot_delta_
+            || snapshot_next_delta + header_->delta_capacity_ < header_->num_deltas_.load(std::memory_order_acquire)) {
+            entities.clear();
+            return false;
+        }
+        next_delta_ = snapshot_next_delta;
+        map_version = snapshot_map_version;
+        return true;
+    }
+    entities.clear();
+    return false;
+}
+
+uint64_t shared_memory_reader::get_map_version() const {
+    return header_->map_version_.load(std::memory_order_acquire);
+}
+
+uint64_t shared_memory_reader::get_num_poses() const {
+    return header_->num_poses_.load(std::memory_order_acquire);
+}
+
+} // namespace publish
+} // namespace stella_vslam
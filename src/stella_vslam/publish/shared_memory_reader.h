@@ -0,0 +1,66 @@
+#ifndef STELLA_VSLAM_PUBLISH_SHARED_MEMORY_READER_H
+#define STELLA_VSLAM_PUBLISH_SHARED_MEMORY_READER_H
+
+#include "stella_vslam/publish/shared_memory_layout.h"
+
+#include <string>
+#include <vector>
+
+namespace stella_vslam {
+namespace publish {
+
+/**
+ * Read the poses and the map deltas written by shared_memory_exporter from another process.
+ * The shared memory is mapped read-only, so the reader never affects the SLAM process.
+ * This class depends only on the layout header, and is not thread-safe.
+ */
+class shared_memory_reader {
+public:
+    //! Constructor (throw std::runtime_error if the shared memory is not found or has another layout)
+    explicit shared_memory_reader(const std::string& name);
+
+    //! Destructor
+    ~shared_memory_reader();
+
+    //! Read the latest pose (return false if no pose is written yet)
+    bool read_latest_pose(shm::pose_data& pose) const;
+
+    /**
+     * Read the map deltas written after the last call (or after the snapshot read by read_snapshot()), in the order of the writing
+     * Return false if the reader must resync with read_snapshot(),
+     * i.e. some of the deltas were overwritten before being read, or a Reset delta was read.
+     * (the deltas before the Reset delta are returned, but the ones after it are not read)
+     */
+    bool read_map_deltas(std::vector<shm::map_delta_data>& deltas);
+
+    /**
+     * Read the latest snapshot of the map (the Upsert records of all the entities),
+     * and continue reading the map deltas written after it
+     * Return false if no usable snapshot is written yet (retry later).
+     */
+    bool read_snapshot(std::vector<shm::map_delta_data>& entities, uint64_t& map_version);
+
+    //! Get the latest map version whose deltas are all written
+    uint64_t get_map_version() const;
+
+    //! Get the number of the poses written so far
+    uint64_t get_num_poses() const;
+
+private:
+    void* addr_ = nullptr;
+    size_t size_ = 0;
+    const shm::header* header_ = nullptr;
+    const shm::pose_slot* pose_slots_ = nullptr;
+    const shm::map_delta_slot* delta_slots_ = nullptr;
+    const shm::snapshot_header* snapshots_[2] = {nullptr, nullptr};
+
+    //! index of the next map delta to read
+    uint64_t next_delta_ = 0;
+    //! the snapshot must be written after this index of the map delta (i.e. after the last Reset delta)
+    uint64_t min_snapshot_delta_ = 0;
+};
+
+} // namespace publish
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_PUBLISH_SHARED_MEMORY_READER_H
@@ -11,6 +11,8 @@
 #include "stella_vslam/data/map_database.h"
 #include "stella_vslam/data/bow_database.h"
 #include "stella_vslam/data/bow_vocabulary.h"
+#include "stella_vslam/data/keyframe_region.h"
+#include "stella_vslam/data/landmark.h"
 #include "stella_vslam/data/marker2d.h"
 #include "stella_vslam/data/marker.h"
 #include "stella_vslam/marker_detector/aruco.h"
@@ -20,11 +22,15 @@
 #include "stella_vslam/marker_detector/aruconano.h"
 #endif // USE_ARUCO_NANO
 #include "stella_vslam/match/stereo.h"
+#include "stella_vslam/match/stereo_epipolar.h"
+#include "stella_vslam/match/stereo_patch_search.h"
 #include "stella_vslam/feature/orb_extractor.h"
 #include "stella_vslam/io/trajectory_io.h"
 #include "stella_vslam/io/map_database_io_factory.h"
 #include "stella_vslam/publish/map_publisher.h"
 #include "stella_vslam/publish/frame_publisher.h"
+#include "stella_vslam/publish/shared_memory_exporter.h"
+#include "stella_vslam/util/background_deleter.h"
 #include "stella_vslam/util/converter.h"
 #include "stella_vslam/util/image_converter.h"
 #include "stella_vslam/util/yaml.h"
@@ -59,16 +65,25 @@ system::system(const std::shared_ptr<config>& cfg, const std::string& vocab_file
     // database
     cam_db_ = new data::camera_database();
     cam_db_->add_camera(camera_);
-    map_db_ = new data::map_database(system_params["min_num_shared_lms"].as<unsigned int>(15));
+    map_db_ = new data::map_database(system_params["min_num_shared_lms"].as<unsigned int>(15),
+                                     system_params["max_num_landmark_observations"].as<unsigned int>(0),
+                                     system_params["max_num_covisibilities"].as<unsigned int>(0));
     if (bow_vocab_) {
         bow_db_ = new data::bow_database(bow_vocab_);
     }
     orb_params_db_ = new data::orb_params_database();
     orb_params_db_->add_orb_params(orb_params_);
+    if (system_params["enable_background_teardown"].as<bool>(true)) {
+        background_deleter_ = new util::background_deleter();
+    }
 
     // frame and map publisher
     frame_publisher_ = std::shared_ptr<publish::frame_publisher>(new publish::frame_publisher(cfg_, map_db_));
     map_publisher_ = std::shared_ptr<publish::map_publisher>(new publish::map_publisher(cfg_, map_db_));
+    const auto shm_export_params = util::yaml_optional_ref(cfg->yaml_node_, "SharedMemoryExport");
+    if (shm_export_params["enabled"].as<bool>(false)) {
+        shm_exporter_ = new publish::shared_memory_exporter(shm_export_params, map_db_);
+    }
 
     // map I/O
     auto map_format = system_params["map_format"].as<std::string>("msgpack");
@@ -96,13 +111,46 @@ system::system(const std::shared_ptr<config>& cfg, const std::string& vocab_file
     const auto min_size = preprocessing_params["min_size"].as<unsigned int>(800);
     const auto desc_type_str = preprocessing_params["descriptor_type"].as<std::string>("ORB");
     const auto desc_type = feature::descriptor_type_from_string(desc_type_str);
-    extractor_left_ = new feature::orb_extractor(orb_params_, min_size, desc_type, mask_rectangles);
+    const auto min_keypts_ratio_in_saturated_cells = preprocessing_params["min_keypts_ratio_in_saturated_cells"].as<float>(0.25);
+    extractor_left_ = new feature::orb_extractor(orb_params_, min_size, desc_type, mask_rectangles, min_keypts_ratio_in_saturated_cells);
     if (camera_->setup_type_ == camera::setup_type_t::Stereo) {
         extractor_right_ = new feature::orb_extractor(orb_params_, min_size, desc_type, mask_rectangles);
+        use_stereo_patch_search_ = preprocessing_params["use_stereo_patch_search"].as<bool>(false);
+
+        // The unrectified stereo images are matched along the epipolar curves without remapping
+        const auto unrectified_stereo_params = util::yaml_optional_ref(cfg->yaml_node_, "UnrectifiedStereo");
+        if (unrectified_stereo_params["enabled"].as<bool>(false)) {
+            if (use_stereo_patch_search_) {
+                throw std::runtime_error("use_stereo_patch_search cannot be used with the unrectified stereo");
+            }
+            right_camera_ = camera::camera_factory::create(util::yaml_optional_ref(unrectified_stereo_params, "right_camera"));
+            const auto values = unrectified_stereo_params["rel_pose_rl"].as<std::vector<double>>();
+            if (values.size() != 16) {
+                throw std::runtime_error("UnrectifiedStereo.rel_pose_rl must be a row-major 4x4 matrix");
+            }
+            const Mat44_t rel_pose_rl = Eigen::Map<const Eigen::Matrix<double, 4, 4, Eigen::RowMajor>>(values.data());
+            rot_rl_ = rel_pose_rl.block<3, 3>(0, 0);
+            trans_rl_ = rel_pose_rl.block<3, 1>(0, 3);
+            min_stereo_depth_ = unrectified_stereo_params["min_depth"].as<double>(camera_->true_baseline_);
+        }
     }
 
+    const auto frame_admission_params = util::yaml_optional_ref(cfg->yaml_node_, "FrameAdmission");
+    if (frame_admission_params["enabled"].as<bool>(false)) {
+        frame_admission_controller_ = new module::frame_admission_controller(frame_admission_params, camera_->fps_);
+    }
+
+    const auto stationary_detection_params = util::yaml_optional_ref(cfg->yaml_node_, "StationaryDetection");
+    if (stationary_detection_params["enabled"].as<bool>(false)) {
+        stationary_detector_ = new module::stationary_detector(stationary_detection_params);
+    }
+
+    requested_ini_fast_thr_ = orb_params_->ini_fast_thr_;
+    requested_min_fast_thr_ = orb_params_->min_fast_thr_;
+
     num_grid_cols_ = preprocessing_params["num_grid_cols"].as<unsigned int>(64);
     num_grid_rows_ = preprocessing_params["num_grid_rows"].as<unsigned int>(48);
+    map_db_->set_grid_size(num_grid_cols_, num_grid_rows_);
 
     if (cfg->marker_model_) {
         if (dynamic_cast<marker_model::aruco*>(cfg->marker_model_.get())) {
@@ -126,6 +174,7 @@ system::system(const std::shared_ptr<config>& cfg, const std::string& vocab_file
     }
 
     // connect modules each other
+    tracker_->set_background_deleter(background_deleter_);
     tracker_->set_mapping_module(mapper_);
     mapper_->set_tracking_module(tracker_);
     if (global_optimizer_) {
@@ -150,6 +199,10 @@ system::~system() {
     delete tracker_;
     tracker_ = nullptr;
 
+    // Stop the export before the map database is destructed
+    delete shm_exporter_;
+    shm_exporter_ = nullptr;
+
     delete bow_db_;
     bow_db_ = nullptr;
     delete map_db_;
@@ -161,10 +214,18 @@ system::~system() {
         bow_vocab_ = nullptr;
     }
 
+    delete frame_admission_controller_;
+    frame_admission_controller_ = nullptr;
+
+    delete stationary_detector_;
+    stationary_detector_ = nullptr;
+
     delete extractor_left_;
     extractor_left_ = nullptr;
     delete extractor_right_;
     extractor_right_ = nullptr;
+    delete right_camera_;
+    right_camera_ = nullptr;
 
     delete marker_detector_;
     marker_detector_ = nullptr;
@@ -172,6 +233,10 @@ system::~system() {
     delete orb_params_db_;
     orb_params_db_ = nullptr;
 
+    // Wait for the destruction of the cleared maps
+    delete background_deleter_;
+    background_deleter_ = nullptr;
+
     spdlog::debug("DESTRUCT: system");
 }
 
@@ -209,6 +274,9 @@ void system::startup(const bool need_initialize) {
     if (global_optimizer_) {
         global_optimization_thread_ = std::unique_ptr<std::thread>(new std::thread(&stella_vslam::global_optimization_module::run, global_optimizer_));
     }
+    if (shm_exporter_) {
+        shm_exporter_->start();
+    }
 }
 
 void system::shutdown() {
@@ -229,6 +297,9 @@ void system::shutdown() {
     if (global_optimization_thread_) {
         global_optimization_thread_->join();
     }
+    if (shm_exporter_) {
+        shm_exporter_->terminate();
+    }
 
     // Print benchmark results before shutdown
     benchmark::benchmark_manager::get_instance().print_summary();
@@ -256,15 +327,10 @@ bool system::load_map_database(const std::string& path) const {
     pause_other_threads();
     spdlog::debug("load_map_database: {}", path);
     bool ok = map_database_io_->load(path, cam_db_, orb_params_db_, map_db_, bow_db_, bow_vocab_);
+    map_db_->record_map_change();
+    mapper_->invalidate_landmark_spatial_hash();
     auto keyfrms = map_db_->get_all_keyframes();
 
-    for (const auto& keyfrm : keyfrms) {
-        keyfrm->frm_obs_.num_grid_cols_ = num_grid_cols_;
-        keyfrm->frm_obs_.num_grid_rows_ = num_grid_rows_;
-        data::assign_keypoints_to_grid(keyfrm->camera_, keyfrm->frm_obs_.undist_keypts_, keyfrm->frm_obs_.keypt_indices_in_cells_,
-                                       keyfrm->frm_obs_.num_grid_cols_, keyfrm->frm_obs_.num_grid_rows_);
-    }
-
     // Set marker model in already detected markers
     std::shared_ptr<marker_model::base> mkr_model = nullptr;
     if (marker_detector_) {
@@ -371,6 +437,8 @@ void system::enable_temporal_mapping() {
 }
 
 data::frame system::create_monocular_frame(const cv::Mat& img, const double timestamp, const cv::Mat& mask) {
+    apply_requested_parameters();
+
     // color conversion
     if (!camera_->is_valid_shape(img)) {
         spdlog::warn("preprocess: Input image size is invalid");
@@ -382,6 +450,7 @@ data::frame system::create_monocular_frame(const cv::Mat& img, const double time
 
     // Extract ORB feature
     keypts_.clear();
+    extractor_left_->set_extraction_map(tracker_->get_extraction_map());
     extractor_left_->extract(img_gray, mask, keypts_, frm_obs.descriptors_);
     if (keypts_.empty()) {
         spdlog::warn("preprocess: cannot extract any keypoints");
@@ -405,10 +474,14 @@ data::frame system::create_monocular_frame(const cv::Mat& img, const double time
         marker_detector_->detect(img_gray, markers_2d);
     }
 
-    return data::frame(next_frame_id_++, timestamp, camera_, orb_params_, frm_obs, std::move(markers_2d));
+    auto frm = data::frame(next_frame_id_++, timestamp, camera_, orb_params_, std::move(frm_obs), std::move(markers_2d));
+    attach_image_pyramid(frm, img);
+    return frm;
 }
 
 data::frame system::create_stereo_frame(const cv::Mat& left_img, const cv::Mat& right_img, const double timestamp, const cv::Mat& mask) {
+    apply_requested_parameters();
+
     // color conversion
     if (!camera_->is_valid_shape(left_img)) {
         spdlog::warn("preprocess: Input image size is invalid");
@@ -429,11 +502,25 @@ data::frame system::create_stereo_frame(const cv::Mat& left_img, const cv::Mat&
 
     // Extract ORB feature
     keypts_.clear();
+    extractor_left_->set_extraction_map(tracker_->get_extraction_map());
     std::thread thread_left([this, &frm_obs, &img_gray, &mask]() {
         extractor_left_->extract(img_gray, mask, keypts_, frm_obs.descriptors_);
     });
-    std::thread thread_right([this, &frm_obs, &right_img_gray, &mask, &keypts_right, &descriptors_right]() {
-        extractor_right_->extract(right_img_gray, mask, keypts_right, descriptors_right);
+    //! bearings of stereo right image (only for the unrectified stereo)
+    eigen_alloc_vector<Vec3_t> bearings_right;
+    std::thread thread_right([this, &right_img_gray, &mask, &keypts_right, &descriptors_right, &bearings_right]() {
+        if (use_stereo_patch_search_) {
+            // Only the image pyramid is needed to search the disparity
+            extractor_right_->compute_image_pyramid(right_img_gray);
+        }
+        else {
+            extractor_right_->extract(right_img_gray, mask, keypts_right, descriptors_right);
+        }
+        if (right_camera_) {
+            std::vector<cv::KeyPoint> undist_keypts_right;
+            right_camera_->undistort_keypoints(keypts_right, undist_keypts_right);
+            right_camera_->convert_keypoints_to_bearings(undist_keypts_right, bearings_right);
+        }
     });
     thread_left.join();
     thread_right.join();
@@ -444,16 +531,33 @@ data::frame system::create_stereo_frame(const cv::Mat& left_img, const cv::Mat&
     // Undistort keypoints
     camera_->undistort_keypoints(keypts_, frm_obs.undist_keypts_);
 
-    // Estimate depth with stereo match
-    match::stereo stereo_matcher(extractor_left_->image_pyramid_, extractor_right_->image_pyramid_,
-                                 keypts_, keypts_right, frm_obs.descriptors_, descriptors_right,
-                                 orb_params_->scale_factors_, orb_params_->inv_scale_factors_,
-                                 camera_->focal_x_baseline_, camera_->true_baseline_);
-    stereo_matcher.compute(frm_obs.stereo_x_right_, frm_obs.depths_);
-
     // Convert to bearing vector
     camera_->convert_keypoints_to_bearings(frm_obs.undist_keypts_, frm_obs.bearings_);
 
+    // Estimate depth with stereo match
+    if (right_camera_) {
+        // Margin of two pixels on the epipolar curves
+        const float epipolar_margin_rad = 2.0 * camera_->true_baseline_ / camera_->focal_x_baseline_;
+        match::stereo_epipolar stereo_matcher(frm_obs.undist_keypts_, frm_obs.bearings_, keypts_right, bearings_right,
+                                              frm_obs.descriptors_, descriptors_right, orb_params_->scale_factors_,
+                                              rot_rl_, trans_rl_, camera_->focal_x_baseline_, min_stereo_depth_,
+                                              epipolar_margin_rad);
+        stereo_matcher.compute(frm_obs.stereo_x_right_, frm_obs.depths_);
+    }
+    else if (use_stereo_patch_search_) {
+        match::stereo_patch_search stereo_matcher(extractor_left_->image_pyramid_, extractor_right_->image_pyramid_, keypts_,
+                                                  orb_params_->scale_factors_, orb_params_->inv_scale_factors_,
+                                                  camera_->focal_x_baseline_, camera_->true_baseline_);
+        stereo_matcher.compute(frm_obs.stereo_x_right_, frm_obs.depths_);
+    }
+    else {
+        match::stereo stereo_matcher(extractor_left_->image_pyramid_, extractor_right_->image_pyramid_,
+                                     keypts_, keypts_right, frm_obs.descriptors_, descriptors_right,
+                                     orb_params_->scale_factors_, orb_params_->inv_scale_factors_,
+                                     camera_->focal_x_baseline_, camera_->true_baseline_);
+        stereo_matcher.compute(frm_obs.stereo_x_right_, frm_obs.depths_);
+    }
+
     // Assign all the keypoints into grid
     frm_obs.num_grid_cols_ = num_grid_cols_;
     frm_obs.num_grid_rows_ = num_grid_rows_;
@@ -466,10 +570,14 @@ data::frame system::create_stereo_frame(const cv::Mat& left_img, const cv::Mat&
         marker_detector_->detect(img_gray, markers_2d);
     }
 
-    return data::frame(next_frame_id_++, timestamp, camera_, orb_params_, frm_obs, std::move(markers_2d));
+    auto frm = data::frame(next_frame_id_++, timestamp, camera_, orb_params_, std::move(frm_obs), std::move(markers_2d));
+    attach_image_pyramid(frm, left_img);
+    return frm;
 }
 
 data::frame system::create_RGBD_frame(const cv::Mat& rgb_img, const cv::Mat& depthmap, const double timestamp, const cv::Mat& mask) {
+    apply_requested_parameters();
+
     // color and depth scale conversion
     if (!camera_->is_valid_shape(rgb_img)) {
         spdlog::warn("preprocess: Input image size is invalid");
@@ -486,6 +594,7 @@ data::frame system::create_RGBD_frame(const cv::Mat& rgb_img, const cv::Mat& dep
 
     // Extract ORB feature
     keypts_.clear();
+    extractor_left_->set_extraction_map(tracker_->get_extraction_map());
     extractor_left_->extract(img_gray, mask, keypts_, frm_obs.descriptors_);
     if (keypts_.empty()) {
         spdlog::warn("preprocess: cannot extract any keypoints");
@@ -531,7 +640,22 @@ data::frame system::create_RGBD_frame(const cv::Mat& rgb_img, const cv::Mat& dep
         marker_detector_->detect(img_gray, markers_2d);
     }
 
-    return data::frame(next_frame_id_++, timestamp, camera_, orb_params_, frm_obs, std::move(markers_2d));
+    auto frm = data::frame(next_frame_id_++, timestamp, camera_, orb_params_, std::move(frm_obs), std::move(markers_2d));
+    attach_image_pyramid(frm, rgb_img);
+    return frm;
+}
+
+void system::attach_image_pyramid(data::frame& frm, const cv::Mat& img) const {
+    if (!tracker_->enable_sparse_image_alignment_) {
+        return;
+    }
+    // The extractor allocates the upper levels for each image, so the frame shares them.
+    // Only the bottom level is copied if it is the input image, which the caller may overwrite.
+    auto image_pyramid = extractor_left_->image_pyramid_;
+    if (!image_pyramid.empty() && image_pyramid.at(0).data == img.data) {
+        image_pyramid.at(0) = image_pyramid.at(0).clone();
+    }
+    frm.set_image_pyramid(image_pyramid, std::make_shared<const std::vector<cv::KeyPoint>>(keypts_));
 }
 
 std::shared_ptr<Mat44_t> system::feed_monocular_frame(const cv::Mat& img, const double timestamp, const cv::Mat& mask) {
@@ -542,6 +666,12 @@ std::shared_ptr<Mat44_t> system::feed_monocular_frame(const cv::Mat& img, const
         spdlog::warn("preprocess: empty image");
         return nullptr;
     }
+    if (auto cam_pose_wc = skip_stationary_frame(img, timestamp)) {
+        return cam_pose_wc;
+    }
+    if (!admit_frame(timestamp)) {
+        return nullptr;
+    }
     const auto start = std::chrono::system_clock::now();
     auto frm = create_monocular_frame(img, timestamp, mask);
     const auto end = std::chrono::system_clock::now();
@@ -557,6 +687,12 @@ std::shared_ptr<Mat44_t> system::feed_stereo_frame(const cv::Mat& left_img, cons
         spdlog::warn("preprocess: empty image");
         return nullptr;
     }
+    if (auto cam_pose_wc = skip_stationary_frame(left_img, timestamp)) {
+        return cam_pose_wc;
+    }
+    if (!admit_frame(timestamp)) {
+        return nullptr;
+    }
     const auto start = std::chrono::system_clock::now();
     auto frm = create_stereo_frame(left_img, right_img, timestamp, mask);
     const auto end = std::chrono::system_clock::now();
@@ -572,6 +708,12 @@ std::shared_ptr<Mat44_t> system::feed_RGBD_frame(const cv::Mat& rgb_img, const c
         spdlog::warn("preprocess: empty image");
         return nullptr;
     }
+    if (auto cam_pose_wc = skip_stationary_frame(rgb_img, timestamp)) {
+        return cam_pose_wc;
+    }
+    if (!admit_frame(timestamp)) {
+        return nullptr;
+    }
     const auto start = std::chrono::system_clock::now();
     auto frm = create_RGBD_frame(rgb_img, depthmap, timestamp, mask);
     const auto end = std::chrono::system_clock::now();
@@ -579,6 +721,53 @@ std::shared_ptr<Mat44_t> system::feed_RGBD_frame(const cv::Mat& rgb_img, const c
     return feed_frame(frm, rgb_img, extraction_time_elapsed_ms);
 }
 
+bool system::admit_frame(const double timestamp) {
+    if (!frame_admission_controller_) {
+        return true;
+    }
+    Mat44_t twist;
+    const bool motion_is_small = tracker_->get_motion_model(timestamp, twist) && frame_admission_controller_->motion_is_small(twist);
+    const bool keyfrm_is_likely = tracker_->new_keyframe_is_likely(timestamp);
+    const auto admission = frame_admission_controller_->decide(timestamp, keyfrm_is_likely, motion_is_small);
+    return admission == module::frame_admission_t::Admitted;
+}
+
+std::shared_ptr<Mat44_t> system::skip_stationary_frame(const cv::Mat& img, const double timestamp) {
+    if (!stationary_detector_) {
+        return nullptr;
+    }
+    auto cam_pose_wc = tracker_->get_stationary_cam_pose_wc();
+    Mat44_t twist;
+    const bool twist_is_valid = tracker_->get_motion_model(timestamp, twist);
+    if (!stationary_detector_->is_stationary(img, camera_->color_order_, cam_pose_wc != nullptr,
+                                             twist_is_valid ? &twist : nullptr)) {
+        return nullptr;
+    }
+    SPDLOG_TRACE("system: skip the stationary frame");
+    if (shm_exporter_) {
+        shm_exporter_->publish_pose(timestamp, tracker_->tracking_state_, cam_pose_wc);
+    }
+    return cam_pose_wc;
+}
+
+unsigned int system::get_num_stationary_frames() const {
+    if (!stationary_detector_) {
+        return 0;
+    }
+    return stationary_detector_->get_num_skipped_frames();
+}
+
+module::frame_admission_controller::statistics system::get_frame_admission_statistics() const {
+    if (!frame_admission_controller_) {
+        return module::frame_admission_controller::statistics();
+    }
+    return frame_admission_controller_->get_statistics();
+}
+
+void system::feed_IMU_measurement(const double timestamp, const Vec3_t& acc, const Vec3_t& gyr) {
+    tracker_->queue_IMU_measurement(imu::measurement(timestamp, acc, gyr));
+}
+
 std::shared_ptr<Mat44_t> system::feed_frame(const data::frame& frm, const cv::Mat& img, const double extraction_time_elapsed_ms) {
     STELLA_BENCHMARK_TIMER("system", "feed_frame");
     
@@ -592,6 +781,10 @@ std::shared_ptr<Mat44_t> system::feed_frame(const data::frame& frm, const cv::Ma
     // Record ORB extraction time in benchmark
     benchmark::benchmark_manager::get_instance().record_time("feature", "orb_extraction", extraction_time_elapsed_ms);
 
+    if (frame_admission_controller_) {
+        frame_admission_controller_->report_processing_time(extraction_time_elapsed_ms + tracking_time_elapsed_ms);
+    }
+
     std::vector<data::marker2d> mkrs2d;
     for (auto id_mkr : frm.markers_2d_)
         mkrs2d.push_back(id_mkr.second);
@@ -607,6 +800,9 @@ std::shared_ptr<Mat44_t> system::feed_frame(const data::frame& frm, const cv::Ma
     if (tracker_->tracking_state_ == tracker_state_t::Tracking && cam_pose_wc) {
         map_publisher_->set_current_cam_pose(util::converter::inverse_pose(*cam_pose_wc));
     }
+    if (shm_exporter_) {
+        shm_exporter_->publish_pose(frm.timestamp_, tracker_->tracking_state_, cam_pose_wc);
+    }
 
     return cam_pose_wc;
 }
@@ -633,6 +829,77 @@ bool system::relocalize_by_pose_2d(const Mat44_t& cam_pose_wc, const Vec3_t& nor
     return status;
 }
 
+bool system::update_parameters(const YAML::Node& yaml_node) {
+    std::lock_guard<std::mutex> lock(mtx_update_parameters_);
+    try {
+        util::validate_runtime_params(yaml_node);
+    }
+    catch (const std::invalid_argument& e) {
+        spdlog::warn("update_parameters: {}", e.what());
+        return false;
+    }
+
+    // The loop detector exists only if the vocabulary is loaded
+    if (yaml_node["LoopDetector"] && !global_optimizer_) {
+        spdlog::warn("update_parameters: LoopDetector is not available without the vocabulary");
+        return false;
+    }
+
+    // The reduced threshold must not exceed the initial one after the change
+    const auto feature_params = util::yaml_optional_ref(yaml_node, "Feature");
+    const auto ini_fast_thr = feature_params["ini_fast_threshold"].as<unsigned int>(requested_ini_fast_thr_);
+    const auto min_fast_thr = feature_params["min_fast_threshold"].as<unsigned int>(requested_min_fast_thr_);
+    if (ini_fast_thr < min_fast_thr) {
+        spdlog::warn("update_parameters: min_fast_threshold ({}) exceeds ini_fast_threshold ({})", min_fast_thr, ini_fast_thr);
+        return false;
+    }
+    requested_ini_fast_thr_ = ini_fast_thr;
+    requested_min_fast_thr_ = min_fast_thr;
+
+    params_queue_.push(yaml_node);
+    if (yaml_node["Mapping"]) {
+        mapper_->request_update_parameters(yaml_node["Mapping"]);
+    }
+    if (yaml_node["LoopDetector"]) {
+        global_optimizer_->request_update_parameters(yaml_node["LoopDetector"]);
+    }
+    return true;
+}
+
+void system::apply_requested_parameters() {
+    for (const auto& yaml_node : params_queue_.pop_all()) {
+        const auto preprocessing_params = util::yaml_optional_ref(yaml_node, "Preprocessing");
+        const auto feature_params = util::yaml_optional_ref(yaml_node, "Feature");
+        for (auto extractor : {extractor_left_, extractor_right_}) {
+            if (!extractor) {
+                continue;
+            }
+            const auto min_size = preprocessing_params["min_size"].as<unsigned int>(extractor->get_min_area());
+            const auto ini_fast_thr = feature_params["ini_fast_threshold"].as<unsigned int>(extractor->get_ini_fast_threshold());
+            const auto min_fast_thr = feature_params["min_fast_threshold"].as<unsigned int>(extractor->get_min_fast_threshold());
+            if (extractor == extractor_left_) {
+                util::record_param_change("system", "min_size", extractor->get_min_area(), min_size);
+                util::record_param_change("system", "ini_fast_threshold", extractor->get_ini_fast_threshold(), ini_fast_thr);
+                util::record_param_change("system", "min_fast_threshold", extractor->get_min_fast_threshold(), min_fast_thr);
+            }
+            extractor->set_min_area(min_size);
+            extractor->set_fast_thresholds(ini_fast_thr, min_fast_thr);
+        }
+
+        if (yaml_node["Tracking"]) {
+            tracker_->update_parameters(yaml_node["Tracking"]);
+        }
+    }
+}
+
+void system::set_relocalization_region(const data::keyframe_region& region) {
+    tracker_->set_relocalization_region(std::make_shared<const data::keyframe_region>(region));
+}
+
+void system::clear_relocalization_region() {
+    tracker_->set_relocalization_region(nullptr);
+}
+
 void system::pause_tracker() {
     auto future_pause = tracker_->async_pause();
     future_pause.get();
@@ -674,6 +941,12 @@ void system::check_reset_request() {
     std::lock_guard<std::mutex> lock(mtx_reset_);
     if (reset_is_requested_) {
         tracker_->reset();
+        if (frame_admission_controller_) {
+            frame_admission_controller_->reset();
+        }
+        if (stationary_detector_) {
+            stationary_detector_->reset();
+        }
         reset_is_requested_ = false;
     }
 }
@@ -3,6 +3,9 @@
 
 #include "stella_vslam/type.h"
 #include "stella_vslam/data/bow_vocabulary_fwd.h"
+#include "stella_vslam/module/frame_admission_controller.h"
+#include "stella_vslam/module/stationary_detector.h"
+#include "stella_vslam/util/runtime_params.h"
 
 #include <string>
 #include <thread>
@@ -30,6 +33,7 @@ class camera_database;
 class orb_params_database;
 class map_database;
 class bow_database;
+class keyframe_region;
 } // namespace data
 
 namespace feature {
@@ -44,12 +48,17 @@ class base;
 namespace publish {
 class map_publisher;
 class frame_publisher;
+class shared_memory_exporter;
 } // namespace publish
 
 namespace io {
 class map_database_io_base;
 }
 
+namespace util {
+class background_deleter;
+} // namespace util
+
 class system {
 public:
     //! Constructor
@@ -144,6 +153,20 @@ public:
     data::frame create_RGBD_frame(const cv::Mat& rgb_img, const cv::Mat& depthmap, const double timestamp, const cv::Mat& mask);
     std::shared_ptr<Mat44_t> feed_RGBD_frame(const cv::Mat& rgb_img, const cv::Mat& depthmap, const double timestamp, const cv::Mat& mask = cv::Mat{});
 
+    //! Feed an IMU measurement (in the body frame) to SLAM system
+    //! (NOTE: feed the measurements before the frames with the later timestamps)
+    //! (NOTE: the preintegrated measurements constrain the rotations and the gyroscope bias in the pose optimization and the local BA,
+    //!        and also the velocities, the positions and the accelerometer bias after the gravity is estimated with the stereo/RGBD map)
+    //! (NOTE: the estimated gravity is not saved with the map)
+    void feed_IMU_measurement(const double timestamp, const Vec3_t& acc, const Vec3_t& gyr);
+
+    //! Get the statistics of the frame admission control
+    //! (all zero if the frame admission control is disabled)
+    module::frame_admission_controller::statistics get_frame_admission_statistics() const;
+
+    //! Get the number of the frames skipped because the camera is stationary
+    unsigned int get_num_stationary_frames() const;
+
     //-----------------------------------------
     // pose initializing/updating
 
@@ -152,6 +175,29 @@ public:
     bool relocalize_by_pose(const Mat44_t& cam_pose_wc);
     bool relocalize_by_pose_2d(const Mat44_t& cam_pose_wc, const Vec3_t& normal_vector);
 
+    //! Restrict the relocalization to the keyframes in the region (e.g. the floor or building where the camera is)
+    void set_relocalization_region(const data::keyframe_region& region);
+
+    //! Relocalize over the entire map again
+    void clear_relocalization_region();
+
+    //-----------------------------------------
+    // runtime configuration
+
+    /**
+     * Request to change the performance parameters while the system is running.
+     * The parameters are given with the same sections and keys as the config:
+     *   Preprocessing: min_size
+     *   Feature: ini_fast_threshold, min_fast_threshold
+     *   Tracking: max_num_local_keyfrms, margin_local_map_projection, margin_local_map_projection_unstable
+     *   Mapping: local_ba_num_first_iter, local_ba_num_second_iter
+     *   LoopDetector: num_final_matches_threshold, min_continuity
+     * Each module applies the changes at its next safe point (e.g. between frames or keyframes),
+     * and the changes are recorded in the benchmark events.
+     * Return false if any of them is invalid, or LoopDetector is given without the vocabulary (nothing is changed).
+     */
+    bool update_parameters(const YAML::Node& yaml_node);
+
     //-----------------------------------------
     // management for pause
 
@@ -194,6 +240,18 @@ private:
     //! Check reset request of the system
     void check_reset_request();
 
+    //! Apply the requested changes of the parameters of the extractors and the tracker
+    void apply_requested_parameters();
+
+    //! Decide whether the frame is processed or dropped to keep up with real time
+    bool admit_frame(const double timestamp);
+
+    //! Get the last camera pose if the camera is stationary and the frame can be skipped (nullptr otherwise)
+    std::shared_ptr<Mat44_t> skip_stationary_frame(const cv::Mat& img, const double timestamp);
+
+    //! Attach the image pyramid of the left image (img is the input image) to the frame for the sparse image alignment
+    void attach_image_pyramid(data::frame& frm, const cv::Mat& img) const;
+
     //! Pause the mapping module and the global optimization module
     void pause_other_threads() const;
 
@@ -223,6 +281,23 @@ private:
     //! BoW database
     data::bow_database* bow_db_ = nullptr;
 
+    //! deleter which destroys the cleared map in the background
+    util::background_deleter* background_deleter_ = nullptr;
+
+    //! controller which drops the frames under the overload (nullptr if disabled)
+    module::frame_admission_controller* frame_admission_controller_ = nullptr;
+
+    //! detector of the unchanged images to skip the processing (nullptr if disabled)
+    module::stationary_detector* stationary_detector_ = nullptr;
+
+    //! requested changes of the parameters of the extractors and the tracker
+    util::runtime_params_queue params_queue_;
+    //! mutex to validate the requested changes one by one
+    std::mutex mtx_update_parameters_;
+    //! FAST thresholds after all the requested changes are applied (to validate them together)
+    unsigned int requested_ini_fast_thr_ = 0;
+    unsigned int requested_min_fast_thr_ = 0;
+
     //! tracker
     tracking_module* tracker_ = nullptr;
 
@@ -244,6 +319,16 @@ private:
     feature::orb_extractor* extractor_left_ = nullptr;
     //! ORB extractor for right image
     feature::orb_extractor* extractor_right_ = nullptr;
+    //! If true, the right image is not extracted and the disparity is searched by patch matching
+    bool use_stereo_patch_search_ = false;
+    //! camera model of the right image if the stereo images are not rectified (nullptr if rectified)
+    camera::base* right_camera_ = nullptr;
+    //! rotation from the left camera to the right camera (for the unrectified stereo)
+    Mat33_t rot_rl_ = Mat33_t::Identity();
+    //! translation from the left camera to the right camera (for the unrectified stereo)
+    Vec3_t trans_rl_ = Vec3_t::Zero();
+    //! minimum depth of the stereo matches (for the unrectified stereo)
+    double min_stereo_depth_ = 0.0;
     //! ORB extractor only when used in initializing
     feature::orb_extractor* ini_extractor_left_ = nullptr;
 
@@ -259,6 +344,8 @@ private:
     std::shared_ptr<publish::frame_publisher> frame_publisher_ = nullptr;
     //! map publisher
     std::shared_ptr<publish::map_publisher> map_publisher_ = nullptr;
+    //! exporter of the poses and the map to the shared memory (nullptr if disabled)
+    publish::shared_memory_exporter* shm_exporter_ = nullptr;
 
     //! map I/O
     std::shared_ptr<io::map_database_io_base> map_database_io_ = nullptr;
@@ -7,13 +7,18 @@
 #include "stella_vslam/data/landmark.h"
 #include "stella_vslam/data/map_database.h"
 #include "stella_vslam/data/bow_database.h"
+#include "stella_vslam/imu/state.h"
 #include "stella_vslam/match/projection.h"
 #include "stella_vslam/module/local_map_updater.h"
 #include "stella_vslam/optimize/pose_optimizer_factory.h"
+#include "stella_vslam/util/converter.h"
+#include "stella_vslam/util/runtime_params.h"
 #include "stella_vslam/util/yaml.h"
 #include "stella_vslam/benchmark/timer.h"
 
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 #include <unordered_map>
 
 #include <spdlog/spdlog.h>
@@ -28,21 +33,34 @@ tracking_module::tracking_module(const std::shared_ptr<config>& cfg, camera::bas
       reloc_angle_threshold_(tracking_yaml_["reloc_angle_threshold"].as<double>(0.45)),
       init_retry_threshold_time_(tracking_yaml_["init_retry_threshold_time"].as<double>(5.0)),
       enable_auto_relocalization_(tracking_yaml_["enable_auto_relocalization"].as<bool>(true)),
+      enable_async_relocalization_(tracking_yaml_["enable_async_relocalization"].as<bool>(false)),
       enable_temporal_keyframe_only_tracking_(tracking_yaml_["enable_temporal_keyframe_only_tracking"].as<bool>(false)),
       use_robust_matcher_for_relocalization_request_(tracking_yaml_["use_robust_matcher_for_relocalization_request"].as<bool>(false)),
       max_num_local_keyfrms_(tracking_yaml_["max_num_local_keyfrms"].as<unsigned int>(60)),
       margin_local_map_projection_(tracking_yaml_["margin_local_map_projection"].as<float>(5.0)),
       margin_local_map_projection_unstable_(tracking_yaml_["margin_local_map_projection_unstable"].as<float>(20.0)),
+      enable_sparse_image_alignment_(tracking_yaml_["enable_sparse_image_alignment"].as<bool>(false)),
+      enable_coverage_driven_extraction_(tracking_yaml_["enable_coverage_driven_extraction"].as<bool>(false)),
+      extraction_map_cell_size_(tracking_yaml_["extraction_map_cell_size"].as<unsigned int>(64)),
+      num_saturating_lms_per_cell_(tracking_yaml_["num_saturating_lms_per_cell"].as<unsigned int>(8)),
       map_db_(map_db), bow_vocab_(bow_vocab), bow_db_(bow_db),
       initializer_(map_db, util::yaml_optional_ref(cfg->yaml_node_, "Initializer")),
       pose_optimizer_(optimize::pose_optimizer_factory::create(tracking_yaml_)),
       frame_tracker_(camera_, pose_optimizer_, 10, initializer_.get_use_fixed_seed(), tracking_yaml_["margin_last_frame_projection"].as<float>(20.0)),
+      sparse_image_aligner_(camera_, util::yaml_optional_ref(cfg->yaml_node_, "SparseImageAligner")),
       relocalizer_(pose_optimizer_, util::yaml_optional_ref(cfg->yaml_node_, "Relocalizer")),
-      keyfrm_inserter_(util::yaml_optional_ref(cfg->yaml_node_, "KeyframeInserter")) {
+      keyfrm_inserter_(util::yaml_optional_ref(cfg->yaml_node_, "KeyframeInserter")),
+      local_lm_ranker_(util::yaml_optional_ref(cfg->yaml_node_, "LocalLandmarkBudget")) {
     spdlog::debug("CONSTRUCT: tracking_module");
+
+    if (cfg->yaml_node_["IMU"]) {
+        imu_params_ = std::make_shared<imu::imu_params>(cfg->yaml_node_["IMU"]);
+        spdlog::info("use IMU measurements for the motion prediction and the pose optimization");
+    }
 }
 
 tracking_module::~tracking_module() {
+    discard_async_relocalization();
     spdlog::debug("DESTRUCT: tracking_module");
 }
 
@@ -55,6 +73,10 @@ void tracking_module::set_global_optimization_module(global_optimization_module*
     global_optimizer_ = global_optimizer;
 }
 
+void tracking_module::set_background_deleter(util::background_deleter* background_deleter) {
+    background_deleter_ = background_deleter;
+}
+
 bool tracking_module::request_relocalize_by_pose(const Mat44_t& pose_cw) {
     std::lock_guard<std::mutex> lock(mtx_relocalize_by_pose_request_);
     if (relocalize_by_pose_is_requested_) {
@@ -80,6 +102,16 @@ bool tracking_module::request_relocalize_by_pose_2d(const Mat44_t& pose_cw, cons
     return true;
 }
 
+void tracking_module::set_relocalization_region(const std::shared_ptr<const data::keyframe_region>& region) {
+    std::lock_guard<std::mutex> lock(mtx_reloc_region_);
+    reloc_region_ = region;
+}
+
+std::shared_ptr<const data::keyframe_region> tracking_module::get_relocalization_region() const {
+    std::lock_guard<std::mutex> lock(mtx_reloc_region_);
+    return reloc_region_;
+}
+
 bool tracking_module::relocalize_by_pose_is_requested() {
     std::lock_guard<std::mutex> lock(mtx_relocalize_by_pose_request_);
     return relocalize_by_pose_is_requested_;
@@ -98,6 +130,8 @@ void tracking_module::finish_relocalize_by_pose_request() {
 void tracking_module::reset() {
     spdlog::info("resetting system");
 
+    discard_async_relocalization();
+
     initializer_.reset();
     keyfrm_inserter_.reset();
 
@@ -113,13 +147,24 @@ void tracking_module::reset() {
     }
 
     if (bow_db_) {
-        bow_db_->clear();
+        bow_db_->clear(background_deleter_);
     }
-    map_db_->clear();
+    map_db_->clear(background_deleter_);
 
     last_reloc_frm_id_ = 0;
     last_reloc_frm_timestamp_ = 0.0;
 
+    imu_preint_from_last_frm_ = nullptr;
+    last_imu_keyfrm_ = nullptr;
+    imu_preint_from_last_keyfrm_ = nullptr;
+    imu_bias_ = imu::bias();
+    imu_velocity_ = Vec3_t::Zero();
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_extraction_map_);
+        extraction_map_ = nullptr;
+    }
+
     tracking_state_ = tracker_state_t::Initializing;
 }
 
@@ -134,6 +179,10 @@ std::shared_ptr<Mat44_t> tracking_module::feed_frame(data::frame curr_frm) {
 
     curr_frm_ = curr_frm;
 
+    if (imu_params_) {
+        preintegrate_IMU_measurements();
+    }
+
     bool succeeded = false;
     if (tracking_state_ == tracker_state_t::Initializing) {
         succeeded = initialize();
@@ -146,10 +195,17 @@ std::shared_ptr<Mat44_t> tracking_module::feed_frame(data::frame curr_frm) {
         unsigned int num_reliable_lms = 0;
         const unsigned int min_num_obs_thr = (3 <= map_db_->get_num_keyframes()) ? 3 : 2;
         succeeded = track(relocalization_is_needed, num_tracked_lms, num_reliable_lms, min_num_obs_thr);
+        last_num_reliable_lms_ = succeeded ? num_reliable_lms : 0;
+        last_min_num_obs_thr_ = min_num_obs_thr;
 
         // check to insert the new keyframe derived from the current frame
         if (succeeded && !is_stopped_keyframe_insertion_ && new_keyframe_is_needed(num_tracked_lms, num_reliable_lms, min_num_obs_thr)) {
-            keyfrm_inserter_.insert_new_keyframe(map_db_, curr_frm_);
+            const auto last_ref_keyfrm = curr_frm_.ref_keyfrm_;
+            keyfrm_inserter_.insert_new_keyframe(map_db_, curr_frm_, last_imu_keyfrm_, imu_preint_from_last_keyfrm_,
+                                                 imu::state(imu_velocity_, imu_bias_));
+            if (imu_params_ && curr_frm_.ref_keyfrm_ != last_ref_keyfrm) {
+                reset_IMU_preintegration_from_keyframe(curr_frm_.ref_keyfrm_);
+            }
         }
     }
 
@@ -183,6 +239,10 @@ std::shared_ptr<Mat44_t> tracking_module::feed_frame(data::frame curr_frm) {
         std::lock_guard<std::mutex> lock(mtx_last_frm_);
         last_frm_ = curr_frm_;
     }
+
+    if (enable_coverage_driven_extraction_) {
+        update_extraction_map();
+    }
     SPDLOG_TRACE("tracking_module: finish tracking");
 
     return cam_pose_wc;
@@ -192,6 +252,16 @@ bool tracking_module::track(bool relocalization_is_needed,
                             unsigned int& num_tracked_lms,
                             unsigned int& num_reliable_lms,
                             const unsigned int min_num_obs_thr) {
+    // While the background relocalization is running, return the current frame as lost without waiting for the map database
+    if (relocalization_is_needed && async_relocalization_is_running() && !relocalize_by_pose_is_requested()) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_last_frm_);
+            curr_frm_.ref_keyfrm_ = last_frm_.ref_keyfrm_;
+        }
+        map_db_->update_frame_statistics(curr_frm_, true);
+        return false;
+    }
+
     // LOCK the map database
     std::lock_guard<std::mutex> lock1(data::map_database::mtx_database_);
     std::lock_guard<std::mutex> lock2(mtx_last_frm_);
@@ -204,6 +274,11 @@ bool tracking_module::track(bool relocalization_is_needed,
     // set the reference keyframe of the current frame
     curr_frm_.ref_keyfrm_ = last_frm_.ref_keyfrm_;
 
+    // the result of the background relocalization is outdated if the tracking has been recovered
+    if (!relocalization_is_needed && future_async_reloc_.valid() && !async_relocalization_is_running()) {
+        discard_async_relocalization();
+    }
+
     bool succeeded = false;
     if (bow_db_ && relocalize_by_pose_is_requested()) {
         // Force relocalization by pose
@@ -213,6 +288,10 @@ bool tracking_module::track(bool relocalization_is_needed,
         SPDLOG_TRACE("tracking_module: track_current_frame (curr_frm_={})", curr_frm_.id_);
         succeeded = track_current_frame();
     }
+    else if (bow_db_ && enable_auto_relocalization_ && enable_async_relocalization_) {
+        SPDLOG_TRACE("tracking_module: relocalize asynchronously (curr_frm_={})", curr_frm_.id_);
+        succeeded = relocalize_asynchronously();
+    }
     else if (bow_db_ && enable_auto_relocalization_) {
         // Compute the BoW representations to perform relocalization
         SPDLOG_TRACE("tracking_module: Compute the BoW representations to perform relocalization (curr_frm_={})", curr_frm_.id_);
@@ -221,7 +300,8 @@ bool tracking_module::track(bool relocalization_is_needed,
         }
         // try to relocalize
         SPDLOG_TRACE("tracking_module: try to relocalize (curr_frm_={})", curr_frm_.id_);
-        succeeded = relocalizer_.relocalize(bow_db_, curr_frm_);
+        const auto reloc_region = get_relocalization_region();
+        succeeded = relocalizer_.relocalize(bow_db_, curr_frm_, reloc_region.get());
         if (succeeded) {
             last_reloc_frm_id_ = curr_frm_.id_;
             last_reloc_frm_timestamp_ = curr_frm_.timestamp_;
@@ -235,11 +315,6 @@ bool tracking_module::track(bool relocalization_is_needed,
         succeeded = track_local_map(num_tracked_lms, num_reliable_lms, num_temporal_keyfrms, min_num_obs_thr, fixed_keyframe_id_threshold);
     }
 
-    // update the local map and optimize current camera pose without temporal keyframes
-    if (fixed_keyframe_id_threshold > 0 && succeeded && num_temporal_keyfrms > 0) {
-        succeeded = track_local_map_without_temporal_keyframes(num_tracked_lms, num_reliable_lms, min_num_obs_thr, fixed_keyframe_id_threshold);
-    }
-
     // update the motion model
     if (succeeded) {
         SPDLOG_TRACE("tracking_module: update_motion_model (curr_frm_={})", curr_frm_.id_);
@@ -273,32 +348,61 @@ bool tracking_module::track_local_map(unsigned int& num_tracked_lms,
 
     if (!succeeded) {
         spdlog::info("local map tracking failed (curr_frm_={})", curr_frm_.id_);
+        return false;
+    }
+
+    // check that the pose is also supported by the landmarks of the fixed map
+    if (fixed_keyframe_id_threshold > 0 && num_temporal_keyfrms > 0) {
+        succeeded = check_tracking_without_temporal_keyframes(fixed_keyframe_id_threshold);
     }
     return succeeded;
 }
 
-bool tracking_module::track_local_map_without_temporal_keyframes(unsigned int& num_tracked_lms,
-                                                                 unsigned int& num_reliable_lms,
-                                                                 const unsigned int min_num_obs_thr,
-                                                                 const unsigned int fixed_keyframe_id_threshold) {
-    bool succeeded = false;
-    SPDLOG_TRACE("tracking_module: update_local_map without temporal keyframes (curr_frm_={})", curr_frm_.id_);
-    succeeded = search_local_landmarks(fixed_keyframe_id_threshold);
+bool tracking_module::check_tracking_without_temporal_keyframes(const unsigned int fixed_keyframe_id_threshold) const {
+    // The inliers of the pose optimization are split into the ones derived from the fixed map and the ones derived from temporal keyframes.
+    // The pose is shared by both sets, so the local map is matched and optimized only once.
+    unsigned int num_fixed_lms = 0;
+    for (const auto& lm : curr_frm_.get_landmarks()) {
+        if (!lm) {
+            continue;
+        }
+        if (lm->will_be_erased()) {
+            continue;
+        }
+        if (is_temporal_landmark(lm, fixed_keyframe_id_threshold)) {
+            continue;
+        }
+        ++num_fixed_lms;
+    }
 
-    if (enable_temporal_keyframe_only_tracking_ && !succeeded) {
-        SPDLOG_TRACE("temporal keyframe only tracking (curr_frm_={})", curr_frm_.id_);
+    if (num_tracked_lms_is_enough(num_fixed_lms)) {
         return true;
     }
 
-    if (succeeded) {
-        SPDLOG_TRACE("tracking_module: optimize_current_frame_with_local_map without temporal keyframes (curr_frm_={})", curr_frm_.id_);
-        succeeded = optimize_current_frame_with_local_map(num_tracked_lms, num_reliable_lms, min_num_obs_thr);
+    if (enable_temporal_keyframe_only_tracking_) {
+        SPDLOG_TRACE("temporal keyframe only tracking (curr_frm_={})", curr_frm_.id_);
+        return true;
     }
 
-    if (!succeeded) {
-        spdlog::info("local map tracking (without temporal keyframes) failed (curr_frm_={})", curr_frm_.id_);
+    spdlog::info("local map tracking (without temporal keyframes) failed (curr_frm_={})", curr_frm_.id_);
+    return false;
+}
+
+bool tracking_module::is_temporal_landmark(const std::shared_ptr<data::landmark>& lm, const unsigned int fixed_keyframe_id_threshold) const {
+    const auto observations = lm->get_all_observations();
+    if (observations.empty()) {
+        return false;
     }
-    return succeeded;
+    unsigned int temporal_observations = 0;
+    for (auto obs : observations) {
+        auto keyfrm = obs.first.lock();
+        if (keyfrm->id_ >= fixed_keyframe_id_threshold) {
+            ++temporal_observations;
+        }
+    }
+    const double temporal_ratio_thr = 0.5;
+    double temporal_ratio = static_cast<double>(temporal_observations) / observations.size();
+    return temporal_ratio > temporal_ratio_thr;
 }
 
 bool tracking_module::initialize() {
@@ -329,6 +433,10 @@ bool tracking_module::initialize() {
         future.get();
     }
 
+    if (imu_params_) {
+        reset_IMU_preintegration_from_keyframe(curr_frm_.ref_keyfrm_);
+    }
+
     // succeeded
     return true;
 }
@@ -339,7 +447,19 @@ bool tracking_module::track_current_frame() {
     // Tracking mode
     if (twist_is_valid_) {
         // if the motion model is valid
-        succeeded = frame_tracker_.motion_based_track(curr_frm_, last_frm_, twist_);
+        // (the frames between the last and current frames might have been dropped)
+        const Mat44_t extrapolated_twist = extrapolate_twist(curr_frm_.timestamp_ - last_frm_.timestamp_);
+        const Mat44_t twist = imu_preint_from_last_frm_ ? predict_twist_by_IMU(extrapolated_twist) : extrapolated_twist;
+        if (enable_sparse_image_alignment_) {
+            // refine the motion model photometrically so that the projection search succeeds with the narrow margin
+            Mat44_t aligned_twist = twist;
+            if (sparse_image_aligner_.align(curr_frm_, last_frm_, aligned_twist)) {
+                succeeded = frame_tracker_.motion_based_track(curr_frm_, last_frm_, aligned_twist);
+            }
+        }
+        if (!succeeded) {
+            succeeded = frame_tracker_.motion_based_track(curr_frm_, last_frm_, twist);
+        }
     }
     if (!succeeded) {
         // Compute the BoW representations to perform the BoW match
@@ -357,6 +477,67 @@ bool tracking_module::track_current_frame() {
     return succeeded;
 }
 
+bool tracking_module::relocalize_asynchronously() {
+    if (!future_async_reloc_.valid()) {
+        // Relocalize a copy of the most recent lost frame in the background
+        auto reloc_frm = std::allocate_shared<data::frame>(Eigen::aligned_allocator<data::frame>(), curr_frm_);
+        const auto reloc_region = get_relocalization_region();
+        future_async_reloc_ = std::async(
+            std::launch::async,
+            [this, reloc_frm, reloc_region]() -> std::shared_ptr<data::frame> {
+                STELLA_BENCHMARK_TIMER("tracking_module", "async_relocalization");
+                // Compute the BoW representations without locking the map database
+                if (!reloc_frm->bow_is_available()) {
+                    reloc_frm->compute_bow(bow_vocab_);
+                }
+                // LOCK the map database
+                std::lock_guard<std::mutex> lock(data::map_database::mtx_database_);
+                if (relocalizer_.relocalize(bow_db_, *reloc_frm, reloc_region.get())) {
+                    return reloc_frm;
+                }
+                return nullptr;
+            });
+        return false;
+    }
+
+    if (async_relocalization_is_running()) {
+        return false;
+    }
+
+    const auto reloc_frm = future_async_reloc_.get();
+    if (!reloc_frm) {
+        // Retry with the current frame
+        return relocalize_asynchronously();
+    }
+
+    // Track the current frame from the relocalized frame
+    spdlog::info("tracking from the relocalized frame (relocalized frame={}, curr_frm_={})", reloc_frm->id_, curr_frm_.id_);
+    last_frm_ = *reloc_frm;
+    last_cam_pose_from_ref_keyfrm_ = last_frm_.get_pose_cw() * last_frm_.ref_keyfrm_->get_pose_wc();
+    // The preintegration is not from the relocalized frame
+    imu_preint_from_last_frm_ = nullptr;
+    curr_frm_.ref_keyfrm_ = last_frm_.ref_keyfrm_;
+    // The motion between the relocalized frame and the current frame is unknown
+    twist_is_valid_ = false;
+    const bool succeeded = track_current_frame();
+    if (succeeded) {
+        last_reloc_frm_id_ = curr_frm_.id_;
+        last_reloc_frm_timestamp_ = curr_frm_.timestamp_;
+    }
+    return succeeded;
+}
+
+bool tracking_module::async_relocalization_is_running() const {
+    return future_async_reloc_.valid()
+           && future_async_reloc_.wait_for(std::chrono::seconds(0)) == std::future_status::timeout;
+}
+
+void tracking_module::discard_async_relocalization() {
+    if (future_async_reloc_.valid()) {
+        future_async_reloc_.get();
+    }
+}
+
 bool tracking_module::relocalize_by_pose(const pose_request& request) {
     bool succeeded = false;
     curr_frm_.set_pose_cw(request.pose_cw_);
@@ -376,6 +557,7 @@ bool tracking_module::relocalize_by_pose(const pose_request& request) {
             last_reloc_frm_timestamp_ = curr_frm_.timestamp_;
             // If the initial pose was given manually, use motion_based_track, expecting that the camera is not moving.
             last_frm_ = curr_frm_;
+            imu_preint_from_last_frm_ = nullptr;
         }
     }
     else {
@@ -401,6 +583,41 @@ std::vector<std::shared_ptr<data::keyframe>> tracking_module::get_close_keyframe
     }
 }
 
+std::shared_ptr<const feature::extraction_map> tracking_module::get_extraction_map() const {
+    std::lock_guard<std::mutex> lock(mtx_extraction_map_);
+    return extraction_map_;
+}
+
+void tracking_module::update_extraction_map() {
+    std::shared_ptr<feature::extraction_map> extraction_map = nullptr;
+    // Extract features uniformly unless the next frame is expected to be tracked with the local map
+    if (tracking_state_ == tracker_state_t::Tracking && curr_frm_.pose_is_valid()) {
+        // predict the camera pose of the next frame with the motion model
+        const Mat44_t pred_pose_cw = twist_is_valid_ ? Mat44_t(twist_ * curr_frm_.get_pose_cw()) : curr_frm_.get_pose_cw();
+        const Mat33_t rot_cw = pred_pose_cw.block<3, 3>(0, 0);
+        const Vec3_t trans_cw = pred_pose_cw.block<3, 1>(0, 3);
+
+        // the cells are on the input image, so the projections are distorted with the camera model
+        extraction_map = std::make_shared<feature::extraction_map>(camera_->cols_, camera_->rows_,
+                                                                   extraction_map_cell_size_, num_saturating_lms_per_cell_);
+        for (const auto& lm : local_landmarks_) {
+            if (!lm || lm->will_be_erased()) {
+                continue;
+            }
+            Vec2_t reproj;
+            float x_right;
+            if (camera_->reproject_to_image(rot_cw, trans_cw, lm->get_pos_in_world(), reproj, x_right)) {
+                const auto dist_pt = camera_->distort_point(cv::Point2f(reproj(0), reproj(1)));
+                extraction_map->add_landmark(dist_pt.x, dist_pt.y);
+            }
+        }
+        SPDLOG_TRACE("tracking_module: extraction map with {} landmarks", extraction_map->get_num_landmarks());
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_extraction_map_);
+    extraction_map_ = extraction_map;
+}
+
 void tracking_module::update_motion_model() {
     if (last_frm_.pose_is_valid()) {
         Mat44_t last_frm_cam_pose_wc = Mat44_t::Identity();
@@ -408,16 +625,212 @@ void tracking_module::update_motion_model() {
         last_frm_cam_pose_wc.block<3, 1>(0, 3) = last_frm_.get_trans_wc();
         twist_is_valid_ = true;
         twist_ = curr_frm_.get_pose_cw() * last_frm_cam_pose_wc;
+        twist_interval_ = curr_frm_.timestamp_ - last_frm_.timestamp_;
     }
     else {
         twist_is_valid_ = false;
         twist_ = Mat44_t::Identity();
+        twist_interval_ = 0.0;
     }
 }
 
+Mat44_t tracking_module::extrapolate_twist(const double interval) const {
+    if (twist_interval_ <= 0.0 || interval <= 0.0) {
+        return twist_;
+    }
+    const double ratio = interval / twist_interval_;
+
+    // scale the rotation and the displacement of the camera (in the last camera frame)
+    const Mat33_t rot_c2c1 = twist_.block<3, 3>(0, 0);
+    const Vec3_t trans_c2c1 = twist_.block<3, 1>(0, 3);
+    const Mat33_t rot_c1c2 = util::converter::to_rot_mat(ratio * util::converter::to_angle_axis(rot_c2c1.transpose()));
+    const Vec3_t trans_c1c2 = -ratio * rot_c2c1.transpose() * trans_c2c1;
+
+    Mat44_t twist = Mat44_t::Identity();
+    twist.block<3, 3>(0, 0) = rot_c1c2.transpose();
+    twist.block<3, 1>(0, 3) = -rot_c1c2.transpose() * trans_c1c2;
+    return twist;
+}
+
+void tracking_module::queue_IMU_measurement(const imu::measurement& imu_meas) {
+    std::lock_guard<std::mutex> lock(mtx_imu_measurements_);
+    if (!imu_measurements_.empty() && imu_meas.timestamp_ <= imu_measurements_.back().timestamp_) {
+        spdlog::warn("discard the IMU measurement which is not newer than the last one ({} <= {})",
+                     imu_meas.timestamp_, imu_measurements_.back().timestamp_);
+        return;
+    }
+    imu_measurements_.push_back(imu_meas);
+}
+
+void tracking_module::update_parameters(const YAML::Node& yaml_node) {
+    const auto max_num_local_keyfrms = yaml_node["max_num_local_keyfrms"].as<unsigned int>(max_num_local_keyfrms_);
+    util::record_param_change("tracking_module", "max_num_local_keyfrms", max_num_local_keyfrms_, max_num_local_keyfrms);
+    max_num_local_keyfrms_ = max_num_local_keyfrms;
+
+    const auto margin = yaml_node["margin_local_map_projection"].as<float>(margin_local_map_projection_);
+    util::record_param_change("tracking_module", "margin_local_map_projection", margin_local_map_projection_, margin);
+    margin_local_map_projection_ = margin;
+
+    const auto margin_unstable = yaml_node["margin_local_map_projection_unstable"].as<float>(margin_local_map_projection_unstable_);
+    util::record_param_change("tracking_module", "margin_local_map_projection_unstable", margin_local_map_projection_unstable_, margin_unstable);
+    margin_local_map_projection_unstable_ = margin_unstable;
+}
+
+bool tracking_module::get_motion_model(const double timestamp, Mat44_t& twist) const {
+    double last_timestamp = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(mtx_last_frm_);
+        last_timestamp = last_frm_.timestamp_;
+    }
+    twist = extrapolate_twist(timestamp - last_timestamp);
+    return twist_is_valid_;
+}
+
+std::shared_ptr<Mat44_t> tracking_module::get_stationary_cam_pose_wc() const {
+    if (tracking_state_ != tracker_state_t::Tracking) {
+        return nullptr;
+    }
+    {
+        // The requested pose must be applied in the next frame
+        std::lock_guard<std::mutex> lock(mtx_relocalize_by_pose_request_);
+        if (relocalize_by_pose_is_requested_) {
+            return nullptr;
+        }
+    }
+    std::shared_ptr<data::keyframe> ref_keyfrm;
+    {
+        std::lock_guard<std::mutex> lock(mtx_last_frm_);
+        if (!last_frm_.pose_is_valid()) {
+            return nullptr;
+        }
+        ref_keyfrm = last_frm_.ref_keyfrm_;
+    }
+    if (!ref_keyfrm || ref_keyfrm->will_be_erased()) {
+        return nullptr;
+    }
+    // Follow the reference keyframe, which may be moved by the optimization while skipping the frames
+    const Mat44_t cam_pose_cw = last_cam_pose_from_ref_keyfrm_ * ref_keyfrm->get_pose_cw();
+    return std::allocate_shared<Mat44_t>(Eigen::aligned_allocator<Mat44_t>(), util::converter::inverse_pose(cam_pose_cw));
+}
+
+bool tracking_module::new_keyframe_is_likely(const double next_timestamp) const {
+    if (tracking_state_ != tracker_state_t::Tracking) {
+        return true;
+    }
+    std::shared_ptr<data::keyframe> ref_keyfrm;
+    {
+        std::lock_guard<std::mutex> lock(mtx_last_frm_);
+        ref_keyfrm = last_frm_.ref_keyfrm_;
+    }
+    if (!ref_keyfrm) {
+        return true;
+    }
+    const auto num_reliable_lms_ref = ref_keyfrm->get_num_tracked_landmarks(last_min_num_obs_thr_);
+    const double reliable_lms_ratio = (0 < num_reliable_lms_ref)
+                                          ? static_cast<double>(last_num_reliable_lms_) / num_reliable_lms_ref
+                                          : 0.0;
+    constexpr double ratio_margin = 0.1;
+    return keyfrm_inserter_.new_keyframe_is_likely(map_db_, next_timestamp, reliable_lms_ratio, ratio_margin);
+}
+
+void tracking_module::preintegrate_IMU_measurements() {
+    imu_preint_from_last_frm_ = nullptr;
+
+    double last_timestamp = 0.0;
+    bool last_pose_is_valid = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx_last_frm_);
+        last_timestamp = last_frm_.timestamp_;
+        last_pose_is_valid = last_frm_.pose_is_valid();
+    }
+
+    eigen_alloc_vector<imu::measurement> measurements;
+    {
+        std::lock_guard<std::mutex> lock(mtx_imu_measurements_);
+        // the first measurement after the current frame (used for the interpolation)
+        auto end_itr = std::upper_bound(imu_measurements_.begin(), imu_measurements_.end(), curr_frm_.timestamp_,
+                                        [](const double timestamp, const imu::measurement& imu_meas) {
+                                            return timestamp < imu_meas.timestamp_;
+                                        });
+        const auto copy_end_itr = (end_itr == imu_measurements_.end()) ? end_itr : std::next(end_itr);
+        measurements.assign(imu_measurements_.begin(), copy_end_itr);
+        // keep the last measurement before the current frame for the next interval
+        if (end_itr != imu_measurements_.begin()) {
+            imu_measurements_.erase(imu_measurements_.begin(), std::prev(end_itr));
+        }
+    }
+
+    if (!last_pose_is_valid || measurements.empty() || curr_frm_.timestamp_ <= last_timestamp) {
+        // the preintegration from the last keyframe is interrupted
+        imu_preint_from_last_keyfrm_ = nullptr;
+        return;
+    }
+
+    auto preint = stella_vslam::make_unique<imu::preintegrator>(*imu_params_, imu_bias_);
+    preint->integrate(measurements, last_timestamp, curr_frm_.timestamp_);
+    if (preint->get_num_measurements() == 0) {
+        imu_preint_from_last_keyfrm_ = nullptr;
+        return;
+    }
+    if (imu_preint_from_last_keyfrm_) {
+        imu_preint_from_last_keyfrm_->integrate(measurements, last_timestamp, curr_frm_.timestamp_);
+    }
+    imu_preint_from_last_frm_ = std::move(preint);
+}
+
+Mat44_t tracking_module::predict_twist_by_IMU(const Mat44_t& twist) const {
+    Vec3_t gravity_w;
+    if (map_db_->get_gravity(gravity_w)) {
+        // predict the pose of the body from the velocity and the gravity
+        const Mat44_t rel_pose_cb = util::converter::inverse_pose(imu_params_->rel_pose_bc_);
+        const Mat44_t last_pose_wb = last_frm_.get_pose_wc() * rel_pose_cb;
+        const Mat33_t last_rot_wb = last_pose_wb.block<3, 3>(0, 0);
+        const Vec3_t last_trans_wb = last_pose_wb.block<3, 1>(0, 3);
+        const double dt = imu_preint_from_last_frm_->get_integration_time();
+
+        Mat44_t pose_wb = Mat44_t::Identity();
+        pose_wb.block<3, 3>(0, 0) = last_rot_wb * imu_preint_from_last_frm_->get_delta_rotation(imu_bias_);
+        pose_wb.block<3, 1>(0, 3) = last_trans_wb + imu_velocity_ * dt + 0.5 * gravity_w * dt * dt
+                                    + last_rot_wb * imu_preint_from_last_frm_->get_delta_position(imu_bias_);
+        const Mat44_t pose_cw = util::converter::inverse_pose(pose_wb * imu_params_->rel_pose_bc_);
+        return pose_cw * last_frm_.get_pose_wc();
+    }
+
+    // rotation of the body/camera from the last frame to the current frame
+    const Mat33_t rot_bc = imu_params_->get_rot_bc();
+    const Mat33_t rot_b1b2 = imu_preint_from_last_frm_->get_delta_rotation(imu_bias_);
+    const Mat33_t rot_c1c2 = rot_bc.transpose() * rot_b1b2 * rot_bc;
+
+    // keep the displacement of the constant velocity model (in the last camera frame),
+    // because the velocity is not estimated until the gravity is known
+    const Mat33_t rot_c2c1 = twist.block<3, 3>(0, 0);
+    const Vec3_t trans_c2c1 = twist.block<3, 1>(0, 3);
+    const Vec3_t trans_c1c2 = -rot_c2c1.transpose() * trans_c2c1;
+
+    Mat44_t predicted_twist = Mat44_t::Identity();
+    predicted_twist.block<3, 3>(0, 0) = rot_c1c2.transpose();
+    predicted_twist.block<3, 1>(0, 3) = -rot_c1c2.transpose() * trans_c1c2;
+    return predicted_twist;
+}
+
+void tracking_module::reset_IMU_preintegration_from_keyframe(const std::shared_ptr<data::keyframe>& keyfrm) {
+    last_imu_keyfrm_ = keyfrm;
+    imu_preint_from_last_keyfrm_ = std::make_shared<imu::preintegrator>(*imu_params_, imu_bias_);
+}
+
+void tracking_module::update_IMU_velocity_by_displacement() {
+    if (!last_frm_.pose_is_valid() || curr_frm_.timestamp_ <= last_frm_.timestamp_) {
+        return;
+    }
+    const Mat44_t rel_pose_cb = util::converter::inverse_pose(imu_params_->rel_pose_bc_);
+    const Vec3_t last_trans_wb = (last_frm_.get_pose_wc() * rel_pose_cb).block<3, 1>(0, 3);
+    const Vec3_t curr_trans_wb = (curr_frm_.get_pose_wc() * rel_pose_cb).block<3, 1>(0, 3);
+    imu_velocity_ = (curr_trans_wb - last_trans_wb) / (curr_frm_.timestamp_ - last_frm_.timestamp_);
+}
+
 void tracking_module::replace_landmarks_in_last_frm(nondeterministic::unordered_map<std::shared_ptr<data::landmark>, std::shared_ptr<data::landmark>>& replaced_lms) {
     std::lock_guard<std::mutex> lock(mtx_last_frm_);
-    for (unsigned int idx = 0; idx < last_frm_.frm_obs_.undist_keypts_.size(); ++idx) {
+    for (unsigned int idx = 0; idx < last_frm_.frm_obs_->undist_keypts_.size(); ++idx) {
         const auto& lm = last_frm_.get_landmark(idx);
         if (!lm) {
             continue;
@@ -447,11 +860,33 @@ bool tracking_module::optimize_current_frame_with_local_map(unsigned int& num_tr
     // optimize the pose
     Mat44_t optimized_pose;
     std::vector<bool> outlier_flags;
-    pose_optimizer_->optimize(curr_frm_, optimized_pose, outlier_flags);
+    bool velocity_is_optimized = false;
+    if (imu_preint_from_last_frm_) {
+        // constrain the pose with the preintegration from the last frame, and estimate the bias (and the velocity)
+        imu::constraint imu_constraint;
+        imu_constraint.preint_ = imu_preint_from_last_frm_;
+        imu_constraint.ref_pose_cw_ = last_frm_.get_pose_cw();
+        imu_constraint.ref_state_ = imu::state(imu_velocity_, imu_bias_);
+        imu_constraint.gravity_is_initialized_ = map_db_->get_gravity(imu_constraint.gravity_w_);
+        imu::state optimized_imu_state;
+        pose_optimizer_->optimize(curr_frm_, imu_constraint, optimized_pose, optimized_imu_state, outlier_flags);
+        imu_bias_ = optimized_imu_state.bias_;
+        if (imu_constraint.gravity_is_initialized_) {
+            imu_velocity_ = optimized_imu_state.velocity_;
+            velocity_is_optimized = true;
+        }
+    }
+    else {
+        pose_optimizer_->optimize(curr_frm_, optimized_pose, outlier_flags);
+    }
     curr_frm_.set_pose_cw(optimized_pose);
+    if (imu_params_ && !velocity_is_optimized) {
+        // the velocity is unknown until the gravity is estimated by the mapping module
+        update_IMU_velocity_by_displacement();
+    }
 
     // Reject outliers
-    for (unsigned int idx = 0; idx < curr_frm_.frm_obs_.undist_keypts_.size(); ++idx) {
+    for (unsigned int idx = 0; idx < curr_frm_.frm_obs_->undist_keypts_.size(); ++idx) {
         if (!outlier_flags.at(idx)) {
             continue;
         }
@@ -461,7 +896,7 @@ bool tracking_module::optimize_current_frame_with_local_map(unsigned int& num_tr
     // count up the number of tracked landmarks
     num_tracked_lms = 0;
     num_reliable_lms = 0;
-    for (unsigned int idx = 0; idx < curr_frm_.frm_obs_.undist_keypts_.size(); ++idx) {
+    for (unsigned int idx = 0; idx < curr_frm_.frm_obs_->undist_keypts_.size(); ++idx) {
         const auto& lm = curr_frm_.get_landmark(idx);
         if (!lm) {
             continue;
@@ -483,6 +918,10 @@ bool tracking_module::optimize_current_frame_with_local_map(unsigned int& num_tr
         lm->increase_num_observed();
     }
 
+    return num_tracked_lms_is_enough(num_tracked_lms);
+}
+
+bool tracking_module::num_tracked_lms_is_enough(const unsigned int num_tracked_lms) const {
     constexpr unsigned int num_tracked_lms_thr = 20;
 
     // if recently relocalized, use the more strict threshold
@@ -503,7 +942,7 @@ bool tracking_module::optimize_current_frame_with_local_map(unsigned int& num_tr
 bool tracking_module::update_local_map(unsigned int fixed_keyframe_id_threshold,
                                        unsigned int& num_temporal_keyfrms) {
     // clean landmark associations
-    for (unsigned int idx = 0; idx < curr_frm_.frm_obs_.undist_keypts_.size(); ++idx) {
+    for (unsigned int idx = 0; idx < curr_frm_.frm_obs_->undist_keypts_.size(); ++idx) {
         const auto& lm = curr_frm_.get_landmark(idx);
         if (!lm) {
             continue;
@@ -560,6 +999,7 @@ bool tracking_module::search_local_landmarks(unsigned int fixed_keyframe_id_thre
     eigen_alloc_unord_map<unsigned int, Vec2_t> lm_to_reproj;
     std::unordered_map<unsigned int, float> lm_to_x_right;
     std::unordered_map<unsigned int, unsigned int> lm_to_scale;
+    std::vector<std::shared_ptr<data::landmark>> proj_candidates;
     for (const auto& lm : local_landmarks_) {
         if (curr_landmark_ids.count(lm->id_)) {
             continue;
@@ -567,20 +1007,8 @@ bool tracking_module::search_local_landmarks(unsigned int fixed_keyframe_id_thre
         if (lm->will_be_erased()) {
             continue;
         }
-        if (fixed_keyframe_id_threshold > 0) {
-            const auto observations = lm->get_observations();
-            unsigned int temporal_observations = 0;
-            for (auto obs : observations) {
-                auto keyfrm = obs.first.lock();
-                if (keyfrm->id_ >= fixed_keyframe_id_threshold) {
-                    ++temporal_observations;
-                }
-            }
-            const double temporal_ratio_thr = 0.5;
-            double temporal_ratio = static_cast<double>(temporal_observations) / observations.size();
-            if (temporal_ratio > temporal_ratio_thr) {
-                continue;
-            }
+        if (fixed_keyframe_id_threshold > 0 && is_temporal_landmark(lm, fixed_keyframe_id_threshold)) {
+            continue;
         }
 
         // check the observability
@@ -588,9 +1016,7 @@ bool tracking_module::search_local_landmarks(unsigned int fixed_keyframe_id_thre
             lm_to_reproj[lm->id_] = reproj;
             lm_to_x_right[lm->id_] = x_right;
             lm_to_scale[lm->id_] = pred_scale_level;
-
-            // this landmark is observable from the current frame
-            lm->increase_num_observable();
+            proj_candidates.push_back(lm);
 
             found_proj_candidate = true;
         }
@@ -606,7 +1032,33 @@ bool tracking_module::search_local_landmarks(unsigned int fixed_keyframe_id_thre
     const float margin = (curr_frm_.id_ < last_reloc_frm_id_ + 2)
                              ? margin_local_map_projection_unstable_
                              : margin_local_map_projection_;
-    projection_matcher.match_frame_and_landmarks(curr_frm_, local_landmarks_, lm_to_reproj, lm_to_x_right, lm_to_scale, margin);
+    if (!local_lm_ranker_.is_enabled()) {
+        for (const auto& lm : proj_candidates) {
+            // this landmark is observable from the current frame
+            lm->increase_num_observable();
+        }
+        projection_matcher.match_frame_and_landmarks(curr_frm_, proj_candidates, lm_to_reproj, lm_to_x_right, lm_to_scale, margin);
+        return true;
+    }
+
+    // match the most useful landmarks first, and stop once the frame has enough matches
+    const auto ranked_lms = local_lm_ranker_.rank(curr_frm_, proj_candidates, lm_to_reproj);
+    const unsigned int num_matches_thr = local_lm_ranker_.get_num_matches_threshold();
+    unsigned int num_matches = curr_landmark_ids.size();
+    auto begin = ranked_lms.begin();
+    while (begin != ranked_lms.end() && num_matches < num_matches_thr) {
+        // (each landmark is matched at most once, so the batch does not exceed the threshold)
+        const auto batch_size = std::min<size_t>(num_matches_thr - num_matches, std::distance(begin, ranked_lms.end()));
+        const std::vector<std::shared_ptr<data::landmark>> batch(begin, begin + batch_size);
+        begin += batch_size;
+        for (const auto& lm : batch) {
+            // only the processed landmarks are counted as observable
+            lm->increase_num_observable();
+        }
+        num_matches += projection_matcher.match_frame_and_landmarks(curr_frm_, batch, lm_to_reproj, lm_to_x_right, lm_to_scale, margin);
+    }
+    SPDLOG_TRACE("tracking_module: matched {}/{} local landmarks (curr_frm_={})",
+                 std::distance(ranked_lms.begin(), begin), ranked_lms.size(), curr_frm_.id_);
     return true;
 }
 
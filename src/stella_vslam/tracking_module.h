@@ -7,6 +7,12 @@
 #include "stella_vslam/module/relocalizer.h"
 #include "stella_vslam/module/keyframe_inserter.h"
 #include "stella_vslam/module/frame_tracker.h"
+#include "stella_vslam/module/local_landmark_ranker.h"
+#include "stella_vslam/module/sparse_image_aligner.h"
+#include "stella_vslam/feature/extraction_map.h"
+#include "stella_vslam/imu/measurement.h"
+#include "stella_vslam/imu/imu_params.h"
+#include "stella_vslam/imu/preintegrator.h"
 
 #include <mutex>
 #include <memory>
@@ -24,8 +30,13 @@ class global_optimization_module;
 namespace data {
 class map_database;
 class bow_database;
+class keyframe_region;
 } // namespace data
 
+namespace util {
+class background_deleter;
+} // namespace util
+
 // tracker state
 enum class tracker_state_t {
     Initializing,
@@ -58,6 +69,9 @@ public:
     //! Set the global optimization module
     void set_global_optimization_module(global_optimization_module* global_optimizer);
 
+    //! Set the deleter which destroys the cleared map in the background (nullptr: destroy it synchronously)
+    void set_background_deleter(util::background_deleter* background_deleter);
+
     //-----------------------------------------
     // interfaces for mapping module and global optimization module
 
@@ -75,6 +89,33 @@ public:
     bool request_relocalize_by_pose(const Mat44_t& pose_cw);
     bool request_relocalize_by_pose_2d(const Mat44_t& pose_cw, const Vec3_t& normal_vector);
 
+    //! Restrict the relocalization when lost to the region (nullptr to search the entire map)
+    void set_relocalization_region(const std::shared_ptr<const data::keyframe_region>& region);
+
+    //! Get the region of the relocalization (nullptr if not restricted)
+    std::shared_ptr<const data::keyframe_region> get_relocalization_region() const;
+
+    //! Get the coverage of the next image by the local landmarks (nullptr if unavailable)
+    std::shared_ptr<const feature::extraction_map> get_extraction_map() const;
+
+    //! Queue the IMU measurement for the prediction of the next frames
+    void queue_IMU_measurement(const imu::measurement& imu_meas);
+
+    //! Change the parameters (max_num_local_keyfrms, margin_local_map_projection(_unstable)) given in the node
+    //! (NOTE: call it between the frames)
+    void update_parameters(const YAML::Node& yaml_node);
+
+    //! Get the motion model from the last frame to the frame at the timestamp (return false if it is invalid)
+    //! (NOTE: the motion is extrapolated over the frames dropped or skipped in between)
+    bool get_motion_model(const double timestamp, Mat44_t& twist) const;
+
+    //! Get the camera pose of the frame which is not processed because the camera is stationary
+    //! (the last pose relative to the reference keyframe, nullptr if it is not tracking)
+    std::shared_ptr<Mat44_t> get_stationary_cam_pose_wc() const;
+
+    //! Check if the frame at the timestamp is likely to be inserted as a keyframe
+    bool new_keyframe_is_likely(const double next_timestamp) const;
+
     //-----------------------------------------
     // management for reset process
 
@@ -124,6 +165,9 @@ public:
     //! If true, automatically try to relocalize when lost
     bool enable_auto_relocalization_ = true;
 
+    //! If true, relocalization when lost is performed in a background thread without blocking the tracking
+    bool enable_async_relocalization_ = false;
+
     //! If true, tracking with only temporal keyframes will not be treated as Lost
     bool enable_temporal_keyframe_only_tracking_ = false;
 
@@ -137,6 +181,19 @@ public:
     float margin_local_map_projection_ = 5.0;
     float margin_local_map_projection_unstable_ = 20.0;
 
+    //! If true, the motion model is refined by the sparse image alignment before the motion based tracking
+    bool enable_sparse_image_alignment_ = false;
+
+    //! If true, the feature extraction budget is allocated according to the predicted projections of the local landmarks
+    bool enable_coverage_driven_extraction_ = false;
+    //! cell size (in pixels) of the extraction map
+    unsigned int extraction_map_cell_size_ = 64;
+    //! number of local landmarks with which a cell of the extraction map is regarded as saturated
+    unsigned int num_saturating_lms_per_cell_ = 8;
+
+    //! IMU parameters (nullptr if the IMU is not used)
+    std::shared_ptr<const imu::imu_params> imu_params_ = nullptr;
+
     //-----------------------------------------
     // variables
 
@@ -163,14 +220,25 @@ protected:
                          unsigned int& num_temporal_keyfrms,
                          unsigned int min_num_obs_thr,
                          unsigned int fixed_keyframe_id_threshold);
-    bool track_local_map_without_temporal_keyframes(unsigned int& num_tracked_lms,
-                                                    unsigned int& num_reliable_lms,
-                                                    unsigned int min_num_obs_thr,
-                                                    unsigned int fixed_keyframe_id_threshold);
+
+    //! Check that enough of the tracked landmarks belong to the fixed map (not to temporal keyframes)
+    bool check_tracking_without_temporal_keyframes(unsigned int fixed_keyframe_id_threshold) const;
+
+    //! Return true if the landmark is mainly observed by temporal keyframes
+    bool is_temporal_landmark(const std::shared_ptr<data::landmark>& lm, unsigned int fixed_keyframe_id_threshold) const;
 
     //! Track the current frame
     bool track_current_frame();
 
+    //! Launch the relocalization of the current frame in the background, or track from the result of the last one
+    bool relocalize_asynchronously();
+
+    //! Return true if the background relocalization is still running
+    bool async_relocalization_is_running() const;
+
+    //! Wait for the background relocalization and discard its result
+    void discard_async_relocalization();
+
     //! Relocalization by pose
     bool relocalize_by_pose(const pose_request& request);
 
@@ -180,6 +248,22 @@ protected:
     //! Update the motion model using the current and last frames
     void update_motion_model();
 
+    //! Preintegrate the queued IMU measurements between the last and current frames
+    void preintegrate_IMU_measurements();
+
+    //! Extrapolate the motion model over the interval from the last frame at the constant velocity
+    Mat44_t extrapolate_twist(const double interval) const;
+
+    //! Predict the motion with the IMU preintegration
+    //! (only the rotation is replaced until the gravity and the velocity are estimated)
+    Mat44_t predict_twist_by_IMU(const Mat44_t& twist) const;
+
+    //! Start the preintegration from the keyframe
+    void reset_IMU_preintegration_from_keyframe(const std::shared_ptr<data::keyframe>& keyfrm);
+
+    //! Approximate the velocity by the displacement of the body between the last and current frames
+    void update_IMU_velocity_by_displacement();
+
     //! Update the camera pose of the last frame
     void update_last_frame();
 
@@ -188,6 +272,12 @@ protected:
                                                unsigned int& num_reliable_lms,
                                                const unsigned int min_num_obs_thr);
 
+    //! Check the number of tracked landmarks is enough to treat the current frame as tracked
+    bool num_tracked_lms_is_enough(unsigned int num_tracked_lms) const;
+
+    //! Build the extraction map for the next frame from the local landmarks
+    void update_extraction_map();
+
     //! Update the local map
     bool update_local_map(unsigned int fixed_keyframe_id_threshold,
                           unsigned int& num_temporal_keyfrms);
@@ -214,6 +304,9 @@ protected:
     //! BoW database
     data::bow_database* bow_db_ = nullptr;
 
+    //! deleter for the cleared map
+    util::background_deleter* background_deleter_ = nullptr;
+
     //! initializer
     module::initializer initializer_;
 
@@ -223,21 +316,39 @@ protected:
     //! frame tracker for current frame
     const module::frame_tracker frame_tracker_;
 
+    //! sparse image aligner for the motion based tracking
+    const module::sparse_image_aligner sparse_image_aligner_;
+
     //! relocalizer
     module::relocalizer relocalizer_;
 
     //! keyframe inserter
     module::keyframe_inserter keyfrm_inserter_;
 
+    //! budget of the local landmarks to be matched
+    const module::local_landmark_ranker local_lm_ranker_;
+
     //! local landmarks
     std::vector<std::shared_ptr<data::landmark>> local_landmarks_;
 
     //! last frame
     data::frame last_frm_;
 
+    //! mutex for the extraction map
+    mutable std::mutex mtx_extraction_map_;
+    //! coverage of the next image by the local landmarks
+    std::shared_ptr<const feature::extraction_map> extraction_map_ = nullptr;
+
     //! mutex for pause process
     mutable std::mutex mtx_last_frm_;
 
+    //! result of the background relocalization (nullptr if failed)
+    std::future<std::shared_ptr<data::frame>> future_async_reloc_;
+
+    //! number of the reliable landmarks tracked in the last frame, and the threshold of the observations
+    unsigned int last_num_reliable_lms_ = 0;
+    unsigned int last_min_num_obs_thr_ = 2;
+
     //! ID of latest frame which succeeded in relocalization
     unsigned int last_reloc_frm_id_ = 0;
     //! timestamp of latest frame which succeeded in relocalization
@@ -247,6 +358,23 @@ protected:
     Mat44_t twist_;
     //! motion model is valid or not
     bool twist_is_valid_ = false;
+    //! interval between the frames from which the motion model is computed [s]
+    double twist_interval_ = 0.0;
+
+    //! mutex for the IMU measurements
+    mutable std::mutex mtx_imu_measurements_;
+    //! IMU measurements not yet used (sorted by timestamp)
+    eigen_alloc_vector<imu::measurement> imu_measurements_;
+    //! IMU bias used for the preintegration (estimated by the pose optimization)
+    imu::bias imu_bias_;
+    //! velocity of the body in the world frame at the last frame
+    Vec3_t imu_velocity_ = Vec3_t::Zero();
+    //! preintegration from the last frame to the current frame (nullptr if unavailable)
+    std::shared_ptr<const imu::preintegrator> imu_preint_from_last_frm_ = nullptr;
+    //! last keyframe from which the measurements are preintegrated (nullptr if unavailable)
+    std::shared_ptr<data::keyframe> last_imu_keyfrm_ = nullptr;
+    //! preintegration from the last keyframe to the current frame (nullptr if interrupted)
+    std::shared_ptr<imu::preintegrator> imu_preint_from_last_keyfrm_ = nullptr;
 
     //! current camera pose from reference keyframe
     //! (to update last camera pose at the beginning of each tracking)
@@ -296,6 +424,11 @@ protected:
     bool relocalize_by_pose_is_requested_ = false;
     //! Requested pose to update
     pose_request relocalize_by_pose_request_;
+
+    //! Mutex for the region of the relocalization
+    mutable std::mutex mtx_reloc_region_;
+    //! region to which the relocalization is restricted (nullptr if not restricted)
+    std::shared_ptr<const data::keyframe_region> reloc_region_ = nullptr;
 };
 
 } // namespace stella_vslam
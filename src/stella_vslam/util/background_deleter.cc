@@ -0,0 +1,74 @@
+#include "stella_vslam/util/background_deleter.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+namespace stella_vslam {
+namespace util {
+
+background_deleter::background_deleter()
+    : thread_(&background_deleter::run, this) {
+    spdlog::debug("CONSTRUCT: util::background_deleter");
+}
+
+background_deleter::~background_deleter() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        terminate_is_requested_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    spdlog::debug("DESTRUCT: util::background_deleter");
+}
+
+void background_deleter::wait_until_empty() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this] { return queue_.empty() && !is_deleting_; });
+}
+
+void background_deleter::push(std::shared_ptr<void> obj) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        queue_.push_back(std::move(obj));
+    }
+    cv_.notify_all();
+}
+
+void background_deleter::run() {
+#ifdef __linux__
+    // Only use the idle CPU time so as not to disturb the tracking
+    sched_param param{};
+    param.sched_priority = 0;
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0) {
+        spdlog::debug("background_deleter: failed to lower the thread priority");
+    }
+#endif
+
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+        cv_.wait(lock, [this] { return !queue_.empty() || terminate_is_requested_; });
+        if (queue_.empty()) {
+            // Termination is requested and nothing remains
+            break;
+        }
+
+        auto obj = std::move(queue_.front());
+        queue_.pop_front();
+        is_deleting_ = true;
+
+        // Destroy the object without holding the lock
+        lock.unlock();
+        obj.reset();
+        lock.lock();
+
+        is_deleting_ = false;
+        cv_.notify_all();
+    }
+}
+
+} // namespace util
+} // namespace stella_vslam
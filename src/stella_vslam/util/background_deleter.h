@@ -0,0 +1,57 @@
+#ifndef STELLA_VSLAM_UTIL_BACKGROUND_DELETER_H
+#define STELLA_VSLAM_UTIL_BACKGROUND_DELETER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace stella_vslam {
+namespace util {
+
+/**
+ * Destroy large object graphs (e.g. the contents of a cleared map) in a low-priority background thread
+ */
+class background_deleter {
+public:
+    //! Constructor
+    background_deleter();
+
+    //! Destructor (destroys the remaining objects before returning)
+    ~background_deleter();
+
+    //! Take the ownership of the object and destroy it in the background thread
+    template<typename T>
+    void dispose(T&& obj) {
+        push(std::make_shared<typename std::decay<T>::type>(std::forward<T>(obj)));
+    }
+
+    //! Block until all the disposed objects are destroyed
+    void wait_until_empty();
+
+private:
+    //! Enqueue the type-erased object
+    void push(std::shared_ptr<void> obj);
+
+    //! Main loop of the background thread
+    void run();
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    //! objects waiting to be destroyed
+    std::deque<std::shared_ptr<void>> queue_;
+    //! the background thread is destroying an object or not
+    bool is_deleting_ = false;
+    //! termination is requested or not
+    bool terminate_is_requested_ = false;
+
+    std::thread thread_;
+};
+
+} // namespace util
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_UTIL_BACKGROUND_DELETER_H
@@ -0,0 +1,103 @@
+#include "stella_vslam/util/runtime_params.h"
+#include "stella_vslam/benchmark/timer.h"
+
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace stella_vslam {
+namespace util {
+
+namespace {
+
+struct runtime_param_range {
+    const char* section;
+    const char* key;
+    double min_value;
+    double max_value;
+    bool is_integer;
+};
+
+//! Parameters which can be changed at runtime and their valid ranges
+const runtime_param_range runtime_param_ranges[] = {
+    {"Preprocessing", "min_size", 1.0, 1e6, true},
+    {"Feature", "ini_fast_threshold", 1.0, 255.0, true},
+    {"Feature", "min_fast_threshold", 1.0, 255.0, true},
+    {"Tracking", "max_num_local_keyfrms", 1.0, 1000.0, true},
+    {"Tracking", "margin_local_map_projection", 0.1, 1000.0, false},
+    {"Tracking", "margin_local_map_projection_unstable", 0.1, 1000.0, false},
+    {"Mapping", "local_ba_num_first_iter", 0.0, 1000.0, true},
+    {"Mapping", "local_ba_num_second_iter", 0.0, 1000.0, true},
+    {"LoopDetector", "num_final_matches_threshold", 1.0, 10000.0, true},
+    {"LoopDetector", "min_continuity", 1.0, 100.0, true},
+};
+
+const runtime_param_range* find_runtime_param_range(const std::string& section, const std::string& key) {
+    for (const auto& range : runtime_param_ranges) {
+        if (section == range.section && key == range.key) {
+            return &range;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+void validate_runtime_params(const YAML::Node& yaml_node) {
+    if (!yaml_node.IsMap()) {
+        throw std::invalid_argument("runtime parameters must be a map of the sections");
+    }
+
+    for (const auto& section_node : yaml_node) {
+        const auto section = section_node.first.as<std::string>();
+        if (!section_node.second.IsMap()) {
+            throw std::invalid_argument("section " + section + " must be a map of the parameters");
+        }
+
+        for (const auto& param_node : section_node.second) {
+            const auto key = param_node.first.as<std::string>();
+            const auto range = find_runtime_param_range(section, key);
+            if (!range) {
+                throw std::invalid_argument(section + "." + key + " cannot be changed at runtime");
+            }
+
+            double value = 0.0;
+            try {
+                value = param_node.second.as<double>();
+            }
+            catch (const YAML::Exception&) {
+                throw std::invalid_argument(section + "." + key + " must be a number");
+            }
+            if (value < range->min_value || range->max_value < value) {
+                throw std::invalid_argument(section + "." + key + " is out of the range ["
+                                            + std::to_string(range->min_value) + ", "
+                                            + std::to_string(range->max_value) + "]");
+            }
+            if (range->is_integer && value != static_cast<double>(static_cast<long long>(value))) {
+                throw std::invalid_argument(section + "." + key + " must be an integer");
+            }
+        }
+    }
+}
+
+void record_param_change(const std::string& module, const std::string& key,
+                         const std::string& old_value, const std::string& new_value) {
+    const auto description = key + ": " + old_value + " -> " + new_value;
+    spdlog::info("{}: change the parameter {}", module, description);
+    benchmark::benchmark_manager::get_instance().record_event(module, description);
+}
+
+void runtime_params_queue::push(const YAML::Node& yaml_node) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    yaml_nodes_.push_back(YAML::Clone(yaml_node));
+}
+
+std::vector<YAML::Node> runtime_params_queue::pop_all() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<YAML::Node> yaml_nodes;
+    yaml_nodes.swap(yaml_nodes_);
+    return yaml_nodes;
+}
+
+} // namespace util
+} // namespace stella_vslam
@@ -0,0 +1,59 @@
+#ifndef STELLA_VSLAM_UTIL_RUNTIME_PARAMS_H
+#define STELLA_VSLAM_UTIL_RUNTIME_PARAMS_H
+
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace stella_vslam {
+namespace util {
+
+/**
+ * Validate the parameters to be changed while the system is running.
+ * The parameters are given with the same sections and keys as the config, e.g.
+ *   Tracking:
+ *     max_num_local_keyfrms: 40
+ * Throw std::invalid_argument if a key is not reconfigurable or a value is out of the range.
+ */
+void validate_runtime_params(const YAML::Node& yaml_node);
+
+//! Record the change of a parameter in the benchmark events and the log
+void record_param_change(const std::string& module, const std::string& key,
+                         const std::string& old_value, const std::string& new_value);
+
+//! Record the change of a parameter in the benchmark events and the log (if the value is changed)
+template<typename T>
+void record_param_change(const std::string& module, const std::string& key, const T& old_value, const T& new_value) {
+    if (old_value == new_value) {
+        return;
+    }
+    std::ostringstream old_ss, new_ss;
+    old_ss << old_value;
+    new_ss << new_value;
+    record_param_change(module, key, old_ss.str(), new_ss.str());
+}
+
+/**
+ * Thread-safe queue of the parameter changes,
+ * which are requested by any thread and applied by the module at its safe point
+ */
+class runtime_params_queue {
+public:
+    //! Request to change the parameters (the node is copied)
+    void push(const YAML::Node& yaml_node);
+
+    //! Take all the requested changes in the order of the requests
+    std::vector<YAML::Node> pop_all();
+
+private:
+    std::mutex mtx_;
+    std::vector<YAML::Node> yaml_nodes_;
+};
+
+} // namespace util
+} // namespace stella_vslam
+
+#endif // STELLA_VSLAM_UTIL_RUNTIME_PARAMS_H
@@ -0,0 +1,122 @@
+#include "stella_vslam/publish/shared_memory_layout.h"
+#include "stella_vslam/publish/shared_memory_reader.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace stella_vslam::publish;
+
+namespace {
+
+volatile std::sig_atomic_t terminate_is_requested = 0;
+
+void request_terminate(int) {
+    terminate_is_requested = 1;
+}
+
+//! Copy of the map built from the snapshots and the map deltas
+struct map_replica {
+    void apply(const shm::map_delta_data& delta) {
+        auto& entities = (delta.entity_ == static_cast<uint32_t>(shm::entity_t::Keyframe)) ? keyfrms_ : lms_;
+        if (delta.op_ == static_cast<uint32_t>(shm::delta_op_t::Upsert)) {
+            entities[delta.id_] = delta;
+        }
+        else if (delta.op_ == static_cast<uint32_t>(shm::delta_op_t::Erase)) {
+            entities.erase(delta.id_);
+        }
+    }
+
+    void clear() {
+        keyfrms_.clear();
+        lms_.clear();
+    }
+
+    std::unordered_map<uint32_t, shm::map_delta_data> keyfrms_;
+    std::unordered_map<uint32_t, shm::map_delta_data> lms_;
+};
+
+const char* to_string(const uint32_t tracking_state) {
+    switch (static_cast<shm::tracking_state_t>(tracking_state)) {
+        case shm::tracking_state_t::Initializing:
+            return "Initializing";
+        case shm::tracking_state_t::Tracking:
+            return "Tracking";
+        case shm::tracking_state_t::Lost:
+            return "Lost";
+    }
+    return "Unknown";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (3 < argc) {
+        std::fprintf(stderr, "usage: %s [name of the shared memory (default: /stella_vslam)] [interval in ms (default: 500)]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const std::string name = (1 < argc) ? argv[1] : "/stella_vslam";
+    const unsigned int interval_ms = (2 < argc) ? std::stoul(argv[2]) : 500;
+
+    std::signal(SIGINT, request_terminate);
+    std::signal(SIGTERM, request_terminate);
+
+    try {
+        shared_memory_reader reader(name);
+        map_replica replica;
+        bool is_synced = false;
+        uint64_t snapshot_map_version = 0;
+        std::vector<shm::map_delta_data> records;
+
+        while (!terminate_is_requested) {
+            // Follow the map deltas, and resync with the snapshot if some of them were missed
+            if (is_synced) {
+                is_synced = reader.read_map_deltas(records);
+                for (const auto& delta : records) {
+                    replica.apply(delta);
+                }
+            }
+            if (!is_synced && reader.read_snapshot(records, snapshot_map_version)) {
+                replica.clear();
+                for (const auto& entity : records) {
+                    replica.apply(entity);
+                }
+                is_synced = reader.read_map_deltas(records);
+                for (const auto& delta : records) {
+                    replica.apply(delta);
+                }
+            }
+
+            shm::pose_data pose;
+            if (!reader.read_latest_pose(pose)) {
+                std::printf("no pose");
+            }
+            else if (pose.pose_is_valid_) {
+                // translation of the column-major pose_wc
+                std::printf("t=%.3f state=%s position=(%.3f, %.3f, %.3f)",
+                            pose.timestamp_, to_string(pose.tracking_state_),
+                            pose.pose_wc_[12], pose.pose_wc_[13], pose.pose_wc_[14]);
+            }
+            else {
+                std::printf("t=%.3f state=%s position=(none)", pose.timestamp_, to_string(pose.tracking_state_));
+            }
+            std::printf(" | map version=%llu keyframes=%zu landmarks=%zu%s\n",
+                        static_cast<unsigned long long>(reader.get_map_version()),
+                        replica.keyfrms_.size(), replica.lms_.size(), is_synced ? "" : " (waiting for a snapshot)");
+            std::fflush(stdout);
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include "stella_vslam/data/bow_vocabulary.h"
+#include "stella_vslam/data/bow_vocabulary_trainer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace stella_vslam;
+
+namespace {
+
+void print_usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [options] <output vocabulary path> <map path>...\n"
+                 "options:\n"
+                 "  --map-format <msgpack|sqlite3>  format of the maps (default: msgpack)\n"
+                 "  --branching-factor <k>          branching factor of the vocabulary tree (default: 10)\n"
+                 "  --depth <L>                     depth of the vocabulary tree (default: 6)\n"
+                 "  --holdout-interval <n>          hold out every n-th keyframe for evaluation, 0 to disable (default: 10)\n",
+                 program);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string map_format = "msgpack";
+    unsigned int branching_factor = 10;
+    unsigned int depth = 6;
+    unsigned int holdout_interval = 10;
+    std::vector<std::string> paths;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+            if (arg == "-h" || arg == "--help") {
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            }
+            else if (arg == "--map-format" && has_value) {
+                map_format = argv[++i];
+            }
+            else if (arg == "--branching-factor" && has_value) {
+                branching_factor = std::stoul(argv[++i]);
+            }
+            else if (arg == "--depth" && has_value) {
+                depth = std::stoul(argv[++i]);
+            }
+            else if (arg == "--holdout-interval" && has_value) {
+                holdout_interval = std::stoul(argv[++i]);
+            }
+            else if (arg.compare(0, 2, "--") == 0) {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            else {
+                paths.push_back(arg);
+            }
+        }
+    }
+    catch (const std::exception&) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (paths.size() < 2 || branching_factor < 2 || depth < 1) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const std::string output_path = paths.front();
+
+    try {
+        data::bow_vocabulary_trainer trainer(branching_factor, depth, holdout_interval);
+        for (unsigned int i = 1; i < paths.size(); ++i) {
+            if (!trainer.add_map(paths.at(i), map_format)) {
+                std::fprintf(stderr, "cannot load the map %s\n", paths.at(i).c_str());
+                return EXIT_FAILURE;
+            }
+        }
+
+        const auto bow_vocab = trainer.train();
+        if (!bow_vocab || !data::bow_vocabulary_util::save(bow_vocab.get(), output_path)) {
+            return EXIT_FAILURE;
+        }
+
+        if (0 < trainer.get_num_holdout_keyframes()) {
+            const auto eval = trainer.evaluate(bow_vocab.get());
+            std::printf("training keyframes: %u\n", trainer.get_num_training_keyframes());
+            std::printf("held-out queries: %u\n", eval.num_queries_);
+            std::printf("retrieval precision: %.3f (%u/%u)\n", eval.precision_, eval.num_correct_, eval.num_queries_);
+            std::printf("mean transform time: %.3f ms/keyframe\n", eval.mean_transform_time_ms_);
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#include "stella_vslam/camera/perspective.h"
+#include "stella_vslam/data/bow_vocabulary.h"
+#include "stella_vslam/data/bow_vocabulary_trainer.h"
+#include "stella_vslam/data/graph_node.h"
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/feature/orb_params.h"
+
+#include <cstdio>
+#include <random>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+constexpr unsigned int num_places = 4;
+constexpr unsigned int num_keyfrms_per_place = 10;
+constexpr unsigned int num_descs = 100;
+
+/**
+ * Keyframes at a few distinct places
+ * The keyframes at the same place observe the same random descriptors with a few flipped bits,
+ * and they are covisible with each other.
+ */
+class bow_vocabulary_trainer_test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 random_engine(42);
+        std::uniform_int_distribution<int> byte_dist(0, 255);
+        std::uniform_int_distribution<int> bit_dist(0, 255);
+
+        for (unsigned int place = 0; place < num_places; ++place) {
+            cv::Mat place_descs(num_descs, 32, CV_8U);
+            for (unsigned int row = 0; row < num_descs; ++row) {
+                for (unsigned int col = 0; col < 32; ++col) {
+                    place_descs.at<uchar>(row, col) = byte_dist(random_engine);
+                }
+            }
+
+            std::vector<std::shared_ptr<data::keyframe>> place_keyfrms;
+            for (unsigned int i = 0; i < num_keyfrms_per_place; ++i) {
+                const unsigned int id = place * num_keyfrms_per_place + i;
+                data::frame_observation frm_obs;
+                frm_obs.descriptors_ = place_descs.clone();
+                for (unsigned int row = 0; row < num_descs; ++row) {
+                    const int bit = bit_dist(random_engine);
+                    frm_obs.descriptors_.at<uchar>(row, bit / 8) ^= 1 << (bit % 8);
+                    frm_obs.undist_keypts_.emplace_back(cv::Point2f(row % 10 * 60 + 30, row / 10 * 45 + 30), 31.0);
+                }
+                place_keyfrms.push_back(data::keyframe::make_keyframe(id, 0.1 * id, Mat44_t::Identity(), &camera_, &orb_params_, frm_obs,
+                                                                      data::bow_vector(), data::bow_feature_vector()));
+            }
+
+            for (const auto& keyfrm_1 : place_keyfrms) {
+                for (const auto& keyfrm_2 : place_keyfrms) {
+                    if (keyfrm_1 != keyfrm_2) {
+                        keyfrm_1->graph_node_->add_connection(keyfrm_2, num_descs);
+                    }
+                }
+            }
+            keyfrms_.insert(keyfrms_.end(), place_keyfrms.begin(), place_keyfrms.end());
+        }
+    }
+
+    camera::perspective camera_{"camera", camera::setup_type_t::Monocular, camera::color_order_t::Gray,
+                                640, 480, 30.0, 400.0, 400.0, 320.0, 240.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    feature::orb_params orb_params_{"ORB setting for test"};
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms_;
+};
+
+} // namespace
+
+TEST_F(bow_vocabulary_trainer_test, train_save_load_and_evaluate) {
+    data::bow_vocabulary_trainer trainer(8, 2, 5);
+    trainer.add_keyframes(keyfrms_);
+    EXPECT_EQ(trainer.get_num_training_keyframes(), 32u);
+    EXPECT_EQ(trainer.get_num_holdout_keyframes(), 8u);
+
+    const auto bow_vocab = trainer.train();
+    ASSERT_NE(bow_vocab, nullptr);
+    const auto eval = trainer.evaluate(bow_vocab.get());
+    EXPECT_EQ(eval.num_queries_, 8u);
+    // the chance level is 1 / num_places
+    EXPECT_GE(eval.precision_, 0.9);
+
+    const std::string path = ::testing::TempDir() + "bow_vocabulary_trainer_test.vocab";
+    ASSERT_TRUE(data::bow_vocabulary_util::save(bow_vocab.get(), path));
+    const std::unique_ptr<data::bow_vocabulary> loaded_bow_vocab(data::bow_vocabulary_util::load(path));
+    std::remove(path.c_str());
+    ASSERT_NE(loaded_bow_vocab, nullptr);
+
+    // the loaded vocabulary gives the same retrieval
+    const auto loaded_eval = trainer.evaluate(loaded_bow_vocab.get());
+    EXPECT_EQ(loaded_eval.num_queries_, eval.num_queries_);
+    EXPECT_EQ(loaded_eval.num_correct_, eval.num_correct_);
+}
+
+TEST_F(bow_vocabulary_trainer_test, evaluate_without_vocabulary) {
+    data::bow_vocabulary_trainer trainer(8, 2, 5);
+    trainer.add_keyframes(keyfrms_);
+    const auto eval = trainer.evaluate(nullptr);
+    EXPECT_EQ(eval.num_queries_, 0u);
+    EXPECT_EQ(eval.precision_, 0.0);
+}
@@ -0,0 +1,254 @@
+#include "stella_vslam/camera/perspective.h"
+#include "stella_vslam/data/graph_node.h"
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/feature/orb_params.h"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+class bounded_covisibility_graph : public ::testing::Test {
+protected:
+    //! Create a keyframe at the position
+    std::shared_ptr<data::keyframe> create_keyframe(const unsigned int id, const Vec3_t& trans_wc) {
+        data::frame_observation frm_obs;
+        frm_obs.undist_keypts_.resize(num_lms_);
+        Mat44_t pose_cw = Mat44_t::Identity();
+        pose_cw.block<3, 1>(0, 3) = -trans_wc;
+        return data::keyframe::make_keyframe(id, 0.1 * id, pose_cw, &camera_, &orb_params_, frm_obs,
+                                             data::bow_vector(), data::bow_feature_vector());
+    }
+
+    //! Create the keyframes sharing the landmarks with the keyframe at the origin
+    std::shared_ptr<data::keyframe> create_covisibility_graph(const std::vector<std::pair<unsigned int, Vec3_t>>& nums_shared_lms_and_trans_wc) {
+        auto curr_keyfrm = create_keyframe(nums_shared_lms_and_trans_wc.size() + 1, Vec3_t::Zero());
+        for (unsigned int idx = 0; idx < num_lms_; ++idx) {
+            lms_.push_back(std::make_shared<data::landmark>(idx, Vec3_t{0.0, 0.0, 5.0}, curr_keyfrm));
+            lms_.back()->connect_to_keyframe(curr_keyfrm, idx);
+        }
+
+        for (unsigned int i = 0; i < nums_shared_lms_and_trans_wc.size(); ++i) {
+            keyfrms_.push_back(create_keyframe(i + 1, nums_shared_lms_and_trans_wc.at(i).second));
+            if (i == 0) {
+                keyfrms_.front()->graph_node_->set_spanning_root(keyfrms_.front());
+            }
+            else {
+                keyfrms_.back()->graph_node_->set_spanning_parent(keyfrms_.front());
+            }
+            for (unsigned int idx = 0; idx < nums_shared_lms_and_trans_wc.at(i).first; ++idx) {
+                lms_.at(idx)->connect_to_keyframe(keyfrms_.back(), idx);
+            }
+        }
+        return curr_keyfrm;
+    }
+
+    static constexpr unsigned int num_lms_ = 60;
+
+    camera::perspective camera_{"camera", camera::setup_type_t::Monocular, camera::color_order_t::Gray,
+                                640, 480, 30.0, 400.0, 400.0, 320.0, 240.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    feature::orb_params orb_params_{"ORB setting for test"};
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms_;
+    std::vector<std::shared_ptr<data::landmark>> lms_;
+};
+
+/**
+ * Keyframe 1 (to be erased) is the child of the root keyframe 0, and the parent of all the other keyframes.
+ * The covisibilities are given as the numbers of the landmarks shared by the pairs of keyframes.
+ */
+class spanning_tree_repair : public ::testing::Test {
+protected:
+    //! Create the keyframes with the landmarks shared by the given pairs (id_1, id_2, number of shared landmarks)
+    void create_spanning_tree(const unsigned int num_keyfrms, const std::vector<std::tuple<unsigned int, unsigned int, unsigned int>>& covisibilities) {
+        keyfrms_.clear();
+        lms_.clear();
+
+        std::vector<unsigned int> nums_keypts(num_keyfrms, 0);
+        for (const auto& covisibility : covisibilities) {
+            nums_keypts.at(std::get<0>(covisibility)) += std::get<2>(covisibility);
+            nums_keypts.at(std::get<1>(covisibility)) += std::get<2>(covisibility);
+        }
+        for (unsigned int id = 0; id < num_keyfrms; ++id) {
+            data::frame_observation frm_obs;
+            frm_obs.undist_keypts_.resize(nums_keypts.at(id));
+            keyfrms_.push_back(data::keyframe::make_keyframe(id, 0.1 * id, Mat44_t::Identity(), &camera_, &orb_params_, frm_obs,
+                                                             data::bow_vector(), data::bow_feature_vector()));
+        }
+
+        keyfrms_.at(0)->graph_node_->set_spanning_root(keyfrms_.at(0));
+        for (unsigned int id = 1; id < num_keyfrms; ++id) {
+            const auto& parent = (id == 1) ? keyfrms_.at(0) : keyfrms_.at(1);
+            keyfrms_.at(id)->graph_node_->set_spanning_parent(parent);
+            parent->graph_node_->add_spanning_child(keyfrms_.at(id));
+        }
+
+        std::vector<unsigned int> next_idx(num_keyfrms, 0);
+        for (const auto& covisibility : covisibilities) {
+            const auto& keyfrm_1 = keyfrms_.at(std::get<0>(covisibility));
+            const auto& keyfrm_2 = keyfrms_.at(std::get<1>(covisibility));
+            for (unsigned int i = 0; i < std::get<2>(covisibility); ++i) {
+                lms_.push_back(std::make_shared<data::landmark>(lms_.size(), Vec3_t{0.0, 0.0, 5.0}, keyfrm_1));
+                lms_.back()->connect_to_keyframe(keyfrm_1, next_idx.at(keyfrm_1->id_)++);
+                lms_.back()->connect_to_keyframe(keyfrm_2, next_idx.at(keyfrm_2->id_)++);
+            }
+        }
+        for (const auto& keyfrm : keyfrms_) {
+            keyfrm->graph_node_->update_connections(0);
+        }
+    }
+
+    /**
+     * Find the new parents of the children of the keyframe by the repair before the max-heap one:
+     * rescan all the remaining children on each step, and attach the one with the maximum number of the shared landmarks
+     * @param keyfrm
+     * @return new parent ID of each child ID
+     */
+    static std::map<unsigned int, unsigned int> recover_by_rescanning(const std::shared_ptr<data::keyframe>& keyfrm) {
+        const auto parent = keyfrm->graph_node_->get_spanning_parent();
+        std::set<unsigned int> parent_candidate_ids{parent->id_};
+        auto children = keyfrm->graph_node_->get_spanning_children();
+
+        std::map<unsigned int, unsigned int> child_id_to_parent_id;
+        while (!children.empty()) {
+            unsigned int max_num_shared_lms = 0;
+            std::shared_ptr<data::keyframe> max_num_shared_lms_parent = nullptr;
+            std::shared_ptr<data::keyframe> max_num_shared_lms_child = nullptr;
+            for (const auto& child : children) {
+                for (const auto& covisibility : child->graph_node_->get_covisibilities()) {
+                    if (!parent_candidate_ids.count(covisibility->id_)) {
+                        continue;
+                    }
+                    const auto num_shared_lms = child->graph_node_->get_num_shared_landmarks(covisibility);
+                    if (max_num_shared_lms < num_shared_lms) {
+                        max_num_shared_lms = num_shared_lms;
+                        max_num_shared_lms_parent = covisibility;
+                        max_num_shared_lms_child = child;
+                    }
+                }
+            }
+            if (!max_num_shared_lms_child) {
+                break;
+            }
+            child_id_to_parent_id[max_num_shared_lms_child->id_] = max_num_shared_lms_parent->id_;
+            children.erase(max_num_shared_lms_child);
+            parent_candidate_ids.insert(max_num_shared_lms_child->id_);
+        }
+        // the children unreachable from the tree are attached to the parent
+        for (const auto& child : children) {
+            child_id_to_parent_id[child->id_] = parent->id_;
+        }
+        return child_id_to_parent_id;
+    }
+
+    //! Erase keyframe 1 from the spanning tree, and check the new parents against the rescanning repair
+    void check_repair() {
+        const auto& erased_keyfrm = keyfrms_.at(1);
+        const auto child_id_to_parent_id = recover_by_rescanning(erased_keyfrm);
+        erased_keyfrm->graph_node_->recover_spanning_connections();
+
+        EXPECT_TRUE(erased_keyfrm->graph_node_->get_spanning_children().empty());
+        EXPECT_FALSE(keyfrms_.at(0)->graph_node_->has_spanning_child(erased_keyfrm));
+        for (unsigned int id = 2; id < keyfrms_.size(); ++id) {
+            const auto& child = keyfrms_.at(id);
+            const auto new_parent = child->graph_node_->get_spanning_parent();
+            ASSERT_TRUE(new_parent);
+            EXPECT_EQ(new_parent->id_, child_id_to_parent_id.at(id));
+            EXPECT_TRUE(new_parent->graph_node_->has_spanning_child(child));
+        }
+    }
+
+    camera::perspective camera_{"camera", camera::setup_type_t::Monocular, camera::color_order_t::Gray,
+                                640, 480, 30.0, 400.0, 400.0, 320.0, 240.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    feature::orb_params orb_params_{"ORB setting for test"};
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms_;
+    std::vector<std::shared_ptr<data::landmark>> lms_;
+};
+
+} // namespace
+
+TEST_F(bounded_covisibility_graph, keep_all_by_default) {
+    auto curr_keyfrm = create_covisibility_graph({{50, Vec3_t{0.1, 0.0, 0.0}},
+                                                  {40, Vec3_t{0.2, 0.0, 0.0}},
+                                                  {30, Vec3_t{0.3, 0.0, 0.0}},
+                                                  {20, Vec3_t{0.4, 0.0, 0.0}},
+                                                  {16, Vec3_t{10.0, 0.0, 0.0}}});
+    curr_keyfrm->graph_node_->update_connections(15);
+    EXPECT_EQ(curr_keyfrm->graph_node_->get_covisibilities().size(), 5);
+}
+
+TEST_F(bounded_covisibility_graph, keep_strongest_and_spread_covisibilities) {
+    auto curr_keyfrm = create_covisibility_graph({{50, Vec3_t{0.1, 0.0, 0.0}},
+                                                  {40, Vec3_t{0.2, 0.0, 0.0}},
+                                                  {30, Vec3_t{0.3, 0.0, 0.0}},
+                                                  {20, Vec3_t{0.4, 0.0, 0.0}},
+                                                  {16, Vec3_t{10.0, 0.0, 0.0}},
+                                                  {18, Vec3_t{0.5, 0.0, 0.0}}});
+    curr_keyfrm->graph_node_->update_connections(15, 4);
+
+    // The three strongest ones, and the farthest one instead of the stronger ones near them
+    const auto covisibilities = curr_keyfrm->graph_node_->get_covisibilities_and_num_shared_lms();
+    ASSERT_EQ(covisibilities.size(), 4);
+    EXPECT_EQ(covisibilities.at(0).first->id_, 1);
+    EXPECT_EQ(covisibilities.at(1).first->id_, 2);
+    EXPECT_EQ(covisibilities.at(2).first->id_, 3);
+    EXPECT_EQ(covisibilities.at(3).first->id_, 5);
+    EXPECT_EQ(covisibilities.at(3).second, 16);
+
+    // The dropped connections are still counted
+    EXPECT_EQ(curr_keyfrm->graph_node_->get_num_shared_landmarks(keyfrms_.at(3)), 20);
+
+    // The bound is kept when the order is updated by the connection from another keyframe
+    curr_keyfrm->graph_node_->add_connection(keyfrms_.at(3), 45);
+    EXPECT_EQ(curr_keyfrm->graph_node_->get_covisibilities().size(), 4);
+}
+
+TEST_F(spanning_tree_repair, match_rescanning_repair) {
+    create_spanning_tree(7, {std::make_tuple(0, 1, 100),
+                             std::make_tuple(1, 2, 60), std::make_tuple(1, 3, 60), std::make_tuple(1, 4, 60),
+                             std::make_tuple(1, 5, 60), std::make_tuple(1, 6, 60),
+                             std::make_tuple(0, 2, 30), std::make_tuple(0, 3, 20), std::make_tuple(0, 4, 10),
+                             std::make_tuple(2, 3, 50), std::make_tuple(2, 4, 25),
+                             std::make_tuple(3, 5, 35), std::make_tuple(4, 5, 40)});
+    check_repair();
+
+    // 2 is attached to the root first, then 3, 5 and 4 are attached through the stronger edges among the children,
+    // and 6 shares no landmarks with them, so it is attached to the root
+    EXPECT_EQ(keyfrms_.at(2)->graph_node_->get_spanning_parent()->id_, 0);
+    EXPECT_EQ(keyfrms_.at(3)->graph_node_->get_spanning_parent()->id_, 2);
+    EXPECT_EQ(keyfrms_.at(4)->graph_node_->get_spanning_parent()->id_, 5);
+    EXPECT_EQ(keyfrms_.at(5)->graph_node_->get_spanning_parent()->id_, 3);
+    EXPECT_EQ(keyfrms_.at(6)->graph_node_->get_spanning_parent()->id_, 0);
+}
+
+TEST_F(spanning_tree_repair, match_rescanning_repair_on_random_graphs) {
+    constexpr unsigned int num_keyfrms = 10;
+    std::mt19937 random_engine(42);
+    std::bernoulli_distribution is_covisible(0.4);
+    for (unsigned int trial = 0; trial < 10; ++trial) {
+        // distinct numbers of the shared landmarks, so that the order of the attachment is unique
+        std::vector<unsigned int> nums_shared_lms(num_keyfrms * num_keyfrms);
+        std::iota(nums_shared_lms.begin(), nums_shared_lms.end(), 1);
+        std::shuffle(nums_shared_lms.begin(), nums_shared_lms.end(), random_engine);
+
+        std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> covisibilities;
+        covisibilities.emplace_back(0, 1, 200);
+        for (unsigned int id_1 = 0; id_1 < num_keyfrms; ++id_1) {
+            for (unsigned int id_2 = std::max(id_1 + 1, 2u); id_2 < num_keyfrms; ++id_2) {
+                if (id_1 == 1 || is_covisible(random_engine)) {
+                    covisibilities.emplace_back(id_1, id_2, nums_shared_lms.at(id_1 * num_keyfrms + id_2));
+                }
+            }
+        }
+        create_spanning_tree(num_keyfrms, covisibilities);
+        check_repair();
+    }
+}
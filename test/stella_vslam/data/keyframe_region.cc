@@ -0,0 +1,29 @@
+#include "stella_vslam/data/keyframe_region.h"
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+TEST(keyframe_region, bounding_box) {
+    const auto region = data::keyframe_region::bounding_box(Vec3_t{1.0, -1.0, 2.0}, Vec3_t{-1.0, 1.0, 0.0});
+    EXPECT_EQ(region.type_, data::keyframe_region_t::BoundingBox);
+    EXPECT_TRUE(region.contains(Vec3_t{0.0, 0.0, 1.0}));
+    EXPECT_TRUE(region.contains(Vec3_t{1.0, 1.0, 2.0}));
+    EXPECT_FALSE(region.contains(Vec3_t{0.0, 0.0, 2.1}));
+    EXPECT_FALSE(region.contains(Vec3_t{-1.5, 0.0, 1.0}));
+}
+
+TEST(keyframe_region, sphere) {
+    const auto region = data::keyframe_region::sphere(Vec3_t{10.0, 0.0, 0.0}, 2.0);
+    EXPECT_TRUE(region.contains(Vec3_t{11.0, 1.0, 1.0}));
+    EXPECT_FALSE(region.contains(Vec3_t{12.0, 1.0, 0.0}));
+    EXPECT_FALSE(region.contains(Vec3_t::Zero()));
+}
+
+TEST(keyframe_region, keyframe_ids) {
+    const auto region = data::keyframe_region::keyframe_ids({1, 2, 3});
+    EXPECT_EQ(region.keyfrm_ids_.size(), 3u);
+    // The positions are not restricted
+    EXPECT_TRUE(region.contains(Vec3_t{100.0, 0.0, 0.0}));
+    EXPECT_FALSE(region.contains(std::shared_ptr<data::keyframe>(nullptr)));
+}
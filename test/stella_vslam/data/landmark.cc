@@ -0,0 +1,254 @@
+#include "stella_vslam/camera/perspective.h"
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/data/map_database.h"
+#include "stella_vslam/feature/orb_params.h"
+#include "stella_vslam/optimize/landmark_convergence_checker.h"
+
+#include <cmath>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+constexpr unsigned int max_num_active_obs = 3;
+
+class landmark_observations : public ::testing::Test {
+protected:
+    //! Create a keyframe looking at the origin from the angle around the Y axis
+    std::shared_ptr<data::keyframe> create_keyframe(const unsigned int id, const double angle, const int scale_level = 0) {
+        data::frame_observation frm_obs;
+        frm_obs.undist_keypts_.resize(1);
+        frm_obs.undist_keypts_.at(0).octave = scale_level;
+        Mat44_t pose_wc = Mat44_t::Identity();
+        pose_wc.block<3, 3>(0, 0) = Eigen::AngleAxisd(angle, Vec3_t::UnitY()).toRotationMatrix();
+        pose_wc.block<3, 1>(0, 3) = -5.0 * Vec3_t{std::sin(angle), 0.0, std::cos(angle)};
+        return data::keyframe::make_keyframe(id, 0.1 * id, pose_wc.inverse(), &camera_, &orb_params_, frm_obs,
+                                             data::bow_vector(), data::bow_feature_vector());
+    }
+
+    camera::perspective camera_{"camera", camera::setup_type_t::Monocular, camera::color_order_t::Gray,
+                                640, 480, 30.0, 400.0, 400.0, 320.0, 240.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    feature::orb_params orb_params_{"ORB setting for test"};
+    data::map_database map_db_{15};
+};
+
+} // namespace
+
+TEST_F(landmark_observations, deactivate_redundant_observations) {
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms;
+    keyfrms.push_back(create_keyframe(0, 0.0));
+    auto lm = std::make_shared<data::landmark>(0, Vec3_t::Zero(), keyfrms.at(0));
+    map_db_.add_landmark(lm);
+    lm->connect_to_keyframe(keyfrms.at(0), 0);
+
+    // Two keyframes with almost the same viewpoint as the reference keyframe, and two distant ones
+    const double angles[] = {0.01, 0.5, 0.02, -0.5};
+    for (unsigned int i = 0; i < 4; ++i) {
+        keyfrms.push_back(create_keyframe(i + 1, angles[i]));
+        lm->connect_to_keyframe(keyfrms.back(), 0);
+        EXPECT_EQ(lm->update_active_observations(max_num_active_obs), 2 <= i);
+    }
+
+    EXPECT_EQ(lm->num_observations(), 5);
+    const auto observations = lm->get_observations();
+    ASSERT_EQ(observations.size(), 3);
+    EXPECT_EQ(lm->get_inactive_observations().size(), 2);
+    EXPECT_EQ(lm->get_all_observations().size(), 5);
+    // The reference keyframe and the distant ones are kept active
+    EXPECT_TRUE(observations.count(keyfrms.at(0)));
+    EXPECT_TRUE(observations.count(keyfrms.at(2)));
+    EXPECT_TRUE(observations.count(keyfrms.at(4)));
+
+    // The inactive observations are still associated
+    EXPECT_TRUE(lm->is_observed_in_keyframe(keyfrms.at(1)));
+    EXPECT_EQ(lm->get_index_in_keyframe(keyfrms.at(3)), 0);
+    EXPECT_EQ(keyfrms.at(1)->get_landmark(0), lm);
+}
+
+TEST_F(landmark_observations, reactivate_inactive_observation) {
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms;
+    for (unsigned int i = 0; i < 5; ++i) {
+        keyfrms.push_back(create_keyframe(i, 0.1 * i));
+    }
+    auto lm = std::make_shared<data::landmark>(0, Vec3_t::Zero(), keyfrms.at(0));
+    map_db_.add_landmark(lm);
+    for (const auto& keyfrm : keyfrms) {
+        lm->connect_to_keyframe(keyfrm, 0);
+        lm->update_active_observations(max_num_active_obs);
+    }
+    ASSERT_EQ(lm->get_observations().size(), 3);
+    ASSERT_EQ(lm->get_inactive_observations().size(), 2);
+
+    // Erasing an active observation reactivates an inactive one
+    const auto active_keyfrm = std::prev(lm->get_observations().end())->first.lock();
+    lm->erase_observation(&map_db_, active_keyfrm);
+    EXPECT_EQ(lm->get_observations().size(), 3);
+    EXPECT_EQ(lm->get_inactive_observations().size(), 1);
+    EXPECT_EQ(lm->num_observations(), 4);
+
+    // Erasing an inactive observation does not change the active ones
+    const auto inactive_keyfrm = lm->get_inactive_observations().begin()->first.lock();
+    lm->erase_observation(&map_db_, inactive_keyfrm);
+    EXPECT_EQ(lm->get_observations().size(), 3);
+    EXPECT_TRUE(lm->get_inactive_observations().empty());
+    EXPECT_FALSE(lm->will_be_erased());
+}
+
+TEST_F(landmark_observations, keep_redundancies_after_erasing_nearest_observation) {
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms;
+    keyfrms.push_back(create_keyframe(0, 0.0));
+    auto lm = std::make_shared<data::landmark>(0, Vec3_t::Zero(), keyfrms.at(0));
+    map_db_.add_landmark(lm);
+    lm->connect_to_keyframe(keyfrms.at(0), 0);
+
+    // The keyframes 1 and 2 are the nearest to each other
+    const double angles[] = {0.3, 0.32, -0.3};
+    for (unsigned int i = 0; i < 3; ++i) {
+        keyfrms.push_back(create_keyframe(i + 1, angles[i]));
+        lm->connect_to_keyframe(keyfrms.back(), 0);
+        EXPECT_FALSE(lm->update_active_observations(max_num_active_obs + 1));
+    }
+
+    // After the keyframe 2 is erased, the keyframe 1 is rescored against the remaining ones,
+    // so the keyframe 3 which is the nearest to the new keyframe 5 is deactivated instead
+    lm->erase_observation(&map_db_, keyfrms.at(2));
+    keyfrms.push_back(create_keyframe(4, 0.6));
+    lm->connect_to_keyframe(keyfrms.back(), 0);
+    keyfrms.push_back(create_keyframe(5, -0.32));
+    lm->connect_to_keyframe(keyfrms.back(), 0);
+    EXPECT_TRUE(lm->update_active_observations(max_num_active_obs + 1));
+
+    const auto observations = lm->get_observations();
+    ASSERT_EQ(observations.size(), 4);
+    EXPECT_TRUE(observations.count(keyfrms.at(1)));
+    EXPECT_FALSE(observations.count(keyfrms.at(3)));
+}
+
+TEST_F(landmark_observations, relative_pos_uncertainty_from_observation_geometry) {
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms;
+    keyfrms.push_back(create_keyframe(0, 0.0));
+    auto lm = std::make_shared<data::landmark>(0, Vec3_t::Zero(), keyfrms.at(0));
+    map_db_.add_landmark(lm);
+    lm->connect_to_keyframe(keyfrms.at(0), 0);
+    lm->update_mean_normal_and_obs_scale_variance();
+
+    // The depth is not constrained by a single bearing
+    EXPECT_EQ(lm->get_relative_pos_uncertainty(), std::numeric_limits<float>::infinity());
+
+    keyfrms.push_back(create_keyframe(1, 0.5));
+    lm->connect_to_keyframe(keyfrms.at(1), 0);
+    lm->set_pos_in_world(Vec3_t::Zero());
+    lm->update_mean_normal_and_obs_scale_variance();
+
+    // The least constrained direction is the bisector of the two rays
+    EXPECT_NEAR(lm->get_relative_pos_uncertainty(), 1.0 / (std::sqrt(2.0) * std::sin(0.25)), 1e-4);
+}
+
+TEST_F(landmark_observations, converge_with_small_BA_updates) {
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms;
+    for (unsigned int i = 0; i < 3; ++i) {
+        keyfrms.push_back(create_keyframe(i, 0.3 * i));
+    }
+    auto lm = std::make_shared<data::landmark>(0, Vec3_t::Zero(), keyfrms.at(0));
+    map_db_.add_landmark(lm);
+    for (const auto& keyfrm : keyfrms) {
+        lm->connect_to_keyframe(keyfrm, 0);
+    }
+    lm->update_mean_normal_and_obs_scale_variance();
+
+    const optimize::landmark_convergence_checker checker(3, 5.0, 1e-3);
+    EXPECT_FALSE(checker.is_converged(*lm));
+
+    // The first update moves the landmark by 1% of the distance
+    const Vec3_t pos_w{0.0, 0.0, 0.05};
+    lm->set_pos_in_world_by_BA(pos_w);
+    lm->update_mean_normal_and_obs_scale_variance();
+    EXPECT_NEAR(lm->get_relative_BA_update(), 0.505, 1e-4);
+    EXPECT_FALSE(checker.is_converged(*lm));
+
+    // The landmark is regarded as converged after it kept still in the following updates
+    for (unsigned int i = 0; i < 10; ++i) {
+        lm->set_pos_in_world_by_BA(pos_w);
+        lm->update_mean_normal_and_obs_scale_variance();
+    }
+    EXPECT_LT(lm->get_relative_BA_update(), 1e-3);
+    EXPECT_TRUE(checker.is_converged(*lm));
+
+    // Nothing is fixed with the default parameters
+    EXPECT_FALSE(optimize::landmark_convergence_checker().is_converged(*lm));
+}
+
+TEST_F(landmark_observations, reset_convergence_on_external_changes) {
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms;
+    for (unsigned int i = 0; i < 4; ++i) {
+        keyfrms.push_back(create_keyframe(i, 0.3 * i));
+    }
+    auto lm = std::make_shared<data::landmark>(0, Vec3_t::Zero(), keyfrms.at(0));
+    map_db_.add_landmark(lm);
+    for (unsigned int i = 0; i < 3; ++i) {
+        lm->connect_to_keyframe(keyfrms.at(i), 0);
+    }
+    lm->update_mean_normal_and_obs_scale_variance();
+
+    const optimize::landmark_convergence_checker checker(3, 5.0, 1e-3, 4);
+    const auto converge = [&lm]() {
+        for (unsigned int i = 0; i < 12; ++i) {
+            lm->set_pos_in_world_by_BA(lm->get_pos_in_world());
+        }
+        lm->update_mean_normal_and_obs_scale_variance();
+    };
+
+    // Moved by the loop correction
+    converge();
+    ASSERT_TRUE(checker.is_converged(*lm));
+    lm->set_pos_in_world(Vec3_t{0.0, 0.0, 0.1});
+    EXPECT_FLOAT_EQ(lm->get_relative_BA_update(), 1.0);
+    EXPECT_FALSE(checker.is_converged(*lm));
+
+    // Observed from a new keyframe
+    converge();
+    ASSERT_TRUE(checker.is_converged(*lm));
+    lm->connect_to_keyframe(keyfrms.at(3), 0);
+    EXPECT_FALSE(checker.is_converged(*lm));
+
+    // Lost an observation
+    converge();
+    ASSERT_TRUE(checker.is_converged(*lm));
+    lm->erase_observation(&map_db_, keyfrms.at(3));
+    EXPECT_FALSE(checker.is_converged(*lm));
+}
+
+TEST_F(landmark_observations, fixed_landmarks_rejoin_periodically) {
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms;
+    for (unsigned int i = 0; i < 3; ++i) {
+        keyfrms.push_back(create_keyframe(i, 0.3 * i));
+    }
+    auto lm = std::make_shared<data::landmark>(0, Vec3_t::Zero(), keyfrms.at(0));
+    map_db_.add_landmark(lm);
+    for (const auto& keyfrm : keyfrms) {
+        lm->connect_to_keyframe(keyfrm, 0);
+    }
+    for (unsigned int i = 0; i < 12; ++i) {
+        lm->set_pos_in_world_by_BA(Vec3_t::Zero());
+    }
+    lm->update_mean_normal_and_obs_scale_variance();
+
+    // The converged landmark is optimized once every 4 keyframes
+    const optimize::landmark_convergence_checker checker(3, 5.0, 1e-3, 4);
+    ASSERT_TRUE(checker.is_converged(*lm));
+    unsigned int num_fixed = 0;
+    for (unsigned int keyfrm_id = 0; keyfrm_id < 8; ++keyfrm_id) {
+        num_fixed += checker.is_fixed(*lm, keyfrm_id);
+    }
+    EXPECT_EQ(num_fixed, 6u);
+
+    // It stays fixed without the refresh
+    const optimize::landmark_convergence_checker checker_without_refresh(3, 5.0, 1e-3, 0);
+    for (unsigned int keyfrm_id = 0; keyfrm_id < 8; ++keyfrm_id) {
+        EXPECT_TRUE(checker_without_refresh.is_fixed(*lm, keyfrm_id));
+    }
+}
@@ -0,0 +1,55 @@
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/data/landmark_spatial_hash.h"
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+std::shared_ptr<data::landmark> create_landmark(const unsigned int id, const Vec3_t& pos_w) {
+    return std::make_shared<data::landmark>(id, 0, pos_w, nullptr, 1, 1);
+}
+
+TEST(landmark_spatial_hash, get_landmarks_in_sphere) {
+    data::landmark_spatial_hash lm_spatial_hash(0.1);
+    const auto lm_1 = create_landmark(1, Vec3_t{0.0, 0.0, 1.0});
+    const auto lm_2 = create_landmark(2, Vec3_t{0.05, 0.0, 1.0});
+    const auto lm_3 = create_landmark(3, Vec3_t{1.0, 0.0, 1.0});
+    lm_spatial_hash.insert(lm_1);
+    lm_spatial_hash.insert(lm_2);
+    lm_spatial_hash.insert(lm_3);
+    EXPECT_EQ(lm_spatial_hash.size(), 3);
+
+    // Across the cell boundary
+    const auto lms = lm_spatial_hash.get_landmarks_in_sphere(Vec3_t{0.01, 0.0, 1.0}, 0.06);
+    ASSERT_EQ(lms.size(), 2);
+    EXPECT_TRUE(std::find(lms.begin(), lms.end(), lm_1) != lms.end());
+    EXPECT_TRUE(std::find(lms.begin(), lms.end(), lm_2) != lms.end());
+
+    EXPECT_TRUE(lm_spatial_hash.get_landmarks_in_sphere(Vec3_t{0.5, 0.0, 1.0}, 0.1).empty());
+}
+
+TEST(landmark_spatial_hash, rehash_moved_landmark) {
+    data::landmark_spatial_hash lm_spatial_hash(0.1);
+    const auto lm = create_landmark(1, Vec3_t{0.0, 0.0, 1.0});
+    lm_spatial_hash.insert(lm);
+
+    lm->set_pos_in_world(Vec3_t{-0.55, 0.0, 1.0});
+    lm_spatial_hash.insert(lm);
+    EXPECT_EQ(lm_spatial_hash.size(), 1);
+
+    EXPECT_TRUE(lm_spatial_hash.get_landmarks_in_sphere(Vec3_t{0.0, 0.0, 1.0}, 0.05).empty());
+    EXPECT_EQ(lm_spatial_hash.get_landmarks_in_sphere(Vec3_t{-0.56, 0.0, 1.0}, 0.05).size(), 1);
+}
+
+TEST(landmark_spatial_hash, remove_expired_landmark) {
+    data::landmark_spatial_hash lm_spatial_hash(0.1);
+    {
+        const auto lm = create_landmark(1, Vec3_t{0.0, 0.0, 1.0});
+        lm_spatial_hash.insert(lm);
+    }
+    EXPECT_EQ(lm_spatial_hash.size(), 1);
+    EXPECT_TRUE(lm_spatial_hash.get_landmarks_in_sphere(Vec3_t{0.0, 0.0, 1.0}, 0.05).empty());
+    EXPECT_EQ(lm_spatial_hash.size(), 0);
+}
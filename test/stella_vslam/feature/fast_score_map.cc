@@ -0,0 +1,71 @@
+#include "stella_vslam/feature/fast_score_map.h"
+
+#include <algorithm>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <opencv2/features2d.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+cv::Mat create_random_image(const int cols, const int rows) {
+    cv::Mat img(rows, cols, CV_8UC1);
+    cv::RNG rng(1);
+    rng.fill(img, cv::RNG::UNIFORM, 0, 256);
+    return img;
+}
+
+void sort_keypoints(std::vector<cv::KeyPoint>& keypts) {
+    std::sort(keypts.begin(), keypts.end(), [](const cv::KeyPoint& a, const cv::KeyPoint& b) {
+        return (a.pt.y != b.pt.y) ? (a.pt.y < b.pt.y) : (a.pt.x < b.pt.x);
+    });
+}
+
+} // namespace
+
+TEST(fast_score_map, same_as_opencv_fast) {
+    const auto img = create_random_image(160, 120);
+
+    feature::fast_score_map score_map;
+    score_map.compute(img, cv::Rect(0, 0, img.cols, img.rows), 7);
+
+    for (const unsigned int thr : {7, 20, 40}) {
+        std::vector<cv::KeyPoint> keypts;
+        score_map.detect(cv::Rect(0, 0, img.cols, img.rows), thr, keypts);
+        std::vector<cv::KeyPoint> expected_keypts;
+        cv::FAST(img, expected_keypts, thr, true);
+
+        sort_keypoints(keypts);
+        sort_keypoints(expected_keypts);
+        ASSERT_EQ(keypts.size(), expected_keypts.size());
+        for (unsigned int i = 0; i < keypts.size(); ++i) {
+            EXPECT_EQ(keypts.at(i).pt, expected_keypts.at(i).pt);
+            EXPECT_FLOAT_EQ(keypts.at(i).response, expected_keypts.at(i).response);
+        }
+    }
+}
+
+TEST(fast_score_map, detect_in_region) {
+    auto img = cv::Mat(100, 100, CV_8UC1);
+    img = 255;
+    cv::rectangle(img, cv::Point2i(50, 50), cv::Point2i(99, 99), cv::Scalar(0), -1);
+
+    feature::fast_score_map score_map;
+    score_map.compute(img, cv::Rect(10, 10, 80, 80), 7);
+    EXPECT_EQ(score_map.get_score(5, 5), -1);
+
+    std::vector<cv::KeyPoint> keypts;
+    score_map.detect(cv::Rect(40, 40, 20, 20), 20, keypts);
+    ASSERT_FALSE(keypts.empty());
+    for (const auto& keypt : keypts) {
+        EXPECT_NEAR(keypt.pt.x, 50, 2.0);
+        EXPECT_NEAR(keypt.pt.y, 50, 2.0);
+    }
+
+    score_map.detect(cv::Rect(10, 10, 20, 20), 7, keypts);
+    EXPECT_TRUE(keypts.empty());
+}
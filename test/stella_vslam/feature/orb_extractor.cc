@@ -7,6 +7,8 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
 cv::Mat draw_lines(const cv::Mat& img, const unsigned int num_segments = 4) {
@@ -399,3 +401,71 @@ TEST(orb_extractor, extract_without_mask_4) {
     EXPECT_EQ(keypts.size(), desc.rows);
     EXPECT_EQ(desc.type(), CV_8U);
 }
+
+TEST(orb_extractor, extract_with_saturated_extraction_map) {
+    const auto params = feature::orb_params("ORB setting for test");
+    auto extractor = feature::orb_extractor(&params, 1000, feature::descriptor_type::ORB);
+
+    // image
+    const auto img = cv::imread(std::string(TEST_DATA_DIR) + "./equirectangular_image_001.jpg", cv::IMREAD_GRAYSCALE);
+    // mask (disabled)
+    const auto mask = cv::Mat();
+
+    std::vector<cv::KeyPoint> keypts;
+    cv::Mat desc;
+    extractor.extract(img, mask, keypts, desc);
+
+    // the whole image is covered by the landmarks
+    auto extraction_map = std::make_shared<feature::extraction_map>(img.cols, img.rows, 64, 1);
+    for (int y = 0; y < img.rows; y += 32) {
+        for (int x = 0; x < img.cols; x += 32) {
+            extraction_map->add_landmark(x, y);
+        }
+    }
+    EXPECT_FLOAT_EQ(extraction_map->get_coverage(img.cols / 2, img.rows / 2), 1.0);
+
+    std::vector<cv::KeyPoint> keypts_covered;
+    cv::Mat desc_covered;
+    extractor.set_extraction_map(extraction_map);
+    extractor.extract(img, mask, keypts_covered, desc_covered);
+
+    EXPECT_GT(keypts_covered.size(), 0);
+    EXPECT_LT(keypts_covered.size(), keypts.size());
+    EXPECT_EQ(keypts_covered.size(), desc_covered.rows);
+}
+
+TEST(orb_extractor, extract_more_in_uncovered_half_of_extraction_map) {
+    const auto params = feature::orb_params("ORB setting for test");
+    auto extractor = feature::orb_extractor(&params, 1000, feature::descriptor_type::ORB);
+
+    // image
+    const auto img = cv::imread(std::string(TEST_DATA_DIR) + "./equirectangular_image_001.jpg", cv::IMREAD_GRAYSCALE);
+    // mask (disabled)
+    const auto mask = cv::Mat();
+
+    // the left half of the image is covered by the landmarks
+    auto extraction_map = std::make_shared<feature::extraction_map>(img.cols, img.rows, 64, 1);
+    for (int y = 0; y < img.rows; y += 32) {
+        for (int x = 0; x < img.cols / 2; x += 32) {
+            extraction_map->add_landmark(x, y);
+        }
+    }
+    const auto count_in_right_half = [&img](const std::vector<cv::KeyPoint>& keypts) {
+        return std::count_if(keypts.begin(), keypts.end(), [&img](const cv::KeyPoint& keypt) {
+            return img.cols / 2 + 64 <= keypt.pt.x;
+        });
+    };
+
+    std::vector<cv::KeyPoint> keypts;
+    cv::Mat desc;
+    extractor.extract(img, mask, keypts, desc);
+
+    std::vector<cv::KeyPoint> keypts_covered;
+    cv::Mat desc_covered;
+    extractor.set_extraction_map(extraction_map);
+    extractor.extract(img, mask, keypts_covered, desc_covered);
+
+    // the budget freed in the left half is spent on the right half
+    EXPECT_GT(count_in_right_half(keypts_covered), count_in_right_half(keypts));
+    EXPECT_EQ(keypts_covered.size(), desc_covered.rows);
+}
@@ -0,0 +1,108 @@
+#include "stella_vslam/imu/imu_params.h"
+#include "stella_vslam/imu/initializer.h"
+#include "stella_vslam/imu/preintegrator.h"
+#include "stella_vslam/util/converter.h"
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+/**
+ * Keyframes of the body rotating at the constant angular velocity and changing the acceleration at each keyframe,
+ * in the world frame whose Z axis is not aligned with the gravity
+ */
+class initializer_test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rel_pose_bc_.block<3, 3>(0, 0) = Eigen::AngleAxisd(0.5 * M_PI, Vec3_t::UnitX()).toRotationMatrix();
+        rel_pose_bc_.block<3, 1>(0, 3) = Vec3_t{0.05, 0.0, 0.02};
+        params_ = std::make_shared<imu::imu_params>(200.0, 1.7e-4, 2.0e-3, 1.9e-5, 3.0e-3, rel_pose_bc_);
+
+        Vec3_t pos_w = Vec3_t::Zero();
+        Vec3_t vel_w{0.4, -0.2, 0.1};
+        for (unsigned int i = 0; i < num_keyfrms_; ++i) {
+            const double t = keyfrm_interval_ * i;
+            Mat44_t pose_wb = Mat44_t::Identity();
+            pose_wb.block<3, 3>(0, 0) = get_rot_wb(t);
+            pose_wb.block<3, 1>(0, 3) = pos_w;
+            cam_poses_cw_.push_back(util::converter::inverse_pose(pose_wb * rel_pose_bc_));
+            true_velocities_w_.push_back(vel_w);
+            if (i + 1 == num_keyfrms_) {
+                break;
+            }
+
+            // The acceleration is constant until the next keyframe
+            const Vec3_t acc_w{std::cos(1.3 * i), 0.5 * std::sin(0.7 * i), -0.8 * std::cos(0.9 * i)};
+            accs_w_.push_back(acc_w);
+
+            pos_w += vel_w * keyfrm_interval_ + 0.5 * acc_w * keyfrm_interval_ * keyfrm_interval_;
+            vel_w += acc_w * keyfrm_interval_;
+        }
+    }
+
+    //! Preintegrate the specific forces between the keyframes (multiplied by the scale factor of the accelerometer)
+    std::vector<std::shared_ptr<const imu::preintegrator>> create_preintegrations(const double acc_scale) const {
+        std::vector<std::shared_ptr<const imu::preintegrator>> preints;
+        for (unsigned int i = 0; i < accs_w_.size(); ++i) {
+            auto preint = std::make_shared<imu::preintegrator>(*params_, imu::bias());
+            const unsigned int num_steps = 60;
+            const double dt = keyfrm_interval_ / num_steps;
+            for (unsigned int step = 0; step < num_steps; ++step) {
+                const double t = keyfrm_interval_ * i + step * dt;
+                preint->integrate(acc_scale * get_rot_wb(t).transpose() * (accs_w_.at(i) - gravity_w_), gyr_, dt);
+            }
+            preints.push_back(preint);
+        }
+        return preints;
+    }
+
+    Mat33_t get_rot_wb(const double t) const {
+        return util::converter::to_rot_mat(gyr_ * t);
+    }
+
+    const unsigned int num_keyfrms_ = 10;
+    const double keyfrm_interval_ = 0.3;
+    const Vec3_t gyr_{0.2, -0.1, 0.4};
+    const Vec3_t gravity_w_ = imu::standard_gravity * Vec3_t{1.0, -3.0, -9.0}.normalized();
+    Mat44_t rel_pose_bc_ = Mat44_t::Identity();
+    std::shared_ptr<imu::imu_params> params_;
+    eigen_alloc_vector<Mat44_t> cam_poses_cw_;
+    eigen_alloc_vector<Vec3_t> true_velocities_w_;
+    eigen_alloc_vector<Vec3_t> accs_w_;
+};
+
+} // namespace
+
+TEST_F(initializer_test, estimate_gravity_and_velocities) {
+    Vec3_t gravity_w;
+    eigen_alloc_vector<Vec3_t> velocities_w;
+    ASSERT_TRUE(imu::estimate_gravity_and_velocities(*params_, cam_poses_cw_, create_preintegrations(1.0), imu::bias(), 0.1,
+                                                     gravity_w, velocities_w));
+    EXPECT_LT((gravity_w - gravity_w_).norm(), 1e-6);
+    ASSERT_EQ(velocities_w.size(), num_keyfrms_);
+    for (unsigned int i = 0; i < num_keyfrms_; ++i) {
+        EXPECT_LT((velocities_w.at(i) - true_velocities_w_.at(i)).norm(), 1e-6);
+    }
+}
+
+TEST_F(initializer_test, reject_inconsistent_gravity_norm) {
+    // e.g. the accelerometer is not in [m/s^2]
+    Vec3_t gravity_w;
+    eigen_alloc_vector<Vec3_t> velocities_w;
+    EXPECT_FALSE(imu::estimate_gravity_and_velocities(*params_, cam_poses_cw_, create_preintegrations(0.5), imu::bias(), 0.1,
+                                                      gravity_w, velocities_w));
+}
+
+TEST_F(initializer_test, reject_too_few_keyframes) {
+    const eigen_alloc_vector<Mat44_t> cam_poses_cw(cam_poses_cw_.begin(), cam_poses_cw_.begin() + 2);
+    const auto all_preints = create_preintegrations(1.0);
+    const std::vector<std::shared_ptr<const imu::preintegrator>> preints(all_preints.begin(), all_preints.begin() + 1);
+    Vec3_t gravity_w;
+    eigen_alloc_vector<Vec3_t> velocities_w;
+    EXPECT_FALSE(imu::estimate_gravity_and_velocities(*params_, cam_poses_cw, preints, imu::bias(), 0.1,
+                                                      gravity_w, velocities_w));
+}
@@ -0,0 +1,179 @@
+#include "stella_vslam/imu/imu_params.h"
+#include "stella_vslam/imu/preintegrator.h"
+#include "stella_vslam/util/converter.h"
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+imu::imu_params create_imu_params() {
+    return imu::imu_params(200.0, 1.7e-4, 2.0e-3, 1.9e-5, 3.0e-3, Mat44_t::Identity());
+}
+
+/**
+ * Body rotating at the constant angular velocity and moving at the constant acceleration in the world frame
+ * (the camera is mounted with the rotation and the offset)
+ */
+class trajectory {
+public:
+    trajectory()
+        : rel_pose_bc_(Mat44_t::Identity()) {
+        rel_pose_bc_.block<3, 3>(0, 0) = Eigen::AngleAxisd(0.5 * M_PI, Vec3_t::UnitX()).toRotationMatrix();
+        rel_pose_bc_.block<3, 1>(0, 3) = Vec3_t{0.05, 0.0, 0.02};
+    }
+
+    imu::imu_params create_imu_params() const {
+        return imu::imu_params(200.0, 1.7e-4, 2.0e-3, 1.9e-5, 3.0e-3, rel_pose_bc_);
+    }
+
+    Mat33_t get_rot_wb(const double t) const {
+        return rot_wb_0_ * util::converter::to_rot_mat(gyr_ * t);
+    }
+
+    Vec3_t get_vel_w(const double t) const {
+        return vel_w_0_ + acc_w_ * t;
+    }
+
+    Mat44_t get_cam_pose_cw(const double t) const {
+        Mat44_t pose_wb = Mat44_t::Identity();
+        pose_wb.block<3, 3>(0, 0) = get_rot_wb(t);
+        pose_wb.block<3, 1>(0, 3) = pos_w_0_ + vel_w_0_ * t + 0.5 * acc_w_ * t * t;
+        return util::converter::inverse_pose(pose_wb * rel_pose_bc_);
+    }
+
+    void integrate(imu::preintegrator& preint, const double t_begin, const unsigned int num_steps, const double dt) const {
+        for (unsigned int i = 0; i < num_steps; ++i) {
+            const double t = t_begin + i * dt;
+            // specific force in the body frame
+            const Vec3_t acc = get_rot_wb(t).transpose() * (acc_w_ - gravity_w_);
+            preint.integrate(acc, gyr_, dt);
+        }
+    }
+
+    Mat44_t rel_pose_bc_;
+    const Mat33_t rot_wb_0_ = Eigen::AngleAxisd(0.3, Vec3_t{1.0, -1.0, 0.5}.normalized()).toRotationMatrix();
+    const Vec3_t pos_w_0_{1.0, 2.0, -0.5};
+    const Vec3_t vel_w_0_{0.4, -0.2, 0.1};
+    const Vec3_t acc_w_{0.3, 0.1, -0.2};
+    const Vec3_t gyr_{0.2, -0.1, 0.4};
+    const Vec3_t gravity_w_{0.0, 0.0, -9.80665};
+};
+
+} // namespace
+
+TEST(preintegrator, constant_motion) {
+    const auto params = create_imu_params();
+    imu::preintegrator preint(params, imu::bias());
+
+    const Vec3_t acc{0.1, -0.2, 0.3};
+    const Vec3_t gyr{0.0, 0.0, 0.5};
+    for (unsigned int i = 0; i < 200; ++i) {
+        preint.integrate(acc, gyr, 0.005);
+    }
+
+    EXPECT_NEAR(preint.get_integration_time(), 1.0, 1e-9);
+    EXPECT_EQ(preint.get_num_measurements(), 200);
+
+    const Mat33_t delta_rot = preint.get_delta_rotation(imu::bias());
+    const Mat33_t expected_rot = Eigen::AngleAxisd(0.5, Vec3_t::UnitZ()).toRotationMatrix();
+    EXPECT_LT((delta_rot - expected_rot).norm(), 1e-6);
+
+    // The covariance grows with the integration
+    EXPECT_GT(preint.get_covariance().trace(), 0.0);
+}
+
+TEST(preintegrator, integrate_without_rotation) {
+    const auto params = create_imu_params();
+    imu::preintegrator preint(params, imu::bias());
+
+    const Vec3_t acc{1.0, 0.0, -2.0};
+    for (unsigned int i = 0; i < 100; ++i) {
+        preint.integrate(acc, Vec3_t::Zero(), 0.01);
+    }
+
+    EXPECT_LT((preint.get_delta_velocity(imu::bias()) - acc).norm(), 1e-9);
+    EXPECT_LT((preint.get_delta_position(imu::bias()) - 0.5 * acc).norm(), 1e-9);
+}
+
+TEST(preintegrator, first_order_bias_correction) {
+    const auto params = create_imu_params();
+    imu::bias perturbed_bias;
+    perturbed_bias.gyr_ = Vec3_t{0.002, -0.001, 0.003};
+    perturbed_bias.acc_ = Vec3_t{0.01, 0.02, -0.01};
+
+    imu::preintegrator preint(params, imu::bias());
+    imu::preintegrator preint_with_bias(params, perturbed_bias);
+    for (unsigned int i = 0; i < 40; ++i) {
+        const Vec3_t acc{0.3 * std::sin(0.1 * i), 9.8, 0.2};
+        const Vec3_t gyr{0.4, 0.2 * std::cos(0.1 * i), -0.3};
+        preint.integrate(acc, gyr, 0.005);
+        preint_with_bias.integrate(acc, gyr, 0.005);
+    }
+
+    const Mat33_t corrected_rot = preint.get_delta_rotation(perturbed_bias);
+    const Mat33_t actual_rot = preint_with_bias.get_delta_rotation(perturbed_bias);
+    EXPECT_LT((corrected_rot - actual_rot).norm(), 1e-6);
+    EXPECT_LT((preint.get_delta_velocity(perturbed_bias) - preint_with_bias.get_delta_velocity(perturbed_bias)).norm(), 1e-5);
+    EXPECT_LT((preint.get_delta_position(perturbed_bias) - preint_with_bias.get_delta_position(perturbed_bias)).norm(), 1e-6);
+}
+
+TEST(preintegrator, integrate_measurements_in_interval) {
+    const auto params = create_imu_params();
+    std::vector<imu::measurement, Eigen::aligned_allocator<imu::measurement>> measurements;
+    for (unsigned int i = 0; i <= 10; ++i) {
+        measurements.emplace_back(0.01 * i, Vec3_t::Zero(), Vec3_t{0.0, 1.0, 0.0});
+    }
+
+    imu::preintegrator preint(params, imu::bias());
+    preint.integrate(measurements, 0.025, 0.085);
+    EXPECT_NEAR(preint.get_integration_time(), 0.06, 1e-9);
+
+    const Mat33_t expected_rot = Eigen::AngleAxisd(0.06, Vec3_t::UnitY()).toRotationMatrix();
+    EXPECT_LT((preint.get_delta_rotation(imu::bias()) - expected_rot).norm(), 1e-9);
+}
+
+TEST(preintegrator, error_of_consistent_trajectory) {
+    const trajectory traj;
+    const auto params = traj.create_imu_params();
+    imu::preintegrator preint(params, imu::bias());
+    traj.integrate(preint, 0.0, 200, 0.005);
+
+    const Mat44_t cam_pose_cw_1 = traj.get_cam_pose_cw(0.0);
+    const Mat44_t cam_pose_cw_2 = traj.get_cam_pose_cw(1.0);
+    const Vec9_t error = preint.compute_error(cam_pose_cw_1, traj.get_vel_w(0.0), cam_pose_cw_2, traj.get_vel_w(1.0),
+                                              imu::bias(), traj.gravity_w_);
+    EXPECT_LT(error.norm(), 1e-6);
+    const Vec3_t rot_error = preint.compute_rotation_error(cam_pose_cw_1.block<3, 3>(0, 0), cam_pose_cw_2.block<3, 3>(0, 0),
+                                                           imu::bias());
+    EXPECT_LT(rot_error.norm(), 1e-6);
+
+    // The error of the velocity appears in the velocity and position residuals
+    const Vec3_t vel_offset{0.1, 0.0, 0.0};
+    const Vec9_t perturbed_error = preint.compute_error(cam_pose_cw_1, traj.get_vel_w(0.0), cam_pose_cw_2, traj.get_vel_w(1.0) + vel_offset,
+                                                        imu::bias(), traj.gravity_w_);
+    EXPECT_LT(perturbed_error.head<3>().norm(), 1e-6);
+    EXPECT_NEAR(perturbed_error.segment<3>(3).norm(), 0.1, 1e-6);
+    EXPECT_LT(perturbed_error.tail<3>().norm(), 1e-6);
+}
+
+TEST(preintegrator, rotation_error_of_gyroscope_bias) {
+    const trajectory traj;
+    const auto params = traj.create_imu_params();
+    imu::bias b;
+    b.gyr_ = Vec3_t{0.01, -0.02, 0.005};
+
+    // The measurements include the bias
+    imu::preintegrator preint(params, imu::bias());
+    for (unsigned int i = 0; i < 200; ++i) {
+        preint.integrate(Vec3_t::Zero(), traj.gyr_ + b.gyr_, 0.005);
+    }
+
+    const Mat33_t cam_rot_cw_1 = traj.get_cam_pose_cw(0.0).block<3, 3>(0, 0);
+    const Mat33_t cam_rot_cw_2 = traj.get_cam_pose_cw(1.0).block<3, 3>(0, 0);
+    EXPECT_GT(preint.compute_rotation_error(cam_rot_cw_1, cam_rot_cw_2, imu::bias()).norm(), 1e-2);
+    EXPECT_LT(preint.compute_rotation_error(cam_rot_cw_1, cam_rot_cw_2, b).norm(), 1e-4);
+}
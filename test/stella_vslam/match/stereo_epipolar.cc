@@ -0,0 +1,106 @@
+#include "stella_vslam/match/stereo_epipolar.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include <opencv2/core.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+constexpr float focal_length = 500.0;
+constexpr float true_baseline = 0.12;
+
+// unrectified stereo rig (the right camera is rotated and displaced also vertically)
+void create_stereo_rig(Mat33_t& rot_rl, Vec3_t& trans_rl) {
+    rot_rl = (Eigen::AngleAxisd(0.1, Vec3_t::UnitY()) * Eigen::AngleAxisd(-0.05, Vec3_t::UnitX())).toRotationMatrix();
+    const Vec3_t center_r_in_l = true_baseline * Vec3_t{1.0, 0.1, 0.02}.normalized();
+    trans_rl = -rot_rl * center_r_in_l;
+}
+
+} // namespace
+
+TEST(stereo_epipolar, match_and_triangulate) {
+    Mat33_t rot_rl;
+    Vec3_t trans_rl;
+    create_stereo_rig(rot_rl, trans_rl);
+
+    std::mt19937 mt(1234);
+    std::uniform_real_distribution<double> rand_xy(-1.0, 1.0);
+    std::uniform_real_distribution<double> rand_z(1.0, 5.0);
+
+    constexpr unsigned int num_points = 200;
+    eigen_alloc_vector<Vec3_t> points;
+    for (unsigned int i = 0; i < num_points; ++i) {
+        points.emplace_back(rand_xy(mt), rand_xy(mt), rand_z(mt));
+    }
+
+    // The right keypoints are stored in the shuffled order
+    std::vector<unsigned int> order(num_points);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), mt);
+
+    cv::Mat descs_left(num_points, 32, CV_8U);
+    cv::RNG rng(1234);
+    rng.fill(descs_left, cv::RNG::UNIFORM, 0, 256);
+    cv::Mat descs_right(num_points, 32, CV_8U);
+
+    std::vector<cv::KeyPoint> keypts_left, keypts_right(num_points);
+    eigen_alloc_vector<Vec3_t> bearings_left, bearings_right(num_points);
+    for (unsigned int i = 0; i < num_points; ++i) {
+        const Vec3_t& pos_l = points.at(i);
+        keypts_left.emplace_back(cv::Point2f(focal_length * pos_l(0) / pos_l(2) + 320.0, focal_length * pos_l(1) / pos_l(2) + 240.0), 31.0, -1, 0, 0);
+        bearings_left.push_back(pos_l.normalized());
+
+        const Vec3_t pos_r = rot_rl * pos_l + trans_rl;
+        const auto idx_right = order.at(i);
+        keypts_right.at(idx_right) = cv::KeyPoint(cv::Point2f(focal_length * pos_r(0) / pos_r(2) + 320.0, focal_length * pos_r(1) / pos_r(2) + 240.0), 31.0, -1, 0, 0);
+        bearings_right.at(idx_right) = pos_r.normalized();
+        descs_left.row(i).copyTo(descs_right.row(idx_right));
+    }
+
+    const std::vector<float> scale_factors{1.0, 1.2, 1.44};
+    const float focal_x_baseline = focal_length * true_baseline;
+    match::stereo_epipolar stereo_matcher(keypts_left, bearings_left, keypts_right, bearings_right,
+                                          descs_left, descs_right, scale_factors,
+                                          rot_rl, trans_rl, focal_x_baseline, true_baseline,
+                                          2.0 / focal_length);
+    std::vector<float> stereo_x_right, depths;
+    stereo_matcher.compute(stereo_x_right, depths);
+
+    ASSERT_EQ(depths.size(), num_points);
+    ASSERT_EQ(stereo_x_right.size(), num_points);
+    for (unsigned int i = 0; i < num_points; ++i) {
+        EXPECT_NEAR(depths.at(i), points.at(i)(2), 1e-3);
+        EXPECT_NEAR(stereo_x_right.at(i), keypts_left.at(i).pt.x - focal_x_baseline / points.at(i)(2), 1e-2);
+    }
+}
+
+TEST(stereo_epipolar, epipolar_angle_of_corresponding_bearings) {
+    Mat33_t rot_rl;
+    Vec3_t trans_rl;
+    create_stereo_rig(rot_rl, trans_rl);
+
+    const std::vector<cv::KeyPoint> keypts;
+    const eigen_alloc_vector<Vec3_t> bearings;
+    const cv::Mat descs;
+    const std::vector<float> scale_factors{1.0};
+    match::stereo_epipolar stereo_matcher(keypts, bearings, keypts, bearings, descs, descs, scale_factors,
+                                          rot_rl, trans_rl, focal_length * true_baseline, true_baseline, 2.0 / focal_length);
+
+    const Vec3_t pos_l{0.3, -0.2, 2.0};
+    const Vec3_t pos_r = rot_rl * pos_l + trans_rl;
+    EXPECT_NEAR(stereo_matcher.compute_epipolar_angle(pos_l.normalized()),
+                stereo_matcher.compute_epipolar_angle(rot_rl.transpose() * pos_r.normalized()), 1e-6);
+
+    float depth;
+    ASSERT_TRUE(stereo_matcher.triangulate_depth(pos_l.normalized(), pos_r.normalized(), depth));
+    EXPECT_NEAR(depth, pos_l(2), 1e-5);
+
+    // The rays diverge
+    EXPECT_FALSE(stereo_matcher.triangulate_depth(pos_l.normalized(), -pos_r.normalized(), depth));
+}
@@ -0,0 +1,100 @@
+#include "stella_vslam/feature/orb_extractor.h"
+#include "stella_vslam/feature/orb_params.h"
+#include "stella_vslam/match/stereo.h"
+#include "stella_vslam/match/stereo_patch_search.h"
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+// textured image and its copy shifted by the disparity
+void create_stereo_images(const int disparity, cv::Mat& left_img, cv::Mat& right_img) {
+    cv::RNG rng(1234);
+    cv::Mat noise(480, 640 + disparity, CV_8UC1);
+    rng.fill(noise, cv::RNG::UNIFORM, 0, 256);
+    cv::Mat textured;
+    cv::GaussianBlur(noise, textured, cv::Size(5, 5), 1.5);
+    left_img = textured.colRange(0, 640).clone();
+    right_img = textured.colRange(disparity, 640 + disparity).clone();
+}
+
+} // namespace
+
+TEST(stereo_patch_search, compute_disparity) {
+    constexpr int disparity = 23;
+    cv::Mat left_img, right_img;
+    create_stereo_images(disparity, left_img, right_img);
+
+    const auto params = feature::orb_params("ORB setting for test");
+    auto extractor_left = feature::orb_extractor(&params, 800);
+    auto extractor_right = feature::orb_extractor(&params, 800);
+
+    std::vector<cv::KeyPoint> keypts_left;
+    cv::Mat descs_left;
+    extractor_left.extract(left_img, cv::Mat(), keypts_left, descs_left);
+    extractor_right.compute_image_pyramid(right_img);
+    ASSERT_GT(keypts_left.size(), 100);
+
+    const float focal_x_baseline = 40.0;
+    const float true_baseline = 0.1;
+    match::stereo_patch_search stereo_matcher(extractor_left.image_pyramid_, extractor_right.image_pyramid_, keypts_left,
+                                              params.scale_factors_, params.inv_scale_factors_,
+                                              focal_x_baseline, true_baseline);
+    std::vector<float> stereo_x_right, depths;
+    stereo_matcher.compute(stereo_x_right, depths);
+
+    ASSERT_EQ(stereo_x_right.size(), keypts_left.size());
+    ASSERT_EQ(depths.size(), keypts_left.size());
+    unsigned int num_valid = 0;
+    for (unsigned int idx = 0; idx < keypts_left.size(); ++idx) {
+        if (depths.at(idx) <= 0.0) {
+            continue;
+        }
+        ++num_valid;
+        EXPECT_NEAR(keypts_left.at(idx).pt.x - stereo_x_right.at(idx), disparity, 1.0 * params.scale_factors_.at(keypts_left.at(idx).octave));
+        EXPECT_NEAR(depths.at(idx), focal_x_baseline / disparity, 0.1);
+    }
+    EXPECT_GT(num_valid, keypts_left.size() / 3);
+}
+
+TEST(stereo_patch_search, compare_with_descriptor_matching) {
+    constexpr int disparity = 40;
+    cv::Mat left_img, right_img;
+    create_stereo_images(disparity, left_img, right_img);
+
+    const auto params = feature::orb_params("ORB setting for test");
+    auto extractor_left = feature::orb_extractor(&params, 800);
+    auto extractor_right = feature::orb_extractor(&params, 800);
+
+    std::vector<cv::KeyPoint> keypts_left, keypts_right;
+    cv::Mat descs_left, descs_right;
+    extractor_left.extract(left_img, cv::Mat(), keypts_left, descs_left);
+    extractor_right.extract(right_img, cv::Mat(), keypts_right, descs_right);
+
+    const float focal_x_baseline = 40.0;
+    const float true_baseline = 0.1;
+    std::vector<float> stereo_x_right, depths;
+    match::stereo(extractor_left.image_pyramid_, extractor_right.image_pyramid_, keypts_left, keypts_right, descs_left, descs_right,
+                  params.scale_factors_, params.inv_scale_factors_, focal_x_baseline, true_baseline)
+        .compute(stereo_x_right, depths);
+    std::vector<float> stereo_x_right_patch, depths_patch;
+    match::stereo_patch_search(extractor_left.image_pyramid_, extractor_right.image_pyramid_, keypts_left,
+                               params.scale_factors_, params.inv_scale_factors_, focal_x_baseline, true_baseline)
+        .compute(stereo_x_right_patch, depths_patch);
+
+    // the both methods should agree on the keypoints matched by the both
+    unsigned int num_common = 0;
+    for (unsigned int idx = 0; idx < keypts_left.size(); ++idx) {
+        if (depths.at(idx) <= 0.0 || depths_patch.at(idx) <= 0.0) {
+            continue;
+        }
+        ++num_common;
+        EXPECT_NEAR(stereo_x_right.at(idx), stereo_x_right_patch.at(idx), 1.0 * params.scale_factors_.at(keypts_left.at(idx).octave));
+    }
+    EXPECT_GT(num_common, 0);
+}
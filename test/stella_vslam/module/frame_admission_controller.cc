@@ -0,0 +1,70 @@
+#include "stella_vslam/module/frame_admission_controller.h"
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+TEST(frame_admission_controller, admit_frames_in_real_time) {
+    module::frame_admission_controller controller(30.0, 100.0);
+    for (unsigned int i = 0; i < 100; ++i) {
+        const auto admission = controller.decide(i / 30.0, false, true);
+        EXPECT_EQ(admission, module::frame_admission_t::Admitted);
+        controller.report_processing_time(20.0);
+    }
+
+    const auto stats = controller.get_statistics();
+    EXPECT_EQ(stats.num_admitted_, 100);
+    EXPECT_DOUBLE_EQ(stats.latency_debt_ms_, 0.0);
+}
+
+TEST(frame_admission_controller, drop_frames_under_overload) {
+    module::frame_admission_controller controller(30.0, 100.0, 3);
+    unsigned int max_num_consecutive_drops = 0;
+    unsigned int num_consecutive_drops = 0;
+    for (unsigned int i = 0; i < 100; ++i) {
+        const auto admission = controller.decide(i / 30.0, false, true);
+        if (admission == module::frame_admission_t::Admitted) {
+            num_consecutive_drops = 0;
+            controller.report_processing_time(60.0);
+        }
+        else {
+            EXPECT_EQ(admission, module::frame_admission_t::DroppedLowMotion);
+            max_num_consecutive_drops = std::max(max_num_consecutive_drops, ++num_consecutive_drops);
+        }
+    }
+
+    const auto stats = controller.get_statistics();
+    EXPECT_GT(stats.num_dropped_low_motion_, 0);
+    EXPECT_EQ(stats.num_dropped_overload_, 0);
+    EXPECT_LE(max_num_consecutive_drops, 3);
+    // The latency stays bounded
+    EXPECT_LT(stats.latency_debt_ms_, 200.0);
+}
+
+TEST(frame_admission_controller, never_drop_keyframe_candidates) {
+    module::frame_admission_controller controller(30.0, 100.0);
+    for (unsigned int i = 0; i < 30; ++i) {
+        EXPECT_EQ(controller.decide(i / 30.0, true, true), module::frame_admission_t::Admitted);
+        controller.report_processing_time(100.0);
+    }
+    EXPECT_GT(controller.get_statistics().latency_debt_ms_, 100.0);
+
+    controller.reset();
+    EXPECT_EQ(controller.get_statistics().num_admitted_, 0);
+    EXPECT_DOUBLE_EQ(controller.get_statistics().latency_debt_ms_, 0.0);
+}
+
+TEST(frame_admission_controller, motion_is_small) {
+    module::frame_admission_controller controller(30.0, 100.0, 3, 0.5, 0.01);
+    Mat44_t twist = Mat44_t::Identity();
+    EXPECT_TRUE(controller.motion_is_small(twist));
+
+    twist.block<3, 1>(0, 3) = Vec3_t{0.0, 0.02, 0.0};
+    EXPECT_FALSE(controller.motion_is_small(twist));
+
+    twist = Mat44_t::Identity();
+    twist.block<3, 3>(0, 0) = Eigen::AngleAxisd(M_PI / 180.0, Vec3_t::UnitZ()).toRotationMatrix();
+    EXPECT_FALSE(controller.motion_is_small(twist));
+}
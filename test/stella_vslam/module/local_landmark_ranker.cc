@@ -0,0 +1,59 @@
+#include "stella_vslam/camera/perspective.h"
+#include "stella_vslam/data/frame.h"
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/feature/orb_params.h"
+#include "stella_vslam/module/local_landmark_ranker.h"
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+TEST(local_landmark_ranker, interleave_image_cells) {
+    camera::perspective camera("camera", camera::setup_type_t::Monocular, camera::color_order_t::Gray,
+                               640, 480, 30.0, 400.0, 400.0, 320.0, 240.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+    feature::orb_params orb_params("ORB setting for test");
+
+    data::frame_observation frm_obs;
+    frm_obs.undist_keypts_.resize(3);
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms;
+    for (unsigned int i = 0; i < 3; ++i) {
+        Mat44_t pose_cw = Mat44_t::Identity();
+        pose_cw(0, 3) = -0.1 * i;
+        keyfrms.push_back(data::keyframe::make_keyframe(i, 0.1 * i, pose_cw, &camera, &orb_params, frm_obs,
+                                                        data::bow_vector(), data::bow_feature_vector()));
+    }
+
+    // Landmark 0 is observed from all the keyframes, and the others from one keyframe
+    std::vector<std::shared_ptr<data::landmark>> lms;
+    for (unsigned int idx = 0; idx < 3; ++idx) {
+        lms.push_back(std::make_shared<data::landmark>(idx, Vec3_t{0.0, 0.0, 5.0}, keyfrms.at(0)));
+        lms.back()->connect_to_keyframe(keyfrms.at(0), idx);
+    }
+    lms.at(0)->connect_to_keyframe(keyfrms.at(1), 0);
+    lms.at(0)->connect_to_keyframe(keyfrms.at(2), 0);
+    for (const auto& lm : lms) {
+        lm->update_mean_normal_and_obs_scale_variance();
+    }
+
+    data::frame frm(0, 0.0, &camera, &orb_params, data::frame_observation(), {});
+    frm.set_pose_cw(Mat44_t::Identity());
+    EXPECT_GT(module::local_landmark_ranker::compute_utility(*lms.at(0), frm.get_trans_wc()),
+              module::local_landmark_ranker::compute_utility(*lms.at(1), frm.get_trans_wc()));
+
+    // Landmarks 0 and 1 are projected onto the left half, and landmark 2 onto the right half
+    eigen_alloc_unord_map<unsigned int, Vec2_t> lm_to_reproj;
+    lm_to_reproj[0] = Vec2_t{100.0, 240.0};
+    lm_to_reproj[1] = Vec2_t{150.0, 240.0};
+    lm_to_reproj[2] = Vec2_t{500.0, 240.0};
+
+    const module::local_landmark_ranker ranker(100, 2, 1);
+    EXPECT_TRUE(ranker.is_enabled());
+    const auto ranked_lms = ranker.rank(frm, lms, lm_to_reproj);
+
+    // The best one of each cell comes before the second best ones
+    ASSERT_EQ(ranked_lms.size(), 3);
+    EXPECT_EQ(ranked_lms.at(0)->id_, 0);
+    EXPECT_EQ(ranked_lms.at(1)->id_, 2);
+    EXPECT_EQ(ranked_lms.at(2)->id_, 1);
+}
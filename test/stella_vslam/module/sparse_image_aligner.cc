@@ -0,0 +1,122 @@
+#include "stella_vslam/camera/perspective.h"
+#include "stella_vslam/data/frame.h"
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/feature/orb_params.h"
+#include "stella_vslam/module/sparse_image_aligner.h"
+
+#include <cmath>
+
+#include <opencv2/core/core.hpp>
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+constexpr double plane_depth = 5.0;
+constexpr unsigned int num_levels = 4;
+
+//! Smooth texture painted on the fronto-parallel plane, parameterized by the pixel coordinates of the reference camera
+double texture(const double u, const double v) {
+    return 128.0 + 50.0 * std::sin(u / 9.0) * std::sin(v / 11.0) + 30.0 * std::cos((u + 2.0 * v) / 17.0);
+}
+
+//! Render the plane (Z = plane_depth in the world) seen from pose_cw, as an image pyramid
+std::vector<cv::Mat> render_pyramid(const camera::perspective& camera, const feature::orb_params& orb_params,
+                                    const Mat44_t& pose_cw, const unsigned int num_levels) {
+    const Mat33_t rot_wc = pose_cw.block<3, 3>(0, 0).transpose();
+    const Vec3_t trans_wc = -rot_wc * pose_cw.block<3, 1>(0, 3);
+
+    std::vector<cv::Mat> pyramid;
+    for (unsigned int level = 0; level < num_levels; ++level) {
+        const double scale_factor = orb_params.scale_factors_.at(level);
+        const int cols = std::round(camera.cols_ / scale_factor);
+        const int rows = std::round(camera.rows_ / scale_factor);
+        cv::Mat img(rows, cols, CV_8UC1);
+        for (int y = 0; y < rows; ++y) {
+            for (int x = 0; x < cols; ++x) {
+                // cast the ray of the pixel onto the plane
+                const Vec3_t ray_c{(x * scale_factor - camera.cx_) / camera.fx_, (y * scale_factor - camera.cy_) / camera.fy_, 1.0};
+                const Vec3_t ray_w = rot_wc * ray_c;
+                const Vec3_t pos_w = trans_wc + (plane_depth - trans_wc(2)) / ray_w(2) * ray_w;
+                const double u = camera.fx_ * pos_w(0) / plane_depth + camera.cx_;
+                const double v = camera.fy_ * pos_w(1) / plane_depth + camera.cy_;
+                img.at<unsigned char>(y, x) = cv::saturate_cast<unsigned char>(texture(u, v));
+            }
+        }
+        pyramid.push_back(img);
+    }
+    return pyramid;
+}
+
+} // namespace
+
+class sparse_image_aligner_test : public ::testing::Test {
+protected:
+    sparse_image_aligner_test()
+        : camera_("camera", camera::setup_type_t::Monocular, camera::color_order_t::Gray,
+                  640, 480, 30.0, 400.0, 400.0, 320.0, 240.0, 0.0, 0.0, 0.0, 0.0, 0.0),
+          orb_params_("ORB setting for test") {}
+
+    void SetUp() override {
+        // keypoints on a grid, whose landmarks lie on the plane
+        data::frame_observation frm_obs;
+        std::vector<cv::KeyPoint> keypts;
+        for (int v = 80; v <= 400; v += 40) {
+            for (int u = 80; u <= 560; u += 40) {
+                keypts.emplace_back(cv::Point2f(u, v), 31.0);
+            }
+        }
+        frm_obs.undist_keypts_ = keypts;
+
+        ref_keyfrm_ = data::keyframe::make_keyframe(0, 0.0, Mat44_t::Identity(), &camera_, &orb_params_, data::frame_observation(),
+                                                    data::bow_vector(), data::bow_feature_vector());
+
+        last_frm_ = stella_vslam::make_unique<data::frame>(0, 0.0, &camera_, &orb_params_, frm_obs, std::unordered_map<unsigned int, data::marker2d>{});
+        last_frm_->set_image_pyramid(render_pyramid(camera_, orb_params_, Mat44_t::Identity(), num_levels),
+                                     std::make_shared<const std::vector<cv::KeyPoint>>(keypts));
+        for (unsigned int idx = 0; idx < keypts.size(); ++idx) {
+            const Vec3_t pos_w{(keypts.at(idx).pt.x - camera_.cx_) / camera_.fx_ * plane_depth,
+                               (keypts.at(idx).pt.y - camera_.cy_) / camera_.fy_ * plane_depth,
+                               plane_depth};
+            last_frm_->add_landmark(std::make_shared<data::landmark>(idx, pos_w, ref_keyfrm_), idx);
+        }
+        last_frm_->set_pose_cw(Mat44_t::Identity());
+    }
+
+    camera::perspective camera_;
+    feature::orb_params orb_params_;
+    std::shared_ptr<data::keyframe> ref_keyfrm_;
+    std::unique_ptr<data::frame> last_frm_;
+};
+
+TEST_F(sparse_image_aligner_test, recover_small_pose_offset) {
+    // true motion from the last frame to the current frame
+    Mat44_t true_velocity = Mat44_t::Identity();
+    true_velocity.block<3, 3>(0, 0) = Eigen::AngleAxisd(0.005, Vec3_t::UnitY()).toRotationMatrix();
+    true_velocity.block<3, 1>(0, 3) = Vec3_t{0.03, -0.02, 0.04};
+
+    data::frame curr_frm(1, 0.1, &camera_, &orb_params_, data::frame_observation(), {});
+    curr_frm.set_image_pyramid(render_pyramid(camera_, orb_params_, true_velocity * last_frm_->get_pose_cw(), num_levels),
+                               std::make_shared<const std::vector<cv::KeyPoint>>());
+
+    const module::sparse_image_aligner aligner(&camera_, num_levels - 1, 0, 30, 20, 15.0);
+    Mat44_t velocity = Mat44_t::Identity();
+    ASSERT_TRUE(aligner.align(curr_frm, *last_frm_, velocity));
+
+    const Mat44_t error = velocity * true_velocity.inverse();
+    EXPECT_LT(error.block<3, 1>(0, 3).norm(), 0.01);
+    EXPECT_LT(Eigen::AngleAxisd(Mat33_t(error.block<3, 3>(0, 0))).angle(), 0.002);
+}
+
+TEST_F(sparse_image_aligner_test, reject_last_frame_without_pose) {
+    data::frame curr_frm(1, 0.1, &camera_, &orb_params_, data::frame_observation(), {});
+    curr_frm.set_image_pyramid(last_frm_->get_image_pyramid(), std::make_shared<const std::vector<cv::KeyPoint>>());
+    last_frm_->invalidate_pose();
+
+    const module::sparse_image_aligner aligner(&camera_, num_levels - 1, 0, 30, 20, 15.0);
+    Mat44_t velocity = Mat44_t::Identity();
+    EXPECT_FALSE(aligner.align(curr_frm, *last_frm_, velocity));
+    EXPECT_TRUE(velocity.isApprox(Mat44_t::Identity()));
+}
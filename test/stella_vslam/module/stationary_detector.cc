@@ -0,0 +1,63 @@
+#include "stella_vslam/module/stationary_detector.h"
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+cv::Mat create_image(const int offset_x) {
+    cv::Mat img(480, 640, CV_8UC1, cv::Scalar(64));
+    cv::rectangle(img, cv::Rect(200 + offset_x, 150, 120, 100), cv::Scalar(200), -1);
+    return img;
+}
+
+} // namespace
+
+TEST(stationary_detector, skip_unchanged_frames) {
+    module::stationary_detector detector(8, 2.0, 100, false);
+    const auto img = create_image(0);
+
+    // The first frame is always processed
+    EXPECT_FALSE(detector.is_stationary(img, camera::color_order_t::Gray, true));
+    for (unsigned int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(detector.is_stationary(img, camera::color_order_t::Gray, true));
+    }
+    EXPECT_EQ(detector.get_num_skipped_frames(), 10);
+
+    // Process the frame as soon as the scene changes
+    EXPECT_FALSE(detector.is_stationary(create_image(40), camera::color_order_t::Gray, true));
+    // The frame cannot be skipped if the tracker cannot reuse the pose
+    EXPECT_FALSE(detector.is_stationary(create_image(40), camera::color_order_t::Gray, false));
+}
+
+TEST(stationary_detector, bound_consecutive_skips) {
+    module::stationary_detector detector(8, 2.0, 3, false);
+    const auto img = create_image(0);
+
+    EXPECT_FALSE(detector.is_stationary(img, camera::color_order_t::Gray, true));
+    for (unsigned int i = 0; i < 3; ++i) {
+        for (unsigned int j = 0; j < 3; ++j) {
+            EXPECT_TRUE(detector.is_stationary(img, camera::color_order_t::Gray, true));
+        }
+        EXPECT_FALSE(detector.is_stationary(img, camera::color_order_t::Gray, true));
+    }
+}
+
+TEST(stationary_detector, confirm_with_motion_prior) {
+    module::stationary_detector detector(8, 2.0, 100, true, 0.1, 0.002);
+    const auto img = create_image(0);
+    EXPECT_FALSE(detector.is_stationary(img, camera::color_order_t::Gray, true));
+
+    // Without the motion model
+    EXPECT_FALSE(detector.is_stationary(img, camera::color_order_t::Gray, true, nullptr));
+
+    Mat44_t twist = Mat44_t::Identity();
+    EXPECT_TRUE(detector.is_stationary(img, camera::color_order_t::Gray, true, &twist));
+
+    twist.block<3, 1>(0, 3) = Vec3_t{0.05, 0.0, 0.0};
+    EXPECT_FALSE(detector.is_stationary(img, camera::color_order_t::Gray, true, &twist));
+}
@@ -0,0 +1,191 @@
+#include "stella_vslam/camera/perspective.h"
+#include "stella_vslam/data/graph_node.h"
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/feature/orb_params.h"
+#include "stella_vslam/optimize/global_bundle_adjuster.h"
+#include "stella_vslam/optimize/hierarchical_bundle_adjuster.h"
+
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+constexpr unsigned int num_keyfrms = 18;
+constexpr unsigned int num_cols = 400;
+
+/**
+ * Keyframes on a line along the X axis, looking at the landmarks on the walls at about 5 m
+ * Each keyframe observes the landmarks within 1.5 m in X, so it is covisible with the two neighbors on each side.
+ */
+class hierarchical_bundle_adjuster_test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (unsigned int col = 0; col < num_cols; ++col) {
+            for (unsigned int row = 0; row < 3; ++row) {
+                const double depth = 4.5 + 0.25 * ((7 * col + row) % 5);
+                true_lms_pos_w_.emplace_back(-1.475 + 0.05 * col, -1.0 + row, depth);
+            }
+        }
+
+        for (unsigned int id = 0; id < num_keyfrms; ++id) {
+            const Vec3_t trans_wc{1.0 * id, 0.0, 0.0};
+            Mat44_t pose_cw = Mat44_t::Identity();
+            pose_cw.block<3, 1>(0, 3) = -trans_wc;
+            true_poses_cw_.push_back(pose_cw);
+
+            data::frame_observation frm_obs;
+            std::vector<unsigned int> lm_indices;
+            for (unsigned int lm_idx = 0; lm_idx < true_lms_pos_w_.size(); ++lm_idx) {
+                const Vec3_t& pos_w = true_lms_pos_w_.at(lm_idx);
+                if (1.5 <= std::abs(pos_w(0) - trans_wc(0))) {
+                    continue;
+                }
+                const Vec2_t reproj = project(pose_cw, pos_w);
+                frm_obs.undist_keypts_.emplace_back(reproj(0), reproj(1), 31.0);
+                lm_indices.push_back(lm_idx);
+            }
+            keyfrms_.push_back(data::keyframe::make_keyframe(id, 0.1 * id, pose_cw, &camera_, &orb_params_, frm_obs,
+                                                             data::bow_vector(), data::bow_feature_vector()));
+            lm_indices_of_keyfrms_.push_back(lm_indices);
+        }
+
+        lms_.resize(true_lms_pos_w_.size());
+        for (unsigned int keyfrm_idx = 0; keyfrm_idx < num_keyfrms; ++keyfrm_idx) {
+            const auto& keyfrm = keyfrms_.at(keyfrm_idx);
+            const auto& lm_indices = lm_indices_of_keyfrms_.at(keyfrm_idx);
+            for (unsigned int idx = 0; idx < lm_indices.size(); ++idx) {
+                auto& lm = lms_.at(lm_indices.at(idx));
+                if (!lm) {
+                    lm = std::make_shared<data::landmark>(lm_indices.at(idx), true_lms_pos_w_.at(lm_indices.at(idx)), keyfrm);
+                }
+                lm->connect_to_keyframe(keyfrm, idx);
+            }
+            if (keyfrm_idx == 0) {
+                keyfrm->graph_node_->set_spanning_root(keyfrms_.front());
+            }
+            else {
+                keyfrm->graph_node_->set_spanning_parent(keyfrms_.at(keyfrm_idx - 1));
+            }
+        }
+        for (const auto& keyfrm : keyfrms_) {
+            keyfrm->graph_node_->update_connections(15);
+        }
+    }
+
+    Vec2_t project(const Mat44_t& pose_cw, const Vec3_t& pos_w) const {
+        const Vec3_t pos_c = pose_cw.block<3, 3>(0, 0) * pos_w + pose_cw.block<3, 1>(0, 3);
+        return Vec2_t{camera_.fx_ * pos_c(0) / pos_c(2) + camera_.cx_, camera_.fy_ * pos_c(1) / pos_c(2) + camera_.cy_};
+    }
+
+    //! RMS reprojection error of the estimates
+    double compute_rms_error(const eigen_alloc_unord_map<unsigned int, Mat44_t>& keyfrm_to_pose_cw,
+                             const eigen_alloc_unord_map<unsigned int, Vec3_t>& lm_to_pos_w) const {
+        double sum_sq_error = 0.0;
+        unsigned int num_obs = 0;
+        for (unsigned int keyfrm_idx = 0; keyfrm_idx < num_keyfrms; ++keyfrm_idx) {
+            const auto& keyfrm = keyfrms_.at(keyfrm_idx);
+            const auto& lm_indices = lm_indices_of_keyfrms_.at(keyfrm_idx);
+            for (unsigned int idx = 0; idx < lm_indices.size(); ++idx) {
+                const auto& keypt = keyfrm->frm_obs_->undist_keypts_.at(idx).pt;
+                const Vec2_t reproj = project(keyfrm_to_pose_cw.at(keyfrm->id_), lm_to_pos_w.at(lm_indices.at(idx)));
+                sum_sq_error += (reproj - Vec2_t{keypt.x, keypt.y}).squaredNorm();
+                ++num_obs;
+            }
+        }
+        return std::sqrt(sum_sq_error / num_obs);
+    }
+
+    //! Perturb the poses (except the root) and the landmark positions
+    void perturb() {
+        std::mt19937 random_engine(42);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (unsigned int keyfrm_idx = 1; keyfrm_idx < num_keyfrms; ++keyfrm_idx) {
+            Mat44_t delta = Mat44_t::Identity();
+            const Vec3_t axis{dist(random_engine), dist(random_engine), dist(random_engine)};
+            delta.block<3, 3>(0, 0) = Eigen::AngleAxisd(0.003, axis.normalized()).toRotationMatrix();
+            delta.block<3, 1>(0, 3) = 0.02 * Vec3_t{dist(random_engine), dist(random_engine), dist(random_engine)};
+            keyfrms_.at(keyfrm_idx)->set_pose_cw(delta * true_poses_cw_.at(keyfrm_idx));
+        }
+        for (const auto& lm : lms_) {
+            lm->set_pos_in_world(true_lms_pos_w_.at(lm->id_) + 0.02 * Vec3_t{dist(random_engine), dist(random_engine), dist(random_engine)});
+        }
+    }
+
+    camera::perspective camera_{"camera", camera::setup_type_t::Monocular, camera::color_order_t::Gray,
+                                640, 480, 30.0, 400.0, 400.0, 320.0, 240.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    feature::orb_params orb_params_{"ORB setting for test"};
+    eigen_alloc_vector<Mat44_t> true_poses_cw_;
+    eigen_alloc_vector<Vec3_t> true_lms_pos_w_;
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms_;
+    std::vector<std::shared_ptr<data::landmark>> lms_;
+    std::vector<std::vector<unsigned int>> lm_indices_of_keyfrms_;
+};
+
+} // namespace
+
+TEST_F(hierarchical_bundle_adjuster_test, partition_along_covisibility_graph) {
+    const optimize::hierarchical_bundle_adjuster hierarchical_BA(6);
+    const auto submaps = hierarchical_BA.partition(keyfrms_);
+
+    // Each submap is grown from the oldest unassigned keyframe along the chain
+    ASSERT_EQ(submaps.size(), 3);
+    std::unordered_set<unsigned int> assigned_keyfrm_ids;
+    for (unsigned int submap_idx = 0; submap_idx < submaps.size(); ++submap_idx) {
+        ASSERT_EQ(submaps.at(submap_idx).size(), 6);
+        for (const auto& keyfrm : submaps.at(submap_idx)) {
+            EXPECT_EQ(keyfrm->id_ / 6, submap_idx);
+            EXPECT_TRUE(assigned_keyfrm_ids.insert(keyfrm->id_).second);
+        }
+    }
+}
+
+TEST_F(hierarchical_bundle_adjuster_test, partition_into_single_submap) {
+    const optimize::hierarchical_bundle_adjuster hierarchical_BA(100);
+    const auto submaps = hierarchical_BA.partition(keyfrms_);
+    ASSERT_EQ(submaps.size(), 1);
+    EXPECT_EQ(submaps.front().size(), num_keyfrms);
+}
+
+TEST_F(hierarchical_bundle_adjuster_test, converge_as_global_BA) {
+    perturb();
+
+    eigen_alloc_unord_map<unsigned int, Mat44_t> initial_keyfrm_to_pose_cw;
+    eigen_alloc_unord_map<unsigned int, Vec3_t> initial_lm_to_pos_w;
+    for (const auto& keyfrm : keyfrms_) {
+        initial_keyfrm_to_pose_cw[keyfrm->id_] = keyfrm->get_pose_cw();
+    }
+    for (const auto& lm : lms_) {
+        initial_lm_to_pos_w[lm->id_] = lm->get_pos_in_world();
+    }
+    const double initial_rms_error = compute_rms_error(initial_keyfrm_to_pose_cw, initial_lm_to_pos_w);
+
+    std::unordered_set<unsigned int> optimized_keyfrm_ids, optimized_lm_ids, optimized_marker_ids;
+    eigen_alloc_unord_map<unsigned int, Vec3_t> lm_to_pos_w;
+    eigen_alloc_unord_map<unsigned int, Mat44_t> keyfrm_to_pose_cw;
+    eigen_alloc_unord_map<unsigned int, std::array<Vec3_t, 4>> marker_to_pos_w;
+    const optimize::global_bundle_adjuster global_BA(10, false);
+    ASSERT_TRUE(global_BA.optimize(keyfrms_, optimized_keyfrm_ids, optimized_lm_ids, optimized_marker_ids,
+                                   lm_to_pos_w, keyfrm_to_pose_cw, marker_to_pos_w));
+    const double global_rms_error = compute_rms_error(keyfrm_to_pose_cw, lm_to_pos_w);
+
+    optimized_keyfrm_ids.clear();
+    optimized_lm_ids.clear();
+    lm_to_pos_w.clear();
+    keyfrm_to_pose_cw.clear();
+    const optimize::hierarchical_bundle_adjuster hierarchical_BA(6, 10, false);
+    ASSERT_TRUE(hierarchical_BA.optimize(keyfrms_, optimized_keyfrm_ids, optimized_lm_ids, optimized_marker_ids,
+                                         lm_to_pos_w, keyfrm_to_pose_cw, marker_to_pos_w));
+    EXPECT_EQ(optimized_keyfrm_ids.size(), num_keyfrms);
+    EXPECT_EQ(optimized_lm_ids.size(), lms_.size());
+    const double hierarchical_rms_error = compute_rms_error(keyfrm_to_pose_cw, lm_to_pos_w);
+
+    // The perturbation is a few pixels, and both reach the noise-free optimum closely
+    EXPECT_GT(initial_rms_error, 1.0);
+    EXPECT_LT(global_rms_error, 0.1);
+    EXPECT_LT(hierarchical_rms_error, 0.1);
+}
@@ -0,0 +1,43 @@
+#include "stella_vslam/optimize/local_window_selector.h"
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+TEST(local_window_selector, select_all_by_default) {
+    const optimize::local_window_selector selector;
+    EXPECT_FALSE(selector.is_enabled());
+
+    const auto local_ids = selector.select_local_keyframes({{1, 10}, {2, 30}, {3, 20}});
+    EXPECT_EQ(local_ids.size(), 3);
+
+    const std::unordered_map<unsigned int, std::vector<unsigned int>> lm_ids_of_candidates{{4, {0, 1}}, {5, {0}}};
+    EXPECT_EQ(selector.select_fixed_keyframes(lm_ids_of_candidates, {{0, 5}, {1, 5}}).size(), 2);
+}
+
+TEST(local_window_selector, select_local_keyframes_by_shared_observations) {
+    const optimize::local_window_selector selector(3, 0, 0);
+    const auto local_ids = selector.select_local_keyframes({{1, 10}, {2, 30}, {3, 20}, {4, 20}});
+    // The current keyframe is counted in the max number, and the newer one is kept if tied
+    ASSERT_EQ(local_ids.size(), 2);
+    EXPECT_EQ(local_ids.at(0), 2);
+    EXPECT_EQ(local_ids.at(1), 4);
+}
+
+TEST(local_window_selector, skip_redundant_fixed_keyframes) {
+    const optimize::local_window_selector selector(0, 2, 2);
+    const std::unordered_map<unsigned int, std::vector<unsigned int>> lm_ids_of_candidates{
+        {10, {0, 1, 2}},
+        {11, {0, 1}},
+        {12, {3}},
+        {13, {2}}};
+    // Landmarks 0 and 1 are observed by the local keyframes once, 2 and 3 never
+    const auto fixed_ids = selector.select_fixed_keyframes(lm_ids_of_candidates, {{0, 1}, {1, 1}});
+
+    // Keyframe 11 is redundant after keyframe 10 is selected, and the number is capped
+    ASSERT_EQ(fixed_ids.size(), 2);
+    EXPECT_EQ(fixed_ids.at(0), 10);
+    EXPECT_TRUE(std::find(fixed_ids.begin(), fixed_ids.end(), 11) == fixed_ids.end());
+}
@@ -0,0 +1,157 @@
+#include "stella_vslam/camera/perspective.h"
+#include "stella_vslam/data/graph_node.h"
+#include "stella_vslam/data/keyframe.h"
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/feature/orb_params.h"
+#include "stella_vslam/optimize/pose_graph_refiner.h"
+
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+constexpr unsigned int num_keyfrms = 12;
+constexpr unsigned int num_cols = 280;
+
+/**
+ * Keyframes on a line along the X axis, looking at the landmarks on the walls at about 5 m
+ * Each keyframe observes the landmarks within 1.5 m in X, so it is covisible with the two neighbors on each side.
+ */
+class pose_graph_refiner_test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (unsigned int col = 0; col < num_cols; ++col) {
+            for (unsigned int row = 0; row < 3; ++row) {
+                const double depth = 4.5 + 0.25 * ((7 * col + row) % 5);
+                true_lms_pos_w_.emplace_back(-1.475 + 0.05 * col, -1.0 + row, depth);
+            }
+        }
+
+        for (unsigned int id = 0; id < num_keyfrms; ++id) {
+            const Vec3_t trans_wc{1.0 * id, 0.0, 0.0};
+            Mat44_t pose_cw = Mat44_t::Identity();
+            pose_cw.block<3, 1>(0, 3) = -trans_wc;
+            true_poses_cw_.push_back(pose_cw);
+
+            data::frame_observation frm_obs;
+            std::vector<unsigned int> lm_indices;
+            for (unsigned int lm_idx = 0; lm_idx < true_lms_pos_w_.size(); ++lm_idx) {
+                const Vec3_t& pos_w = true_lms_pos_w_.at(lm_idx);
+                if (1.5 <= std::abs(pos_w(0) - trans_wc(0))) {
+                    continue;
+                }
+                const Vec2_t reproj = project(pose_cw, pos_w);
+                frm_obs.undist_keypts_.emplace_back(reproj(0), reproj(1), 31.0);
+                lm_indices.push_back(lm_idx);
+            }
+            keyfrms_.push_back(data::keyframe::make_keyframe(id, 0.1 * id, pose_cw, &camera_, &orb_params_, frm_obs,
+                                                             data::bow_vector(), data::bow_feature_vector()));
+            lm_indices_of_keyfrms_.push_back(lm_indices);
+        }
+
+        lms_.resize(true_lms_pos_w_.size());
+        for (unsigned int keyfrm_idx = 0; keyfrm_idx < num_keyfrms; ++keyfrm_idx) {
+            const auto& keyfrm = keyfrms_.at(keyfrm_idx);
+            const auto& lm_indices = lm_indices_of_keyfrms_.at(keyfrm_idx);
+            for (unsigned int idx = 0; idx < lm_indices.size(); ++idx) {
+                auto& lm = lms_.at(lm_indices.at(idx));
+                if (!lm) {
+                    lm = std::make_shared<data::landmark>(lm_indices.at(idx), true_lms_pos_w_.at(lm_indices.at(idx)), keyfrm);
+                }
+                lm->connect_to_keyframe(keyfrm, idx);
+            }
+            if (keyfrm_idx == 0) {
+                keyfrm->graph_node_->set_spanning_root(keyfrms_.front());
+            }
+            else {
+                keyfrm->graph_node_->set_spanning_parent(keyfrms_.at(keyfrm_idx - 1));
+            }
+        }
+        for (const auto& keyfrm : keyfrms_) {
+            keyfrm->graph_node_->update_connections(15);
+        }
+    }
+
+    Vec2_t project(const Mat44_t& pose_cw, const Vec3_t& pos_w) const {
+        const Vec3_t pos_c = pose_cw.block<3, 3>(0, 0) * pos_w + pose_cw.block<3, 1>(0, 3);
+        return Vec2_t{camera_.fx_ * pos_c(0) / pos_c(2) + camera_.cx_, camera_.fy_ * pos_c(1) / pos_c(2) + camera_.cy_};
+    }
+
+    //! Perturb the poses except the root, as a loop correction leaves them inconsistent with the landmarks
+    void perturb() {
+        std::mt19937 random_engine(42);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (unsigned int keyfrm_idx = 1; keyfrm_idx < num_keyfrms; ++keyfrm_idx) {
+            Mat44_t delta = Mat44_t::Identity();
+            const Vec3_t axis{dist(random_engine), dist(random_engine), dist(random_engine)};
+            delta.block<3, 3>(0, 0) = Eigen::AngleAxisd(0.003, axis.normalized()).toRotationMatrix();
+            delta.block<3, 1>(0, 3) = 0.02 * Vec3_t{dist(random_engine), dist(random_engine), dist(random_engine)};
+            keyfrms_.at(keyfrm_idx)->set_pose_cw(delta * true_poses_cw_.at(keyfrm_idx));
+        }
+    }
+
+    //! Max translation and rotation errors of the poses
+    void compute_max_errors(const eigen_alloc_unord_map<unsigned int, Mat44_t>& keyfrm_to_pose_cw,
+                            double& max_trans_error, double& max_rot_error) const {
+        max_trans_error = 0.0;
+        max_rot_error = 0.0;
+        for (unsigned int keyfrm_idx = 0; keyfrm_idx < num_keyfrms; ++keyfrm_idx) {
+            const Mat44_t error = keyfrm_to_pose_cw.at(keyfrms_.at(keyfrm_idx)->id_) * true_poses_cw_.at(keyfrm_idx).inverse();
+            max_trans_error = std::max(max_trans_error, error.block<3, 1>(0, 3).norm());
+            max_rot_error = std::max(max_rot_error, Eigen::AngleAxisd(Mat33_t(error.block<3, 3>(0, 0))).angle());
+        }
+    }
+
+    camera::perspective camera_{"camera", camera::setup_type_t::Monocular, camera::color_order_t::Gray,
+                                640, 480, 30.0, 400.0, 400.0, 320.0, 240.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    feature::orb_params orb_params_{"ORB setting for test"};
+    eigen_alloc_vector<Mat44_t> true_poses_cw_;
+    eigen_alloc_vector<Vec3_t> true_lms_pos_w_;
+    std::vector<std::shared_ptr<data::keyframe>> keyfrms_;
+    std::vector<std::shared_ptr<data::landmark>> lms_;
+    std::vector<std::vector<unsigned int>> lm_indices_of_keyfrms_;
+};
+
+} // namespace
+
+TEST_F(pose_graph_refiner_test, restore_perturbed_chain) {
+    perturb();
+
+    eigen_alloc_unord_map<unsigned int, Mat44_t> initial_keyfrm_to_pose_cw;
+    for (const auto& keyfrm : keyfrms_) {
+        initial_keyfrm_to_pose_cw[keyfrm->id_] = keyfrm->get_pose_cw();
+    }
+    double initial_max_trans_error, initial_max_rot_error;
+    compute_max_errors(initial_keyfrm_to_pose_cw, initial_max_trans_error, initial_max_rot_error);
+
+    const optimize::pose_graph_refiner refiner(15);
+    eigen_alloc_unord_map<unsigned int, Mat44_t> keyfrm_to_pose_cw;
+    ASSERT_TRUE(refiner.optimize(keyfrms_, keyfrm_to_pose_cw));
+    ASSERT_EQ(keyfrm_to_pose_cw.size(), num_keyfrms);
+    double max_trans_error, max_rot_error;
+    compute_max_errors(keyfrm_to_pose_cw, max_trans_error, max_rot_error);
+
+    // The landmarks are noise-free, so the relative poses distilled from them are exact
+    EXPECT_GT(initial_max_trans_error, 0.01);
+    EXPECT_LT(max_trans_error, 0.1 * initial_max_trans_error);
+    EXPECT_LT(max_rot_error, 0.1 * initial_max_rot_error);
+}
+
+TEST_F(pose_graph_refiner_test, keep_relative_poses_without_enough_shared_landmarks) {
+    perturb();
+
+    // No constraint can be distilled, so only the spanning tree keeps the current relative poses
+    const optimize::pose_graph_refiner refiner(1000);
+    eigen_alloc_unord_map<unsigned int, Mat44_t> keyfrm_to_pose_cw;
+    ASSERT_TRUE(refiner.optimize(keyfrms_, keyfrm_to_pose_cw));
+    ASSERT_EQ(keyfrm_to_pose_cw.size(), num_keyfrms);
+    for (const auto& keyfrm : keyfrms_) {
+        const Mat44_t error = keyfrm_to_pose_cw.at(keyfrm->id_) * keyfrm->get_pose_wc();
+        EXPECT_LT(error.block<3, 1>(0, 3).norm(), 1e-6);
+        EXPECT_LT(Eigen::AngleAxisd(Mat33_t(error.block<3, 3>(0, 0))).angle(), 1e-6);
+    }
+}
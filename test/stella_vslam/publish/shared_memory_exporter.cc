@@ -0,0 +1,243 @@
+#include "stella_vslam/data/landmark.h"
+#include "stella_vslam/data/map_database.h"
+#include "stella_vslam/publish/shared_memory_exporter.h"
+#include "stella_vslam/publish/shared_memory_reader.h"
+
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+std::string get_shm_name(const std::string& test_name) {
+    return "/stella_vslam_test_" + test_name + "_" + std::to_string(getpid());
+}
+
+std::shared_ptr<data::landmark> create_landmark(const unsigned int id, const Vec3_t& pos_w) {
+    return std::make_shared<data::landmark>(id, 0, pos_w, nullptr, 1, 1);
+}
+
+} // namespace
+
+TEST(shared_memory_exporter, read_latest_pose) {
+    publish::shared_memory_exporter exporter(get_shm_name("pose"), nullptr, 4);
+    publish::shared_memory_reader reader(exporter.name_);
+
+    publish::shm::pose_data pose;
+    EXPECT_FALSE(reader.read_latest_pose(pose));
+
+    for (unsigned int i = 0; i < 10; ++i) {
+        Mat44_t cam_pose_wc = Mat44_t::Identity();
+        cam_pose_wc(0, 3) = i;
+        exporter.publish_pose(0.1 * i, tracker_state_t::Tracking, std::make_shared<Mat44_t>(cam_pose_wc));
+    }
+    exporter.publish_pose(1.0, tracker_state_t::Lost, nullptr);
+    EXPECT_EQ(reader.get_num_poses(), 11);
+
+    ASSERT_TRUE(reader.read_latest_pose(pose));
+    EXPECT_DOUBLE_EQ(pose.timestamp_, 1.0);
+    EXPECT_EQ(pose.tracking_state_, static_cast<uint32_t>(publish::shm::tracking_state_t::Lost));
+    EXPECT_EQ(pose.pose_is_valid_, 0);
+
+    exporter.publish_pose(1.1, tracker_state_t::Tracking, std::make_shared<Mat44_t>(Mat44_t::Identity()));
+    ASSERT_TRUE(reader.read_latest_pose(pose));
+    EXPECT_EQ(pose.pose_is_valid_, 1);
+    EXPECT_TRUE(Eigen::Map<const Mat44_t>(pose.pose_wc_).isIdentity());
+}
+
+TEST(shared_memory_exporter, read_map_changes) {
+    publish::shared_memory_exporter exporter(get_shm_name("map"), nullptr, 4, 64, 16, 200, 0);
+    publish::shared_memory_reader reader(exporter.name_);
+
+    auto lm_1 = create_landmark(1, Vec3_t{0.0, 0.0, 1.0});
+    auto lm_2 = create_landmark(2, Vec3_t{1.0, 0.0, 1.0});
+    std::vector<publish::shm::map_delta_data> records;
+    uint64_t map_version = 0;
+
+    // The readers start from the snapshot
+    EXPECT_FALSE(reader.read_snapshot(records, map_version));
+    ASSERT_TRUE(exporter.publish_snapshot({}, {lm_1, lm_2}));
+    ASSERT_TRUE(reader.read_snapshot(records, map_version));
+    EXPECT_EQ(map_version, 0);
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records.at(0).op_, static_cast<uint32_t>(publish::shm::delta_op_t::Upsert));
+    EXPECT_EQ(records.at(0).entity_, static_cast<uint32_t>(publish::shm::entity_t::Landmark));
+    EXPECT_EQ(records.at(0).id_, 1);
+    EXPECT_DOUBLE_EQ(records.at(0).data_[2], 1.0);
+    ASSERT_TRUE(reader.read_map_deltas(records));
+    EXPECT_TRUE(records.empty());
+
+    // Only the given changes are written
+    lm_1->set_pos_in_world(Vec3_t{0.0, 0.5, 1.0});
+    exporter.publish_map_changes({}, {lm_1}, {}, {2});
+    EXPECT_EQ(reader.get_map_version(), 1);
+    ASSERT_TRUE(reader.read_map_deltas(records));
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records.at(0).op_, static_cast<uint32_t>(publish::shm::delta_op_t::Upsert));
+    EXPECT_EQ(records.at(0).id_, 1);
+    EXPECT_DOUBLE_EQ(records.at(0).data_[1], 0.5);
+    EXPECT_EQ(records.at(1).op_, static_cast<uint32_t>(publish::shm::delta_op_t::Erase));
+    EXPECT_EQ(records.at(1).id_, 2);
+    EXPECT_EQ(records.at(1).map_version_, 1);
+
+    // Nothing is written without any change
+    exporter.publish_map_changes({}, {}, {}, {});
+    EXPECT_EQ(reader.get_map_version(), 1);
+}
+
+TEST(shared_memory_exporter, resync_with_snapshot) {
+    publish::shared_memory_exporter exporter(get_shm_name("overrun"), nullptr, 4, 8, 32, 200, 0);
+    publish::shared_memory_reader reader(exporter.name_);
+
+    std::vector<std::shared_ptr<data::landmark>> lms;
+    for (unsigned int i = 0; i < 20; ++i) {
+        lms.push_back(create_landmark(i, Vec3_t{0.1 * i, 0.0, 1.0}));
+    }
+    ASSERT_TRUE(exporter.publish_snapshot({}, {}));
+    exporter.publish_map_changes({}, lms, {}, {});
+
+    // The deltas overwrote themselves, and the snapshot is older than the remaining deltas
+    std::vector<publish::shm::map_delta_data> records;
+    uint64_t map_version = 0;
+    EXPECT_FALSE(reader.read_map_deltas(records));
+    EXPECT_FALSE(reader.read_snapshot(records, map_version));
+
+    // The snapshot is written apart from the deltas
+    ASSERT_TRUE(exporter.publish_snapshot({}, lms));
+    ASSERT_TRUE(reader.read_snapshot(records, map_version));
+    EXPECT_EQ(map_version, 1);
+    ASSERT_EQ(records.size(), 20);
+    EXPECT_EQ(records.back().id_, 19);
+
+    // A Reset delta makes the readers resync with the snapshot written with it
+    exporter.publish_map_changes({}, {lms.front()}, {}, {});
+    ASSERT_TRUE(exporter.publish_map_reset({}, {lms.front()}));
+    ASSERT_FALSE(reader.read_map_deltas(records));
+    ASSERT_EQ(records.size(), 1);
+    ASSERT_TRUE(reader.read_snapshot(records, map_version));
+    EXPECT_EQ(map_version, 3);
+    EXPECT_EQ(records.size(), 1);
+    EXPECT_TRUE(reader.read_map_deltas(records));
+}
+
+TEST(shared_memory_exporter, refuse_snapshot_exceeding_capacity) {
+    publish::shared_memory_exporter exporter(get_shm_name("capacity"), nullptr, 4, 8, 4, 200, 0);
+    publish::shared_memory_reader reader(exporter.name_);
+
+    std::vector<std::shared_ptr<data::landmark>> lms;
+    for (unsigned int i = 0; i < 4; ++i) {
+        lms.push_back(create_landmark(i, Vec3_t{0.1 * i, 0.0, 1.0}));
+    }
+    ASSERT_TRUE(exporter.publish_snapshot({}, lms));
+
+    // The previous snapshot is kept
+    lms.push_back(create_landmark(4, Vec3_t{0.4, 0.0, 1.0}));
+    EXPECT_FALSE(exporter.publish_snapshot({}, lms));
+    std::vector<publish::shm::map_delta_data> records;
+    uint64_t map_version = 0;
+    ASSERT_TRUE(reader.read_snapshot(records, map_version));
+    EXPECT_EQ(records.size(), 4);
+
+    // The Reset delta is not written without the snapshot to resync with
+    EXPECT_FALSE(exporter.publish_map_reset({}, lms));
+    EXPECT_EQ(reader.get_map_version(), 0);
+    ASSERT_TRUE(reader.read_map_deltas(records));
+    EXPECT_TRUE(records.empty());
+    ASSERT_TRUE(reader.read_snapshot(records, map_version));
+    EXPECT_EQ(records.size(), 4);
+}
+
+TEST(shared_memory_exporter, refuse_existing_shared_memory) {
+    publish::shared_memory_exporter exporter(get_shm_name("existing"), nullptr, 4);
+    EXPECT_THROW(publish::shared_memory_exporter(exporter.name_, nullptr, 4), std::runtime_error);
+
+    // The shared memory of the running one is kept
+    publish::shared_memory_reader reader(exporter.name_);
+    exporter.publish_pose(0.0, tracker_state_t::Tracking, nullptr);
+    EXPECT_EQ(reader.get_num_poses(), 1);
+
+    // It is taken over only if requested
+    EXPECT_NO_THROW(publish::shared_memory_exporter(exporter.name_, nullptr, 4, 64, 16, 200, 0, true));
+}
+
+TEST(shared_memory_exporter, export_recorded_changes) {
+    data::map_database map_db(15);
+    publish::shared_memory_exporter exporter(get_shm_name("changes"), &map_db, 4, 64, 16, 200, 0);
+    publish::shared_memory_reader reader(exporter.name_);
+    std::vector<publish::shm::map_delta_data> records;
+    uint64_t map_version = 0;
+
+    // The first export writes the snapshot
+    exporter.export_map_changes();
+    ASSERT_TRUE(reader.read_snapshot(records, map_version));
+    EXPECT_TRUE(records.empty());
+
+    // The addition and the erasure are recorded by the map database
+    auto lm_1 = create_landmark(1, Vec3_t{0.0, 0.0, 1.0});
+    auto lm_2 = create_landmark(2, Vec3_t{1.0, 0.0, 1.0});
+    map_db.add_landmark(lm_1);
+    map_db.add_landmark(lm_2);
+    exporter.export_map_changes();
+    ASSERT_TRUE(reader.read_map_deltas(records));
+    EXPECT_EQ(records.size(), 2);
+
+    map_db.erase_landmark(lm_2->id_);
+    lm_1->set_pos_in_world(Vec3_t{0.0, 0.5, 1.0});
+    map_db.record_changed_landmarks({lm_1->id_});
+    exporter.export_map_changes();
+    ASSERT_TRUE(reader.read_map_deltas(records));
+    ASSERT_EQ(records.size(), 2);
+    for (const auto& delta : records) {
+        if (delta.id_ == lm_1->id_) {
+            EXPECT_EQ(delta.op_, static_cast<uint32_t>(publish::shm::delta_op_t::Upsert));
+            EXPECT_DOUBLE_EQ(delta.data_[1], 0.5);
+        }
+        else {
+            EXPECT_EQ(delta.op_, static_cast<uint32_t>(publish::shm::delta_op_t::Erase));
+            EXPECT_EQ(delta.id_, lm_2->id_);
+        }
+    }
+
+    // The change of the whole map is written as a snapshot
+    map_db.record_map_change();
+    exporter.export_map_changes();
+    EXPECT_FALSE(reader.read_map_deltas(records));
+    ASSERT_TRUE(reader.read_snapshot(records, map_version));
+    ASSERT_EQ(records.size(), 1);
+    EXPECT_EQ(records.front().id_, lm_1->id_);
+}
+
+TEST(shared_memory_exporter, retry_reset_until_snapshot_fits) {
+    data::map_database map_db(15);
+    publish::shared_memory_exporter exporter(get_shm_name("retry"), &map_db, 4, 64, 1, 200, 0);
+    publish::shared_memory_reader reader(exporter.name_);
+    std::vector<publish::shm::map_delta_data> records;
+    uint64_t map_version = 0;
+
+    auto lm_1 = create_landmark(1, Vec3_t{0.0, 0.0, 1.0});
+    auto lm_2 = create_landmark(2, Vec3_t{1.0, 0.0, 1.0});
+    map_db.add_landmark(lm_1);
+    exporter.export_map_changes();
+    ASSERT_TRUE(reader.read_snapshot(records, map_version));
+    ASSERT_EQ(records.size(), 1);
+
+    // The whole map does not fit in the snapshot, so the readers keep the last one without a Reset delta
+    map_db.add_landmark(lm_2);
+    map_db.record_map_change();
+    exporter.export_map_changes();
+    ASSERT_TRUE(reader.read_map_deltas(records));
+    EXPECT_TRUE(records.empty());
+
+    // The reset is written once the snapshot fits
+    map_db.erase_landmark(lm_1->id_);
+    exporter.export_map_changes();
+    EXPECT_FALSE(reader.read_map_deltas(records));
+    ASSERT_TRUE(reader.read_snapshot(records, map_version));
+    ASSERT_EQ(records.size(), 1);
+    EXPECT_EQ(records.front().id_, lm_2->id_);
+    EXPECT_TRUE(reader.read_map_deltas(records));
+}
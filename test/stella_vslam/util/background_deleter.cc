@@ -0,0 +1,60 @@
+#include "stella_vslam/util/background_deleter.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+namespace {
+
+struct destruction_recorder {
+    destruction_recorder(std::atomic<unsigned int>* num_destructed, std::thread::id* destructed_thread_id)
+        : num_destructed_(num_destructed), destructed_thread_id_(destructed_thread_id) {}
+
+    destruction_recorder(destruction_recorder&& other) noexcept
+        : num_destructed_(other.num_destructed_), destructed_thread_id_(other.destructed_thread_id_) {
+        other.num_destructed_ = nullptr;
+    }
+
+    ~destruction_recorder() {
+        if (num_destructed_) {
+            *destructed_thread_id_ = std::this_thread::get_id();
+            ++(*num_destructed_);
+        }
+    }
+
+    std::atomic<unsigned int>* num_destructed_;
+    std::thread::id* destructed_thread_id_;
+};
+
+} // namespace
+
+TEST(background_deleter, destroy_in_background_thread) {
+    std::atomic<unsigned int> num_destructed{0};
+    std::thread::id destructed_thread_id;
+
+    util::background_deleter deleter;
+    deleter.dispose(destruction_recorder(&num_destructed, &destructed_thread_id));
+    deleter.wait_until_empty();
+
+    EXPECT_EQ(num_destructed, 1);
+    EXPECT_NE(destructed_thread_id, std::this_thread::get_id());
+}
+
+TEST(background_deleter, destroy_remaining_objects_on_destruction) {
+    std::atomic<unsigned int> num_destructed{0};
+    std::thread::id destructed_thread_id;
+
+    {
+        util::background_deleter deleter;
+        for (unsigned int i = 0; i < 10; ++i) {
+            std::vector<destruction_recorder> recorders;
+            recorders.emplace_back(&num_destructed, &destructed_thread_id);
+            deleter.dispose(std::move(recorders));
+        }
+    }
+
+    EXPECT_EQ(num_destructed, 10);
+}
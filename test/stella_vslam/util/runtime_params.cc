@@ -0,0 +1,43 @@
+#include "stella_vslam/util/runtime_params.h"
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+using namespace stella_vslam;
+
+TEST(runtime_params, validate_valid_params) {
+    const auto yaml_node = YAML::Load(
+        "Tracking: {max_num_local_keyfrms: 40, margin_local_map_projection: 7.5}\n"
+        "Feature: {ini_fast_threshold: 25, min_fast_threshold: 10}\n");
+    EXPECT_NO_THROW(util::validate_runtime_params(yaml_node));
+}
+
+TEST(runtime_params, validate_invalid_params) {
+    // Not reconfigurable
+    EXPECT_THROW(util::validate_runtime_params(YAML::Load("Camera: {fps: 30}")), std::invalid_argument);
+    EXPECT_THROW(util::validate_runtime_params(YAML::Load("Tracking: {enable_auto_relocalization: false}")), std::invalid_argument);
+    // Out of the range
+    EXPECT_THROW(util::validate_runtime_params(YAML::Load("Feature: {ini_fast_threshold: 300}")), std::invalid_argument);
+    EXPECT_THROW(util::validate_runtime_params(YAML::Load("Tracking: {max_num_local_keyfrms: 0}")), std::invalid_argument);
+    // Not an integer
+    EXPECT_THROW(util::validate_runtime_params(YAML::Load("Mapping: {local_ba_num_first_iter: 2.5}")), std::invalid_argument);
+    EXPECT_THROW(util::validate_runtime_params(YAML::Load("LoopDetector: {min_continuity: abc}")), std::invalid_argument);
+}
+
+TEST(runtime_params, queue_keeps_request_order) {
+    util::runtime_params_queue params_queue;
+    EXPECT_TRUE(params_queue.pop_all().empty());
+
+    auto yaml_node = YAML::Load("Tracking: {max_num_local_keyfrms: 40}");
+    params_queue.push(yaml_node);
+    // The request must not be affected by the later modification of the node
+    yaml_node["Tracking"]["max_num_local_keyfrms"] = 20;
+    params_queue.push(YAML::Load("Tracking: {max_num_local_keyfrms: 30}"));
+
+    const auto yaml_nodes = params_queue.pop_all();
+    ASSERT_EQ(yaml_nodes.size(), 2);
+    EXPECT_EQ(yaml_nodes.at(0)["Tracking"]["max_num_local_keyfrms"].as<unsigned int>(), 40);
+    EXPECT_EQ(yaml_nodes.at(1)["Tracking"]["max_num_local_keyfrms"].as<unsigned int>(), 30);
+    EXPECT_TRUE(params_queue.pop_all().empty());
+}